@@ -106,6 +106,18 @@ private:
     MandatoryOff("layer");
     SetDefaultParameterInt("layer",0);
 
+    AddParameter(ParameterType_Bool, "spatialsorting", "Spatial sorting of samples");
+    SetParameterDescription("spatialsorting", "If enabled, the sampling positions of each "
+      "streaming division are sorted by image row and column before being dispatched to the "
+      "threads. This speeds up the extraction, but the output samples are not written in the "
+      "order of the input positions.");
+
+    AddParameter(ParameterType_Int, "transactionsize", "Transaction size");
+    SetParameterDescription("transactionsize", "Maximum number of samples written to the "
+      "output within one transaction. 0 means one transaction for each streaming division.");
+    SetMinimumParameterIntValue("transactionsize",0);
+    SetDefaultParameterInt("transactionsize",0);
+
     AddRAMParameter();
 
     // Doc example parameter settings
@@ -202,6 +214,8 @@ private:
     filter->SetClassFieldName(fieldName);
     filter->SetOutputFieldPrefix(namePrefix);
     filter->SetOutputFieldNames(nameList);
+    filter->SetSpatialSorting(GetParameterInt("spatialsorting"));
+    filter->SetTransactionSize(GetParameterInt("transactionsize"));
     filter->GetStreamer()->SetAutomaticAdaptativeStreaming(GetParameterInt("ram"));
 
     
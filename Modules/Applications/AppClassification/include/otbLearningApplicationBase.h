@@ -32,6 +32,9 @@
 
 //Estimator
 #include "otbMachineLearningModelFactory.h"
+
+// Out-of-core sample source
+#include "otbOGRListSampleChunkReader.h"
 #include <string>
 
 namespace otb
@@ -103,6 +106,9 @@ public:
   typedef typename ModelType::TargetListSampleType  TargetListSampleType;
   typedef typename ModelType::TargetValueType       TargetValueType;
 
+  typedef otb::OGRListSampleChunkReader<
+            ListSampleType, TargetListSampleType>  SampleChunkReaderType;
+
   itkGetConstReferenceMacro(SupervisedClassifier, std::vector<std::string>);
   itkGetConstReferenceMacro(UnsupervisedClassifier, std::vector<std::string>);
 
@@ -134,6 +140,31 @@ protected:
     typename ListSampleType::Pointer validationListSample,
     std::string modelPath);
 
+  /** Generic method to train and save the machine learning model on samples
+   * read by chunks, so that the memory used stays bounded. Each epoch is a
+   * complete pass over the samples, and each chunk is given to the model as
+   * a minibatch. Only models supporting incremental training can be used. */
+  void TrainIncremental(SampleChunkReaderType * reader,
+                        unsigned int nbEpochs,
+                        std::string modelPath);
+
+  /** Generic method to load a model file and use it to classify samples read
+   * by chunks. The reference labels of the samples are appended to
+   * referenceLabels, in the same order as the returned predicted labels. */
+  typename TargetListSampleType::Pointer ClassifyIncremental(
+    SampleChunkReaderType * reader,
+    std::string modelPath,
+    TargetListSampleType * referenceLabels);
+
+  /** Is the chosen machine learning model able to learn incrementally ? */
+  bool IsIncrementalTrainingSupported();
+
+  /** Create and configure the chosen machine learning model, without training
+   * it. Returns a null pointer for the models that can not be created apart
+   * from their training. When given, the reader provides the number of
+   * features and the class labels of the samples. */
+  ModelPointerType CreateModel(SampleChunkReaderType * reader);
+
   /** Init method that creates all the parameters for machine learning models */
   void DoInit() override;
 
@@ -186,6 +217,9 @@ private:
   void TrainNeuralNetwork(typename ListSampleType::Pointer trainingListSample,
                           typename TargetListSampleType::Pointer trainingLabeledListSample,
                           std::string modelPath);
+  /** Create and configure the neural network, without training it */
+  ModelPointerType CreateNeuralNetwork(unsigned int nbFeatures,
+                                       const std::vector<TargetValueType> & classLabels);
   void TrainNormalBayes(typename ListSampleType::Pointer trainingListSample,
                         typename TargetListSampleType::Pointer trainingLabeledListSample,
                         std::string modelPath);
@@ -206,6 +240,8 @@ private:
   void TrainSharkKMeans(typename ListSampleType::Pointer trainingListSample,
                         typename TargetListSampleType::Pointer trainingLabeledListSample,
                         std::string modelPath);
+  /** Create and configure the kmeans model, without training it */
+  ModelPointerType CreateSharkKMeans();
 #endif
   //@}
 };
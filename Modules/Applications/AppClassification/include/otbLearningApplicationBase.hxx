@@ -274,6 +274,137 @@ LearningApplicationBase<TInputValue,TOutputValue>
   dummyFilter->InvokeEvent(itk::EndEvent());
 }
 
+template <class TInputValue, class TOutputValue>
+typename LearningApplicationBase<TInputValue,TOutputValue>::ModelPointerType
+LearningApplicationBase<TInputValue,TOutputValue>
+::CreateModel(SampleChunkReaderType * reader)
+{
+  // get the name of the chosen machine learning model
+  const std::string modelName = GetParameterString("classifier");
+  ModelPointerType model;
+  if (modelName == "sharkkm")
+    {
+    #ifdef OTB_USE_SHARK
+    model = CreateSharkKMeans();
+    #endif
+    }
+  else if (modelName == "ann")
+    {
+    #ifdef OTB_USE_OPENCV
+    std::vector<TargetValueType> classLabels;
+    unsigned int nbFeatures = 0;
+    if (reader)
+      {
+      if (!this->m_RegressionFlag)
+        {
+        // The output layer size depends on the number of classes
+        classLabels = reader->ReadClassLabels();
+        }
+      nbFeatures = static_cast<unsigned int>(reader->GetFieldNames().size());
+      }
+    model = CreateNeuralNetwork(nbFeatures, classLabels);
+    #endif
+    }
+  return model;
+}
+
+template <class TInputValue, class TOutputValue>
+bool
+LearningApplicationBase<TInputValue,TOutputValue>
+::IsIncrementalTrainingSupported()
+{
+  ModelPointerType model = CreateModel(nullptr);
+  return model.IsNotNull() && model->IsIncrementalTrainingSupported();
+}
+
+template <class TInputValue, class TOutputValue>
+void
+LearningApplicationBase<TInputValue,TOutputValue>
+::TrainIncremental(SampleChunkReaderType * reader,
+                   unsigned int nbEpochs,
+                   std::string modelPath)
+{
+  otbAppLogINFO("Computing model file : "<<modelPath);
+  otbAppLogINFO("Samples are read by chunks of " << reader->GetChunkSize() << " samples");
+
+  ModelPointerType model = CreateModel(reader);
+  if (model.IsNull() || !model->IsIncrementalTrainingSupported())
+    {
+    otbAppLogFATAL("The classifier " << GetParameterString("classifier")
+                   << " does not support out-of-core training.");
+    }
+
+  // Setup fake reporter
+  RGBAPixelConverter<int,int>::Pointer dummyFilter =
+    RGBAPixelConverter<int,int>::New();
+  dummyFilter->SetProgress(0.0f);
+  this->AddProcess(dummyFilter,"Training model by chunks...");
+  dummyFilter->InvokeEvent(itk::StartEvent());
+
+  for (unsigned int epoch = 0; epoch < nbEpochs; ++epoch)
+    {
+    reader->Rewind();
+    while (reader->ReadNextChunk())
+      {
+      model->SetInputListSample(reader->GetListSample());
+      model->SetTargetListSample(reader->GetTargetListSample());
+      model->TrainIncrement();
+      }
+    otbAppLogINFO("Epoch " << epoch + 1 << "/" << nbEpochs << " done on "
+                  << reader->GetNumberOfSamplesRead() << " samples");
+    dummyFilter->UpdateProgress(static_cast<float>(epoch + 1) / nbEpochs);
+    }
+  model->Save(modelPath);
+
+  dummyFilter->UpdateProgress(1.0f);
+  dummyFilter->InvokeEvent(itk::EndEvent());
+}
+
+template <class TInputValue, class TOutputValue>
+typename LearningApplicationBase<TInputValue,TOutputValue>
+::TargetListSampleType::Pointer
+LearningApplicationBase<TInputValue,TOutputValue>
+::ClassifyIncremental(SampleChunkReaderType * reader,
+                      std::string modelPath,
+                      TargetListSampleType * referenceLabels)
+{
+  // Setup fake reporter
+  RGBAPixelConverter<int,int>::Pointer dummyFilter =
+    RGBAPixelConverter<int,int>::New();
+  dummyFilter->SetProgress(0.0f);
+  this->AddProcess(dummyFilter,"Validation by chunks...");
+  dummyFilter->InvokeEvent(itk::StartEvent());
+
+  ModelPointerType model = ModelFactoryType::CreateMachineLearningModel(modelPath,
+                                                                        ModelFactoryType::ReadMode);
+  if (model.IsNull())
+    {
+    otbAppLogFATAL(<< "Error when loading model " << modelPath);
+    }
+  model->Load(modelPath);
+  model->SetRegressionMode(this->m_RegressionFlag);
+
+  // Only labels are kept in memory
+  typename TargetListSampleType::Pointer predictedList = TargetListSampleType::New();
+  reader->Rewind();
+  while (reader->ReadNextChunk())
+    {
+    typename TargetListSampleType::Pointer predictedChunk = model->PredictBatch(reader->GetListSample(), NULL);
+    const TargetListSampleType * referenceChunk = reader->GetTargetListSample();
+    for (unsigned int i = 0; i < predictedChunk->Size(); ++i)
+      {
+      predictedList->PushBack(predictedChunk->GetMeasurementVector(i));
+      referenceLabels->PushBack(referenceChunk->GetMeasurementVector(i));
+      }
+    }
+
+  // update reporter
+  dummyFilter->UpdateProgress(1.0f);
+  dummyFilter->InvokeEvent(itk::EndEvent());
+
+  return predictedList;
+}
+
 }
 }
 
@@ -143,6 +143,8 @@ void TrainImagesBase::ShareClassificationParams()
   ShareParameter( "rand", "training.rand" );
 
   ShareParameter( "io.confmatout", "training.io.confmatout" );
+
+  ShareParameter( "stream", "training.stream" );
 }
 
 void TrainImagesBase::ConnectClassificationParams()
@@ -161,12 +161,37 @@ LearningApplicationBase<TInputValue,TOutputValue>
 ::TrainNeuralNetwork(typename ListSampleType::Pointer trainingListSample,
                      typename TargetListSampleType::Pointer trainingLabeledListSample,
                      std::string modelPath)
+{
+  std::vector<TargetValueType> classLabels;
+  if (!this->m_RegressionFlag)
+    {
+    std::set<TargetValueType> labelSet;
+    TargetSampleType currentLabel;
+    for (unsigned int itLab = 0; itLab < trainingLabeledListSample->Size(); ++itLab)
+      {
+      currentLabel = trainingLabeledListSample->GetMeasurementVector(itLab);
+      labelSet.insert(currentLabel[0]);
+      }
+    classLabels.assign(labelSet.begin(), labelSet.end());
+    }
+
+  ModelPointerType classifier =
+    CreateNeuralNetwork(trainingListSample->GetMeasurementVectorSize(), classLabels);
+  classifier->SetInputListSample(trainingListSample);
+  classifier->SetTargetListSample(trainingLabeledListSample);
+  classifier->Train();
+  classifier->Save(modelPath);
+}
+
+template <class TInputValue, class TOutputValue>
+typename LearningApplicationBase<TInputValue,TOutputValue>::ModelPointerType
+LearningApplicationBase<TInputValue,TOutputValue>
+::CreateNeuralNetwork(unsigned int nbFeatures,
+                      const std::vector<TargetValueType> & classLabels)
 {
   typedef otb::NeuralNetworkMachineLearningModel<InputValueType, OutputValueType> NeuralNetworkType;
   typename NeuralNetworkType::Pointer classifier = NeuralNetworkType::New();
   classifier->SetRegressionMode(this->m_RegressionFlag);
-  classifier->SetInputListSample(trainingListSample);
-  classifier->SetTargetListSample(trainingLabeledListSample);
 
   switch (GetParameterInt("classifier.ann.t"))
     {
@@ -185,8 +210,7 @@ LearningApplicationBase<TInputValue,TOutputValue>
   std::vector<std::string> sizes = GetParameterStringList("classifier.ann.sizes");
 
 
-  unsigned int nbImageBands = trainingListSample->GetMeasurementVectorSize();
-  layerSizes.push_back(nbImageBands);
+  layerSizes.push_back(nbFeatures);
   for (unsigned int i = 0; i < sizes.size(); i++)
     {
     unsigned int nbNeurons = boost::lexical_cast<unsigned int>(sizes[i]);
@@ -194,22 +218,14 @@ LearningApplicationBase<TInputValue,TOutputValue>
     }
 
 
-  unsigned int nbClasses = 0;
   if (this->m_RegressionFlag)
     {
     layerSizes.push_back(1);
     }
   else
     {
-    std::set<TargetValueType> labelSet;
-    TargetSampleType currentLabel;
-    for (unsigned int itLab = 0; itLab < trainingLabeledListSample->Size(); ++itLab)
-      {
-      currentLabel = trainingLabeledListSample->GetMeasurementVector(itLab);
-      labelSet.insert(currentLabel[0]);
-      }
-    nbClasses = labelSet.size();
-    layerSizes.push_back(nbClasses);
+    layerSizes.push_back(static_cast<unsigned int>(classLabels.size()));
+    classifier->SetClassLabels(classLabels);
     }
 
   classifier->SetLayerSizes(layerSizes);
@@ -254,8 +270,7 @@ LearningApplicationBase<TInputValue,TOutputValue>
     }
   classifier->SetEpsilon(GetParameterFloat("classifier.ann.eps"));
   classifier->SetMaxIter(GetParameterInt("classifier.ann.iter"));
-  classifier->Train();
-  classifier->Save(modelPath);
+  return classifier.GetPointer();
 }
 
 } //end namespace wrapper
@@ -50,6 +50,17 @@ template<class TInputValue, class TOutputValue>
 void LearningApplicationBase<TInputValue, TOutputValue>::TrainSharkKMeans(
         typename ListSampleType::Pointer trainingListSample,
         typename TargetListSampleType::Pointer trainingLabeledListSample, std::string modelPath)
+{
+  ModelPointerType classifier = CreateSharkKMeans();
+  classifier->SetInputListSample( trainingListSample );
+  classifier->SetTargetListSample( trainingLabeledListSample );
+  classifier->Train();
+  classifier->Save( modelPath );
+}
+
+template<class TInputValue, class TOutputValue>
+typename LearningApplicationBase<TInputValue, TOutputValue>::ModelPointerType
+LearningApplicationBase<TInputValue, TOutputValue>::CreateSharkKMeans()
 {
   unsigned int nbMaxIter = static_cast<unsigned int>(abs( GetParameterInt( "classifier.sharkkm.maxiter" ) ));
   unsigned int k = static_cast<unsigned int>(abs( GetParameterInt( "classifier.sharkkm.k" ) ));
@@ -57,12 +68,9 @@ void LearningApplicationBase<TInputValue, TOutputValue>::TrainSharkKMeans(
   typedef otb::SharkKMeansMachineLearningModel<InputValueType, OutputValueType> SharkKMeansType;
   typename SharkKMeansType::Pointer classifier = SharkKMeansType::New();
   classifier->SetRegressionMode( this->m_RegressionFlag );
-  classifier->SetInputListSample( trainingListSample );
-  classifier->SetTargetListSample( trainingLabeledListSample );
   classifier->SetK( k );
   classifier->SetMaximumNumberOfIterations( nbMaxIter );
-  classifier->Train();
-  classifier->Save( modelPath );
+  return classifier.GetPointer();
 }
 
 } //end namespace wrapper
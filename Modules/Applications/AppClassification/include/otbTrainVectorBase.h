@@ -72,6 +72,8 @@ public:
 
   typedef otb::Statistics::ShiftScaleSampleListFilter<ListSampleType, ListSampleType> ShiftScaleFilterType;
 
+  typedef Superclass::SampleChunkReaderType SampleChunkReaderType;
+
 protected:
 
   /** Class used to store statistics Measurment (mean/stddev) */
@@ -169,6 +171,25 @@ protected:
   ExtractSamplesWithLabel(std::string parameterName, std::string parameterLayer, const ShiftScaleParameters &measurement);
 
 
+  /** Create a reader giving the samples of the input files by chunks, the
+   * chunk size being deduced from the available RAM.
+   *
+   * \param parameterName the name of the input file option in the input application parameters
+   * \param parameterLayer the name of the layer option in the input application parameters
+   * \param measurement statics measurement (mean/stddev)
+   * \return the configured reader
+   */
+  SampleChunkReaderType::Pointer
+  CreateSampleChunkReader(std::string parameterName, std::string parameterLayer, const ShiftScaleParameters &measurement);
+
+  /**
+   * Train the model and classify the validation samples without loading all
+   * the samples in memory. Only the reference and predicted labels of the
+   * validation samples are kept.
+   * \param measurement statics measurement (mean/stddev)
+   */
+  virtual void TrainAndClassifyIncrementally(const ShiftScaleParameters &measurement);
+
   /**
    * Retrieve statistics mean and standard deviation if input statistics are provided.
    * Otherwise mean is set to 0 and standard deviation to 1 for each Features.
@@ -95,6 +95,29 @@ void TrainVectorBase::DoInit()
   SetParameterDescription("v", "Verbose mode, display the contingency table result.");
   SetParameterInt("v", 1);
 
+  // Out-of-core training
+  AddParameter( ParameterType_Group, "stream", "Out-of-core training" );
+  SetParameterDescription( "stream",
+    "This group of parameters allows reading the samples by chunks instead of "
+    "loading them all in memory. It is only available for the classifiers able "
+    "to learn incrementally (sharkkm and ann)." );
+
+  AddParameter( ParameterType_Bool, "stream.enable", "Enable out-of-core training" );
+  SetParameterDescription( "stream.enable",
+    "If enabled, the samples are read by chunks and each chunk is used as a "
+    "minibatch to update the model. The validation is also done by chunks." );
+
+  AddParameter( ParameterType_Int, "stream.epochs", "Number of epochs" );
+  SetParameterDescription( "stream.epochs",
+    "Number of complete passes over the training samples." );
+  SetDefaultParameterInt( "stream.epochs", 1 );
+  SetMinimumParameterIntValue( "stream.epochs", 1 );
+  MandatoryOff( "stream.epochs" );
+
+  AddRAMParameter( "stream.ram" );
+  SetParameterDescription( "stream.ram",
+    "Available memory for the samples of a chunk (in MB)." );
+
   // Doc example parameter settings
   SetDocExampleParameterValue( "io.vd", "vectorData.shp" );
   SetDocExampleParameterValue( "io.stats", "meanVar.xml" );
@@ -156,6 +179,13 @@ void TrainVectorBase::DoExecute()
     }
 
   ShiftScaleParameters measurement = GetStatistics( m_FeaturesInfo.m_NbFeatures );
+
+  if( GetParameterInt( "stream.enable" ) )
+    {
+    TrainAndClassifyIncrementally( measurement );
+    return;
+    }
+
   ExtractAllSamples( measurement );
 
   this->Train( m_TrainingSamplesWithLabel.listSample, m_TrainingSamplesWithLabel.labeledListSample, GetParameterString( "io.out" ) );
@@ -207,6 +237,54 @@ TrainVectorBase::ExtractClassificationSamplesWithLabel(const ShiftScaleParameter
 }
 
 
+void TrainVectorBase::TrainAndClassifyIncrementally(const ShiftScaleParameters &measurement)
+{
+  if( !IsIncrementalTrainingSupported() )
+    {
+    otbAppLogFATAL( "The classifier " << GetParameterString( "classifier" )
+                    << " does not support out-of-core training." );
+    }
+
+  SampleChunkReaderType::Pointer trainingReader = CreateSampleChunkReader( "io.vd", "layer", measurement );
+  this->TrainIncremental( trainingReader, static_cast<unsigned int>( GetParameterInt( "stream.epochs" ) ),
+                          GetParameterString( "io.out" ) );
+
+  SampleChunkReaderType::Pointer validationReader = trainingReader;
+  if( GetClassifierCategory() == Supervised )
+    {
+    if( HasValue( "valid.vd" ) && IsParameterEnabled( "valid.vd" ) )
+      {
+      validationReader = CreateSampleChunkReader( "valid.vd", "valid.layer", measurement );
+      }
+    else
+      {
+      otbAppLogWARNING(
+              "The validation set is empty. The performance estimation is done using the input training set in this case." );
+      }
+    }
+
+  // Sample lists are left empty, only labels are stored
+  m_TrainingSamplesWithLabel = SamplesWithLabel();
+  m_ClassificationSamplesWithLabel = SamplesWithLabel();
+  m_PredictedList = this->ClassifyIncremental( validationReader, GetParameterString( "io.out" ),
+                                               m_ClassificationSamplesWithLabel.labeledListSample );
+}
+
+TrainVectorBase::SampleChunkReaderType::Pointer
+TrainVectorBase::CreateSampleChunkReader(std::string parameterName, std::string parameterLayer,
+                                         const ShiftScaleParameters &measurement)
+{
+  SampleChunkReaderType::Pointer reader = SampleChunkReaderType::New();
+  reader->SetFileNames( this->GetParameterStringList( parameterName ) );
+  reader->SetLayerIndex( static_cast<unsigned int>( this->GetParameterInt( parameterLayer ) ) );
+  reader->SetFieldNames( m_FeaturesInfo.m_SelectedNames );
+  reader->SetClassFieldName( m_FeaturesInfo.m_SelectedCFieldName );
+  reader->SetShifts( measurement.meanMeasurementVector );
+  reader->SetScales( measurement.stddevMeasurementVector );
+  reader->SetAvailableRAM( static_cast<unsigned int>( this->GetParameterInt( "stream.ram" ) ) );
+  return reader;
+}
+
 TrainVectorBase::ShiftScaleParameters
 TrainVectorBase::GetStatistics(unsigned int nbFeatures)
 {
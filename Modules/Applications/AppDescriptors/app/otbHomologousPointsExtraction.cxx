@@ -29,6 +29,7 @@
 #include "otbImageToSIFTKeyPointSetFilter.h"
 #endif
 #include "otbImageToSURFKeyPointSetFilter.h"
+#include "otbImageToTiledKeyPointSetFilter.h"
 #include "otbKeyPointSetsMatchingFilter.h"
 #include "otbMultiToMonoChannelExtractROI.h"
 #include "otbKeyPointSetsMatchingFilter.h"
@@ -146,6 +147,24 @@ private:
     AddParameter(ParameterType_Bool,"backmatching","Use back-matching to filter matches");
     SetParameterDescription("backmatching","If set to true, matches should be consistent in both ways.");
 
+    AddParameter(ParameterType_Bool,"exactsearch","Use exhaustive nearest neighbor search");
+    SetParameterDescription("exactsearch","If set to true, the nearest neighbors of the keypoints are found by an exhaustive search instead of an approximate search with randomized k-d trees. This is slower on large keypoint sets.");
+
+    AddParameter(ParameterType_Int,"tilesize","Size of keypoints extraction tiles");
+    SetParameterDescription("tilesize","If set, keypoints are extracted in parallel on square tiles of this size (in pixels) instead of whole images, which bounds the memory used by large images.");
+    SetMinimumParameterIntValue("tilesize",16);
+    MandatoryOff("tilesize");
+
+    AddParameter(ParameterType_Int,"tilestep","Step between keypoints extraction tiles");
+    SetParameterDescription("tilestep","Step between tiles in pixels. If larger than the tile size, keypoints are only extracted on a sparse grid of tiles. If not set, the tiles cover the whole images.");
+    SetMinimumParameterIntValue("tilestep",16);
+    MandatoryOff("tilestep");
+
+    AddParameter(ParameterType_Int,"tilemargin","Margin of keypoints extraction tiles");
+    SetParameterDescription("tilemargin","Margin added around each tile (in pixels), so that keypoints near tile borders are detected as on the whole image.");
+    SetMinimumParameterIntValue("tilemargin",0);
+    SetDefaultParameterInt("tilemargin",64);
+
     AddParameter(ParameterType_Choice,"mode","Keypoints search mode");
 
     AddChoice("mode.full","Extract and match all keypoints (no streaming)");
@@ -205,6 +224,38 @@ private:
 
   }
 
+  template <class TKeyPointFilter>
+  PointSetType::Pointer ExtractKeyPoints(FloatImageType * image, bool parallelTiles)
+  {
+    PointSetType::Pointer keyPoints;
+    if(IsParameterEnabled("tilesize"))
+      {
+      typedef ImageToTiledKeyPointSetFilter<TKeyPointFilter> TiledFilterType;
+      typename TiledFilterType::Pointer tiledFilter = TiledFilterType::New();
+      typename TiledFilterType::SizeType tileSize, tileStep;
+      tileSize.Fill(GetParameterInt("tilesize"));
+      tileStep.Fill(IsParameterEnabled("tilestep") ? GetParameterInt("tilestep") : 0);
+      tiledFilter->SetInput(image);
+      tiledFilter->SetTileSize(tileSize);
+      tiledFilter->SetTileStep(tileStep);
+      tiledFilter->SetMargin(GetParameterInt("tilemargin"));
+      if(!parallelTiles)
+        {
+        tiledFilter->SetNumberOfThreads(1);
+        }
+      tiledFilter->Update();
+      keyPoints = tiledFilter->GetOutput();
+      }
+    else
+      {
+      typename TKeyPointFilter::Pointer filter = TKeyPointFilter::New();
+      filter->SetInput(image);
+      filter->Update();
+      keyPoints = filter->GetOutput();
+      }
+    return keyPoints;
+  }
+
   void Match(FloatImageType * im1, FloatImageType * im2, RSTransformType * rsTransform, RSTransformType * rsTransform1ToWGS84,RSTransformType * rsTransform2ToWGS84, std::ofstream & file, OGRMultiLineString * mls = nullptr)
   {
     MatchingFilterType::Pointer matchingFilter = MatchingFilterType::New();
@@ -212,46 +263,42 @@ private:
     if(GetParameterString("algorithm")=="sift")
       {
       otbAppLogINFO("Using SIFT points");
-      SiftFilterType::Pointer sift1 = SiftFilterType::New();
-      sift1->SetInput(im1);
-
-      SiftFilterType::Pointer sift2 = SiftFilterType::New();
-      sift2->SetInput(im2);
+      #ifdef OTB_USE_SIFTFAST
+      // SiftFast uses global resources, tiles can not be processed in parallel
+      const bool parallelTiles = false;
+      #else
+      const bool parallelTiles = true;
+      #endif
+      PointSetType::Pointer sift1 = ExtractKeyPoints<SiftFilterType>(im1, parallelTiles);
 
-      sift1->Update();
+      otbAppLogINFO("Found " << sift1->GetNumberOfPoints()<<" sift points in image 1.");
 
-      otbAppLogINFO("Found " << sift1->GetOutput()->GetNumberOfPoints()<<" sift points in image 1.");
+      PointSetType::Pointer sift2 = ExtractKeyPoints<SiftFilterType>(im2, parallelTiles);
 
-      sift2->Update();
+      otbAppLogINFO("Found " << sift2->GetNumberOfPoints()<<" sift points in image 2.");
 
-      otbAppLogINFO("Found " << sift2->GetOutput()->GetNumberOfPoints()<<" sift points in image 2.");
-
-      matchingFilter->SetInput1(sift1->GetOutput());
-      matchingFilter->SetInput2(sift2->GetOutput());
+      matchingFilter->SetInput1(sift1);
+      matchingFilter->SetInput2(sift2);
       }
     else if(GetParameterString("algorithm")=="surf")
       {
-      SurfFilterType::Pointer surf1 = SurfFilterType::New();
-      surf1->SetInput(im1);
-
-      SurfFilterType::Pointer surf2 = SurfFilterType::New();
-      surf2->SetInput(im2);
-
       otbAppLogINFO("Doing update");
-      surf1->Update();
+      PointSetType::Pointer surf1 = ExtractKeyPoints<SurfFilterType>(im1, true);
 
-      otbAppLogINFO("Found " << surf1->GetOutput()->GetNumberOfPoints()<<" surf points in image 1.");
+      otbAppLogINFO("Found " << surf1->GetNumberOfPoints()<<" surf points in image 1.");
 
-      surf2->Update();
+      PointSetType::Pointer surf2 = ExtractKeyPoints<SurfFilterType>(im2, true);
 
-      otbAppLogINFO("Found " << surf2->GetOutput()->GetNumberOfPoints()<<" surf points in image 2.");
+      otbAppLogINFO("Found " << surf2->GetNumberOfPoints()<<" surf points in image 2.");
 
-      matchingFilter->SetInput1(surf1->GetOutput());
-      matchingFilter->SetInput2(surf2->GetOutput());
+      matchingFilter->SetInput1(surf1);
+      matchingFilter->SetInput2(surf2);
       matchingFilter->SetDistanceThreshold(GetParameterFloat("threshold"));
       matchingFilter->SetUseBackMatching(GetParameterInt("backmatching"));
       }
 
+    matchingFilter->SetExactSearch(GetParameterInt("exactsearch"));
+
     try
       {
 
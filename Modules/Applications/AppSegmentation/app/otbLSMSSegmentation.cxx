@@ -27,6 +27,7 @@
 #include "itkStatisticsImageFilter.h"
 #include "itkChangeLabelImageFilter.h"
 #include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
 #include "itkScalarConnectedComponentImageFilter.h"
 #include "otbConcatenateVectorImageFilter.h"
 #include "otbAffineFunctor.h"
@@ -36,6 +37,7 @@
 
 #include <time.h>
 #include <algorithm>
+#include <map>
 
 #include "otbWrapperApplication.h"
 #include "otbWrapperApplicationFactory.h"
@@ -98,6 +100,8 @@ private:
   // ImportGeoInformationImageFilterType::Pointer m_ImportGeoInformationFilter;
   std::vector<std::string> m_FilesToRemoveAfterExecute;
   bool m_TmpDirCleanup;
+  // Tiles kept in memory (memory mode), indexed by their file name
+  std::map<std::string, LabelImageType::Pointer> m_InMemoryTiles;
 
   std::string CreateFileName(unsigned int row, unsigned int column, std::string label)
   {
@@ -129,6 +133,14 @@ private:
   {
     std::string currentFile = CreateFileName(row,column,label);
 
+    if(GetParameterInt("memory"))
+      {
+      img->Update();
+      img->DisconnectPipeline();
+      m_InMemoryTiles[currentFile] = img;
+      return currentFile;
+      }
+
     LabelImageWriterType::Pointer imageWriter = LabelImageWriterType::New();
     imageWriter->SetInput(img);
     imageWriter->SetFileName(currentFile);
@@ -137,8 +149,35 @@ private:
     return currentFile;
   }
 
+  LabelImageType::Pointer ReadTile(unsigned int row, unsigned int column, std::string label)
+  {
+    std::string currentFile = CreateFileName(row,column,label);
+
+    if(GetParameterInt("memory"))
+      {
+      std::map<std::string, LabelImageType::Pointer>::iterator it = m_InMemoryTiles.find(currentFile);
+      if(it == m_InMemoryTiles.end())
+        {
+        otbAppLogFATAL(<<"Tile "<<currentFile<<" not found in memory");
+        }
+      return it->second;
+      }
+
+    LabelImageReaderType::Pointer reader = LabelImageReaderType::New();
+    reader->SetFileName(currentFile);
+    reader->Update();
+    LabelImageType::Pointer img = reader->GetOutput();
+    img->DisconnectPipeline();
+    return img;
+  }
+
   void RemoveFile(std::string tile)
   {
+    if(m_InMemoryTiles.erase(tile) > 0)
+      {
+      return;
+      }
+
     // Cleanup
     if(GetParameterInt("cleanup"))
       {
@@ -239,7 +278,9 @@ private:
                           " soon as they are not needed anymore (if cleanup is activated, tmpdir"
                           " set and tmpdir does not exists before running the application, it will"
                           " be removed as well during cleanup). The tmpdir option allows defining"
-                          " a directory where to write the temporary files.\n\n"
+                          " a directory where to write the temporary files. If enough memory is"
+                          " available, the memory option allows keeping the tiles in memory"
+                          " instead, so that no temporary file is written.\n\n"
                           "Please also note that the output image type should be set to uint32 to"
                           " ensure that there are enough labels available.\n\n"
                           "The output of this application can be passed to the"
@@ -307,6 +348,9 @@ private:
     SetParameterDescription("cleanup","If activated, the application will try to remove all temporary files it created.");
     SetParameterInt("cleanup",1);
 
+    AddParameter(ParameterType_Bool,"memory","Keep tiles in memory");
+    SetParameterDescription("memory","If activated, the tiles are kept in memory instead of being written to temporary files, and the output label image is assembled in memory. This avoids all temporary file I/O, but needs about twice the size of the output label image in memory. The tmpdir and cleanup parameters are not used in this mode.");
+
     // Doc example parameter settings
     SetDocExampleParameterValue("in","smooth.tif");
     SetDocExampleParameterValue("inpos","position.tif");
@@ -339,8 +383,11 @@ private:
     unsigned long sizeTilesY   = GetParameterInt("tilesizey");
 
 
+    const bool inMemory = GetParameterInt("memory");
+    m_InMemoryTiles.clear();
+
     // Ensure that temporary directory exists if activated:
-    if(IsParameterEnabled("tmpdir"))
+    if(!inMemory && IsParameterEnabled("tmpdir"))
       {
       if(!itksys::SystemTools::FileExists(GetParameterString("tmpdir")))
         {
@@ -478,20 +525,13 @@ private:
         unsigned long sizeX = std::min(sizeTilesX+1,sizeImageX-startX+1);
         unsigned long sizeY = std::min(sizeTilesY+1,sizeImageY-startY+1);
 
-        std::string tileIn = CreateFileName(row,column,"SEG");
-
         // Read current tile
-        LabelImageReaderType::Pointer tileInReader = LabelImageReaderType::New();
-        tileInReader->SetFileName(tileIn);
-        tileInReader->Update();
+        LabelImageType::Pointer tileIn = ReadTile(row,column,"SEG");
 
         // Analyse intersection between in and up tiles
         if(row>0)
           {
-          std::string tileUp = CreateFileName(row-1,column,"SEG");
-          LabelImageReaderType::Pointer tileUpReader = LabelImageReaderType::New();
-          tileUpReader->SetFileName(tileUp);
-          tileUpReader->Update();
+          LabelImageType::Pointer tileUp = ReadTile(row-1,column,"SEG");
 
           LabelImageType::IndexType pixelIndexIn;
           LabelImageType::IndexType pixelIndexUp;
@@ -503,12 +543,12 @@ private:
             {
             pixelIndexUp[0] = pixelIndexIn[0];
 
-            LabelImagePixelType curCanLabel = tileInReader->GetOutput()->GetPixel(pixelIndexIn);
+            LabelImagePixelType curCanLabel = tileIn->GetPixel(pixelIndexIn);
            while(LUT[curCanLabel] != curCanLabel)
               {
               curCanLabel = LUT[curCanLabel];
               }
-           LabelImagePixelType adjCanLabel = tileUpReader->GetOutput()->GetPixel(pixelIndexUp);
+           LabelImagePixelType adjCanLabel = tileUp->GetPixel(pixelIndexUp);
 
            while(LUT[adjCanLabel] != adjCanLabel)
               {
@@ -528,10 +568,7 @@ private:
         // Analyse intersection between in and left tiles
          if(column>0)
           {
-          std::string tileLeft = CreateFileName(row,column-1,"SEG");
-          LabelImageReaderType::Pointer tileLeftReader = LabelImageReaderType::New();
-          tileLeftReader->SetFileName(tileLeft);
-          tileLeftReader->Update();
+          LabelImageType::Pointer tileLeft = ReadTile(row,column-1,"SEG");
 
           LabelImageType::IndexType pixelIndexIn;
           LabelImageType::IndexType pixelIndexUp;
@@ -543,12 +580,12 @@ private:
             {
             pixelIndexUp[1] = pixelIndexIn[1];
 
-            LabelImagePixelType curCanLabel = tileInReader->GetOutput()->GetPixel(pixelIndexIn);
+            LabelImagePixelType curCanLabel = tileIn->GetPixel(pixelIndexIn);
            while(LUT[curCanLabel] != curCanLabel)
               {
               curCanLabel = LUT[curCanLabel];
               }
-           LabelImagePixelType adjCanLabel = tileLeftReader->GetOutput()->GetPixel(pixelIndexUp);
+           LabelImagePixelType adjCanLabel = tileLeft->GetPixel(pixelIndexUp);
            while(LUT[adjCanLabel] != adjCanLabel)
               {
               adjCanLabel = LUT[adjCanLabel];
@@ -594,12 +631,11 @@ private:
 
         std::string tileIn = CreateFileName(row,column,"SEG");
 
-        LabelImageReaderType::Pointer readerIn = LabelImageReaderType::New();
-        readerIn->SetFileName(tileIn);
+        LabelImageType::Pointer readerIn = ReadTile(row,column,"SEG");
 
         // Remove extra margin now that lut is built
         ExtractROIFilterType::Pointer labelImage = ExtractROIFilterType::New();
-        labelImage->SetInput(readerIn->GetOutput());
+        labelImage->SetInput(readerIn);
         labelImage->SetStartX(0);
         labelImage->SetStartY(0);
         labelImage->SetSizeX(sizeX);
@@ -634,6 +670,8 @@ private:
 
         // Remove previous tile (not needed anymore)
         readerIn = nullptr; // release the input file
+        labelImage = nullptr;
+        changeLabel = nullptr;
         RemoveFile(tileIn);
         }
       }
@@ -672,11 +710,10 @@ private:
           {
           std::string tileIn = CreateFileName(row,column,"RELAB");
 
-          LabelImageReaderType::Pointer readerIn = LabelImageReaderType::New();
-          readerIn->SetFileName(tileIn);
+          LabelImageType::Pointer readerIn = ReadTile(row,column,"RELAB");
 
           ChangeLabelImageFilterType::Pointer changeLabel = ChangeLabelImageFilterType::New();
-          changeLabel->SetInput(readerIn->GetOutput());
+          changeLabel->SetInput(readerIn);
           for(LabelImagePixelType label = 1; label<regionCount+1; ++label)
             {
             if(label != newLabels[label])
@@ -687,10 +724,14 @@ private:
 
           // Write the relabeled tile
           std::string tmpfile = WriteTile(changeLabel->GetOutput(),row,column,"FINAL");
-          m_FilesToRemoveAfterExecute.push_back(tmpfile);
+          if(!inMemory)
+            {
+            m_FilesToRemoveAfterExecute.push_back(tmpfile);
+            }
 
           // Clean previous tiles (not needed anymore)
           readerIn = nullptr; // release the input file
+          changeLabel = nullptr;
           RemoveFile(tileIn);
           }
         }
@@ -698,6 +739,51 @@ private:
       // Clear newLabels, we do not need it anymore
       newLabels.clear();
 
+      if(inMemory)
+        {
+        // Assemble the final tiles in a single label image
+        LabelImageType::Pointer labelOut = LabelImageType::New();
+        LabelImageType::RegionType outRegion;
+        outRegion.SetSize(0, sizeImageX);
+        outRegion.SetSize(1, sizeImageY);
+        labelOut->SetRegions(outRegion);
+        labelOut->Allocate();
+
+        for(unsigned int column = 0; column < nbTilesX; ++column)
+          {
+          for(unsigned int row = 0; row < nbTilesY; ++row)
+            {
+            LabelImageType::Pointer tile = ReadTile(row,column,"FINAL");
+            LabelImageType::RegionType tileRegion = tile->GetLargestPossibleRegion();
+            LabelImageType::RegionType dstRegion = tileRegion;
+            dstRegion.SetIndex(0, column*sizeTilesX);
+            dstRegion.SetIndex(1, row*sizeTilesY);
+            LabelImageIterator srcIt(tile, tileRegion);
+            itk::ImageRegionIterator<LabelImageType> dstIt(labelOut, dstRegion);
+            for(srcIt.GoToBegin(), dstIt.GoToBegin(); !srcIt.IsAtEnd(); ++srcIt, ++dstIt)
+              {
+              dstIt.Set(srcIt.Get());
+              }
+            tile = nullptr;
+            RemoveFile(CreateFileName(row,column,"FINAL"));
+            }
+          }
+
+        clock_t toc = clock();
+
+        otbAppLogINFO(<<"Elapsed time: "<<(double)(toc - tic) / CLOCKS_PER_SEC<<" seconds");
+
+        ImportGeoInformationImageFilterType::Pointer
+          importGeoInformationFilter =
+          ImportGeoInformationImageFilterType::New();
+        importGeoInformationFilter->SetInput(labelOut);
+        importGeoInformationFilter->SetSource(imageIn);
+
+        SetParameterOutputImage("out",importGeoInformationFilter->GetOutput());
+        RegisterPipeline();
+        return;
+        }
+
       // Here we write a temporary vrt file that will be used to
       // stitch together all the tiles
       std::string vrtfile = WriteVRTFile(nbTilesX,nbTilesY,sizeTilesX,sizeTilesY,sizeImageX,sizeImageY);
@@ -745,6 +831,7 @@ private:
       }
 
     m_FilesToRemoveAfterExecute.clear();
+    m_InMemoryTiles.clear();
     m_TmpDirCleanup = false;
   }
 };
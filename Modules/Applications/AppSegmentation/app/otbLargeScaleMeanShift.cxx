@@ -120,6 +120,12 @@ private:
       "The output raster image",
       "It corresponds to the output of the small region merging step.");
 
+    ShareParameter("memory","segmentation.memory",
+      "Keep intermediate results in memory",
+      "If activated, the segmentation tiles and the intermediate label images "
+      "are kept in memory, and no temporary file is written. This needs about "
+      "three times the size of a 32 bits label image of the input in memory.");
+
     AddParameter( ParameterType_Bool, "cleanup", "Temporary files cleaning" );
     SetParameterDescription( "cleanup",
       "If activated, the application will try to clean all temporary files it created" );
@@ -156,6 +162,7 @@ private:
   void DoExecute() override
     {
     bool isVector(GetParameterString("mode") == "vector");
+    bool inMemory(GetParameterInt("memory"));
     std::string outPath(isVector ?
       GetParameterString("mode.vector.out"):
       GetParameterString("mode.raster.out"));
@@ -176,10 +183,20 @@ private:
       0.5 * (double)GetInternalApplication("smoothing")->GetParameterInt("spatialr"));
     GetInternalApplication("segmentation")->SetParameterFloat("ranger",
       0.5 * GetInternalApplication("smoothing")->GetParameterFloat("ranger"));
-    GetInternalApplication("segmentation")->ExecuteAndWriteOutput();
+    if (inMemory)
+      {
+      // in-memory connexion of the label image, no temporary file
+      ExecuteInternal("segmentation");
+      GetInternalApplication("merging")->SetParameterInputImage("inseg",
+        GetInternalApplication("segmentation")->GetParameterOutputImage("out"));
+      }
+    else
+      {
+      GetInternalApplication("segmentation")->ExecuteAndWriteOutput();
+      GetInternalApplication("merging")->SetParameterString("inseg",
+        tmpFilenames[0]);
+      }
 
-    GetInternalApplication("merging")->SetParameterString("inseg",
-      tmpFilenames[0]);
     EnableParameter("mode.raster.out");
     if (isVector)
       {
@@ -187,7 +204,18 @@ private:
       tmpFilenames.push_back(outPath+std::string("_labelmap_merged.geom"));
       GetInternalApplication("merging")->SetParameterString("out",
         tmpFilenames[2]);
-      GetInternalApplication("merging")->ExecuteAndWriteOutput();
+      if (inMemory)
+        {
+        ExecuteInternal("merging");
+        GetInternalApplication("vectorization")->SetParameterInputImage("inseg",
+          GetInternalApplication("merging")->GetParameterOutputImage("out"));
+        }
+      else
+        {
+        GetInternalApplication("merging")->ExecuteAndWriteOutput();
+        GetInternalApplication("vectorization")->SetParameterString("inseg",
+          tmpFilenames[2]);
+        }
       if (IsParameterEnabled("mode.vector.imfield") &&
           HasValue("mode.vector.imfield"))
         {
@@ -199,8 +227,6 @@ private:
         GetInternalApplication("vectorization")->SetParameterInputImage("in",
           GetParameterImage<ImageBaseType>("in"));
         }
-      GetInternalApplication("vectorization")->SetParameterString("inseg",
-        tmpFilenames[2]);
       ExecuteInternal("vectorization");
       }
     else
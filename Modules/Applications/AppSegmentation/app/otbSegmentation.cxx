@@ -30,6 +30,7 @@
 #include "otbVectorImageToAmplitudeImageFilter.h"
 #include "itkGradientMagnitudeImageFilter.h"
 #include "otbWatershedSegmentationFilter.h"
+#include "otbTiledWatershedSegmentationFilter.h"
 #include "otbMorphologicalProfilesSegmentationFilter.h"
 
 // Large scale vectorization framework
@@ -95,6 +96,9 @@ public:
   typedef otb::WatershedSegmentationFilter
   <FloatImageType,LabelImageType>         WatershedSegmentationFilterType;
 
+  typedef otb::TiledWatershedSegmentationFilter
+  <FloatImageType,LabelImageType>         TiledWatershedSegmentationFilterType;
+
   // Geodesic morphology multiscale segmentation
   typedef otb::MorphologicalProfilesSegmentationFilter<FloatImageType,LabelImageType> MorphologicalProfilesSegmentationFilterType;
 
@@ -130,6 +134,10 @@ public:
   <FloatImageType,
    WatershedSegmentationFilterType>      StreamingVectorizedWatershedFilterType;
 
+  typedef otb::StreamingImageToOGRLayerSegmentationFilter
+  <FloatImageType,
+   TiledWatershedSegmentationFilterType> StreamingVectorizedTiledWatershedFilterType;
+
   typedef otb::ClampImageFilter<FloatImageType, UInt32ImageType> ClampFilterType;
 
   /** Standard macro */
@@ -227,6 +235,32 @@ private:
     SetMinimumParameterFloatValue("filter.watershed.level",0);
     SetMaximumParameterFloatValue("filter.watershed.level",1);
 
+    // Tiled watershed
+    AddChoice("filter.tiledwatershed","Tiled watershed");
+    SetParameterDescription("filter.tiledwatershed","A multithreaded watershed on the same height function as the watershed filter. The image is flooded in parallel by tiles, with a halo around each tile, and adjacent basins are merged by increasing saddle height. Its segments differ from the ones of the watershed filter.");
+
+    AddParameter(ParameterType_Float,"filter.tiledwatershed.threshold","Depth Threshold");
+    SetParameterDescription("filter.tiledwatershed.threshold","Depth threshold Units in percentage of the maximum depth in the image.");
+    SetDefaultParameterFloat("filter.tiledwatershed.threshold",0.01);
+    SetMinimumParameterFloatValue("filter.tiledwatershed.threshold",0);
+    SetMaximumParameterFloatValue("filter.tiledwatershed.threshold",1);
+
+    AddParameter(ParameterType_Float,"filter.tiledwatershed.level","Flood Level");
+    SetParameterDescription("filter.tiledwatershed.level","Adjacent basins are merged when the shallowest one is less deep than this level below their saddle (between 0 and 1, in proportion of the height range)");
+    SetDefaultParameterFloat("filter.tiledwatershed.level",0.1);
+    SetMinimumParameterFloatValue("filter.tiledwatershed.level",0);
+    SetMaximumParameterFloatValue("filter.tiledwatershed.level",1);
+
+    AddParameter(ParameterType_Int,"filter.tiledwatershed.tilesize","Flooding tile size");
+    SetParameterDescription("filter.tiledwatershed.tilesize","Size of the tiles flooded in parallel. The whole image (or stream tile in vector mode) is held in memory.");
+    SetDefaultParameterInt("filter.tiledwatershed.tilesize",512);
+    SetMinimumParameterIntValue("filter.tiledwatershed.tilesize",1);
+
+    AddParameter(ParameterType_Int,"filter.tiledwatershed.halo","Flooding halo radius");
+    SetParameterDescription("filter.tiledwatershed.halo","Radius of the halo flooded around each tile. Basins whose minimum lies farther than the halo from a tile may be split along its border.");
+    SetDefaultParameterInt("filter.tiledwatershed.halo",64);
+    SetMinimumParameterIntValue("filter.tiledwatershed.halo",0);
+
     AddParameter(ParameterType_Choice, "mode", "Processing mode");
     SetParameterDescription("mode", "Choice of processing mode, either raster or large-scale.");
 
@@ -633,6 +667,32 @@ private:
         layer,
         0);
       }
+    else if (segType == "tiledwatershed")
+      {
+      otbAppLogINFO(<<"Using tiled watershed segmentation."<<std::endl);
+
+      AmplitudeFilterType::Pointer amplitudeFilter = AmplitudeFilterType::New();
+
+      amplitudeFilter->SetInput(this->GetParameterFloatVectorImage("in"));
+
+      GradientMagnitudeFilterType::Pointer gradientMagnitudeFilter = GradientMagnitudeFilterType::New();
+      gradientMagnitudeFilter->SetInput(amplitudeFilter->GetOutput());
+
+      StreamingVectorizedTiledWatershedFilterType::Pointer
+          watershedVectorizedFilter = StreamingVectorizedTiledWatershedFilterType::New();
+
+      watershedVectorizedFilter->GetSegmentationFilter()->SetThreshold(
+        GetParameterFloat("filter.tiledwatershed.threshold"));
+      watershedVectorizedFilter->GetSegmentationFilter()->SetLevel(GetParameterFloat("filter.tiledwatershed.level"));
+      watershedVectorizedFilter->GetSegmentationFilter()->SetTileSize(GetParameterInt("filter.tiledwatershed.tilesize"));
+      watershedVectorizedFilter->GetSegmentationFilter()->SetHaloRadius(GetParameterInt("filter.tiledwatershed.halo"));
+
+      streamSize = this->GenericApplySegmentation<FloatImageType,TiledWatershedSegmentationFilterType>(
+        watershedVectorizedFilter,
+        gradientMagnitudeFilter->GetOutput(),
+        layer,
+        0);
+      }
     else if (segType == "mprofiles")
       {
       otbAppLogINFO(<<"Using multiscale geodesic morphology segmentation."<<std::endl);
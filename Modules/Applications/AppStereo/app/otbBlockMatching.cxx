@@ -28,6 +28,7 @@
 
 #include "otbSubPixelDisparityImageFilter.h"
 #include "otbDisparityMapMedianFilter.h"
+#include "otbSemiGlobalMatchingImageFilter.h"
 
 namespace otb
 {
@@ -65,6 +66,11 @@ public:
                                                            FloatImageType,
                                                            LPBlockMatchingFunctorType> LPBlockMatchingFilterType;
 
+  typedef otb::SemiGlobalMatchingImageFilter<FloatImageType,
+                                             FloatImageType,
+                                             FloatImageType,
+                                             FloatImageType> SemiGlobalMatchingFilterType;
+
   typedef otb::VarianceImageFilter<FloatImageType,FloatImageType> VarianceFilterType;
 
 
@@ -111,6 +117,7 @@ private:
     m_SSDBlockMatcher = SSDBlockMatchingFilterType::New();
     m_NCCBlockMatcher = NCCBlockMatchingFilterType::New();
     m_LPBlockMatcher  = LPBlockMatchingFilterType::New();
+    m_SGMatcher       = SemiGlobalMatchingFilterType::New();
     m_SSDSubPixFilter = SSDSubPixelDisparityFilterType::New();
     m_NCCSubPixFilter = NCCSubPixelDisparityFilterType::New();
     m_LPSubPixFilter  = LPSubPixelDisparityFilterType::New();
@@ -272,6 +279,36 @@ private:
     SetDefaultParameterFloat("bm.metric.lp.p", 1.0);
     SetMinimumParameterFloatValue("bm.metric.lp.p", 0.0);
 
+    AddChoice("bm.metric.sgm","Semi-Global Matching");
+    SetParameterDescription("bm.metric.sgm","Census transform of radius "
+      "bm.radius (at most 3) as matching cost, aggregated along several "
+      "image paths with a small penalty for disparity changes of one pixel "
+      "and a large penalty for larger jumps. Only horizontal disparities are "
+      "estimated, vertical disparities are set to 0 and bm.step is ignored. "
+      "Any sub-pixel option enables the parabolic fit of aggregated costs. "
+      "Disparities failing the left-right consistency check are flagged in "
+      "io.outmask.");
+
+    AddParameter(ParameterType_Int,"bm.metric.sgm.p1","Small penalty");
+    SetParameterDescription("bm.metric.sgm.p1", "Penalty for disparity changes "
+      "of one pixel between neighbours along a path.");
+    SetDefaultParameterInt("bm.metric.sgm.p1", 4);
+    SetMinimumParameterIntValue("bm.metric.sgm.p1", 0);
+
+    AddParameter(ParameterType_Int,"bm.metric.sgm.p2","Large penalty");
+    SetParameterDescription("bm.metric.sgm.p2", "Penalty for disparity changes "
+      "of more than one pixel between neighbours along a path (must be "
+      "greater or equal to the small penalty).");
+    SetDefaultParameterInt("bm.metric.sgm.p2", 48);
+    SetMinimumParameterIntValue("bm.metric.sgm.p2", 0);
+
+    AddParameter(ParameterType_Int,"bm.metric.sgm.paths","Number of paths");
+    SetParameterDescription("bm.metric.sgm.paths", "Number of aggregation "
+      "paths: 8 or 16.");
+    SetDefaultParameterInt("bm.metric.sgm.paths", 8);
+    SetMinimumParameterIntValue("bm.metric.sgm.paths", 8);
+    SetMaximumParameterIntValue("bm.metric.sgm.paths", 16);
+
     AddParameter(ParameterType_Int,"bm.radius","Radius of blocks");
     SetParameterDescription("bm.radius","The radius (in pixels) of blocks in Block-Matching");
     SetDefaultParameterInt("bm.radius",3);
@@ -749,7 +786,7 @@ private:
         }
       }
     // Lp case
-    else
+    else if (GetParameterInt("bm.metric") == 2)
       {
       m_LPBlockMatcher->SetLeftInput(leftImage);
       m_LPBlockMatcher->SetRightInput(rightImage);
@@ -816,6 +853,50 @@ private:
         metricImage = m_LPBlockMatcher->GetMetricOutput();
         }
       }
+    // Semi-global matching case
+    else
+      {
+      if (step > 1)
+        {
+        otbAppLogWARNING("Parameter bm.step is ignored by semi-global matching"<<std::endl);
+        }
+      if (useInitialDispUniform || useInitialDispMap)
+        {
+        otbAppLogWARNING("Initial disparities are ignored by semi-global matching"<<std::endl);
+        }
+      if (minvdisp != 0 || maxvdisp != 0)
+        {
+        otbAppLogWARNING("Semi-global matching only explores horizontal disparities"<<std::endl);
+        }
+
+      m_SGMatcher->SetLeftInput(leftImage);
+      m_SGMatcher->SetRightInput(rightImage);
+      m_SGMatcher->SetCensusRadius(std::min(radius, 3U));
+      m_SGMatcher->SetMinimumHorizontalDisparity(minhdisp);
+      m_SGMatcher->SetMaximumHorizontalDisparity(maxhdisp);
+      m_SGMatcher->SetP1(GetParameterInt("bm.metric.sgm.p1"));
+      m_SGMatcher->SetP2(GetParameterInt("bm.metric.sgm.p2"));
+      m_SGMatcher->SetNumberOfPaths(GetParameterInt("bm.metric.sgm.paths") < 16 ? 8 : 16);
+      m_SGMatcher->SetSubPixelInterpolation(GetParameterInt("bm.subpixel") > 0);
+
+      AddProcess(m_SGMatcher,"Semi-global matching");
+
+      if(maskingLeft)
+        {
+        m_SGMatcher->SetLeftMaskInput(maskLeftImage);
+        }
+      if(maskingRight)
+        {
+        m_SGMatcher->SetRightMaskInput(maskRightImage);
+        }
+
+      hdispImage = m_SGMatcher->GetHorizontalDisparityOutput();
+      vdispImage = m_SGMatcher->GetVerticalDisparityOutput();
+      metricImage = m_SGMatcher->GetMetricOutput();
+
+      // The validity mask includes the left mask and the left-right check
+      maskLeftImage = m_SGMatcher->GetValidityMaskOutput();
+      }
 
     if (IsParameterEnabled("bm.medianfilter.radius") && IsParameterEnabled("bm.medianfilter.incoherence"))
       {
@@ -875,6 +956,9 @@ private:
   // Lp Block matching filter
   LPBlockMatchingFilterType::Pointer  m_LPBlockMatcher;
 
+  // Semi-global matching filter
+  SemiGlobalMatchingFilterType::Pointer m_SGMatcher;
+
   // SSD sub-pixel disparity filter
   SSDSubPixelDisparityFilterType::Pointer m_SSDSubPixFilter;
 
@@ -228,6 +228,18 @@ private:
       "cross-correlation" );
     MandatoryOff("m");
 
+    AddParameter(ParameterType_Int,  "nl",   "Number Of Levels");
+    SetParameterDescription( "nl", "Number of levels of the multi-resolution "
+      "pyramid. With more than one level, the exploration radius is only "
+      "searched at the coarsest level, and the offsets are refined at each "
+      "finer level. This mode is much faster for large exploration radii, and "
+      "always uses the cross-correlation with subtracted mean (CCSM). Default "
+      "is 1 (full resolution search only)." );
+    SetDefaultParameterInt("nl", 1);
+    SetMinimumParameterIntValue("nl", 1);
+    SetMaximumParameterIntValue("nl", 8);
+    MandatoryOff("nl");
+
     AddParameter(ParameterType_Float,  "spa",   "SubPixelAccuracy");
     SetParameterDescription( "spa", "Metric extrema location will be refined up"
       " to the given accuracy. Default is 0.01" );
@@ -370,6 +382,19 @@ private:
       metricId = GetParameterString("m");
       }
 
+    const unsigned int nbLevels = GetParameterInt("nl");
+    if(nbLevels > 1)
+      {
+      otbAppLogINFO("Number of levels : "<<nbLevels);
+      if(metricId != "CCSM")
+        {
+        otbAppLogWARNING("Multi-resolution mode always uses the CCSM metric, "
+          "metric "<<metricId<<" is ignored");
+        metricId = "CCSM";
+        }
+      m_Registration->SetNumberOfLevels(nbLevels);
+      }
+
     if(metricId == "CC")
       {
       otbAppLogINFO("Metric : Cross-correlation");
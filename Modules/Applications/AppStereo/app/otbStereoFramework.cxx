@@ -22,6 +22,7 @@
 
 #include "otbStereorectificationDisplacementFieldSource.h"
 #include "otbStreamingWarpImageFilter.h"
+#include "otbStereorectificationResampleImageFilter.h"
 #include "otbBandMathImageFilter.h"
 #include "otbSubPixelDisparityImageFilter.h"
 #include "otbDisparityMapMedianFilter.h"
@@ -62,6 +63,7 @@
 #include "otbImageList.h"
 #include "otbImageListToVectorImageFilter.h"
 #include "otbBijectionCoherencyFilter.h"
+#include "otbSemiGlobalMatchingImageFilter.h"
 
 namespace otb
 {
@@ -104,6 +106,11 @@ public:
      FloatImageType,
      DisplacementFieldType>                    ResampleFilterType;
 
+  typedef otb::StereorectificationResampleImageFilter
+    <FloatImageType,
+     FloatImageType,
+     DisplacementFieldType>                    EpipolarResampleFilterType;
+
   typedef otb::BCOInterpolateImageFunction
     <FloatImageType>                          InterpolatorType;
 
@@ -136,6 +143,11 @@ public:
                                                               FloatImageType,
                                                               LPBlockMatchingFunctorType> LPBlockMatchingFilterType;
 
+  typedef otb::SemiGlobalMatchingImageFilter<FloatImageType,
+                                             FloatImageType,
+                                             FloatImageType,
+                                             FloatImageType>  SemiGlobalMatchingFilterType;
+
   typedef otb::BandMathImageFilter
     <FloatImageType>                          BandMathFilterType;
 
@@ -410,6 +422,9 @@ private:
     AddChoice("output.fusionmethod.mean","Mean");
     SetParameterDescription("output.fusionmethod.mean","The cell is filled with"
       " the mean of measured elevation values");
+    AddChoice("output.fusionmethod.median","Median");
+    SetParameterDescription("output.fusionmethod.median","The cell is filled with"
+      " the median of measured elevation values");
     AddChoice("output.fusionmethod.acc", "Accumulator");
     SetParameterDescription("output.fusionmethod.acc", "Accumulator mode. The"
       " cell is filled with the the number of values (for debugging purposes).");
@@ -504,6 +519,29 @@ private:
     SetDefaultParameterFloat("bm.metric.lp.p", 1.0);
     SetMinimumParameterFloatValue("bm.metric.lp.p", 0.0);
 
+    AddChoice("bm.metric.sgm","Semi-Global Matching");
+    SetParameterDescription("bm.metric.sgm","Census transform of radius "
+      "bm.radius (at most 3) aggregated along several image paths, with a "
+      "small penalty for disparity changes of one pixel and a large penalty "
+      "for larger jumps. Bijection consistency is checked on the aggregated "
+      "costs instead of a reverse block-matching.");
+
+    AddParameter(ParameterType_Int,"bm.metric.sgm.p1","Small penalty");
+    SetParameterDescription("bm.metric.sgm.p1", "Penalty for disparity changes of one pixel between neighbours along a path");
+    SetDefaultParameterInt("bm.metric.sgm.p1", 4);
+    SetMinimumParameterIntValue("bm.metric.sgm.p1", 0);
+
+    AddParameter(ParameterType_Int,"bm.metric.sgm.p2","Large penalty");
+    SetParameterDescription("bm.metric.sgm.p2", "Penalty for larger disparity changes between neighbours along a path (must be greater or equal to the small penalty)");
+    SetDefaultParameterInt("bm.metric.sgm.p2", 48);
+    SetMinimumParameterIntValue("bm.metric.sgm.p2", 0);
+
+    AddParameter(ParameterType_Int,"bm.metric.sgm.paths","Number of paths");
+    SetParameterDescription("bm.metric.sgm.paths", "Number of aggregation paths: 8 or 16");
+    SetDefaultParameterInt("bm.metric.sgm.paths", 8);
+    SetMinimumParameterIntValue("bm.metric.sgm.paths", 8);
+    SetMaximumParameterIntValue("bm.metric.sgm.paths", 16);
+
     AddParameter(ParameterType_Int,"bm.radius","Correlation window radius (in pixels)");
     SetParameterDescription("bm.radius","The radius of blocks in Block-Matching (in pixels)");
     SetDefaultParameterInt("bm.radius",2);
@@ -802,16 +840,6 @@ private:
       leftInverseDisplacement->DisconnectPipeline();
       m_Filters.push_back(leftInverseDisplacement.GetPointer());
 
-      ResampleFilterType::Pointer leftResampleFilter = ResampleFilterType::New();
-      leftResampleFilter->SetInput(inleft);
-      leftResampleFilter->SetDisplacementField(leftDisplacement);
-      leftResampleFilter->SetInterpolator(m_Interpolator);
-      leftResampleFilter->SetOutputSize(epiSize);
-      leftResampleFilter->SetOutputSpacing(epiSpacing);
-      leftResampleFilter->SetOutputOrigin(epiOrigin);
-      leftResampleFilter->SetEdgePaddingValue(defaultValue);
-      m_Filters.push_back(leftResampleFilter.GetPointer());
-
       DisplacementFieldCastFilterType::Pointer rightGridCaster = DisplacementFieldCastFilterType::New();
       rightGridCaster->SetInput(epipolarGridSource->GetRightDisplacementFieldOutput());
       rightGridCaster->Update();
@@ -821,15 +849,33 @@ private:
       rightDisplacement->DisconnectPipeline();
       m_Filters.push_back(rightDisplacement.GetPointer());
 
-      ResampleFilterType::Pointer rightResampleFilter = ResampleFilterType::New();
-      rightResampleFilter->SetInput(inright);
-      rightResampleFilter->SetDisplacementField(rightDisplacement);
-      rightResampleFilter->SetInterpolator(m_Interpolator);
-      rightResampleFilter->SetOutputSize(epiSize);
-      rightResampleFilter->SetOutputSpacing(epiSpacing);
-      rightResampleFilter->SetOutputOrigin(epiOrigin);
-      rightResampleFilter->SetEdgePaddingValue(defaultValue);
-      m_Filters.push_back(rightResampleFilter.GetPointer());
+      // Left and right images are resampled together, on a margin covering
+      // the block-matching windows, the disparity range and the median
+      // filter, so that all their consumers are served by a single pass
+      EpipolarResampleFilterType::Pointer epipolarResampleFilter = EpipolarResampleFilterType::New();
+      InterpolatorType::Pointer leftInterpolator = InterpolatorType::New();
+      leftInterpolator->SetRadius(2);
+      InterpolatorType::Pointer rightInterpolator = InterpolatorType::New();
+      rightInterpolator->SetRadius(2);
+      epipolarResampleFilter->SetLeftInput(inleft);
+      epipolarResampleFilter->SetRightInput(inright);
+      epipolarResampleFilter->SetLeftDisplacementField(leftDisplacement);
+      epipolarResampleFilter->SetRightDisplacementField(rightDisplacement);
+      epipolarResampleFilter->SetLeftInterpolator(leftInterpolator);
+      epipolarResampleFilter->SetRightInterpolator(rightInterpolator);
+      epipolarResampleFilter->SetOutputSize(epiSize);
+      epipolarResampleFilter->SetOutputSpacing(epiSpacing);
+      epipolarResampleFilter->SetOutputOrigin(epiOrigin);
+      epipolarResampleFilter->SetEdgePaddingValue(defaultValue);
+      FloatImageType::SizeType epipolarMargin;
+      epipolarMargin[0] = this->GetParameterInt("bm.radius") + 3
+        + static_cast<unsigned int>(std::max(std::abs(minDisp), std::abs(maxDisp)));
+      epipolarMargin[1] = this->GetParameterInt("bm.radius") + 3;
+      epipolarResampleFilter->SetOutputMargin(epipolarMargin);
+      m_Filters.push_back(epipolarResampleFilter.GetPointer());
+
+      FloatImageType * leftEpipolarImage = epipolarResampleFilter->GetLeftOutput();
+      FloatImageType * rightEpipolarImage = epipolarResampleFilter->GetRightOutput();
 
       // Compute masks
       FloatImageType::Pointer leftmask;
@@ -839,7 +885,7 @@ private:
       unsigned int inputIdLeft = 0;
       unsigned int inputIdRight = 0;
 
-      lBandMathFilter->SetNthInput(inputIdLeft, leftResampleFilter->GetOutput(), "inleft");
+      lBandMathFilter->SetNthInput(inputIdLeft, leftEpipolarImage, "inleft");
       ++inputIdLeft;
       std::ostringstream leftCondition;
       leftCondition << "(inleft > 0)";
@@ -867,7 +913,7 @@ private:
         {
         // Left side
         VarianceFilterType::Pointer leftVarianceFilter = VarianceFilterType::New();
-        leftVarianceFilter->SetInput(leftResampleFilter->GetOutput());
+        leftVarianceFilter->SetInput(leftEpipolarImage);
         VarianceFilterType::InputSizeType vradius;
         vradius.Fill(this->GetParameterInt("bm.radius"));
         leftVarianceFilter->SetRadius(vradius);
@@ -893,7 +939,7 @@ private:
 
       m_Filters.push_back(leftMaskResampleFilter.GetPointer());
 
-      rBandMathFilter->SetNthInput(inputIdRight, rightResampleFilter->GetOutput(), "inright");
+      rBandMathFilter->SetNthInput(inputIdRight, rightEpipolarImage, "inright");
       ++inputIdRight;
       std::ostringstream rightCondition;
       rightCondition << "(inright > 0)";
@@ -919,7 +965,7 @@ private:
         {
         // right side
         VarianceFilterType::Pointer rightVarianceFilter = VarianceFilterType::New();
-        rightVarianceFilter->SetInput(rightResampleFilter->GetOutput());
+        rightVarianceFilter->SetInput(rightEpipolarImage);
         VarianceFilterType::InputSizeType vradius;
         vradius.Fill(this->GetParameterInt("bm.radius"));
         rightVarianceFilter->SetRadius(vradius);
@@ -981,6 +1027,8 @@ private:
       LPBlockMatchingFilterType::Pointer invLPBlockMatcherFilter;
       LPSubPixelFilterType::Pointer LPSubPixelFilter;
 
+      SemiGlobalMatchingFilterType::Pointer SGMFilter;
+
       switch (GetParameterInt("bm.metric"))
         {
         case 0: //SSDDivMean
@@ -1006,8 +1054,8 @@ private:
             SSDDivMeanBlockMatcherFilter,
             invSSDDivMeanBlockMatcherFilter,
             SSDDivMeanSubPixelFilter,
-            leftResampleFilter->GetOutput(),
-            rightResampleFilter->GetOutput(),
+            leftEpipolarImage,
+            rightEpipolarImage,
             lBandMathFilter->GetOutput(),
             rBandMathFilter->GetOutput(),
             finalMaskFilter->GetOutput(),
@@ -1039,8 +1087,8 @@ private:
             SSDBlockMatcherFilter,
             invSSDBlockMatcherFilter,
             SSDSubPixelFilter,
-            leftResampleFilter->GetOutput(),
-            rightResampleFilter->GetOutput(),
+            leftEpipolarImage,
+            rightEpipolarImage,
             lBandMathFilter->GetOutput(),
             rBandMathFilter->GetOutput(),
             finalMaskFilter->GetOutput(),
@@ -1070,8 +1118,8 @@ private:
             NCCBlockMatcherFilter,
             invNCCBlockMatcherFilter,
             NCCSubPixelFilter,
-            leftResampleFilter->GetOutput(),
-            rightResampleFilter->GetOutput(),
+            leftEpipolarImage,
+            rightEpipolarImage,
             lBandMathFilter->GetOutput(),
             rBandMathFilter->GetOutput(),
             finalMaskFilter->GetOutput(),
@@ -1105,19 +1153,70 @@ private:
             LPBlockMatcherFilter,
             invLPBlockMatcherFilter,
             LPSubPixelFilter,
-            leftResampleFilter->GetOutput(),
-            rightResampleFilter->GetOutput(),
+            leftEpipolarImage,
+            rightEpipolarImage,
             lBandMathFilter->GetOutput(),
             rBandMathFilter->GetOutput(),
             finalMaskFilter->GetOutput(),
             minimize, minDisp, maxDisp);
 
           break;
+
+        case 4: //SGM
+          otbAppLogINFO(<<"Using Semi-Global Matching.");
+
+          SGMFilter = SemiGlobalMatchingFilterType::New();
+          blockMatcherFilterPointer = SGMFilter.GetPointer();
+          m_Filters.push_back(blockMatcherFilterPointer);
+
+          minimize = true;
+          SGMFilter->SetLeftInput(leftEpipolarImage);
+          SGMFilter->SetRightInput(rightEpipolarImage);
+          SGMFilter->SetLeftMaskInput(lBandMathFilter->GetOutput());
+          SGMFilter->SetRightMaskInput(rBandMathFilter->GetOutput());
+          SGMFilter->SetCensusRadius(std::min(this->GetParameterInt("bm.radius"), 3));
+          SGMFilter->SetMinimumHorizontalDisparity(static_cast<int>(std::floor(minDisp)));
+          SGMFilter->SetMaximumHorizontalDisparity(static_cast<int>(std::ceil(maxDisp)));
+          SGMFilter->SetP1(this->GetParameterInt("bm.metric.sgm.p1"));
+          SGMFilter->SetP2(this->GetParameterInt("bm.metric.sgm.p2"));
+          SGMFilter->SetNumberOfPaths(this->GetParameterInt("bm.metric.sgm.paths") < 16 ? 8 : 16);
+          SGMFilter->SetLeftRightCheck(GetParameterInt("postproc.bij") != 0);
+          SGMFilter->UpdateOutputInformation();
+          break;
         default:
           break;
         }
 
-       if (GetParameterInt("postproc.bij"))
+      // Disparity and metric images
+      FloatImageType::Pointer hDispImage;
+      FloatImageType::Pointer vDispImage;
+      FloatImageType::Pointer metricImage;
+      if (SGMFilter)
+        {
+        hDispImage = SGMFilter->GetHorizontalDisparityOutput();
+        vDispImage = SGMFilter->GetVerticalDisparityOutput();
+        metricImage = SGMFilter->GetMetricOutput();
+        }
+      else
+        {
+        hDispImage = subPixelFilterPointer->GetOutput(0);
+        vDispImage = subPixelFilterPointer->GetOutput(1);
+        metricImage = subPixelFilterPointer->GetOutput(2);
+        }
+
+       if (GetParameterInt("postproc.bij") && SGMFilter)
+        {
+        // The left-right check is done by the semi-global matching filter
+        finalMaskFilter->SetNthInput(1, SGMFilter->GetValidityMaskOutput(), "lrrl");
+
+        #ifdef OTB_MUPARSER_HAS_CXX_LOGICAL_OPERATORS
+        finalMaskFilter->SetExpression("(inmask > 0 and lrrl > 0) ? 255 : 0");
+        #else
+        finalMaskFilter->SetExpression("if(inmask > 0 and lrrl > 0, 255, 0)");
+        #endif
+        m_Filters.push_back(finalMaskFilter.GetPointer());
+        }
+       else if (GetParameterInt("postproc.bij"))
         {
         otbAppLogINFO(<<"Using reverse block-matching to filter incoherent disparity values.");
         bijectFilter = BijectionFilterType::New();
@@ -1145,12 +1244,12 @@ private:
         }
 
 
-     FloatImageType::Pointer hDispOutput = subPixelFilterPointer->GetOutput(0);
+     FloatImageType::Pointer hDispOutput = hDispImage;
       FloatImageType::Pointer finalMaskImage=finalMaskFilter->GetOutput();
       if (GetParameterInt("postproc.med"))
         {
         MedianFilterType::Pointer hMedianFilter = MedianFilterType::New();
-        hMedianFilter->SetInput(subPixelFilterPointer->GetOutput(0));
+        hMedianFilter->SetInput(hDispImage);
         hMedianFilter->SetRadius(2);
         hMedianFilter->SetIncoherenceThreshold(2.0);
         hMedianFilter->SetMaskInput(finalMaskFilter->GetOutput());
@@ -1162,7 +1261,7 @@ private:
 
       DisparityTranslateFilter::Pointer disparityTranslateFilter = DisparityTranslateFilter::New();
       disparityTranslateFilter->SetHorizontalDisparityMapInput(hDispOutput);
-      disparityTranslateFilter->SetVerticalDisparityMapInput(subPixelFilterPointer->GetOutput(1));
+      disparityTranslateFilter->SetVerticalDisparityMapInput(vDispImage);
       disparityTranslateFilter->SetInverseEpipolarLeftGrid(leftInverseDisplacement);
       disparityTranslateFilter->SetDirectEpipolarRightGrid(rightDisplacement);
       // disparityTranslateFilter->SetDisparityMaskInput()
@@ -1278,7 +1377,7 @@ private:
       maskCondition << "(hdisp > " << minDisp << ") and (hdisp < " << maxDisp << ") and (mask>0)";
       if (IsParameterEnabled("postproc.metrict"))
         {
-        dispMaskFilter->SetNthInput(2, subPixelFilterPointer->GetOutput(2), "metric");
+        dispMaskFilter->SetNthInput(2, metricImage, "metric");
         maskCondition << " and (metric ";
         if (minimize == true)
           {
@@ -1352,6 +1451,10 @@ private:
       {
       m_Multi3DMapToDEMFilter ->SetCellFusionMode(otb::CellFusionMode::MEAN);
       }
+    else if(GetParameterString("output.fusionmethod") == "median")
+      {
+      m_Multi3DMapToDEMFilter ->SetCellFusionMode(otb::CellFusionMode::MEDIAN);
+      }
     else if(GetParameterString("output.fusionmethod") == "acc")
       {
       m_Multi3DMapToDEMFilter ->SetCellFusionMode(otb::CellFusionMode::ACC);
@@ -25,8 +25,10 @@
 #include "otbScalarImageToTexturesFilter.h"
 #include "otbScalarImageToAdvancedTexturesFilter.h"
 #include "otbScalarImageToHigherOrderTexturesFilter.h"
+#include "otbVectorImageToTexturesFilter.h"
 
 #include "otbMultiToMonoChannelExtractROI.h"
+#include "otbMultiChannelExtractROI.h"
 #include "otbClampImageFilter.h"
 #include "otbImageList.h"
 #include "otbImageListToVectorImageFilter.h"
@@ -48,10 +50,14 @@ typedef itk::SmartPointer<const Self> ConstPointer;
 typedef MultiToMonoChannelExtractROI<FloatVectorImageType::InternalPixelType,FloatVectorImageType::InternalPixelType>
                                                                                ExtractorFilterType;
 typedef ClampImageFilter<FloatImageType, FloatImageType>                       ClampFilterType;
+typedef MultiChannelExtractROI<FloatVectorImageType::InternalPixelType,FloatVectorImageType::InternalPixelType>
+                                                                               MultiExtractorFilterType;
+typedef ClampImageFilter<FloatVectorImageType, FloatVectorImageType>           MultiClampFilterType;
 
 typedef ScalarImageToTexturesFilter<FloatImageType, FloatImageType>            HarTexturesFilterType;
 typedef ScalarImageToAdvancedTexturesFilter<FloatImageType, FloatImageType>    AdvTexturesFilterType;
 typedef ScalarImageToHigherOrderTexturesFilter<FloatImageType, FloatImageType> HigTexturesFilterType;
+typedef VectorImageToTexturesFilter<FloatVectorImageType, FloatVectorImageType> MultiTexturesFilterType;
 
 typedef HarTexturesFilterType::SizeType                                        RadiusType;
 typedef HarTexturesFilterType::OffsetType                                      OffsetType;
@@ -90,11 +96,19 @@ SetDocLongDescription(
     "Nonuniformity, Run Length Nonuniformity, Run Percentage (measures the texture "
     "sharpness homogeneity), Low Grey-Level Run Emphasis, High Grey-Level Run Emphasis, "
     "Short Run Low Grey-Level Emphasis, Short Run High Grey-Level Emphasis, Long Run Low "
-    "Grey-Level Emphasis and Long Run High Grey-Level Emphasis.");
+    "Grey-Level Emphasis and Long Run High Grey-Level Emphasis.\n\n"
+
+    "The simple features can be computed on several channels (channels parameter) "
+    "and in the four directions 0, 45, 90 and 135 degrees (parameters.directions) "
+    "in a single pass over the input image. In that case, the output bands are "
+    "ordered by channel, then by direction, then by feature, and the features can "
+    "be averaged over the directions (parameters.average).");
 
 SetDocLimitations("The computation of the features is based on a Gray Level Co-occurrence "
     "matrix (GLCM) from the quantized input image. Consequently the quantization "
-    "parameters (min, max, nbbin) must be appropriate to the range of the pixel values.");
+    "parameters (min, max, nbbin) must be appropriate to the range of the pixel values. "
+    "Several channels and the four directions are only supported by the simple "
+    "texture set.");
 SetDocAuthors("OTB-Team");
 SetDocSeeAlso("[1] HARALICK, Robert M., SHANMUGAM, Karthikeyan, et al. "
     "Textural features for image classification. IEEE Transactions on systems, "
@@ -113,6 +127,11 @@ SetParameterDescription("channel", "The selected channel index");
 SetDefaultParameterInt("channel", 1);
 SetMinimumParameterIntValue("channel", 1);
 
+AddParameter(ParameterType_ListView, "channels", "Selected Channels");
+SetParameterDescription("channels", "Channels to process in a single pass with "
+  "the simple texture set. If no channel is selected, the channel parameter is used.");
+MandatoryOff("channels");
+
 AddParameter(ParameterType_Int, "step", "Computation step");
 SetParameterDescription("step", "Step (in pixels) to compute output texture values."
   " The first computed pixel position is shifted by (step-1)/2 in both directions.");
@@ -140,6 +159,21 @@ AddParameter(ParameterType_Int,"parameters.yoff","Y Offset");
 SetParameterDescription("parameters.yoff", "Y Offset");
 SetDefaultParameterInt("parameters.yoff", 1);
 
+AddParameter(ParameterType_Choice,"parameters.directions","Co-occurrence directions");
+SetParameterDescription("parameters.directions", "Offsets used to compute the "
+  "co-occurrences");
+AddChoice("parameters.directions.single","Single offset");
+SetParameterDescription("parameters.directions.single", "Use the offset given by "
+  "xoff and yoff");
+AddChoice("parameters.directions.four","Four directions");
+SetParameterDescription("parameters.directions.four", "Use the directions 0, 45, 90 and "
+  "135 degrees, at a distance equal to max(|xoff|, |yoff|). Only available with the "
+  "simple texture set.");
+
+AddParameter(ParameterType_Bool,"parameters.average","Average over directions");
+SetParameterDescription("parameters.average", "Average the features computed with the "
+  "four directions, so that one set of features is produced per channel.");
+
 AddParameter(ParameterType_Float,"parameters.min","Image Minimum");
 SetParameterDescription("parameters.min", "Image Minimum");
 SetDefaultParameterFloat("parameters.min", 0);
@@ -196,7 +230,85 @@ SetOfficialDocLink();
 
 void DoUpdateParameters() override
 {
-  // Nothing to do here : all parameters are independent
+  if ( HasValue("in") )
+    {
+    FloatVectorImageType* inImage = GetParameterImage("in");
+    inImage->UpdateOutputInformation();
+    unsigned int nbComponents = inImage->GetNumberOfComponentsPerPixel();
+    ListViewParameter *channelsParam =
+      dynamic_cast<ListViewParameter*>(GetParameterByKey("channels"));
+    // Update the channels to be selected if nbComponents is changed
+    if (channelsParam != nullptr && channelsParam->GetNbChoices() != nbComponents)
+      {
+      ClearChoices("channels");
+      for (unsigned int idx = 0; idx < nbComponents; ++idx)
+        {
+        std::ostringstream key, item;
+        key<<"channels.channel"<<idx+1;
+        item<<"Channel"<<idx+1;
+        AddChoice(key.str(), item.str());
+        }
+      }
+    }
+}
+
+void ExecuteMultiTextures(FloatVectorImageType* inImage,
+                          const RadiusType& radius,
+                          const OffsetType& offset,
+                          const RadiusType& stepping,
+                          const OffsetType& stepOffset)
+{
+  MultiTexturesFilterType::OffsetListType offsets;
+  if ( GetParameterString("parameters.directions") == "four" )
+    {
+    const long distance = std::max(std::abs(offset[0]), std::abs(offset[1]));
+    OffsetType direction;
+    direction[0] = distance; direction[1] = 0;
+    offsets.push_back(direction);
+    direction[0] = distance; direction[1] = -distance;
+    offsets.push_back(direction);
+    direction[0] = 0; direction[1] = -distance;
+    offsets.push_back(direction);
+    direction[0] = -distance; direction[1] = -distance;
+    offsets.push_back(direction);
+    }
+  else
+    {
+    offsets.push_back(offset);
+    }
+
+  m_MultiExtractorFilter = MultiExtractorFilterType::New();
+  m_MultiExtractorFilter->SetInput(inImage);
+  m_MultiExtractorFilter->ClearChannels();
+  std::vector<int> selectedChannels = GetSelectedItems("channels");
+  if ( selectedChannels.empty() )
+    {
+    m_MultiExtractorFilter->SetChannel(GetParameterInt("channel"));
+    }
+  for (unsigned int idx = 0; idx < selectedChannels.size(); ++idx)
+    {
+    m_MultiExtractorFilter->SetChannel(selectedChannels[idx] + 1);
+    }
+
+  m_MultiClampFilter = MultiClampFilterType::New();
+  m_MultiClampFilter->SetInput(m_MultiExtractorFilter->GetOutput());
+  m_MultiClampFilter->SetLower(GetParameterFloat("parameters.min"));
+  m_MultiClampFilter->SetUpper(GetParameterFloat("parameters.max"));
+
+  m_MultiTexFilter = MultiTexturesFilterType::New();
+  m_MultiTexFilter->SetInput(m_MultiClampFilter->GetOutput());
+  m_MultiTexFilter->SetRadius(radius);
+  m_MultiTexFilter->SetOffsets(offsets);
+  m_MultiTexFilter->SetInputImageMinimum(GetParameterFloat("parameters.min"));
+  m_MultiTexFilter->SetInputImageMaximum(GetParameterFloat("parameters.max"));
+  m_MultiTexFilter->SetNumberOfBinsPerAxis(GetParameterInt("parameters.nbbin"));
+  m_MultiTexFilter->SetSubsampleFactor(stepping);
+  m_MultiTexFilter->SetSubsampleOffset(stepOffset);
+  m_MultiTexFilter->SetAverageOffsets(GetParameterInt("parameters.average"));
+
+  otbAppLogINFO(<< "Computing the simple texture set on " << m_MultiExtractorFilter->GetNbChannels()
+                << " channel(s) with " << offsets.size() << " offset(s) in one pass");
+  SetParameterOutputImage("out", m_MultiTexFilter->GetOutput());
 }
 
 void DoExecute() override
@@ -226,6 +338,18 @@ void DoExecute() override
   OffsetType stepOffset;
   stepOffset.Fill((GetParameterInt("step") - 1) / 2);
 
+  const bool multiChannels = !GetSelectedItems("channels").empty();
+  const bool multiDirections = GetParameterString("parameters.directions") == "four";
+  if( multiChannels || multiDirections )
+    {
+    if( texType != "simple" )
+      {
+      otbAppLogFATAL(<< "Several channels or directions are only supported by the simple texture set");
+      }
+    ExecuteMultiTextures(inImage, radius, offset, stepping, stepOffset);
+    return;
+    }
+
   m_ExtractorFilter = ExtractorFilterType::New();
   m_ExtractorFilter->SetInput(inImage);
   m_ExtractorFilter->SetStartX(inImage->GetLargestPossibleRegion().GetIndex(0));
@@ -337,6 +461,9 @@ ImageListToVectorImageFilterType::Pointer m_AdvConcatener;
 HigTexturesFilterType::Pointer            m_HigTexFilter;
 ImageListType::Pointer                    m_HigImageList;
 ImageListToVectorImageFilterType::Pointer m_HigConcatener;
+MultiExtractorFilterType::Pointer         m_MultiExtractorFilter;
+MultiClampFilterType::Pointer             m_MultiClampFilter;
+MultiTexturesFilterType::Pointer          m_MultiTexFilter;
 };
 }
 }
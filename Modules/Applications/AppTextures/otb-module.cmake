@@ -32,6 +32,7 @@ otb_module(OTBAppTextures
   TEST_DEPENDS
     OTBTestKernel
     OTBCommandLine
+    OTBAppImageUtils
 
   DESCRIPTION
     "${DOCUMENTATION}"
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbParallelFor_h
+#define otbParallelFor_h
+
+#include <cstddef>
+#include <functional>
+
+#include "itkIntTypes.h"
+#include "OTBCommonExport.h"
+
+namespace otb
+{
+
+/** Body of a ParallelFor loop: processes the indices [begin, end) in the
+ * thread threadId */
+typedef std::function<void(std::size_t begin,
+                           std::size_t end,
+                           itk::ThreadIdType threadId)> ParallelForBodyType;
+
+/** Split [0, size) in contiguous ranges, one per thread, and call body on
+ * each range with an itk::MultiThreader. At most min(numberOfThreads, size)
+ * threads are used, and thread ids are in [0, numberOfThreads), so that
+ * they can index per-thread buffers. Nothing is done if size is 0.
+ *
+ * \ingroup OTBCommon
+ */
+void OTBCommon_EXPORT ParallelFor(std::size_t size,
+                                  itk::ThreadIdType numberOfThreads,
+                                  ParallelForBodyType const & body);
+
+} // namespace otb
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "itkMultiThreader.h"
+
+#include "otbParallelFor.h"
+
+namespace otb
+{
+
+namespace
+{
+
+struct ParallelForStruct
+{
+  std::size_t Size;
+  ParallelForBodyType const * Body;
+};
+
+ITK_THREAD_RETURN_TYPE ParallelForCallback(void * arg)
+{
+  auto threadInfo = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  auto str = static_cast<ParallelForStruct *>(threadInfo->UserData);
+  const std::size_t threadId = threadInfo->ThreadID;
+  const std::size_t nbThreads = threadInfo->NumberOfThreads;
+
+  (*str->Body)( str->Size * threadId / nbThreads,
+                str->Size * (threadId + 1) / nbThreads,
+                threadInfo->ThreadID );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+} // end of anonymous namespace
+
+void ParallelFor(std::size_t size,
+                 itk::ThreadIdType numberOfThreads,
+                 ParallelForBodyType const & body)
+{
+  if (size == 0)
+    {
+    return;
+    }
+  const std::size_t nbThreads = std::max<std::size_t>(1,
+    std::min<std::size_t>(numberOfThreads, size));
+  if (nbThreads == 1)
+    {
+    body(0, size, 0);
+    return;
+    }
+
+  ParallelForStruct str;
+  str.Size = size;
+  str.Body = &body;
+
+  auto threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(static_cast<itk::ThreadIdType>(nbThreads));
+  threader->SetSingleMethod(ParallelForCallback, &str);
+  threader->SingleMethodExecute();
+}
+
+} // namespace otb
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "itkMacro.h"
+
+#include "otbParallelFor.h"
+
+int otbParallelForTest(int itkNotUsed(argc), char * itkNotUsed(argv)[])
+{
+  const itk::ThreadIdType nbThreads = 4;
+  const std::size_t sizes[] = {0, 1, 3, 4, 1001};
+
+  for (std::size_t size : sizes)
+    {
+    std::vector<int> visits(size, 0);
+    std::atomic<std::size_t> nbCalls(0);
+    std::atomic<bool> validRanges(true);
+
+    otb::ParallelFor(size, nbThreads,
+      [&](std::size_t begin, std::size_t end, itk::ThreadIdType threadId)
+      {
+      ++nbCalls;
+      if (threadId >= nbThreads || begin > end || end > size)
+        {
+        validRanges = false;
+        return;
+        }
+      for (std::size_t i = begin; i < end; ++i)
+        {
+        ++visits[i];
+        }
+      });
+
+    for (std::size_t i = 0; i < size; ++i)
+      {
+      if (visits[i] != 1)
+        {
+        std::cerr << "Index " << i << " of [0, " << size << ") visited "
+                  << visits[i] << " times" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    if (!validRanges || nbCalls > std::min<std::size_t>(size, nbThreads))
+      {
+      std::cerr << "Invalid ranges or too many threads for size " << size
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
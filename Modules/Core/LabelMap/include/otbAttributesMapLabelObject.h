@@ -30,9 +30,15 @@
 #include "itkShapeLabelObject.h"
 #endif
 
+#include "itkLabelMap.h"
+#include "itkMetaDataObject.h"
 #include "otbPolygon.h"
+#include "otbAttributesMapTable.h"
+#include <algorithm>
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace otb
 {
@@ -108,13 +114,9 @@ public:
   {
     TMeasurementVector newSample(m_Attributes.size());
 
-    unsigned int attrIndex = 0;
-    typename AttributesListType::const_iterator attrIt = m_Attributes.begin();
-    while(attrIt != m_Attributes.end())
+    for (unsigned int attrIndex = 0; attrIndex < m_Attributes.size(); ++attrIndex)
       {
-      newSample[attrIndex] = object->GetAttribute(attrIt->c_str());
-      ++attrIt;
-      ++attrIndex;
+      newSample[attrIndex] = object->GetAttribute(m_Attributes[attrIndex].c_str());
       }
     return newSample;
   }
@@ -157,11 +159,18 @@ private:
  *  \brief A LabelObject with a generic attributes map
  *
  *  This class derives from itk::LabelObject and extends it to
- *  store pairs of key, value (of type TAttributesValue) in an internal
- *  map container.
+ *  store pairs of key, value (of type TAttributesValue).
  *
  * As such it allows storing any custom attributes as necessary.
  *
+ * The objects of a label map store their values in a row of an
+ * AttributesMapTable shared by the map, given by GetAttributesTable(labelMap),
+ * which stores each attribute in a column. An object which is not in such a
+ * table keeps its values in a small list of its own until it is bound to
+ * one. The string-keyed methods look the name up in the table; loops over the
+ * objects of a map should rather get the columns once from the table of the
+ * map and use the column-based methods.
+ *
  * \sa LabelObject, ShapeLabelObject, StatisticsLabelObject
  *
  * \ingroup DataRepresentation
@@ -201,22 +210,108 @@ public:
   typedef typename Superclass::LineType          LineType;
   typedef typename Superclass::LengthType        LengthType;
 
-  /// Map container typedefs
+  /// Map container typedefs (used to exchange attributes by name)
   typedef std::map<std::string, AttributesValueType> AttributesMapType;
   typedef typename AttributesMapType::iterator       AttributesMapIteratorType;
   typedef typename AttributesMapType::const_iterator AttributesMapConstIteratorType;
 
+  /// List of (name, value) pairs of an object out of a table
+  typedef std::vector<std::pair<std::string, AttributesValueType> > AttributesListType;
+
   // The polygon corresponding to the label object
   typedef Polygon<double>               PolygonType;
   typedef typename PolygonType::Pointer PolygonPointerType;
 
+  /// Table storing the attributes
+  typedef AttributesMapTable<AttributesValueType>  AttributesTableType;
+  typedef typename AttributesTableType::Pointer   AttributesTablePointerType;
+
+  /**
+   * Returns the attributes table of a label map, stored in its meta-data
+   * dictionary. If the map has no table yet, it adopts the one of its first
+   * object, or a new one. The objects of the map which are not in this table
+   * are then moved to it. This must not be called while other threads
+   * access the attributes of the objects.
+   */
+  template <class TLabelMap>
+  static AttributesTableType * GetAttributesTable(TLabelMap * labelMap)
+  {
+    itk::MetaDataDictionary & dict = labelMap->GetMetaDataDictionary();
+    AttributesTablePointerType table;
+    itk::ExposeMetaData<AttributesTablePointerType>(dict, AttributesTableKey(), table);
+
+    typename TLabelMap::Iterator it(labelMap);
+    if (table.IsNull())
+      {
+      if (!it.IsAtEnd() && it.GetLabelObject()->GetAttributesTable() != nullptr)
+        {
+        table = it.GetLabelObject()->GetAttributesTable();
+        }
+      else
+        {
+        table = AttributesTableType::New();
+        }
+      itk::EncapsulateMetaData<AttributesTablePointerType>(dict, AttributesTableKey(), table);
+      }
+
+    for (; !it.IsAtEnd(); ++it)
+      {
+      it.GetLabelObject()->SetAttributesTable(table);
+      }
+    return table;
+  }
+
+  /** Returns the table storing the attributes of the object, if any */
+  AttributesTableType * GetAttributesTable() const
+  {
+    return m_AttributesTable;
+  }
+
+  /** Returns the row of the object in its attributes table */
+  unsigned int GetAttributesRow() const
+  {
+    return m_AttributesRow;
+  }
+
+  /**
+   * Move the attributes of the object to a row of a table, or to its own
+   * list if table is null. The row of the former table is released.
+   */
+  void SetAttributesTable(AttributesTableType * table)
+  {
+    if (table == m_AttributesTable.GetPointer())
+      {
+      return;
+      }
+
+    AttributesListType attributes = this->GetAttributesList();
+    if (m_AttributesTable.IsNotNull())
+      {
+      m_AttributesTable->ReleaseRow(m_AttributesRow);
+      }
+    m_AttributesTable = table;
+    m_AttributesRow = 0;
+    AttributesListType().swap(m_Attributes);
+
+    if (table == nullptr)
+      {
+      m_Attributes.swap(attributes);
+      return;
+      }
+    m_AttributesRow = table->AddRow();
+    for (typename AttributesListType::const_iterator it = attributes.begin(); it != attributes.end(); ++it)
+      {
+      table->SetValue(m_AttributesRow, table->GetColumn(it->first), it->second);
+      }
+  }
+
   /**
    * Set an attribute value.
    * If the key name already exists in the map, the value is overwritten.
    */
   void SetAttribute(const char * name, AttributesValueType value)
   {
-    m_Attributes[name] = value;
+    this->SetAttribute(std::string(name), value);
   }
 
   /**
@@ -225,7 +320,32 @@ public:
    */
   void SetAttribute(const std::string& name, AttributesValueType value)
   {
-    this->SetAttribute(name.c_str(), value);
+    if (m_AttributesTable.IsNotNull())
+      {
+      m_AttributesTable->SetValue(m_AttributesRow, m_AttributesTable->GetColumn(name), value);
+      return;
+      }
+    for (typename AttributesListType::iterator it = m_Attributes.begin(); it != m_Attributes.end(); ++it)
+      {
+      if (it->first == name)
+        {
+        it->second = value;
+        return;
+        }
+      }
+    m_Attributes.push_back(std::make_pair(name, value));
+  }
+
+  /**
+   * Set the value of the attribute of a column of the attributes table.
+   */
+  void SetAttribute(unsigned int column, AttributesValueType value)
+  {
+    if (m_AttributesTable.IsNull() || column >= m_AttributesTable->GetNumberOfColumns())
+      {
+      itkExceptionMacro(<< "No attribute column of index " << column);
+      }
+    m_AttributesTable->SetValue(m_AttributesRow, column, value);
   }
 
   /**
@@ -233,42 +353,97 @@ public:
    */
   AttributesValueType GetAttribute(const char * name) const
   {
-    AttributesMapConstIteratorType it = m_Attributes.find(name);
-    if (it != m_Attributes.end())
+    if (m_AttributesTable.IsNotNull())
+      {
+      unsigned int column = 0;
+      AttributesValueType value;
+      if (m_AttributesTable->FindColumn(name, column)
+          && m_AttributesTable->GetValue(m_AttributesRow, column, value))
+        {
+        return value;
+        }
+      }
+    else
+      {
+      for (typename AttributesListType::const_iterator it = m_Attributes.begin(); it != m_Attributes.end(); ++it)
+        {
+        if (it->first == name)
+          {
+          return it->second;
+          }
+        }
+      }
+    itkExceptionMacro(<< "Could not find attribute named " << name);
+  }
+
+  /**
+   * Returns the attribute of a column of the attributes table
+   */
+  AttributesValueType GetAttribute(unsigned int column) const
+  {
+    AttributesValueType value;
+    if (m_AttributesTable.IsNotNull() && m_AttributesTable->GetValue(m_AttributesRow, column, value))
       {
-      return it->second;
+      return value;
       }
     else
       {
-      itkExceptionMacro(<< "Could not find attribute named " << name);
+      if (m_AttributesTable.IsNotNull() && column < m_AttributesTable->GetNumberOfColumns())
+        {
+        itkExceptionMacro(<< "Could not find attribute named " << m_AttributesTable->GetColumnName(column));
+        }
+      itkExceptionMacro(<< "Could not find attribute of index " << column);
       }
   }
 
+  /**
+   * Returns true if the attribute of a column of the attributes table is set
+   */
+  bool HasAttribute(unsigned int column) const
+  {
+    return m_AttributesTable.IsNotNull() && m_AttributesTable->HasValue(m_AttributesRow, column);
+  }
+
   /**
    * Returns the total number of attributes
    */
   unsigned int GetNumberOfAttributes() const
   {
-    return m_Attributes.size();
+    if (m_AttributesTable.IsNull())
+      {
+      return static_cast<unsigned int>(m_Attributes.size());
+      }
+    return static_cast<unsigned int>(this->GetAvailableAttributesIndices().size());
   }
 
   /**
-   * Returns the list of available attributes
+   * Returns the list of available attributes, sorted by name
    */
   std::vector<std::string> GetAvailableAttributes() const
   {
     std::vector<std::string> attributesNames;
 
-    AttributesMapConstIteratorType it = m_Attributes.begin();
-
-    while (it != m_Attributes.end())
+    const AttributesListType attributes = this->GetAttributesList();
+    for (typename AttributesListType::const_iterator it = attributes.begin(); it != attributes.end(); ++it)
       {
       attributesNames.push_back(it->first);
-      ++it;
       }
+    std::sort(attributesNames.begin(), attributesNames.end());
     return attributesNames;
   }
 
+  /**
+   * Returns the columns of the available attributes in the attributes table
+   */
+  std::vector<unsigned int> GetAvailableAttributesIndices() const
+  {
+    if (m_AttributesTable.IsNull())
+      {
+      return std::vector<unsigned int>();
+      }
+    return m_AttributesTable->GetColumnsOfRow(m_AttributesRow);
+  }
+
   /**
   * This method is overloaded to add the copy of the attributes map.
   */
@@ -278,11 +453,33 @@ public:
 
     // copy the data of the current type if possible
     const Self * src = dynamic_cast<const Self *>(lo);
-    if (src == nullptr)
+    if (src == nullptr || src == this)
       {
       return;
       }
-    m_Attributes = src->m_Attributes;
+
+    if (m_AttributesTable.IsNull())
+      {
+      m_Attributes = src->GetAttributesList();
+      return;
+      }
+
+    m_AttributesTable->ClearRow(m_AttributesRow);
+    if (src->m_AttributesTable == m_AttributesTable)
+      {
+      const std::vector<unsigned int> columns = src->GetAvailableAttributesIndices();
+      for (std::vector<unsigned int>::const_iterator it = columns.begin(); it != columns.end(); ++it)
+        {
+        m_AttributesTable->SetValue(m_AttributesRow, *it, src->GetAttribute(*it));
+        }
+      return;
+      }
+
+    const AttributesListType attributes = src->GetAttributesList();
+    for (typename AttributesListType::const_iterator it = attributes.begin(); it != attributes.end(); ++it)
+      {
+      m_AttributesTable->SetValue(m_AttributesRow, m_AttributesTable->GetColumn(it->first), it->second);
+      }
   }
 
   /** Return the polygon (const version) */
@@ -305,27 +502,60 @@ public:
 
 protected:
   /** Constructor */
-  AttributesMapLabelObject() : m_Attributes(), m_Polygon(PolygonType::New()) {}
-  /** Destructor */
-  ~AttributesMapLabelObject() override {}
+  AttributesMapLabelObject() : m_AttributesTable(), m_AttributesRow(0), m_Attributes(), m_Polygon(PolygonType::New()) {}
+  /** Destructor, releasing the row of the object */
+  ~AttributesMapLabelObject() override
+  {
+    if (m_AttributesTable.IsNotNull())
+      {
+      m_AttributesTable->ReleaseRow(m_AttributesRow);
+      }
+  }
 
   /** The printself method */
   void PrintSelf(std::ostream& os, itk::Indent indent) const override
   {
     Superclass::PrintSelf(os, indent);
     os << indent << "Attributes: " << std::endl;
-    for (AttributesMapConstIteratorType it = m_Attributes.begin();
-         it != m_Attributes.end(); ++it)
+    const std::vector<std::string> names = this->GetAvailableAttributes();
+    for (std::vector<std::string>::const_iterator it = names.begin();
+         it != names.end(); ++it)
       {
-      os << indent << indent << it->first << " = " << it->second << std::endl;
+      os << indent << indent << *it << " = " << this->GetAttribute(it->c_str()) << std::endl;
       }
   }
 private:
   AttributesMapLabelObject(const Self &) = delete;
   void operator =(const Self&) = delete;
 
-  /** The attributes map */
-  AttributesMapType m_Attributes;
+  /** The (name, value) pairs of the attributes of the object */
+  AttributesListType GetAttributesList() const
+  {
+    if (m_AttributesTable.IsNull())
+      {
+      return m_Attributes;
+      }
+    AttributesListType attributes;
+    const std::vector<unsigned int> columns = this->GetAvailableAttributesIndices();
+    for (std::vector<unsigned int>::const_iterator it = columns.begin(); it != columns.end(); ++it)
+      {
+      attributes.push_back(std::make_pair(m_AttributesTable->GetColumnName(*it), this->GetAttribute(*it)));
+      }
+    return attributes;
+  }
+
+  /** Key of the attributes table in the dictionary of a label map */
+  static const char * AttributesTableKey()
+  {
+    return "AttributesMapTable";
+  }
+
+  /** The table holding the attributes values, and the row of the object */
+  AttributesTablePointerType m_AttributesTable;
+  unsigned int m_AttributesRow;
+
+  /** The attributes of an object which is not in a table */
+  AttributesListType m_Attributes;
 
   /** The polygon corresponding to the label object. Caution, this
    *  will be empty by default */
@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbAttributesMapTable_h
+#define otbAttributesMapTable_h
+
+#include "itkLightObject.h"
+#include "itkObjectFactory.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace otb
+{
+
+/** \class AttributesMapTable
+ *  \brief Columnar storage of the attributes of a set of label objects
+ *
+ * The table gives a column to each attribute name, in the order of
+ * registration, and a row to each label object. The values of a column are
+ * stored contiguously, one per row, with a flag telling whether the object
+ * of the row holds the attribute.
+ *
+ * A table is owned by a label map, which gives a row to each of its
+ * objects (see AttributesMapLabelObject::GetAttributesTable()), so that two
+ * label maps do not share their attribute names.
+ *
+ * Values are read and written by column index without any lock, and the
+ * column of a name is found without any lock either. Only the registration
+ * of a new column takes a lock, so that columns can be added while other
+ * threads access values. Columns never move once registered. Rows, on the
+ * other hand, must be added and released while no other thread uses the
+ * table, which is the case when objects are bound to the table of their
+ * label map before a threaded pass. Released rows are reused by AddRow().
+ *
+ * \sa AttributesMapLabelObject
+ *
+ * \ingroup OTBLabelMap
+ */
+template <class TAttributesValue>
+class ITK_EXPORT AttributesMapTable : public itk::LightObject
+{
+public:
+  /** Standard class typedefs */
+  typedef AttributesMapTable            Self;
+  typedef itk::LightObject              Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(AttributesMapTable, LightObject);
+
+  typedef TAttributesValue AttributesValueType;
+
+  /** Find the column of an attribute. Returns false if the name is not
+   * registered. */
+  bool FindColumn(const std::string & name, unsigned int & column) const
+  {
+    return Find(m_Directory.load(std::memory_order_acquire), name, column);
+  }
+
+  /** Get the column of an attribute, registering it if needed */
+  unsigned int GetColumn(const std::string & name)
+  {
+    unsigned int column = 0;
+    if (this->FindColumn(name, column))
+      {
+      return column;
+      }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (this->FindColumn(name, column))
+      {
+      return column;
+      }
+
+    // Grow the directory when it is full, keeping the former one for the
+    // threads still reading it
+    DirectoryType * directory = m_Directory.load(std::memory_order_relaxed);
+    column = m_NumberOfColumns.load(std::memory_order_relaxed);
+    if (column == directory->Columns.size())
+      {
+      std::unique_ptr<DirectoryType> grown(new DirectoryType(2 * column));
+      for (unsigned int c = 0; c < column; ++c)
+        {
+        grown->Columns[c] = directory->Columns[c];
+        Insert(grown.get(), c);
+        }
+      directory = grown.get();
+      m_Directories.push_back(std::move(grown));
+      m_Directory.store(directory, std::memory_order_release);
+      }
+
+    m_Columns.emplace_back(new ColumnType(name, m_NumberOfRows));
+    directory->Columns[column] = m_Columns.back().get();
+    Insert(directory, column);
+    m_NumberOfColumns.store(column + 1, std::memory_order_release);
+    return column;
+  }
+
+  /** Name of a column */
+  const std::string & GetColumnName(unsigned int column) const
+  {
+    return this->GetColumnData(column)->Name;
+  }
+
+  /** Number of registered columns */
+  unsigned int GetNumberOfColumns() const
+  {
+    return m_NumberOfColumns.load(std::memory_order_acquire);
+  }
+
+  /** Get an empty row, reusing a released one if any, and return its index */
+  unsigned int AddRow()
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_FreeRows.empty())
+      {
+      const unsigned int row = m_FreeRows.back();
+      m_FreeRows.pop_back();
+      return row;
+      }
+    for (auto & column : m_Columns)
+      {
+      column->Values.push_back(AttributesValueType());
+      column->Set.push_back(0);
+      }
+    return m_NumberOfRows++;
+  }
+
+  /** Unset all the values of a row and make it available to AddRow() */
+  void ReleaseRow(unsigned int row)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    this->ClearRow(row);
+    m_FreeRows.push_back(row);
+  }
+
+  /** Number of rows, including the released ones */
+  unsigned int GetNumberOfRows() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_NumberOfRows;
+  }
+
+  /** Unset all the values of a row */
+  void ClearRow(unsigned int row)
+  {
+    const unsigned int nbColumns = this->GetNumberOfColumns();
+    for (unsigned int column = 0; column < nbColumns; ++column)
+      {
+      this->GetColumnData(column)->Set[row] = 0;
+      }
+  }
+
+  /** Columns of the values set in a row */
+  std::vector<unsigned int> GetColumnsOfRow(unsigned int row) const
+  {
+    std::vector<unsigned int> columns;
+    const unsigned int nbColumns = this->GetNumberOfColumns();
+    for (unsigned int column = 0; column < nbColumns; ++column)
+      {
+      if (this->GetColumnData(column)->Set[row])
+        {
+        columns.push_back(column);
+        }
+      }
+    return columns;
+  }
+
+  /** Returns true if the value of a column is set in a row */
+  bool HasValue(unsigned int row, unsigned int column) const
+  {
+    return column < this->GetNumberOfColumns() && this->GetColumnData(column)->Set[row];
+  }
+
+  /** Get the value of a column in a row. Returns false if it is not set. */
+  bool GetValue(unsigned int row, unsigned int column, AttributesValueType & value) const
+  {
+    if (column >= this->GetNumberOfColumns())
+      {
+      return false;
+      }
+    const ColumnType * data = this->GetColumnData(column);
+    if (!data->Set[row])
+      {
+      return false;
+      }
+    value = data->Values[row];
+    return true;
+  }
+
+  /** Set the value of a registered column in a row */
+  void SetValue(unsigned int row, unsigned int column, AttributesValueType value)
+  {
+    ColumnType * data = this->GetColumnData(column);
+    data->Values[row] = value;
+    data->Set[row] = 1;
+  }
+
+protected:
+  AttributesMapTable() : m_Directory(nullptr), m_NumberOfColumns(0), m_NumberOfRows(0)
+  {
+    m_Directories.emplace_back(new DirectoryType(8));
+    m_Directory.store(m_Directories.back().get(), std::memory_order_release);
+  }
+  ~AttributesMapTable() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override
+  {
+    Superclass::PrintSelf(os, indent);
+    os << indent << "NumberOfRows: " << this->GetNumberOfRows() << std::endl;
+    os << indent << "NumberOfColumns: " << this->GetNumberOfColumns() << std::endl;
+  }
+
+private:
+  AttributesMapTable(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Values of an attribute, one per row */
+  struct ColumnType
+  {
+    ColumnType(const std::string & name, unsigned int nbRows)
+      : Name(name), Values(nbRows), Set(nbRows, 0) {}
+
+    const std::string                Name;
+    std::vector<AttributesValueType> Values;
+    /** Flags of the values set */
+    std::vector<unsigned char>       Set;
+  };
+
+  /** Columns by index, and an open addressing hash table of their names
+   * holding column + 1 (0 for an empty slot). Neither is resized: a larger
+   * directory replaces it when it is full. */
+  struct DirectoryType
+  {
+    explicit DirectoryType(unsigned int capacity)
+      : Columns(capacity, nullptr), Slots(new std::atomic<unsigned int>[2 * capacity]),
+        NumberOfSlots(2 * capacity)
+    {
+      for (unsigned int slot = 0; slot < NumberOfSlots; ++slot)
+        {
+        Slots[slot].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    std::vector<ColumnType *>                   Columns;
+    std::unique_ptr<std::atomic<unsigned int>[]> Slots;
+    unsigned int                                NumberOfSlots;
+  };
+
+  static bool Find(const DirectoryType * directory, const std::string & name, unsigned int & column)
+  {
+    const std::size_t mask = directory->NumberOfSlots - 1;
+    for (std::size_t slot = std::hash<std::string>()(name) & mask; ; slot = (slot + 1) & mask)
+      {
+      const unsigned int entry = directory->Slots[slot].load(std::memory_order_acquire);
+      if (entry == 0)
+        {
+        return false;
+        }
+      if (directory->Columns[entry - 1]->Name == name)
+        {
+        column = entry - 1;
+        return true;
+        }
+      }
+  }
+
+  static void Insert(DirectoryType * directory, unsigned int column)
+  {
+    const std::size_t mask = directory->NumberOfSlots - 1;
+    std::size_t slot = std::hash<std::string>()(directory->Columns[column]->Name) & mask;
+    while (directory->Slots[slot].load(std::memory_order_relaxed) != 0)
+      {
+      slot = (slot + 1) & mask;
+      }
+    directory->Slots[slot].store(column + 1, std::memory_order_release);
+  }
+
+  ColumnType * GetColumnData(unsigned int column) const
+  {
+    return m_Directory.load(std::memory_order_acquire)->Columns[column];
+  }
+
+  /** Current directory of the columns */
+  std::atomic<DirectoryType *> m_Directory;
+  /** All the directories, the former ones being kept for concurrent readers */
+  std::vector<std::unique_ptr<DirectoryType> > m_Directories;
+  /** Columns, in the order of registration */
+  std::vector<std::unique_ptr<ColumnType> > m_Columns;
+  std::atomic<unsigned int> m_NumberOfColumns;
+
+  unsigned int m_NumberOfRows;
+  /** Released rows, reused by AddRow() */
+  std::vector<unsigned int> m_FreeRows;
+
+  /** Guards the registration of columns and the rows */
+  mutable std::mutex m_Mutex;
+};
+
+} // end namespace otb
+#endif
@@ -99,6 +99,14 @@ protected:
   /** Destructor */
   ~LabelMapFeaturesFunctorImageFilter() override {}
 
+  /** Move the attributes of the objects of the output to the attributes
+   * table of the output */
+  void BeforeThreadedGenerateData() override
+  {
+    Superclass::BeforeThreadedGenerateData();
+    LabelObjectType::GetAttributesTable(this->GetOutput());
+  }
+
   /** Threaded generate data */
   void ThreadedProcessLabelObject(LabelObjectType * labelObject) override
   {
@@ -97,33 +97,40 @@ MinMaxAttributesLabelMapFilter<TInputImage>
   AttributesMapType& minAttr = this->GetMinimumOutput()->Get();
   AttributesMapType& maxAttr = this->GetMaximumOutput()->Get();
 
-  // create an entry in the output maps for each attribute
-  std::vector<std::string>::const_iterator valueIt;
-  for (valueIt = attributes.begin(); valueIt != attributes.end(); ++valueIt)
+  // resolve the column of each attribute once, in the table of the map
+  typename LabelObjectType::AttributesTableType * table =
+    LabelObjectType::GetAttributesTable(this->GetLabelMap());
+  const std::size_t nbAttributes = attributes.size();
+  std::vector<unsigned int> indices(nbAttributes);
+  for (std::size_t j = 0; j < nbAttributes; ++j)
     {
-    minAttr[*valueIt] = itk::NumericTraits<AttributesValueType>::max();
-    maxAttr[*valueIt] = itk::NumericTraits<AttributesValueType>::NonpositiveMin();
+    indices[j] = table->GetColumn(attributes[j]);
     }
 
+  std::vector<AttributesValueType> minValues(nbAttributes, itk::NumericTraits<AttributesValueType>::max());
+  std::vector<AttributesValueType> maxValues(nbAttributes, itk::NumericTraits<AttributesValueType>::NonpositiveMin());
 
   for(unsigned int i = 0; i < this->GetLabelMap()->GetNumberOfLabelObjects(); ++i)
     {
-     LabelObjectType* labelObject =this->GetLabelMap()->GetNthLabelObject(i);
-     std::vector<std::string>::const_iterator it;
-        for (it = attributes.begin(); it != attributes.end(); ++it)
-          {
-          AttributesValueType val = labelObject->GetAttribute((*it).c_str());
-          // Update min
-          if (val < minAttr[*it])
-           minAttr[*it] = val;
-          //Update max
-          if (val > maxAttr[*it])
-            maxAttr[*it] = val;
-          }
-        ++it;
+    LabelObjectType* labelObject = this->GetLabelMap()->GetNthLabelObject(i);
+    for (std::size_t j = 0; j < nbAttributes; ++j)
+      {
+      AttributesValueType val = labelObject->GetAttribute(indices[j]);
+      // Update min
+      if (val < minValues[j])
+        minValues[j] = val;
+      //Update max
+      if (val > maxValues[j])
+        maxValues[j] = val;
+      }
     }
 
-
+  // create an entry in the output maps for each attribute
+  for (std::size_t j = 0; j < nbAttributes; ++j)
+    {
+    minAttr[attributes[j]] = minValues[j];
+    maxAttr[attributes[j]] = maxValues[j];
+    }
 }
 
 }// end namespace otb
@@ -52,6 +52,7 @@ public:
   typedef TLabelObject                                  LabelObjectType;
   typedef typename LabelObjectType::AttributesMapType   AttributesMapType;
   typedef typename LabelObjectType::AttributesValueType AttributesValueType;
+  typedef typename LabelObjectType::AttributesTableType AttributesTableType;
 
   /** Constructor */
   NormalizeAttributesLabelObjectFunctor();
@@ -71,16 +72,30 @@ public:
   void SetMinAttributesValues(const AttributesMapType& minValues)
   {
     m_Min = minValues;
+    m_Table = nullptr;
   }
 
   void SetMaxAttributesValues(const AttributesMapType& maxValues)
   {
     m_Max = maxValues;
+    m_Table = nullptr;
   }
 
+  /** Resolve the columns of the attributes having both a minimum and a
+   * maximum in an attributes table, so that the objects of this table are
+   * normalized without looking up names */
+  void SetAttributesTable(const AttributesTableType * table);
+
 private:
   AttributesMapType m_Min;
   AttributesMapType m_Max;
+
+  /** Table of the resolved columns */
+  const AttributesTableType *      m_Table;
+  /** Minimum and range of each column of the attributes table */
+  std::vector<AttributesValueType> m_ColumnMin;
+  std::vector<AttributesValueType> m_ColumnRange;
+  std::vector<bool>                m_ColumnNormalized;
 };
 
 }
@@ -145,6 +160,9 @@ protected:
   /** Destructor */
   ~NormalizeAttributesLabelMapFilter() override{}
 
+  /** Resolve the columns of the attributes table of the output */
+  void BeforeThreadedGenerateData() override;
+
   /** PrintSelf method */
   void PrintSelf(std::ostream& os, itk::Indent indent) const override;
 
@@ -30,7 +30,7 @@ namespace Functor {
 
 template <class TLabelObject>
 NormalizeAttributesLabelObjectFunctor<TLabelObject>
-::NormalizeAttributesLabelObjectFunctor()
+::NormalizeAttributesLabelObjectFunctor() : m_Table(nullptr)
 {}
 
 /** The comparator (!=) */
@@ -52,28 +52,86 @@ NormalizeAttributesLabelObjectFunctor<TLabelObject>
   return !(this != self);
   }
 
+template <class TLabelObject>
+void
+NormalizeAttributesLabelObjectFunctor<TLabelObject>
+::SetAttributesTable(const AttributesTableType * table)
+{
+  m_Table = table;
+  m_ColumnMin.clear();
+  m_ColumnRange.clear();
+  m_ColumnNormalized.clear();
+
+  typename AttributesMapType::const_iterator minIt;
+  for (minIt = m_Min.begin(); minIt != m_Min.end(); ++minIt)
+    {
+    typename AttributesMapType::const_iterator maxIt = m_Max.find(minIt->first);
+    if (maxIt == m_Max.end())
+      {
+      continue;
+      }
+    unsigned int index = 0;
+    if (!table->FindColumn(minIt->first, index))
+      {
+      continue;
+      }
+    if (index >= m_ColumnNormalized.size())
+      {
+      m_ColumnMin.resize(index + 1, AttributesValueType());
+      m_ColumnRange.resize(index + 1, AttributesValueType());
+      m_ColumnNormalized.resize(index + 1, false);
+      }
+    m_ColumnMin[index] = minIt->second;
+    m_ColumnRange[index] = maxIt->second - minIt->second;
+    m_ColumnNormalized[index] = true;
+    }
+}
+
 template <class TLabelObject>
 void
 NormalizeAttributesLabelObjectFunctor<TLabelObject>
 ::operator() (LabelObjectType * lo) const
 {
-  const std::vector<std::string>& attr = lo->GetAvailableAttributes();
+  if (m_Table == nullptr || lo->GetAttributesTable() != m_Table)
+    {
+    const std::vector<std::string>& attr = lo->GetAvailableAttributes();
+
+    std::vector<std::string>::const_iterator it;
+    for (it = attr.begin(); it != attr.end(); ++it)
+      {
+      const AttributesValueType& value = lo->GetAttribute( (*it).c_str() );
+      typename AttributesMapType::const_iterator minIt = m_Min.find(*it);
+      typename AttributesMapType::const_iterator maxIt = m_Max.find(*it);
+      if (minIt != m_Min.end() && maxIt != m_Max.end())
+        {
+        lo->SetAttribute( (*it).c_str(), (value - minIt->second)/(maxIt->second - minIt->second) );
+        }
+      }
+    return;
+    }
 
-  std::vector<std::string>::const_iterator it;
-  for (it = attr.begin(); it != attr.end(); ++it)
+  const unsigned int nbColumns = static_cast<unsigned int>(m_ColumnNormalized.size());
+  for (unsigned int index = 0; index < nbColumns; ++index)
     {
-    const AttributesValueType& value = lo->GetAttribute( (*it).c_str() );
-    typename AttributesMapType::const_iterator minIt = m_Min.find(*it);
-    typename AttributesMapType::const_iterator maxIt = m_Max.find(*it);
-    if (minIt != m_Min.end() && maxIt != m_Max.end())
+    if (m_ColumnNormalized[index] && lo->HasAttribute(index))
       {
-      lo->SetAttribute( (*it).c_str(), (value - minIt->second)/(maxIt->second - minIt->second) );
+      const AttributesValueType value = lo->GetAttribute(index);
+      lo->SetAttribute(index, (value - m_ColumnMin[index]) / m_ColumnRange[index]);
       }
     }
 }
 
 } // end namespace Functor
 
+template<class TImage>
+void
+NormalizeAttributesLabelMapFilter<TImage>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+  this->GetFunctor().SetAttributesTable(LabelObjectType::GetAttributesTable(this->GetOutput()));
+}
+
 template<class TImage>
 void
 NormalizeAttributesLabelMapFilter<TImage>
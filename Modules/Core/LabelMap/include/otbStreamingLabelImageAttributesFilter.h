@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingLabelImageAttributesFilter_h
+#define otbStreamingLabelImageAttributesFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "otbVectorImage.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace otb
+{
+
+/** \class PersistentLabelImageAttributesFilter
+ * \brief Compute shape and radiometric attributes of the objects of a label
+ * image, without building a label map.
+ *
+ * For each label different from the background value, this filter
+ * accumulates the population, the bounding box, the first and second order
+ * moments of the pixel indices and the number of pixels on the image border.
+ * If a feature image is set with SetFeatureImage(), the sums of the first
+ * four powers, the minimum and the maximum of each band are also accumulated.
+ *
+ * The accumulators are stored in flat arrays, one slot per label. Each thread
+ * fills its own arrays for the current requested region, which are merged
+ * into the global ones after each region, so that the memory used is one
+ * slot per label, whatever the number of threads and regions.
+ *
+ * Synthetize() computes a columnar table: one column per attribute and one
+ * row per label, in increasing label order. Attributes are named as in
+ * ShapeAttributesLabelMapFilter and BandsStatisticsAttributesLabelMapFilter:
+ * - SHAPE::Size, SHAPE::PhysicalSize, SHAPE::SizeOnBorder,
+ *   SHAPE::Elongation, SHAPE::RegionElongation, SHAPE::RegionRatio,
+ *   SHAPE::RegionIndex{d}, SHAPE::RegionSize{d}, SHAPE::PhysicalCentroid{d},
+ *   SHAPE::PrincipalMoments{d} for each dimension d,
+ * - STATS::Band{b}::Mean, Variance, Sigma, Skewness, Kurtosis, Minimum,
+ *   Maximum, Sum for each band b in [1..N].
+ *
+ * Attributes that need the geometry of the object (perimeter, Feret
+ * diameter, Flusser moments) are not computed.
+ *
+ * This filter persists its temporary data: if it is updated on several
+ * requested regions, the attributes are the ones of the whole set of
+ * regions.
+ *
+ * \sa StreamingLabelImageAttributesFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBLabelMap
+ */
+template <class TLabelImage, class TFeatureImage = otb::VectorImage<float, TLabelImage::ImageDimension> >
+class ITK_EXPORT PersistentLabelImageAttributesFilter
+  : public PersistentImageFilter<TLabelImage, TLabelImage>
+{
+public:
+  /** Standard class typedefs */
+  typedef PersistentLabelImageAttributesFilter             Self;
+  typedef PersistentImageFilter<TLabelImage, TLabelImage>  Superclass;
+  typedef itk::SmartPointer<Self>                          Pointer;
+  typedef itk::SmartPointer<const Self>                    ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentLabelImageAttributesFilter, PersistentImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TLabelImage::ImageDimension);
+
+  typedef TLabelImage                                   LabelImageType;
+  typedef typename LabelImageType::PixelType            LabelType;
+  typedef typename LabelImageType::RegionType           RegionType;
+  typedef typename LabelImageType::IndexType            IndexType;
+  typedef typename IndexType::IndexValueType            IndexValueType;
+
+  typedef TFeatureImage                                 FeatureImageType;
+
+  typedef std::uint64_t                                 CountType;
+  typedef std::vector<double>                           AttributeColumnType;
+
+  /** Set the feature image used to compute the radiometric attributes
+   * (optional) */
+  void SetFeatureImage(const FeatureImageType * image);
+
+  /** Get the feature image */
+  const FeatureImageType * GetFeatureImage() const;
+
+  /** Label of the pixels which do not belong to any object */
+  itkSetMacro(BackgroundValue, LabelType);
+  itkGetConstMacro(BackgroundValue, LabelType);
+
+  /** Labels of the objects, in increasing order (rows of the table) */
+  const std::vector<LabelType> & GetLabels() const
+  {
+    return m_Labels;
+  }
+
+  /** Names of the attributes (columns of the table) */
+  const std::vector<std::string> & GetAttributeNames() const
+  {
+    return m_AttributeNames;
+  }
+
+  /** Column of an attribute, throws if the attribute does not exist */
+  unsigned int GetAttributeIndex(const std::string & name) const;
+
+  /** Values of an attribute for each label, in the order of GetLabels() */
+  const AttributeColumnType & GetAttributeColumn(unsigned int column) const
+  {
+    return m_AttributeColumns[column];
+  }
+
+  /** Values of an attribute for each label, in the order of GetLabels() */
+  const AttributeColumnType & GetAttributeColumn(const std::string & name) const
+  {
+    return m_AttributeColumns[this->GetAttributeIndex(name)];
+  }
+
+  void Reset(void) override;
+
+  void Synthetize(void) override;
+
+protected:
+  PersistentLabelImageAttributesFilter();
+  ~PersistentLabelImageAttributesFilter() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  void GenerateOutputInformation() override;
+
+  void GenerateInputRequestedRegion() override;
+
+  void AllocateOutputs() override;
+
+  void BeforeThreadedGenerateData() override;
+
+  void ThreadedGenerateData(const RegionType& outputRegionForThread,
+                            itk::ThreadIdType threadId) override;
+
+  /** Merge the accumulators of the threads into the global one */
+  void AfterThreadedGenerateData() override;
+
+private:
+  PersistentLabelImageAttributesFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Accumulators of a set of labels, stored in flat arrays */
+  struct AccumulatorType
+  {
+    std::unordered_map<LabelType, std::size_t> Slots;
+    std::vector<LabelType>      Labels;
+    std::vector<CountType>      Counts;
+    std::vector<CountType>      SizesOnBorder;
+    /** ImageDimension values per label */
+    std::vector<IndexValueType> MinIndices;
+    std::vector<IndexValueType> MaxIndices;
+    std::vector<double>         IndexSums;
+    /** ImageDimension x ImageDimension values per label */
+    std::vector<double>         IndexProductSums;
+    /** 4 values per band and per label: sums of v, v^2, v^3 and v^4 */
+    std::vector<double>         BandSums;
+    /** One value per band and per label */
+    std::vector<double>         BandMinimums;
+    std::vector<double>         BandMaximums;
+
+    void Clear();
+  };
+
+  /** Slot of a label in an accumulator, created if needed */
+  std::size_t GetSlot(AccumulatorType & acc, LabelType label) const;
+
+  /** Add the accumulators of src to the ones of dst */
+  void Merge(AccumulatorType & dst, const AccumulatorType & src) const;
+
+  LabelType m_BackgroundValue;
+
+  unsigned int m_NumberOfBands;
+
+  AccumulatorType m_Accumulator;
+
+  std::vector<AccumulatorType> m_ThreadAccumulators;
+
+  std::vector<LabelType>           m_Labels;
+  std::vector<std::string>         m_AttributeNames;
+  std::vector<AttributeColumnType> m_AttributeColumns;
+};
+
+/** \class StreamingLabelImageAttributesFilter
+ * \brief Compute shape and radiometric attributes of the objects of a label
+ * image by streaming
+ *
+ * This class streams the label image (and the optional feature image)
+ * through a PersistentLabelImageAttributesFilter. Unlike the attribute label
+ * map filters, it never holds the whole label image nor the lines of the
+ * objects in memory.
+ *
+ * \code
+ * typedef otb::StreamingLabelImageAttributesFilter<LabelImageType, ImageType> AttributesFilterType;
+ * AttributesFilterType::Pointer attributes = AttributesFilterType::New();
+ * attributes->SetInput(labelImage);
+ * attributes->SetFeatureImage(image);
+ * attributes->Update();
+ * const std::vector<double> & means = attributes->GetAttributeColumn("STATS::Band1::Mean");
+ * \endcode
+ *
+ * \sa PersistentLabelImageAttributesFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBLabelMap
+ */
+template <class TLabelImage, class TFeatureImage = otb::VectorImage<float, TLabelImage::ImageDimension> >
+class ITK_EXPORT StreamingLabelImageAttributesFilter
+  : public PersistentFilterStreamingDecorator
+      <PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage> >
+{
+public:
+  /** Standard class typedefs */
+  typedef StreamingLabelImageAttributesFilter Self;
+  typedef PersistentFilterStreamingDecorator
+    <PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage> > Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(StreamingLabelImageAttributesFilter, PersistentFilterStreamingDecorator);
+
+  typedef TLabelImage                                           LabelImageType;
+  typedef TFeatureImage                                         FeatureImageType;
+  typedef typename Superclass::FilterType::LabelType            LabelType;
+  typedef typename Superclass::FilterType::AttributeColumnType  AttributeColumnType;
+
+  /** Set the input label image */
+  using Superclass::SetInput;
+  void SetInput(const LabelImageType * input)
+  {
+    this->GetFilter()->SetInput(input);
+  }
+
+  /** Get the input label image */
+  const LabelImageType * GetInput()
+  {
+    return this->GetFilter()->GetInput();
+  }
+
+  /** Set the feature image (optional) */
+  void SetFeatureImage(const FeatureImageType * image)
+  {
+    this->GetFilter()->SetFeatureImage(image);
+  }
+
+  /** Get the feature image */
+  const FeatureImageType * GetFeatureImage() const
+  {
+    return this->GetFilter()->GetFeatureImage();
+  }
+
+  /** Set the background value */
+  void SetBackgroundValue(LabelType value)
+  {
+    this->GetFilter()->SetBackgroundValue(value);
+  }
+
+  /** Get the background value */
+  LabelType GetBackgroundValue() const
+  {
+    return this->GetFilter()->GetBackgroundValue();
+  }
+
+  /** Labels of the objects, in increasing order */
+  const std::vector<LabelType> & GetLabels() const
+  {
+    return this->GetFilter()->GetLabels();
+  }
+
+  /** Names of the attributes */
+  const std::vector<std::string> & GetAttributeNames() const
+  {
+    return this->GetFilter()->GetAttributeNames();
+  }
+
+  /** Values of an attribute for each label, in the order of GetLabels() */
+  const AttributeColumnType & GetAttributeColumn(const std::string & name) const
+  {
+    return this->GetFilter()->GetAttributeColumn(name);
+  }
+
+protected:
+  /** Constructor */
+  StreamingLabelImageAttributesFilter() {}
+  /** Destructor */
+  ~StreamingLabelImageAttributesFilter() override {}
+
+private:
+  StreamingLabelImageAttributesFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingLabelImageAttributesFilter.hxx"
+#endif
+
+#endif
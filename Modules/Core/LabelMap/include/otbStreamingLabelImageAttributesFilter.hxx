@@ -0,0 +1,534 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingLabelImageAttributesFilter_hxx
+#define otbStreamingLabelImageAttributesFilter_hxx
+
+#include "otbStreamingLabelImageAttributesFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkProgressReporter.h"
+#include "itkMatrix.h"
+#include "vnl/algo/vnl_symmetric_eigensystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+namespace otb
+{
+
+template <class TLabelImage, class TFeatureImage>
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::PersistentLabelImageAttributesFilter() : m_BackgroundValue(0), m_NumberOfBands(0)
+{
+  this->SetNumberOfRequiredInputs(1);
+}
+
+template <class TLabelImage, class TFeatureImage>
+void
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::SetFeatureImage(const FeatureImageType * image)
+{
+  // Process object is not const-correct so the const_cast is required here
+  this->itk::ProcessObject::SetNthInput(1, const_cast<FeatureImageType *>(image));
+}
+
+template <class TLabelImage, class TFeatureImage>
+const typename PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::FeatureImageType *
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::GetFeatureImage() const
+{
+  if (this->GetNumberOfInputs() < 2)
+    {
+    return nullptr;
+    }
+  return static_cast<const FeatureImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TLabelImage, class TFeatureImage>
+unsigned int
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::GetAttributeIndex(const std::string & name) const
+{
+  auto it = std::find(m_AttributeNames.begin(), m_AttributeNames.end(), name);
+  if (it == m_AttributeNames.end())
+    {
+    itkExceptionMacro(<< "Unknown attribute: " << name);
+    }
+  return static_cast<unsigned int>(it - m_AttributeNames.begin());
+}
+
+template <class TLabelImage, class TFeatureImage>
+void
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  if (this->GetInput())
+    {
+    this->GetOutput()->CopyInformation(this->GetInput());
+    this->GetOutput()->SetLargestPossibleRegion(this->GetInput()->GetLargestPossibleRegion());
+
+    if (this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() == 0)
+      {
+      this->GetOutput()->SetRequestedRegion(this->GetOutput()->GetLargestPossibleRegion());
+      }
+    }
+}
+
+template <class TLabelImage, class TFeatureImage>
+void
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::GenerateInputRequestedRegion()
+{
+  auto labelImage = const_cast<LabelImageType *>(this->GetInput());
+  auto featureImage = const_cast<FeatureImageType *>(this->GetFeatureImage());
+  const RegionType & outputRegion = this->GetOutput()->GetRequestedRegion();
+
+  if (labelImage)
+    {
+    labelImage->SetRequestedRegion(outputRegion);
+    }
+  if (featureImage)
+    {
+    featureImage->SetRequestedRegion(outputRegion);
+    }
+}
+
+template <class TLabelImage, class TFeatureImage>
+void
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::AllocateOutputs()
+{
+  // Nothing to allocate: the output image is not intended to be used
+}
+
+template <class TLabelImage, class TFeatureImage>
+void
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::AccumulatorType
+::Clear()
+{
+  Slots.clear();
+  Labels.clear();
+  Counts.clear();
+  SizesOnBorder.clear();
+  MinIndices.clear();
+  MaxIndices.clear();
+  IndexSums.clear();
+  IndexProductSums.clear();
+  BandSums.clear();
+  BandMinimums.clear();
+  BandMaximums.clear();
+}
+
+template <class TLabelImage, class TFeatureImage>
+std::size_t
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::GetSlot(AccumulatorType & acc, LabelType label) const
+{
+  auto inserted = acc.Slots.emplace(label, acc.Labels.size());
+  if (inserted.second)
+    {
+    acc.Labels.push_back(label);
+    acc.Counts.push_back(0);
+    acc.SizesOnBorder.push_back(0);
+    acc.MinIndices.insert(acc.MinIndices.end(), ImageDimension,
+                          std::numeric_limits<IndexValueType>::max());
+    acc.MaxIndices.insert(acc.MaxIndices.end(), ImageDimension,
+                          std::numeric_limits<IndexValueType>::lowest());
+    acc.IndexSums.insert(acc.IndexSums.end(), ImageDimension, 0.);
+    acc.IndexProductSums.insert(acc.IndexProductSums.end(), ImageDimension * ImageDimension, 0.);
+    acc.BandSums.insert(acc.BandSums.end(), 4 * m_NumberOfBands, 0.);
+    acc.BandMinimums.insert(acc.BandMinimums.end(), m_NumberOfBands,
+                            std::numeric_limits<double>::max());
+    acc.BandMaximums.insert(acc.BandMaximums.end(), m_NumberOfBands,
+                            std::numeric_limits<double>::lowest());
+    }
+  return inserted.first->second;
+}
+
+template <class TLabelImage, class TFeatureImage>
+void
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::Merge(AccumulatorType & dst, const AccumulatorType & src) const
+{
+  const unsigned int dim = ImageDimension;
+  const unsigned int nbBands = m_NumberOfBands;
+  for (std::size_t s = 0; s < src.Labels.size(); ++s)
+    {
+    const std::size_t d = this->GetSlot(dst, src.Labels[s]);
+    dst.Counts[d] += src.Counts[s];
+    dst.SizesOnBorder[d] += src.SizesOnBorder[s];
+    for (unsigned int i = 0; i < dim; ++i)
+      {
+      dst.MinIndices[d * dim + i] = std::min(dst.MinIndices[d * dim + i], src.MinIndices[s * dim + i]);
+      dst.MaxIndices[d * dim + i] = std::max(dst.MaxIndices[d * dim + i], src.MaxIndices[s * dim + i]);
+      dst.IndexSums[d * dim + i] += src.IndexSums[s * dim + i];
+      }
+    for (unsigned int i = 0; i < dim * dim; ++i)
+      {
+      dst.IndexProductSums[d * dim * dim + i] += src.IndexProductSums[s * dim * dim + i];
+      }
+    for (unsigned int b = 0; b < 4 * nbBands; ++b)
+      {
+      dst.BandSums[d * 4 * nbBands + b] += src.BandSums[s * 4 * nbBands + b];
+      }
+    for (unsigned int b = 0; b < nbBands; ++b)
+      {
+      dst.BandMinimums[d * nbBands + b] = std::min(dst.BandMinimums[d * nbBands + b], src.BandMinimums[s * nbBands + b]);
+      dst.BandMaximums[d * nbBands + b] = std::max(dst.BandMaximums[d * nbBands + b], src.BandMaximums[s * nbBands + b]);
+      }
+    }
+}
+
+template <class TLabelImage, class TFeatureImage>
+void
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::Reset()
+{
+  auto featureImage = const_cast<FeatureImageType *>(this->GetFeatureImage());
+  m_NumberOfBands = 0;
+  if (featureImage)
+    {
+    featureImage->UpdateOutputInformation();
+    m_NumberOfBands = featureImage->GetNumberOfComponentsPerPixel();
+    }
+
+  m_Accumulator.Clear();
+  m_ThreadAccumulators.clear();
+  m_Labels.clear();
+  m_AttributeNames.clear();
+  m_AttributeColumns.clear();
+}
+
+template <class TLabelImage, class TFeatureImage>
+void
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::BeforeThreadedGenerateData()
+{
+  m_ThreadAccumulators.resize(this->GetNumberOfThreads());
+  for (auto & acc : m_ThreadAccumulators)
+    {
+    acc.Clear();
+    }
+}
+
+template <class TLabelImage, class TFeatureImage>
+void
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  const LabelImageType * labelImage = this->GetInput();
+  const FeatureImageType * featureImage = this->GetFeatureImage();
+  const unsigned int dim = ImageDimension;
+  const unsigned int nbBands = m_NumberOfBands;
+
+  const RegionType & largestRegion = labelImage->GetLargestPossibleRegion();
+  const IndexType borderMin = largestRegion.GetIndex();
+  const IndexType borderMax = largestRegion.GetUpperIndex();
+
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  AccumulatorType & acc = m_ThreadAccumulators[threadId];
+
+  itk::ImageRegionConstIteratorWithIndex<LabelImageType> labelIt(labelImage, outputRegionForThread);
+  itk::ImageRegionConstIterator<FeatureImageType> featureIt;
+  if (featureImage)
+    {
+    featureIt = itk::ImageRegionConstIterator<FeatureImageType>(featureImage, outputRegionForThread);
+    featureIt.GoToBegin();
+    }
+
+  // Objects are made of runs of pixels: the slot of the previous label is
+  // reused as long as the label does not change
+  bool hasSlot = false;
+  LabelType slotLabel = m_BackgroundValue;
+  std::size_t slot = 0;
+
+  for (labelIt.GoToBegin(); !labelIt.IsAtEnd(); ++labelIt)
+    {
+    const LabelType label = labelIt.Get();
+    if (label != m_BackgroundValue)
+      {
+      if (!hasSlot || label != slotLabel)
+        {
+        slot = this->GetSlot(acc, label);
+        slotLabel = label;
+        hasSlot = true;
+        }
+
+      const IndexType & idx = labelIt.GetIndex();
+      ++acc.Counts[slot];
+
+      bool onBorder = false;
+      IndexValueType * minIndices = &acc.MinIndices[slot * dim];
+      IndexValueType * maxIndices = &acc.MaxIndices[slot * dim];
+      double * indexSums = &acc.IndexSums[slot * dim];
+      double * indexProductSums = &acc.IndexProductSums[slot * dim * dim];
+      for (unsigned int i = 0; i < dim; ++i)
+        {
+        minIndices[i] = std::min(minIndices[i], idx[i]);
+        maxIndices[i] = std::max(maxIndices[i], idx[i]);
+        onBorder = onBorder || idx[i] == borderMin[i] || idx[i] == borderMax[i];
+        indexSums[i] += idx[i];
+        for (unsigned int j = 0; j < dim; ++j)
+          {
+          indexProductSums[i * dim + j] += static_cast<double>(idx[i]) * idx[j];
+          }
+        }
+      if (onBorder)
+        {
+        ++acc.SizesOnBorder[slot];
+        }
+
+      if (featureImage)
+        {
+        const typename FeatureImageType::PixelType & pixel = featureIt.Get();
+        double * bandSums = &acc.BandSums[slot * 4 * nbBands];
+        double * bandMinimums = &acc.BandMinimums[slot * nbBands];
+        double * bandMaximums = &acc.BandMaximums[slot * nbBands];
+        for (unsigned int b = 0; b < nbBands; ++b)
+          {
+          const double v = static_cast<double>(pixel[b]);
+          const double v2 = v * v;
+          bandSums[4 * b] += v;
+          bandSums[4 * b + 1] += v2;
+          bandSums[4 * b + 2] += v2 * v;
+          bandSums[4 * b + 3] += v2 * v2;
+          bandMinimums[b] = std::min(bandMinimums[b], v);
+          bandMaximums[b] = std::max(bandMaximums[b], v);
+          }
+        }
+      }
+
+    if (featureImage)
+      {
+      ++featureIt;
+      }
+    progress.CompletedPixel();
+    }
+}
+
+template <class TLabelImage, class TFeatureImage>
+void
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::AfterThreadedGenerateData()
+{
+  for (auto & acc : m_ThreadAccumulators)
+    {
+    this->Merge(m_Accumulator, acc);
+    acc.Clear();
+    }
+}
+
+template <class TLabelImage, class TFeatureImage>
+void
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::Synthetize()
+{
+  const LabelImageType * labelImage = this->GetInput();
+  const unsigned int dim = ImageDimension;
+  const unsigned int nbBands = m_NumberOfBands;
+  const AccumulatorType & acc = m_Accumulator;
+
+  // Column names
+  m_AttributeNames.clear();
+  m_AttributeNames.push_back("SHAPE::Size");
+  m_AttributeNames.push_back("SHAPE::PhysicalSize");
+  m_AttributeNames.push_back("SHAPE::SizeOnBorder");
+  m_AttributeNames.push_back("SHAPE::Elongation");
+  m_AttributeNames.push_back("SHAPE::RegionElongation");
+  m_AttributeNames.push_back("SHAPE::RegionRatio");
+  std::ostringstream oss;
+  for (unsigned int i = 0; i < dim; ++i)
+    {
+    const char * names[] = {"RegionIndex", "RegionSize", "PhysicalCentroid", "PrincipalMoments"};
+    for (const char * name : names)
+      {
+      oss.str("");
+      oss << "SHAPE::" << name << i;
+      m_AttributeNames.push_back(oss.str());
+      }
+    }
+  for (unsigned int b = 0; b < nbBands; ++b)
+    {
+    const char * names[] = {"Mean", "Variance", "Sigma", "Skewness", "Kurtosis", "Minimum", "Maximum", "Sum"};
+    for (const char * name : names)
+      {
+      oss.str("");
+      oss << "STATS::Band" << b + 1 << "::" << name; // [1..N] convention in feature naming
+      m_AttributeNames.push_back(oss.str());
+      }
+    }
+
+  // Rows in increasing label order
+  const std::size_t nbLabels = acc.Labels.size();
+  std::vector<std::size_t> order(nbLabels);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&acc](std::size_t a, std::size_t b)
+    {
+    return acc.Labels[a] < acc.Labels[b];
+    });
+
+  m_Labels.resize(nbLabels);
+  m_AttributeColumns.assign(m_AttributeNames.size(), AttributeColumnType(nbLabels));
+
+  // Linear part of the index to physical point transform
+  typedef itk::Matrix<double, ImageDimension, ImageDimension> MatrixType;
+  typedef itk::ContinuousIndex<double, ImageDimension>        ContinuousIndexType;
+  typedef typename LabelImageType::PointType                  PointType;
+  MatrixType indexToPhysical;
+  ContinuousIndexType zeroIndex;
+  zeroIndex.Fill(0);
+  PointType zeroPoint;
+  labelImage->TransformContinuousIndexToPhysicalPoint(zeroIndex, zeroPoint);
+  for (unsigned int j = 0; j < dim; ++j)
+    {
+    ContinuousIndexType unitIndex = zeroIndex;
+    unitIndex[j] = 1;
+    PointType unitPoint;
+    labelImage->TransformContinuousIndexToPhysicalPoint(unitIndex, unitPoint);
+    for (unsigned int i = 0; i < dim; ++i)
+      {
+      indexToPhysical(i, j) = unitPoint[i] - zeroPoint[i];
+      }
+    }
+
+  double sizePerPixel = 1;
+  for (unsigned int i = 0; i < dim; ++i)
+    {
+    sizePerPixel *= std::abs(labelImage->GetSignedSpacing()[i]);
+    }
+
+  for (std::size_t row = 0; row < nbLabels; ++row)
+    {
+    const std::size_t s = order[row];
+    m_Labels[row] = acc.Labels[s];
+    const double size = static_cast<double>(acc.Counts[s]);
+    unsigned int col = 0;
+
+    // Bounding box and centered second order moments in index space
+    ContinuousIndexType centroid;
+    MatrixType indexMoments;
+    double regionPixels = 1;
+    double minSize = std::numeric_limits<double>::max();
+    double maxSize = std::numeric_limits<double>::lowest();
+    for (unsigned int i = 0; i < dim; ++i)
+      {
+      centroid[i] = acc.IndexSums[s * dim + i] / size;
+      const double regionSize = acc.MaxIndices[s * dim + i] - acc.MinIndices[s * dim + i] + 1;
+      regionPixels *= regionSize;
+      const double physicalRegionSize = regionSize * std::abs(labelImage->GetSignedSpacing()[i]);
+      minSize = std::min(minSize, physicalRegionSize);
+      maxSize = std::max(maxSize, physicalRegionSize);
+      }
+    for (unsigned int i = 0; i < dim; ++i)
+      {
+      for (unsigned int j = 0; j < dim; ++j)
+        {
+        indexMoments(i, j) = acc.IndexProductSums[(s * dim + i) * dim + j] / size
+          - centroid[i] * centroid[j];
+        }
+      }
+    PointType physicalCentroid;
+    labelImage->TransformContinuousIndexToPhysicalPoint(centroid, physicalCentroid);
+
+    // Principal moments of the physical positions
+    const MatrixType centralMoments = indexToPhysical * indexMoments * indexToPhysical.GetTranspose();
+    vnl_symmetric_eigensystem<double> eigen(centralMoments.GetVnlMatrix());
+    double elongation = 0;
+    if (eigen.D(dim - 2, dim - 2) != 0)
+      {
+      elongation = std::sqrt(eigen.D(dim - 1, dim - 1) / eigen.D(dim - 2, dim - 2));
+      }
+
+    m_AttributeColumns[col++][row] = size;
+    m_AttributeColumns[col++][row] = size * sizePerPixel;
+    m_AttributeColumns[col++][row] = static_cast<double>(acc.SizesOnBorder[s]);
+    m_AttributeColumns[col++][row] = elongation;
+    m_AttributeColumns[col++][row] = maxSize / minSize;
+    m_AttributeColumns[col++][row] = size / regionPixels;
+    for (unsigned int i = 0; i < dim; ++i)
+      {
+      m_AttributeColumns[col++][row] = acc.MinIndices[s * dim + i];
+      m_AttributeColumns[col++][row] = acc.MaxIndices[s * dim + i] - acc.MinIndices[s * dim + i] + 1;
+      m_AttributeColumns[col++][row] = physicalCentroid[i];
+      m_AttributeColumns[col++][row] = eigen.D(i, i);
+      }
+
+    // Radiometric statistics, computed as in StatisticsAttributesLabelMapFilter
+    for (unsigned int b = 0; b < nbBands; ++b)
+      {
+      const double sum = acc.BandSums[(s * nbBands + b) * 4];
+      const double sum2 = acc.BandSums[(s * nbBands + b) * 4 + 1];
+      const double sum3 = acc.BandSums[(s * nbBands + b) * 4 + 2];
+      const double sum4 = acc.BandSums[(s * nbBands + b) * 4 + 3];
+      const double mean = sum / size;
+      const double variance = size > 1 ? (sum2 - (sum * sum / size)) / (size - 1) : 0.;
+      const double sigma = std::sqrt(variance);
+      const double mean2 = mean * mean;
+      double skewness = 0;
+      double kurtosis = 0;
+
+      const double epsilon = 1E-10;
+      if (std::abs(variance) > epsilon)
+        {
+        skewness = ((sum3 - 3.0 * mean * sum2) / size + 2.0 * mean * mean2) / (variance * sigma);
+        kurtosis = ((sum4 - 4.0 * mean * sum3 + 6.0 * mean2 * sum2) / size - 3.0 * mean2 * mean2)
+          / (variance * variance) - 3.0;
+        }
+
+      m_AttributeColumns[col++][row] = mean;
+      m_AttributeColumns[col++][row] = variance;
+      m_AttributeColumns[col++][row] = sigma;
+      m_AttributeColumns[col++][row] = skewness;
+      m_AttributeColumns[col++][row] = kurtosis;
+      m_AttributeColumns[col++][row] = acc.BandMinimums[s * nbBands + b];
+      m_AttributeColumns[col++][row] = acc.BandMaximums[s * nbBands + b];
+      m_AttributeColumns[col++][row] = sum;
+      }
+    }
+
+  // The accumulators are not needed anymore
+  m_Accumulator.Clear();
+  m_ThreadAccumulators.clear();
+}
+
+template <class TLabelImage, class TFeatureImage>
+void
+PersistentLabelImageAttributesFilter<TLabelImage, TFeatureImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Background value: " << m_BackgroundValue << std::endl;
+  os << indent << "Number of bands: " << m_NumberOfBands << std::endl;
+  os << indent << "Number of labels: " << m_Labels.size() << std::endl;
+  os << indent << "Number of attributes: " << m_AttributeNames.size() << std::endl;
+}
+
+} // end namespace otb
+
+#endif
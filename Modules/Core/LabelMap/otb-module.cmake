@@ -29,6 +29,7 @@ otb_module(OTBLabelMap
     OTBITK
     OTBImageBase
     OTBMoments
+    OTBStreaming
     OTBVectorDataBase
     OTBVectorDataManipulation
 
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbAttributesMapLabelObject.h"
+
+#include <iostream>
+
+typedef otb::AttributesMapLabelObject<unsigned int, 2, double> LabelObjectType;
+typedef LabelObjectType::LabelMapType                          LabelMapType;
+typedef LabelObjectType::AttributesTableType                   AttributesTableType;
+
+int otbAttributesMapLabelObject(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  LabelObjectType::Pointer lo1 = LabelObjectType::New();
+  LabelObjectType::Pointer lo2 = LabelObjectType::New();
+  lo1->SetLabel(1);
+  lo2->SetLabel(2);
+
+  lo1->SetAttribute("SHAPE::Size", 10.);
+  lo1->SetAttribute(std::string("SHAPE::Perimeter"), 4.);
+  lo2->SetAttribute("SHAPE::Perimeter", 7.);
+
+  // Objects out of a label map keep their attributes without a table
+  if (lo1->GetAttributesTable() != nullptr || lo2->GetAttributesTable() != nullptr
+      || lo1->GetNumberOfAttributes() != 2 || lo1->GetAttribute("SHAPE::Size") != 10.
+      || !lo1->GetAvailableAttributesIndices().empty())
+    {
+    std::cerr << "Objects out of a label map should not have a table" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  LabelMapType::Pointer labelMap = LabelMapType::New();
+  labelMap->AddLabelObject(lo1);
+  labelMap->AddLabelObject(lo2);
+
+  // The objects of the map are moved to the table of the map
+  AttributesTableType * table = LabelObjectType::GetAttributesTable(labelMap.GetPointer());
+  if (table != LabelObjectType::GetAttributesTable(labelMap.GetPointer())
+      || lo1->GetAttributesTable() != table || lo2->GetAttributesTable() != table
+      || lo1->GetAttributesRow() == lo2->GetAttributesRow())
+    {
+    std::cerr << "Objects of the map should share the table of the map" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  unsigned int sizeIndex = 0;
+  unsigned int perimeterIndex = 0;
+  if (table->GetNumberOfColumns() != 2
+      || !table->FindColumn("SHAPE::Size", sizeIndex)
+      || !table->FindColumn("SHAPE::Perimeter", perimeterIndex)
+      || table->GetColumnName(perimeterIndex) != "SHAPE::Perimeter")
+    {
+    std::cerr << "Inconsistent attributes table" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (lo1->GetAttribute(sizeIndex) != 10. || lo1->GetAttribute("SHAPE::Perimeter") != 4.
+      || lo2->GetAttribute(perimeterIndex) != 7.)
+    {
+    std::cerr << "Wrong attribute values" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (lo1->GetNumberOfAttributes() != 2 || lo2->GetNumberOfAttributes() != 1
+      || lo2->HasAttribute(sizeIndex))
+    {
+    std::cerr << "Wrong number of attributes" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Attributes are listed by name, as with the former map storage
+  std::vector<std::string> names = lo1->GetAvailableAttributes();
+  if (names.size() != 2 || names[0] != "SHAPE::Perimeter" || names[1] != "SHAPE::Size")
+    {
+    std::cerr << "Wrong list of attributes" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Unset attributes are not found
+  bool caught = false;
+  try
+    {
+    lo2->GetAttribute("SHAPE::Size");
+    }
+  catch (itk::ExceptionObject&)
+    {
+    caught = true;
+    }
+  if (!caught)
+    {
+    std::cerr << "Unset attribute should not be found" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Another label map does not share the attribute names
+  LabelObjectType::Pointer lo3 = LabelObjectType::New();
+  lo3->SetLabel(3);
+  LabelMapType::Pointer otherLabelMap = LabelMapType::New();
+  otherLabelMap->AddLabelObject(lo3);
+  AttributesTableType * otherTable = LabelObjectType::GetAttributesTable(otherLabelMap.GetPointer());
+  lo3->SetAttribute("STATS::Band1::Mean", 2.);
+  if (otherTable == table || otherTable->GetNumberOfColumns() != 1
+      || otherTable->GetColumnName(0) != "STATS::Band1::Mean"
+      || table->GetNumberOfColumns() != 2)
+    {
+    std::cerr << "Label maps should have their own attributes table" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Copies between tables go by name
+  lo3->CopyAttributesFrom(lo1);
+  if (lo3->GetAttributesTable() != otherTable || lo3->GetNumberOfAttributes() != 2
+      || lo3->GetAttribute("SHAPE::Perimeter") != 4. || lo3->HasAttribute(0))
+    {
+    std::cerr << "Wrong copy of attributes between tables" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  lo2->CopyAttributesFrom(lo1);
+  if (lo2->GetNumberOfAttributes() != 2 || lo2->GetAttribute(perimeterIndex) != 4.)
+    {
+    std::cerr << "Wrong copy of attributes" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Copies to an object out of a label map do not create a table
+  LabelObjectType::Pointer lo4 = LabelObjectType::New();
+  lo4->CopyAttributesFrom(lo1);
+  if (lo4->GetAttributesTable() != nullptr || lo4->GetNumberOfAttributes() != 2
+      || lo4->GetAttribute("SHAPE::Size") != 10.)
+    {
+    std::cerr << "Wrong copy of attributes out of a label map" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Rows released by objects leaving a table are reused
+  const unsigned int nbRows = table->GetNumberOfRows();
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    lo2->SetAttributesTable(otherTable);
+    lo2->SetAttributesTable(table);
+    }
+  lo4->SetAttributesTable(table);
+  lo4 = nullptr;
+  LabelObjectType::Pointer lo5 = LabelObjectType::New();
+  lo5->SetAttributesTable(table);
+  if (table->GetNumberOfRows() != nbRows + 1 || otherTable->GetNumberOfRows() != 2
+      || lo5->GetNumberOfAttributes() != 0 || lo2->GetAttribute(perimeterIndex) != 4.)
+    {
+    std::cerr << "Released rows should be reused" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -31,4 +31,6 @@ void RegisterTests()
   REGISTER_TEST(otbMinMaxAttributesLabelMapFilter);
   REGISTER_TEST(otbNormalizeAttributesLabelMapFilter);
   REGISTER_TEST(otbBandsStatisticsAttributesLabelMapFilter);
+  REGISTER_TEST(otbStreamingLabelImageAttributesFilter);
+  REGISTER_TEST(otbAttributesMapLabelObject);
 }
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbImage.h"
+#include "otbVectorImage.h"
+#include "otbImageFileReader.h"
+#include "otbImageToLabelMapWithAttributesFilter.h"
+#include "otbStreamingLabelImageAttributesFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+int otbStreamingLabelImageAttributesFilter(int argc, char* argv[])
+{
+  if (argc != 4)
+    {
+    std::cerr << "Usage: " << argv[0] << " image labelImage nbTiles" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const char * infname = argv[1];
+  const char * lfname  = argv[2];
+  const unsigned int nbTiles = atoi(argv[3]);
+
+  typedef otb::VectorImage<double, 2>                           ImageType;
+  typedef otb::Image<unsigned int, 2>                           LabeledImageType;
+  typedef otb::AttributesMapLabelObjectWithClassLabel<double, 2, double, double> LabelObjectType;
+
+  typedef otb::ImageToLabelMapWithAttributesFilter<ImageType,
+    LabeledImageType, unsigned int, LabelObjectType>                            LabelMapFilterType;
+  typedef otb::StreamingLabelImageAttributesFilter<LabeledImageType, ImageType> AttributesFilterType;
+  typedef otb::ImageFileReader<ImageType>                      ReaderType;
+  typedef otb::ImageFileReader<LabeledImageType>               LabeledReaderType;
+
+  ReaderType::Pointer         reader = ReaderType::New();
+  LabeledReaderType::Pointer  labeledReader = LabeledReaderType::New();
+  reader->SetFileName(infname);
+  labeledReader->SetFileName(lfname);
+
+  // Reference: attributes of the label map
+  LabelMapFilterType::Pointer labelMapFilter = LabelMapFilterType::New();
+  labelMapFilter->SetInput(reader->GetOutput());
+  labelMapFilter->SetLabeledImage(labeledReader->GetOutput());
+  labelMapFilter->Update();
+  LabelMapFilterType::LabelMapType * labelMap = labelMapFilter->GetOutput();
+
+  // Attributes computed by tiles
+  AttributesFilterType::Pointer attributesFilter = AttributesFilterType::New();
+  attributesFilter->SetInput(labeledReader->GetOutput());
+  attributesFilter->SetFeatureImage(reader->GetOutput());
+  attributesFilter->GetStreamer()->SetNumberOfDivisionsTiledStreaming(nbTiles);
+  attributesFilter->Update();
+
+  const std::vector<unsigned int> & labels = attributesFilter->GetLabels();
+  const std::vector<std::string> & names = attributesFilter->GetAttributeNames();
+
+  if (labels.size() != labelMap->GetNumberOfLabelObjects())
+    {
+    std::cerr << "Expected " << labelMap->GetNumberOfLabelObjects() << " labels, got "
+              << labels.size() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  unsigned int nbCompared = 0;
+  for (std::size_t row = 0; row < labels.size(); ++row)
+    {
+    if (!labelMap->HasLabel(labels[row]))
+      {
+      std::cerr << "Label " << labels[row] << " is not in the label map" << std::endl;
+      return EXIT_FAILURE;
+      }
+    const LabelObjectType * labelObject = labelMap->GetLabelObject(labels[row]);
+    const std::vector<std::string> available = labelObject->GetAvailableAttributes();
+
+    for (const auto & name : names)
+      {
+      if (std::find(available.begin(), available.end(), name) == available.end())
+        {
+        continue;
+        }
+      const double expected = labelObject->GetAttribute(name.c_str());
+      const double value = attributesFilter->GetAttributeColumn(name)[row];
+      if (std::isnan(expected))
+        {
+        // Variance of single pixel objects in the label map
+        continue;
+        }
+      if (std::abs(value - expected) > 1e-6 * std::max(1., std::abs(expected)))
+        {
+        std::cerr << "Label " << labels[row] << ", " << name << ": expected " << expected
+                  << ", got " << value << std::endl;
+        return EXIT_FAILURE;
+        }
+      ++nbCompared;
+      }
+    }
+
+  std::cout << nbCompared << " attribute values compared for " << labels.size() << " labels" << std::endl;
+  if (nbCompared == 0)
+    {
+    std::cerr << "No attribute in common with the label map" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
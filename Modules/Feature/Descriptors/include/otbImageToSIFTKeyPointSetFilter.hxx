@@ -139,6 +139,7 @@ ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
     m_ShrinkFilter = ShrinkFilterType::New();
     m_ShrinkFilter->SetInput(m_LastGaussian);
     m_ShrinkFilter->SetShrinkFactors(m_ShrinkFactors);
+    m_ShrinkFilter->SetNumberOfThreads(this->GetNumberOfThreads());
     m_ShrinkFilter->Update();
 
     input = m_ShrinkFilter->GetOutput();
@@ -177,6 +178,7 @@ ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
 {
   m_ExpandFilter->SetInput(this->GetInput());
   m_ExpandFilter->SetExpandFactors(m_ExpandFactors);
+  m_ExpandFilter->SetNumberOfThreads(this->GetNumberOfThreads());
   m_ExpandFilter->Update();
 
   typename InputImageType::PointType   origin0 = this->GetInput()->GetOrigin();
@@ -228,6 +230,8 @@ ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
     m_YGaussianFilter->SetSigma(ysigman);
     m_YGaussianFilter->SetDirection(1);
     m_YGaussianFilter->SetInput(m_XGaussianFilter->GetOutput());
+    m_XGaussianFilter->SetNumberOfThreads(this->GetNumberOfThreads());
+    m_YGaussianFilter->SetNumberOfThreads(this->GetNumberOfThreads());
 
     m_YGaussianFilter->Update();
 
@@ -238,6 +242,9 @@ ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
     m_GradientFilter->SetInput(m_YGaussianFilter->GetOutput());
     m_MagnitudeFilter->SetInput(m_GradientFilter->GetOutput());
     m_OrientationFilter->SetInput(m_GradientFilter->GetOutput());
+    m_GradientFilter->SetNumberOfThreads(this->GetNumberOfThreads());
+    m_MagnitudeFilter->SetNumberOfThreads(this->GetNumberOfThreads());
+    m_OrientationFilter->SetNumberOfThreads(this->GetNumberOfThreads());
 
     m_MagnitudeFilter->Update();
     m_OrientationFilter->Update();
@@ -250,6 +257,7 @@ ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
       m_SubtractFilter = SubtractFilterType::New();
       m_SubtractFilter->SetInput1(m_YGaussianFilter->GetOutput());
       m_SubtractFilter->SetInput2(previousGaussian);
+      m_SubtractFilter->SetNumberOfThreads(this->GetNumberOfThreads());
       m_SubtractFilter->Update();
       m_DoGList->PushBack(m_SubtractFilter->GetOutput());
       }
@@ -104,6 +104,7 @@ ImageToSURFKeyPointSetFilter<TInputImage, TOutputPointSet>
 
       m_ResampleFilter = ResampleFilterType::New();
       m_ResampleFilter->SetInput(this->GetInput());
+      m_ResampleFilter->SetNumberOfThreads(this->GetNumberOfThreads());
 
       SizeType size = this->GetInput()->GetLargestPossibleRegion().GetSize();
       for (int l = 0; l < 2; ++l)
@@ -147,6 +148,7 @@ ImageToSURFKeyPointSetFilter<TInputImage, TOutputPointSet>
       else m_DetHessianFilter->SetInput(m_determinantImage);
 
       m_DetHessianFilter->SetSigma(sigma_in);
+      m_DetHessianFilter->SetNumberOfThreads(this->GetNumberOfThreads());
       m_DetHessianFilter->Update();
       m_determinantImage = m_DetHessianFilter->GetOutput();
 
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbImageToTiledKeyPointSetFilter_h
+#define otbImageToTiledKeyPointSetFilter_h
+
+#include "otbImageToPointSetFilter.h"
+#include "itkRegionOfInterestImageFilter.h"
+#include "otbParallelFor.h"
+
+#include <vector>
+#include <functional>
+#include <string>
+
+namespace otb
+{
+
+/** \class ImageToTiledKeyPointSetFilter
+ *  \brief Extract key points from an image by overlapping tiles processed in parallel.
+ *
+ * Key point detectors such as ImageToSIFTKeyPointSetFilter, ImageToSURFKeyPointSetFilter
+ * or SiftFastImageFilter process their whole input image, and build its whole scale-space
+ * pyramid in memory. This filter splits the largest possible region of the input image into
+ * tiles of size TileSize, extends each tile by Margin pixels, and runs one key point detector
+ * of type TKeyPointFilter on each extended tile. The Margin has to cover the support of the
+ * detector at its coarsest octave. Tiles are read from the upstream pipeline one at a time,
+ * and up to GetNumberOfThreads() tiles are processed at the same time, which bounds the
+ * memory used to this number of tiles and their pyramids. The threads are split between
+ * the tiles processed at the same time: each detector runs with GetNumberOfThreads()
+ * divided by the number of these tiles, and at least one thread.
+ *
+ * A key point is kept only by the tile whose non-extended region contains it, so that key
+ * points found twice in overlapping margins are output once. Output key points are ordered
+ * by tile, the tiles being ordered by row.
+ *
+ * By default, the tiles cover the whole image. If TileStep is larger than TileSize, tiles are
+ * spaced by TileStep and key points are only searched on this sparse grid, which is enough for
+ * homologous points extraction on large images.
+ *
+ * The detectors are created with TKeyPointFilter::New(), and configured by the function set with
+ * SetKeyPointFilterInitializer(). Detectors relying on a global state, such as SiftFastImageFilter,
+ * must be run with a single thread.
+ *
+ * \sa ImageToSIFTKeyPointSetFilter
+ * \sa ImageToSURFKeyPointSetFilter
+ * \sa SiftFastImageFilter
+ *
+ * \ingroup OTBDescriptors
+ */
+template <class TKeyPointFilter>
+class ITK_EXPORT ImageToTiledKeyPointSetFilter
+  : public ImageToPointSetFilter<typename TKeyPointFilter::InputImageType,
+                                 typename TKeyPointFilter::OutputPointSetType>
+{
+public:
+  /** Standard typedefs */
+  typedef ImageToTiledKeyPointSetFilter                                         Self;
+  typedef ImageToPointSetFilter<typename TKeyPointFilter::InputImageType,
+                                typename TKeyPointFilter::OutputPointSetType>   Superclass;
+  typedef itk::SmartPointer<Self>                                               Pointer;
+  typedef itk::SmartPointer<const Self>                                         ConstPointer;
+
+  /** Creation through object factory macro */
+  itkNewMacro(Self);
+
+  /** Type macro */
+  itkTypeMacro(ImageToTiledKeyPointSetFilter, ImageToPointSetFilter);
+
+  /** Template parameters typedefs */
+  typedef TKeyPointFilter                          KeyPointFilterType;
+  typedef typename KeyPointFilterType::Pointer     KeyPointFilterPointerType;
+
+  typedef typename Superclass::InputImageType       InputImageType;
+  typedef typename Superclass::InputImagePointer    InputImagePointer;
+  typedef typename Superclass::InputImageRegionType InputImageRegionType;
+  typedef typename InputImageType::SizeType         SizeType;
+  typedef typename InputImageType::IndexType        IndexType;
+
+  typedef typename Superclass::OutputPointSetType OutputPointSetType;
+  typedef typename OutputPointSetType::PointType  OutputPointType;
+  typedef typename OutputPointSetType::PixelType  OutputPixelType;
+
+  typedef itk::RegionOfInterestImageFilter<InputImageType, InputImageType> ExtractFilterType;
+
+  /** Function configuring the detector of each tile */
+  typedef std::function<void(KeyPointFilterType *)> KeyPointFilterInitializerType;
+
+  /** Set/Get the size of the tiles, before the margin is added */
+  itkSetMacro(TileSize, SizeType);
+  itkGetConstReferenceMacro(TileSize, SizeType);
+
+  /** Set/Get the step between tiles. Values lower than the tile size are
+   * replaced by the tile size */
+  itkSetMacro(TileStep, SizeType);
+  itkGetConstReferenceMacro(TileStep, SizeType);
+
+  /** Set/Get the margin added around each tile */
+  itkSetMacro(Margin, unsigned int);
+  itkGetMacro(Margin, unsigned int);
+
+  /** Set the function called on the detector of each tile before its
+   * update, to set its parameters */
+  void SetKeyPointFilterInitializer(const KeyPointFilterInitializerType & initializer)
+  {
+    m_KeyPointFilterInitializer = initializer;
+    this->Modified();
+  }
+
+  /** Compute the tiles covering the largest possible region of the input.
+   * Key points are searched in the extended tiles, and kept if they fall
+   * in the corresponding tile. */
+  void ComputeTiles(std::vector<InputImageRegionType> & tiles,
+                    std::vector<InputImageRegionType> & extendedTiles) const;
+
+protected:
+  /** Constructor */
+  ImageToTiledKeyPointSetFilter();
+  /** Destructor */
+  ~ImageToTiledKeyPointSetFilter() override {}
+
+  /** Only the first tile is requested, the others are requested from
+   * GenerateData() */
+  void GenerateInputRequestedRegion() override;
+
+  /** Main computation method */
+  void GenerateData() override;
+
+  /** Create and configure the detector of a tile */
+  virtual KeyPointFilterPointerType CreateKeyPointFilter() const;
+
+  /** PrintSelf method */
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+private:
+  ImageToTiledKeyPointSetFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Key points found in a tile */
+  struct TileKeyPointsType
+  {
+    std::vector<OutputPointType> Points;
+    std::vector<OutputPixelType> Data;
+    std::string                  Error;
+  };
+
+  /** Size of the tiles */
+  SizeType m_TileSize;
+
+  /** Step between tiles */
+  SizeType m_TileStep;
+
+  /** Margin around tiles */
+  unsigned int m_Margin;
+
+  /** Configuration of the detectors */
+  KeyPointFilterInitializerType m_KeyPointFilterInitializer;
+};
+
+} // End namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbImageToTiledKeyPointSetFilter.hxx"
+#endif
+
+#endif
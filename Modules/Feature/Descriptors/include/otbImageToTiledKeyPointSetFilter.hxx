@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbImageToTiledKeyPointSetFilter_hxx
+#define otbImageToTiledKeyPointSetFilter_hxx
+
+#include "otbImageToTiledKeyPointSetFilter.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace otb
+{
+
+template <class TKeyPointFilter>
+ImageToTiledKeyPointSetFilter<TKeyPointFilter>
+::ImageToTiledKeyPointSetFilter()
+{
+  m_TileSize.Fill(1024);
+  m_TileStep.Fill(0);
+  m_Margin = 64;
+}
+
+template <class TKeyPointFilter>
+void
+ImageToTiledKeyPointSetFilter<TKeyPointFilter>
+::ComputeTiles(std::vector<InputImageRegionType> & tiles,
+               std::vector<InputImageRegionType> & extendedTiles) const
+{
+  tiles.clear();
+  extendedTiles.clear();
+
+  const InputImageType * input = dynamic_cast<const InputImageType *>(this->itk::ProcessObject::GetInput(0));
+  if (input == nullptr)
+    {
+    return;
+    }
+  const InputImageRegionType largestRegion = input->GetLargestPossibleRegion();
+
+  SizeType size, step, nbTiles;
+  for (unsigned int d = 0; d < 2; ++d)
+    {
+    size[d] = std::max<typename SizeType::SizeValueType>(m_TileSize[d], 1);
+    step[d] = std::max(m_TileStep[d], size[d]);
+    nbTiles[d] = largestRegion.GetSize()[d] == 0 ? 0 : (largestRegion.GetSize()[d] - 1) / step[d] + 1;
+    }
+
+  // Tiles are ordered by row, the first dimension varying fastest
+  const std::size_t total = nbTiles[0] * nbTiles[1];
+  for (std::size_t t = 0; t < total; ++t)
+    {
+    IndexType index = largestRegion.GetIndex();
+    index[0] += static_cast<typename IndexType::IndexValueType>((t % nbTiles[0]) * step[0]);
+    index[1] += static_cast<typename IndexType::IndexValueType>((t / nbTiles[0]) * step[1]);
+
+    InputImageRegionType tile(index, size);
+    tile.Crop(largestRegion);
+
+    InputImageRegionType extendedTile = tile;
+    extendedTile.PadByRadius(m_Margin);
+    extendedTile.Crop(largestRegion);
+
+    tiles.push_back(tile);
+    extendedTiles.push_back(extendedTile);
+    }
+}
+
+template <class TKeyPointFilter>
+void
+ImageToTiledKeyPointSetFilter<TKeyPointFilter>
+::GenerateInputRequestedRegion()
+{
+  InputImagePointer input = const_cast<InputImageType *>(this->GetInput());
+  if (input.IsNull())
+    {
+    return;
+    }
+
+  std::vector<InputImageRegionType> tiles, extendedTiles;
+  this->ComputeTiles(tiles, extendedTiles);
+
+  if (!extendedTiles.empty())
+    {
+    input->SetRequestedRegion(extendedTiles.front());
+    }
+}
+
+template <class TKeyPointFilter>
+typename ImageToTiledKeyPointSetFilter<TKeyPointFilter>
+::KeyPointFilterPointerType
+ImageToTiledKeyPointSetFilter<TKeyPointFilter>
+::CreateKeyPointFilter() const
+{
+  KeyPointFilterPointerType filter = KeyPointFilterType::New();
+  if (m_KeyPointFilterInitializer)
+    {
+    m_KeyPointFilterInitializer(filter);
+    }
+  return filter;
+}
+
+template <class TKeyPointFilter>
+void
+ImageToTiledKeyPointSetFilter<TKeyPointFilter>
+::GenerateData()
+{
+  typename Superclass::PointsContainerType * outputPoints = this->GetOutput()->GetPoints();
+  outputPoints->Initialize();
+  typename Superclass::PointDataContainerType * outputPointData = this->GetOutput()->GetPointData();
+  outputPointData->Initialize();
+
+  InputImagePointer input = const_cast<InputImageType *>(this->GetInput());
+  const InputImageRegionType largestRegion = input->GetLargestPossibleRegion();
+
+  std::vector<InputImageRegionType> tiles, extendedTiles;
+  this->ComputeTiles(tiles, extendedTiles);
+
+  // Tiles are processed by batches of at most one tile per thread, which
+  // bounds the memory used by the detectors
+  const std::size_t batchSize = std::max<std::size_t>(this->GetNumberOfThreads(), 1);
+
+  std::vector<typename InputImageType::Pointer> tileImages;
+  std::vector<KeyPointFilterPointerType>        detectors;
+  std::vector<TileKeyPointsType>                keyPoints;
+  unsigned long                                 nbOutputPoints = 0;
+
+  for (std::size_t batchStart = 0;
+       batchStart < tiles.size() && !this->GetAbortGenerateData();
+       batchStart += batchSize)
+    {
+    const std::size_t batchEnd = std::min(batchStart + batchSize, tiles.size());
+
+    // The upstream pipeline is updated sequentially. The threads are split
+    // between the tiles of the batch, so that at most GetNumberOfThreads()
+    // threads run at the same time.
+    tileImages.clear();
+    detectors.clear();
+    const itk::ThreadIdType threadsPerTile = std::max<itk::ThreadIdType>(
+      this->GetNumberOfThreads() / (batchEnd - batchStart), 1);
+    for (std::size_t t = batchStart; t < batchEnd; ++t)
+      {
+      typename ExtractFilterType::Pointer extract = ExtractFilterType::New();
+      extract->SetInput(input);
+      extract->SetRegionOfInterest(extendedTiles[t]);
+      extract->Update();
+
+      typename InputImageType::Pointer tileImage = extract->GetOutput();
+      tileImage->DisconnectPipeline();
+      tileImages.push_back(tileImage);
+
+      KeyPointFilterPointerType detector = this->CreateKeyPointFilter();
+      detector->SetInput(tileImage);
+      detector->SetNumberOfThreads(std::min(detector->GetNumberOfThreads(), threadsPerTile));
+      detectors.push_back(detector);
+      }
+
+    keyPoints.assign(batchEnd - batchStart, TileKeyPointsType());
+
+    ParallelFor(batchEnd - batchStart, this->GetNumberOfThreads(),
+      [&](std::size_t begin, std::size_t end, itk::ThreadIdType)
+      {
+      for (std::size_t k = begin; k < end; ++k)
+        {
+        const InputImageRegionType& tile = tiles[batchStart + k];
+        TileKeyPointsType&          tileKeyPoints = keyPoints[k];
+
+        // A key point belongs to the tile containing its nearest pixel.
+        // Tiles on the image border also keep the key points beyond it.
+        double lower[2], upper[2];
+        for (unsigned int d = 0; d < 2; ++d)
+          {
+          const typename IndexType::IndexValueType tileEnd = tile.GetIndex()[d] + tile.GetSize()[d];
+          const typename IndexType::IndexValueType largestEnd = largestRegion.GetIndex()[d] + largestRegion.GetSize()[d];
+          lower[d] = tile.GetIndex()[d] == largestRegion.GetIndex()[d]
+            ? -std::numeric_limits<double>::max() : tile.GetIndex()[d] - 0.5;
+          upper[d] = tileEnd == largestEnd
+            ? std::numeric_limits<double>::max() : tileEnd - 0.5;
+          }
+
+        try
+          {
+          detectors[k]->Update();
+          }
+        catch (itk::ExceptionObject & err)
+          {
+          tileKeyPoints.Error = err.GetDescription();
+          continue;
+          }
+        catch (std::exception & err)
+          {
+          tileKeyPoints.Error = err.what();
+          continue;
+          }
+
+        const OutputPointSetType * tileOutput = detectors[k]->GetOutput();
+        typename OutputPointSetType::PointsContainer::ConstIterator    pIt = tileOutput->GetPoints()->Begin();
+        typename OutputPointSetType::PointDataContainer::ConstIterator pdIt = tileOutput->GetPointData()->Begin();
+        for (; pIt != tileOutput->GetPoints()->End() && pdIt != tileOutput->GetPointData()->End(); ++pIt, ++pdIt)
+          {
+          itk::ContinuousIndex<typename OutputPointType::ValueType, 2> index;
+          input->TransformPhysicalPointToContinuousIndex(pIt.Value(), index);
+          if (index[0] >= lower[0] && index[0] < upper[0] && index[1] >= lower[1] && index[1] < upper[1])
+            {
+            tileKeyPoints.Points.push_back(pIt.Value());
+            tileKeyPoints.Data.push_back(pdIt.Value());
+            }
+          }
+
+        // Release the tile and its pyramid as soon as possible
+        detectors[k] = nullptr;
+        }
+      });
+    tileImages.clear();
+    detectors.clear();
+
+    // Copy the key points to the output, in the order of the tiles
+    for (std::size_t k = 0; k < keyPoints.size(); ++k)
+      {
+      if (!keyPoints[k].Error.empty())
+        {
+        itkExceptionMacro(<< "Key point extraction failed on tile " << extendedTiles[batchStart + k]
+                          << ": " << keyPoints[k].Error);
+        }
+      for (std::size_t i = 0; i < keyPoints[k].Points.size(); ++i)
+        {
+        outputPoints->InsertElement(nbOutputPoints, keyPoints[k].Points[i]);
+        outputPointData->InsertElement(nbOutputPoints, keyPoints[k].Data[i]);
+        ++nbOutputPoints;
+        }
+      }
+
+    this->UpdateProgress(static_cast<float>(batchEnd) / tiles.size());
+    }
+
+  itkDebugMacro(<< "Found " << nbOutputPoints << " key points in " << tiles.size() << " tiles");
+}
+
+template <class TKeyPointFilter>
+void
+ImageToTiledKeyPointSetFilter<TKeyPointFilter>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "TileSize: " << m_TileSize << std::endl;
+  os << indent << "TileStep: " << m_TileStep << std::endl;
+  os << indent << "Margin: " << m_Margin << std::endl;
+}
+
+} // End namespace otb
+
+#endif
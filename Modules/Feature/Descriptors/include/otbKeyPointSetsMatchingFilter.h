@@ -24,6 +24,11 @@
 #include "otbObjectListSource.h"
 #include "otbLandmark.h"
 #include "itkEuclideanDistanceMetric.h"
+#include "otbParallelFor.h"
+#include "itkNumericTraits.h"
+
+#include <vector>
+#include <functional>
 
 namespace otb
 {
@@ -41,6 +46,15 @@ namespace otb
  *   Matches are stored in a landmark object containing both matched points and point data. The landmark data will hold the distance value
  *   between the data.
  *
+ *   By default, the nearest neighbors are searched with an approximate index: the descriptors are copied to
+ *   contiguous arrays, and a forest of randomized k-d trees (SetNumberOfTrees()) is explored in best-bin-first order
+ *   until a given number of descriptors (SetMaximumNumberOfChecks()) has been compared. This search always uses the
+ *   Euclidean distance, and is exact when the searched point set is not larger than the maximum number of checks.
+ *   ExactSearchOn() falls back to the exhaustive search with the TDistance metric, which can be used to validate the
+ *   approximate matches. The approximate search is only available when TDistance is the default
+ *   EuclideanDistanceMetric: with any other metric, the exhaustive search is always used. In both cases, the query
+ *   points are processed by several threads.
+ *
  *   \sa Landmark
  *   \sa PointSet
  *   \sa EuclideanDistanceMetric
@@ -88,6 +102,13 @@ public:
   itkGetMacro(UseBackMatching, bool);
   itkSetMacro(DistanceThreshold, double);
   itkGetMacro(DistanceThreshold, double);
+  itkBooleanMacro(ExactSearch);
+  itkSetMacro(ExactSearch, bool);
+  itkGetMacro(ExactSearch, bool);
+  itkSetClampMacro(NumberOfTrees, unsigned int, 1, itk::NumericTraits<unsigned int>::max());
+  itkGetMacro(NumberOfTrees, unsigned int);
+  itkSetClampMacro(MaximumNumberOfChecks, unsigned int, 2, itk::NumericTraits<unsigned int>::max());
+  itkGetMacro(MaximumNumberOfChecks, unsigned int);
 
   /// Set the first pointset
   void SetInput1(const PointSetType * pointset);
@@ -119,6 +140,51 @@ private:
   KeyPointSetsMatchingFilter(const Self &) = delete;
   void operator =(const Self&) = delete;
 
+  typedef typename PointDataType::ValueType DescriptorValueType;
+
+  /** Descriptors of a point set, stored contiguously */
+  struct DescriptorSetType
+  {
+    unsigned int                     Dimension;
+    std::vector<DescriptorValueType> Values;
+    std::vector<unsigned int>        Ids;
+  };
+
+  /** Node of a k-d tree. Leaves have a negative split dimension, and hold
+   * the range [Begin, End) of the tree indices. */
+  struct KdNodeType
+  {
+    int          SplitDimension;
+    double       SplitValue;
+    unsigned int Children[2];
+    unsigned int Begin;
+    unsigned int End;
+  };
+
+  struct KdTreeType
+  {
+    std::vector<KdNodeType>   Nodes;
+    std::vector<unsigned int> Indices;
+  };
+
+  typedef std::vector<KdTreeType> KdForestType;
+
+  /** Copy the point data of a point set to contiguous arrays */
+  void FillDescriptorSet(const PointSetType * pointset, DescriptorSetType & descriptors) const;
+
+  /** Build the randomized k-d trees indexing a descriptor set */
+  void BuildForest(const DescriptorSetType & descriptors, KdForestType & forest) const;
+
+  /**
+   * Find the (approximate) nearest neighbor of query in descriptors.
+   * \return a pair of (position in descriptors, distance ratio).
+   */
+  NeighborSearchResultType ApproximateNearestNeighbor(const DescriptorValueType * query,
+                                                      const DescriptorSetType & descriptors,
+                                                      const KdForestType & forest,
+                                                      std::vector<unsigned int> & visitStamps,
+                                                      unsigned int stamp) const;
+
   // Find back matches from 2 to 1 to validate them
   bool m_UseBackMatching;
 
@@ -127,6 +193,15 @@ private:
 
   // Distance calculator
   DistancePointerType m_DistanceCalculator;
+
+  // Use the exhaustive search instead of the k-d trees
+  bool m_ExactSearch;
+
+  // Number of randomized k-d trees
+  unsigned int m_NumberOfTrees;
+
+  // Maximum number of descriptors compared by an approximate search
+  unsigned int m_MaximumNumberOfChecks;
 };
 
 } // end namespace otb
@@ -23,6 +23,14 @@
 
 #include "otbKeyPointSetsMatchingFilter.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <type_traits>
+
 namespace otb
 {
 
@@ -35,6 +43,9 @@ KeyPointSetsMatchingFilter<TPointSet, TDistance>
   m_DistanceThreshold = 0.6;
   // Object used to measure distance
   m_DistanceCalculator = DistanceType::New();
+  m_ExactSearch = false;
+  m_NumberOfTrees = 4;
+  m_MaximumNumberOfChecks = 256;
 }
 
 template <class TPointSet, class TDistance>
@@ -91,60 +102,126 @@ KeyPointSetsMatchingFilter<TPointSet, TDistance>
   // Get the output pointer
   LandmarkListPointerType landmarks = this->GetOutput();
 
-  // Define iterators on points and point data.
-  PointsIteratorType    pIt  = ps1->GetPoints()->Begin();
-  PointDataIteratorType pdIt = ps1->GetPointData()->Begin();
+  const std::size_t nbPoints1 = ps1->GetNumberOfPoints();
 
-  // iterate on pointset 1
-  while (pdIt != ps1->GetPointData()->End()
-         && pIt != ps1->GetPoints()->End())
+  // Forward and backward search results, computed in parallel and in the
+  // order of pointset 1. The back search is only done for points passing
+  // the distance threshold.
+  std::vector<NeighborSearchResultType> forward(nbPoints1);
+  std::vector<unsigned int>             backward(nbPoints1, 0);
+
+  // The k-d trees assume the Euclidean distance: other metrics are always
+  // searched exhaustively
+  const bool euclideanDistance =
+    std::is_same<DistanceType, itk::Statistics::EuclideanDistanceMetric<PointDataType> >::value;
+
+  if (m_ExactSearch || !euclideanDistance)
     {
-    // Get point and point data at current location
-    bool          matchFound = false;
-    unsigned int  currentIndex = pIt.Index();
-    PointDataType data = pdIt.Value();
-    PointType     point = pIt.Value();
+    std::vector<const PointDataType *> data1;
+    data1.reserve(nbPoints1);
+    for (PointDataIteratorType it = ps1->GetPointData()->Begin(); it != ps1->GetPointData()->End(); ++it)
+      {
+      data1.push_back(&it.Value());
+      }
+    forward.resize(data1.size());
+    backward.resize(data1.size());
 
-    // These variables will hold the matched point and point data
-    PointDataType dataMatch;
-    PointType     pointMatch;
+    ParallelFor(data1.size(), this->GetNumberOfThreads(),
+      [this, &data1, &forward, &backward, ps1, ps2](std::size_t begin, std::size_t end, itk::ThreadIdType)
+      {
+      for (std::size_t i = begin; i < end; ++i)
+        {
+        forward[i] = this->NearestNeighbor(*data1[i], ps2);
+        if (m_UseBackMatching && forward[i].second < m_DistanceThreshold)
+          {
+          backward[i] = this->NearestNeighbor(ps2->GetPointData()->GetElement(forward[i].first), ps1).first;
+          }
+        }
+      });
+    }
+  else
+    {
+    DescriptorSetType descriptors1, descriptors2;
+    this->FillDescriptorSet(ps1, descriptors1);
+    this->FillDescriptorSet(ps2, descriptors2);
 
-    // call to the matching routine
-    NeighborSearchResultType searchResult1 = NearestNeighbor(data, ps2);
+    if (descriptors1.Dimension != descriptors2.Dimension)
+      {
+      itkExceptionMacro(<< "Point data of both pointsets must have the same size (" << descriptors1.Dimension
+                        << " != " << descriptors2.Dimension << ")");
+      }
+    forward.resize(descriptors1.Ids.size());
+    backward.resize(descriptors1.Ids.size());
 
-    // Check if the neighbor distance is lower than the threshold
-    if (searchResult1.second < m_DistanceThreshold)
+    KdForestType forest1, forest2;
+    this->BuildForest(descriptors2, forest2);
+    if (m_UseBackMatching)
       {
-      // Get the matched point and point data
-      dataMatch = ps2->GetPointData()->GetElement(searchResult1.first);
-      pointMatch = ps2->GetPoints()->GetElement(searchResult1.first);
+      this->BuildForest(descriptors1, forest1);
+      }
 
-      // If the back matching option is on
+    ParallelFor(descriptors1.Ids.size(), this->GetNumberOfThreads(),
+      [this, &descriptors1, &descriptors2, &forest1, &forest2, &forward, &backward]
+      (std::size_t begin, std::size_t end, itk::ThreadIdType)
+      {
+      // Visit stamps avoid comparing a descriptor twice when it is reached
+      // from several trees, the stamp is unique for each query
+      std::vector<unsigned int> visit1, visit2(descriptors2.Ids.size(), 0);
       if (m_UseBackMatching)
         {
-        // Peform the back search
-        NeighborSearchResultType searchResult2 = NearestNeighbor(dataMatch, ps1);
-
-        // Test if back search finds the same match
-        if (currentIndex == searchResult2.first)
-          {
-          matchFound = true;
-          }
+        visit1.assign(descriptors1.Ids.size(), 0);
         }
-      else // else back matching
+      const unsigned int dim = descriptors1.Dimension;
+      for (std::size_t i = begin; i < end; ++i)
         {
-        matchFound = true;
+        const unsigned int stamp = static_cast<unsigned int>(i + 1);
+        NeighborSearchResultType result = this->ApproximateNearestNeighbor(
+          descriptors1.Values.data() + i * dim, descriptors2, forest2, visit2, stamp);
+        const unsigned int position2 = result.first;
+        result.first = descriptors2.Ids[position2];
+        forward[i] = result;
+
+        if (m_UseBackMatching && result.second < m_DistanceThreshold)
+          {
+          const NeighborSearchResultType back = this->ApproximateNearestNeighbor(
+            descriptors2.Values.data() + static_cast<std::size_t>(position2) * dim, descriptors1, forest1, visit1, stamp);
+          backward[i] = descriptors1.Ids[back.first];
+          }
         }
+      });
+    }
+
+  // Define iterators on points and point data.
+  PointsIteratorType    pIt  = ps1->GetPoints()->Begin();
+  PointDataIteratorType pdIt = ps1->GetPointData()->Begin();
+  std::size_t           position = 0;
+
+  // iterate on pointset 1
+  while (pdIt != ps1->GetPointData()->End()
+         && pIt != ps1->GetPoints()->End()
+         && position < forward.size())
+    {
+    // Get the search result of the current point
+    bool                           matchFound = false;
+    unsigned int                   currentIndex = pIt.Index();
+    const NeighborSearchResultType searchResult1 = forward[position];
+
+    // Check if the neighbor distance is lower than the threshold
+    if (searchResult1.second < m_DistanceThreshold)
+      {
+      // If the back matching option is on, test if back search finds the
+      // same match
+      matchFound = !m_UseBackMatching || backward[position] == currentIndex;
       }
 
     // If we found a match, add the proper landmark
     if (matchFound)
       {
       LandmarkPointerType landmark = LandmarkType::New();
-      landmark->SetPoint1(point);
-      landmark->SetPointData1(data);
-      landmark->SetPoint2(pointMatch);
-      landmark->SetPointData2(dataMatch);
+      landmark->SetPoint1(pIt.Value());
+      landmark->SetPointData1(pdIt.Value());
+      landmark->SetPoint2(ps2->GetPoints()->GetElement(searchResult1.first));
+      landmark->SetPointData2(ps2->GetPointData()->GetElement(searchResult1.first));
       landmark->SetLandmarkData(searchResult1.second);
 
       // Add the new landmark to the landmark list
@@ -152,6 +229,7 @@ KeyPointSetsMatchingFilter<TPointSet, TDistance>
       }
     ++pdIt;
     ++pIt;
+    ++position;
     }
 }
 
@@ -229,6 +307,283 @@ KeyPointSetsMatchingFilter<TPointSet, TDistance>
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "UseBackMatching: " << m_UseBackMatching << std::endl;
+  os << indent << "DistanceThreshold: " << m_DistanceThreshold << std::endl;
+  os << indent << "ExactSearch: " << m_ExactSearch << std::endl;
+  os << indent << "NumberOfTrees: " << m_NumberOfTrees << std::endl;
+  os << indent << "MaximumNumberOfChecks: " << m_MaximumNumberOfChecks << std::endl;
+}
+
+template <class TPointSet, class TDistance>
+void
+KeyPointSetsMatchingFilter<TPointSet, TDistance>
+::FillDescriptorSet(const PointSetType * pointset, DescriptorSetType & descriptors) const
+{
+  descriptors.Dimension = 0;
+  descriptors.Values.clear();
+  descriptors.Ids.clear();
+
+  PointDataIteratorType it = pointset->GetPointData()->Begin();
+  if (it != pointset->GetPointData()->End())
+    {
+    descriptors.Dimension = it.Value().Size();
+    }
+  descriptors.Values.reserve(static_cast<std::size_t>(descriptors.Dimension) * pointset->GetPointData()->Size());
+  descriptors.Ids.reserve(pointset->GetPointData()->Size());
+
+  for (; it != pointset->GetPointData()->End(); ++it)
+    {
+    const PointDataType& data = it.Value();
+    if (data.Size() != descriptors.Dimension)
+      {
+      itkExceptionMacro(<< "Point data " << it.Index() << " has size " << data.Size() << ", expected "
+                        << descriptors.Dimension);
+      }
+    for (unsigned int k = 0; k < descriptors.Dimension; ++k)
+      {
+      descriptors.Values.push_back(data[k]);
+      }
+    descriptors.Ids.push_back(it.Index());
+    }
+}
+
+template <class TPointSet, class TDistance>
+void
+KeyPointSetsMatchingFilter<TPointSet, TDistance>
+::BuildForest(const DescriptorSetType & descriptors, KdForestType & forest) const
+{
+  // Number of descriptors per leaf, number of descriptors used to estimate
+  // the split dimension, and number of candidate split dimensions
+  const std::size_t leafSize = 8;
+  const std::size_t sampleSize = 128;
+  const std::size_t nbCandidates = 5;
+
+  const std::size_t nbDescriptors = descriptors.Ids.size();
+  const unsigned int dim = descriptors.Dimension;
+
+  forest.clear();
+  // Small sets are scanned exhaustively, no need to index them
+  if (nbDescriptors <= m_MaximumNumberOfChecks || dim == 0)
+    {
+    return;
+    }
+  forest.resize(m_NumberOfTrees);
+
+  std::vector<double>       mean(dim), variance(dim);
+  std::vector<unsigned int> dimensions(dim);
+
+  for (unsigned int t = 0; t < m_NumberOfTrees; ++t)
+    {
+    // Each tree has its own deterministic random sequence
+    std::mt19937 generator(t + 1);
+    KdTreeType&  tree = forest[t];
+    tree.Indices.resize(nbDescriptors);
+    std::iota(tree.Indices.begin(), tree.Indices.end(), 0u);
+
+    KdNodeType root;
+    root.SplitDimension = -1;
+    root.SplitValue = 0;
+    root.Children[0] = root.Children[1] = 0;
+    root.Begin = 0;
+    root.End = static_cast<unsigned int>(nbDescriptors);
+    tree.Nodes.push_back(root);
+
+    std::vector<unsigned int> pending(1, 0);
+    while (!pending.empty())
+      {
+      const unsigned int nodeId = pending.back();
+      pending.pop_back();
+      const unsigned int begin = tree.Nodes[nodeId].Begin;
+      const unsigned int end = tree.Nodes[nodeId].End;
+      if (end - begin <= leafSize)
+        {
+        continue;
+        }
+
+      // Estimate the mean and variance of each dimension on a sample
+      const std::size_t nbSamples = std::min<std::size_t>(sampleSize, end - begin);
+      const std::size_t step = (end - begin) / nbSamples;
+      std::fill(mean.begin(), mean.end(), 0.);
+      std::fill(variance.begin(), variance.end(), 0.);
+      for (std::size_t s = 0; s < nbSamples; ++s)
+        {
+        const DescriptorValueType * values = &descriptors.Values[static_cast<std::size_t>(tree.Indices[begin + s * step]) * dim];
+        for (unsigned int k = 0; k < dim; ++k)
+          {
+          mean[k] += values[k];
+          variance[k] += static_cast<double>(values[k]) * values[k];
+          }
+        }
+      for (unsigned int k = 0; k < dim; ++k)
+        {
+        mean[k] /= nbSamples;
+        variance[k] = variance[k] / nbSamples - mean[k] * mean[k];
+        }
+
+      // Randomly pick the split dimension among the ones of highest variance
+      std::iota(dimensions.begin(), dimensions.end(), 0u);
+      const std::size_t nbTop = std::min<std::size_t>(nbCandidates, dim);
+      std::partial_sort(dimensions.begin(), dimensions.begin() + nbTop, dimensions.end(),
+                        [&variance](unsigned int a, unsigned int b) { return variance[a] > variance[b]; });
+      const unsigned int splitDim = dimensions[std::uniform_int_distribution<std::size_t>(0, nbTop - 1)(generator)];
+
+      auto value = [&descriptors, dim, splitDim](unsigned int index)
+        {
+        return static_cast<double>(descriptors.Values[static_cast<std::size_t>(index) * dim + splitDim]);
+        };
+
+      // Split at the mean, or at the median if all values fall on one side
+      double       splitValue = mean[splitDim];
+      unsigned int middle = static_cast<unsigned int>(
+        std::partition(tree.Indices.begin() + begin, tree.Indices.begin() + end,
+                       [&value, splitValue](unsigned int index) { return value(index) < splitValue; })
+        - tree.Indices.begin());
+      if (middle == begin || middle == end)
+        {
+        middle = begin + (end - begin) / 2;
+        std::nth_element(tree.Indices.begin() + begin, tree.Indices.begin() + middle, tree.Indices.begin() + end,
+                         [&value](unsigned int a, unsigned int b) { return value(a) < value(b); });
+        splitValue = value(tree.Indices[middle]);
+        }
+
+      KdNodeType child;
+      child.SplitDimension = -1;
+      child.SplitValue = 0;
+      child.Children[0] = child.Children[1] = 0;
+      child.Begin = begin;
+      child.End = middle;
+      tree.Nodes.push_back(child);
+      child.Begin = middle;
+      child.End = end;
+      tree.Nodes.push_back(child);
+
+      KdNodeType& node = tree.Nodes[nodeId];
+      node.SplitDimension = static_cast<int>(splitDim);
+      node.SplitValue = splitValue;
+      node.Children[0] = static_cast<unsigned int>(tree.Nodes.size() - 2);
+      node.Children[1] = static_cast<unsigned int>(tree.Nodes.size() - 1);
+      pending.push_back(node.Children[0]);
+      pending.push_back(node.Children[1]);
+      }
+    }
+}
+
+template <class TPointSet, class TDistance>
+typename KeyPointSetsMatchingFilter<TPointSet, TDistance>::NeighborSearchResultType
+KeyPointSetsMatchingFilter<TPointSet, TDistance>
+::ApproximateNearestNeighbor(const DescriptorValueType * query,
+                             const DescriptorSetType & descriptors,
+                             const KdForestType & forest,
+                             std::vector<unsigned int> & visitStamps,
+                             unsigned int stamp) const
+{
+  const unsigned int dim = descriptors.Dimension;
+
+  // Squared distances and position of the two nearest neighbors. Ties are
+  // resolved towards the first descriptor, as in the exhaustive search.
+  double       nearestDistance = std::numeric_limits<double>::max();
+  double       secondNearestDistance = std::numeric_limits<double>::max();
+  unsigned int nearestPosition = 0;
+  unsigned int nbChecks = 0;
+
+  auto check = [&](unsigned int position)
+    {
+    const DescriptorValueType * values = &descriptors.Values[static_cast<std::size_t>(position) * dim];
+    double distance = 0;
+    for (unsigned int k = 0; k < dim; ++k)
+      {
+      const double diff = static_cast<double>(query[k]) - values[k];
+      distance += diff * diff;
+      }
+    ++nbChecks;
+    if (distance < nearestDistance || (distance == nearestDistance && position < nearestPosition))
+      {
+      secondNearestDistance = nearestDistance;
+      nearestDistance = distance;
+      nearestPosition = position;
+      }
+    else if (distance < secondNearestDistance)
+      {
+      secondNearestDistance = distance;
+      }
+    };
+
+  if (forest.empty())
+    {
+    for (unsigned int position = 0; position < descriptors.Ids.size(); ++position)
+      {
+      check(position);
+      }
+    }
+  else
+    {
+    // Best-bin-first exploration: branches not taken are queued with a lower
+    // bound of their distance to the query, shared by all the trees
+    struct BranchType
+    {
+      double       Bound;
+      unsigned int Tree;
+      unsigned int Node;
+      bool operator<(const BranchType& other) const
+      {
+        return Bound > other.Bound;
+      }
+    };
+    std::priority_queue<BranchType> branches;
+
+    auto descend = [&](unsigned int treeId, unsigned int nodeId, double bound)
+      {
+      const KdTreeType& tree = forest[treeId];
+      while (tree.Nodes[nodeId].SplitDimension >= 0)
+        {
+        const KdNodeType& node = tree.Nodes[nodeId];
+        const double diff = static_cast<double>(query[node.SplitDimension]) - node.SplitValue;
+        const unsigned int nearChild = diff < 0 ? node.Children[0] : node.Children[1];
+        const unsigned int farChild = diff < 0 ? node.Children[1] : node.Children[0];
+        branches.push(BranchType{bound + diff * diff, treeId, farChild});
+        nodeId = nearChild;
+        }
+      const KdNodeType& leaf = tree.Nodes[nodeId];
+      for (unsigned int i = leaf.Begin; i < leaf.End; ++i)
+        {
+        const unsigned int position = tree.Indices[i];
+        if (visitStamps[position] != stamp)
+          {
+          visitStamps[position] = stamp;
+          check(position);
+          }
+        }
+      };
+
+    for (unsigned int t = 0; t < forest.size(); ++t)
+      {
+      descend(t, 0, 0.);
+      }
+    while (!branches.empty() && nbChecks < m_MaximumNumberOfChecks)
+      {
+      const BranchType branch = branches.top();
+      branches.pop();
+      // No remaining branch can improve the two nearest neighbors
+      if (branch.Bound >= secondNearestDistance)
+        {
+        break;
+        }
+      descend(branch.Tree, branch.Node, branch.Bound);
+      }
+    }
+
+  // Fill results, the ratio is computed on the distances
+  NeighborSearchResultType result;
+  result.first = nearestPosition;
+  if (secondNearestDistance == 0 || secondNearestDistance == std::numeric_limits<double>::max())
+    {
+    result.second = 1;
+    }
+  else
+    {
+    result.second = std::sqrt(nearestDistance / secondNearestDistance);
+    }
+  return result;
 }
 
 } // end namespace otb
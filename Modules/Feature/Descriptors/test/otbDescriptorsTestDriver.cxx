@@ -27,6 +27,8 @@ void RegisterTests()
   REGISTER_TEST(otbHistogramOfOrientedGradientCovariantImageFunction);
   REGISTER_TEST(otbImageToSURFKeyPointSetFilterOutputInterestPointAscii);
   REGISTER_TEST(otbKeyPointSetsMatchingFilter);
+  REGISTER_TEST(otbKeyPointSetsMatchingFilterApproximateSearch);
+  REGISTER_TEST(otbImageToTiledKeyPointSetFilter);
   REGISTER_TEST(otbImageToSIFTKeyPointSetFilterOutputDescriptorAscii);
   REGISTER_TEST(otbImageToSIFTKeyPointSetFilterOutputAscii);
   REGISTER_TEST(otbFourierMellinImageFilter);
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "otbImageToTiledKeyPointSetFilter.h"
+#include "otbImageToSURFKeyPointSetFilter.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "itkVariableLengthVector.h"
+#include "itkPointSet.h"
+
+int otbImageToTiledKeyPointSetFilter(int itkNotUsed(argc), char * argv[])
+{
+  const char *       infname = argv[1];
+  const unsigned int octaves = atoi(argv[2]);
+  const unsigned int scales = atoi(argv[3]);
+  const unsigned int tileSize = atoi(argv[4]);
+  const unsigned int tileStep = atoi(argv[5]);
+  const unsigned int margin = atoi(argv[6]);
+
+  typedef float RealType;
+  const unsigned int Dimension = 2;
+
+  typedef otb::Image<RealType, Dimension>                                    ImageType;
+  typedef itk::VariableLengthVector<RealType>                                RealVectorType;
+  typedef otb::ImageFileReader<ImageType>                                    ReaderType;
+  typedef itk::PointSet<RealVectorType, Dimension>                           PointSetType;
+  typedef otb::ImageToSURFKeyPointSetFilter<ImageType, PointSetType>         SURFFilterType;
+  typedef otb::ImageToTiledKeyPointSetFilter<SURFFilterType>                 TiledFilterType;
+  typedef TiledFilterType::InputImageRegionType                              RegionType;
+  typedef PointSetType::PointsContainer::ConstIterator                       PointsIteratorType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(infname);
+  reader->UpdateOutputInformation();
+  ImageType * image = reader->GetOutput();
+  const RegionType largestRegion = image->GetLargestPossibleRegion();
+
+  // Key points of the whole image
+  SURFFilterType::Pointer filter = SURFFilterType::New();
+  filter->SetInput(image);
+  filter->SetOctavesNumber(octaves);
+  filter->SetScalesNumber(scales);
+  filter->Update();
+
+  // Key points extracted by tiles
+  TiledFilterType::Pointer tiledFilter = TiledFilterType::New();
+  TiledFilterType::SizeType size, step;
+  size.Fill(tileSize);
+  step.Fill(tileStep);
+  tiledFilter->SetInput(image);
+  tiledFilter->SetTileSize(size);
+  tiledFilter->SetTileStep(step);
+  tiledFilter->SetMargin(margin);
+  tiledFilter->SetKeyPointFilterInitializer([octaves, scales](SURFFilterType * detector)
+    {
+    detector->SetOctavesNumber(octaves);
+    detector->SetScalesNumber(scales);
+    });
+  tiledFilter->Update();
+
+  std::vector<RegionType> tiles, extendedTiles;
+  tiledFilter->ComputeTiles(tiles, extendedTiles);
+
+  // Check if a key point falls in one of the tiles
+  auto isInTiles = [&](const PointSetType::PointType & point)
+    {
+    ImageType::IndexType index;
+    image->TransformPhysicalPointToIndex(point, index);
+    for (unsigned int d = 0; d < Dimension; ++d)
+      {
+      index[d] = std::max(index[d], largestRegion.GetIndex()[d]);
+      index[d] = std::min(index[d], largestRegion.GetIndex()[d] + static_cast<ImageType::IndexValueType>(largestRegion.GetSize()[d]) - 1);
+      }
+    for (std::vector<RegionType>::const_iterator it = tiles.begin(); it != tiles.end(); ++it)
+      {
+      if (it->IsInside(index))
+        {
+        return true;
+        }
+      }
+    return false;
+    };
+
+  const PointSetType * reference = filter->GetOutput();
+  const PointSetType * tiled = tiledFilter->GetOutput();
+
+  unsigned int nbReference = 0;
+  unsigned int nbFound = 0;
+  for (PointsIteratorType it = reference->GetPoints()->Begin(); it != reference->GetPoints()->End(); ++it)
+    {
+    if (!isInTiles(it.Value()))
+      {
+      continue;
+      }
+    ++nbReference;
+    for (PointsIteratorType tIt = tiled->GetPoints()->Begin(); tIt != tiled->GetPoints()->End(); ++tIt)
+      {
+      if (it.Value().EuclideanDistanceTo(tIt.Value()) < 1e-3)
+        {
+        ++nbFound;
+        break;
+        }
+      }
+    }
+
+  // Key points of the overlaps must be output once, and only inside tiles
+  unsigned int nbDuplicates = 0;
+  unsigned int nbOutside = 0;
+  for (PointsIteratorType it = tiled->GetPoints()->Begin(); it != tiled->GetPoints()->End(); ++it)
+    {
+    if (!isInTiles(it.Value()))
+      {
+      ++nbOutside;
+      }
+    PointsIteratorType next = it;
+    for (++next; next != tiled->GetPoints()->End(); ++next)
+      {
+      if (it.Value().EuclideanDistanceTo(next.Value()) < 1e-6)
+        {
+        ++nbDuplicates;
+        }
+      }
+    }
+
+  std::cout << tiles.size() << " tiles, reference key points: " << nbReference << ", tiled key points: "
+            << tiled->GetNumberOfPoints() << ", found: " << nbFound << ", duplicates: " << nbDuplicates
+            << ", outside tiles: " << nbOutside << std::endl;
+
+  if (nbReference == 0 || nbFound < 0.9 * nbReference || tiled->GetNumberOfPoints() > 1.1 * nbReference)
+    {
+    std::cerr << "Tiled key points differ from the key points of the whole image." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (nbDuplicates != 0 || nbOutside != 0)
+    {
+    std::cerr << "Key points are duplicated or outside tiles." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -24,9 +24,11 @@
 
 #include "itkVariableLengthVector.h"
 #include "itkPointSet.h"
+#include "itkManhattanDistanceMetric.h"
 
 #include <iostream>
 #include <fstream>
+#include <random>
 
 int otbKeyPointSetsMatchingFilter(int itkNotUsed(argc), char* argv[])
 {
@@ -106,3 +108,129 @@ int otbKeyPointSetsMatchingFilter(int itkNotUsed(argc), char* argv[])
 
   return EXIT_SUCCESS;
 }
+
+int otbKeyPointSetsMatchingFilterApproximateSearch(int itkNotUsed(argc), char* argv[])
+{
+  const unsigned int nbPoints        = atoi(argv[1]);
+  const unsigned int dimension       = atoi(argv[2]);
+  const bool         useBackMatching = atoi(argv[3]);
+
+  typedef itk::VariableLengthVector<float>              PointDataType;
+  typedef itk::PointSet<PointDataType, 2>               PointSetType;
+  typedef PointSetType::PointType                       PointType;
+  typedef otb::KeyPointSetsMatchingFilter<PointSetType> MatchingFilterType;
+  typedef MatchingFilterType::LandmarkListType          LandmarkListType;
+
+  // Random descriptors in pointset 2. Half of the descriptors of pointset 1
+  // are noisy copies of them, the other half are unrelated.
+  std::mt19937                    generator(42);
+  std::normal_distribution<float> normal(0, 1);
+
+  PointSetType::Pointer ps1 = PointSetType::New();
+  PointSetType::Pointer ps2 = PointSetType::New();
+
+  for (unsigned int i = 0; i < nbPoints; ++i)
+    {
+    PointType point;
+    point[0] = i;
+    point[1] = 0;
+    PointDataType data2(dimension), data1(dimension);
+    for (unsigned int k = 0; k < dimension; ++k)
+      {
+      data2[k] = normal(generator);
+      }
+    for (unsigned int k = 0; k < dimension; ++k)
+      {
+      data1[k] = (i % 2 == 0) ? data2[k] + 0.2f * normal(generator) : normal(generator);
+      }
+    ps1->SetPoint(i, point);
+    ps1->SetPointData(i, data1);
+    ps2->SetPoint(i, point);
+    ps2->SetPointData(i, data2);
+    }
+
+  MatchingFilterType::Pointer exactFilter = MatchingFilterType::New();
+  exactFilter->SetInput1(ps1);
+  exactFilter->SetInput2(ps2);
+  exactFilter->SetUseBackMatching(useBackMatching);
+  exactFilter->ExactSearchOn();
+  exactFilter->Update();
+
+  MatchingFilterType::Pointer approximateFilter = MatchingFilterType::New();
+  approximateFilter->SetInput1(ps1);
+  approximateFilter->SetInput2(ps2);
+  approximateFilter->SetUseBackMatching(useBackMatching);
+  approximateFilter->Update();
+
+  // Both filters output landmarks in the order of pointset 1, the point
+  // coordinates identify the matched descriptors
+  LandmarkListType * exactMatches = exactFilter->GetOutput();
+  LandmarkListType * approximateMatches = approximateFilter->GetOutput();
+
+  unsigned int nbFound = 0;
+  LandmarkListType::Iterator approximateIt = approximateMatches->Begin();
+  for (LandmarkListType::Iterator exactIt = exactMatches->Begin(); exactIt != exactMatches->End(); ++exactIt)
+    {
+    while (approximateIt != approximateMatches->End()
+           && approximateIt.Get()->GetPoint1()[0] < exactIt.Get()->GetPoint1()[0])
+      {
+      ++approximateIt;
+      }
+    if (approximateIt != approximateMatches->End()
+        && approximateIt.Get()->GetPoint1() == exactIt.Get()->GetPoint1()
+        && approximateIt.Get()->GetPoint2() == exactIt.Get()->GetPoint2())
+      {
+      ++nbFound;
+      }
+    }
+
+  std::cout << "Exact matches: " << exactMatches->Size() << ", approximate matches: " << approximateMatches->Size()
+            << ", found by both: " << nbFound << std::endl;
+
+  if (exactMatches->Size() < nbPoints / 4)
+    {
+    std::cerr << "Too few exact matches: " << exactMatches->Size() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (nbFound < 0.95 * exactMatches->Size() || approximateMatches->Size() > 1.05 * exactMatches->Size())
+    {
+    std::cerr << "Approximate matches differ from exact matches." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The k-d trees only support the Euclidean distance: with another metric,
+  // the default search must be the exact one
+  typedef itk::Statistics::ManhattanDistanceMetric<PointDataType>            ManhattanDistanceType;
+  typedef otb::KeyPointSetsMatchingFilter<PointSetType, ManhattanDistanceType> ManhattanFilterType;
+
+  ManhattanFilterType::Pointer manhattanFilter = ManhattanFilterType::New();
+  manhattanFilter->SetInput1(ps1);
+  manhattanFilter->SetInput2(ps2);
+  manhattanFilter->SetUseBackMatching(useBackMatching);
+  manhattanFilter->Update();
+
+  ManhattanFilterType::Pointer manhattanExactFilter = ManhattanFilterType::New();
+  manhattanExactFilter->SetInput1(ps1);
+  manhattanExactFilter->SetInput2(ps2);
+  manhattanExactFilter->SetUseBackMatching(useBackMatching);
+  manhattanExactFilter->ExactSearchOn();
+  manhattanExactFilter->Update();
+
+  ManhattanFilterType::LandmarkListType * manhattanMatches = manhattanFilter->GetOutput();
+  ManhattanFilterType::LandmarkListType * manhattanExactMatches = manhattanExactFilter->GetOutput();
+
+  bool sameManhattanMatches = manhattanMatches->Size() == manhattanExactMatches->Size();
+  for (unsigned int i = 0; sameManhattanMatches && i < manhattanMatches->Size(); ++i)
+    {
+    sameManhattanMatches = manhattanMatches->GetNthElement(i)->GetPoint1() == manhattanExactMatches->GetNthElement(i)->GetPoint1()
+                           && manhattanMatches->GetNthElement(i)->GetPoint2() == manhattanExactMatches->GetNthElement(i)->GetPoint2();
+    }
+  if (!sameManhattanMatches)
+    {
+    std::cerr << "The search with a non Euclidean metric is not exact." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
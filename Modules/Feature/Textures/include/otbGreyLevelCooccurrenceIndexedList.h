@@ -117,8 +117,10 @@ public:
   /** Get the total frequency of Co-occurrence pairs. */
   itkGetMacro(Symmetry, bool);
 
-  /** Get std::vector containing non-zero co-occurrence pairs */
-  VectorType GetVector();
+  /** Get std::vector containing co-occurrence pairs. After calls to
+    * RemovePixelPair(), it may contain pairs with a zero frequency until
+    * SortPairs() or Clear() is called. */
+  const VectorType & GetVector() const;
 
   /** Initialize the lowerbound and upper bound vecotor, Fill m_LookupArray with
     * -1 and set m_TotalFrequency to zero */
@@ -129,6 +131,28 @@ public:
   //m_InputImageMaximum. If so add to m_Vector via AddPairToVector method */
   void AddPixelPair(const PixelValueType& pixelvalue1, const PixelValueType& pixelvalue2);
 
+  /** Remove a pixel pair previously added with AddPixelPair. Pairs whose
+    * frequency drops to zero stay in m_Vector until SortPairs() or Clear()
+    * is called. This allows to update the list when a neighborhood window
+    * slides over the image. */
+  void RemovePixelPair(const PixelValueType& pixelvalue1, const PixelValueType& pixelvalue2);
+
+  /** Sort the co-occurrence pairs by bin index and drop the pairs whose
+    * frequency is zero. Features summed over the sorted list do not depend
+    * on the order in which pairs were added and removed. Only the pairs
+    * added since the previous call are sorted, then merged with the
+    * others. */
+  void SortPairs();
+
+  /** Remove all co-occurrence pairs while keeping the bins set by
+    * Initialize. Only the entries of m_LookupArray in use are reset. */
+  void Clear();
+
+  /** Get the bin of a pixel value. Returns false if the value is out of
+    * [m_InputImageMinimum, m_InputImageMaximum]. This allows to quantize an
+    * image once when it is used for several co-occurrence lists. */
+  bool GetPixelBin(const PixelValueType& pixelvalue, IndexValueType& bin) const;
+
   /* Get the frequency value from Vector with index =[j,i] */
   RelativeFrequencyType GetFrequency(IndexValueType i, IndexValueType j);
 
@@ -146,6 +170,10 @@ protected:
     * co-occurrence pair is added again with index values swapped */
   void AddPairToVector(IndexType index);
 
+  /** Decrement the frequency of the co-occurrence pair with given index. The
+    * pair stays in m_Vector when its frequency reaches zero. */
+  void RemovePairFromVector(IndexType index);
+
   void SetBinMin(const unsigned int dimension, const InstanceIdentifier nbin,
                  PixelValueType min);
 
@@ -168,6 +196,9 @@ private:
   /* std::vector holding actual co-occurrence pairs */
   VectorType m_Vector;
 
+  /* Number of pairs at the beginning of m_Vector sorted by SortPairs() */
+  std::size_t m_NumberOfSortedPairs;
+
   /* Size instance */
   SizeType m_Size;
 
@@ -23,12 +23,14 @@
 #define otbGreyLevelCooccurrenceIndexedList_hxx
 
 #include "otbGreyLevelCooccurrenceIndexedList.h"
+#include <algorithm>
 
 namespace otb
 {
 template <class TPixel>
 GreyLevelCooccurrenceIndexedList<TPixel>::
 GreyLevelCooccurrenceIndexedList():
+m_NumberOfSortedPairs(0),
 m_Size(),
 m_Symmetry(true),
 m_TotalFrequency(0),
@@ -57,6 +59,8 @@ Initialize(const unsigned int nbins, const PixelValueType min,
   m_Symmetry = symmetry;
   m_LookupArray = LookupArrayType(m_Size[0] * m_Size[1]);
   m_LookupArray.Fill(-1);
+  m_Vector.clear();
+  m_NumberOfSortedPairs = 0;
   m_TotalFrequency = 0;
 
   // adjust the sizes of min max value containers
@@ -246,6 +250,116 @@ AddPixelPair(const PixelValueType& pixelvalue1, const PixelValueType& pixelvalue
     }
 }
 
+template <class TPixel >
+void
+GreyLevelCooccurrenceIndexedList<TPixel>::
+RemovePixelPair(const PixelValueType& pixelvalue1, const PixelValueType& pixelvalue2)
+{
+  // Same bounds as in AddPixelPair, so that only pairs previously added are
+  // removed
+  if ( pixelvalue1 < m_InputImageMinimum
+       || pixelvalue1 > m_InputImageMaximum )
+    {
+    return;
+    }
+
+  if ( pixelvalue2 < m_InputImageMinimum
+       || pixelvalue2 > m_InputImageMaximum )
+    {
+    return;
+    }
+
+  IndexType index;
+  PixelPairType ppair( PixelPairSize);
+  ppair[0] = pixelvalue1;
+  ppair[1] = pixelvalue2;
+
+  this->GetIndex(ppair, index);
+  this->RemovePairFromVector(index);
+  if(m_Symmetry)
+    {
+    IndexValueType temp;
+    temp = index[0];
+    index[0] = index[1];
+    index[1] = temp;
+    this->RemovePairFromVector(index);
+    }
+}
+
+template <class TPixel >
+bool
+GreyLevelCooccurrenceIndexedList<TPixel>::
+GetPixelBin(const PixelValueType& pixelvalue, IndexValueType& bin) const
+{
+  if ( pixelvalue < m_InputImageMinimum
+       || pixelvalue > m_InputImageMaximum )
+    {
+    return false;
+    }
+
+  IndexType index;
+  PixelPairType ppair( PixelPairSize);
+  ppair[0] = pixelvalue;
+  ppair[1] = pixelvalue;
+  this->GetIndex(ppair, index);
+  bin = index[0];
+  return true;
+}
+
+template <class TPixel >
+void
+GreyLevelCooccurrenceIndexedList<TPixel>::
+Clear()
+{
+  typename VectorType::const_iterator it;
+  for (it = m_Vector.begin(); it != m_Vector.end(); ++it)
+    {
+    m_LookupArray[(*it).first[1] * m_Size[0] + (*it).first[0]] = -1;
+    }
+  m_Vector.clear();
+  m_NumberOfSortedPairs = 0;
+  m_TotalFrequency = 0;
+}
+
+template <class TPixel >
+void
+GreyLevelCooccurrenceIndexedList<TPixel>::
+SortPairs()
+{
+  // Drop the pairs with a zero frequency, keeping the order of the others
+  std::size_t nbPairs = 0;
+  std::size_t nbSortedPairs = 0;
+  for (std::size_t i = 0; i < m_Vector.size(); ++i)
+    {
+    if (m_Vector[i].second == 0)
+      {
+      m_LookupArray[m_Vector[i].first[1] * m_Size[0] + m_Vector[i].first[0]] = -1;
+      continue;
+      }
+    if (i < m_NumberOfSortedPairs)
+      {
+      ++nbSortedPairs;
+      }
+    m_Vector[nbPairs++] = m_Vector[i];
+    }
+  m_Vector.resize(nbPairs);
+
+  // Sort the pairs added since the last call and merge them with the others
+  const SizeType size = m_Size;
+  auto lessIndex = [size](const CooccurrencePairType & a, const CooccurrencePairType & b)
+    {
+    return a.first[1] * size[0] + a.first[0] < b.first[1] * size[0] + b.first[0];
+    };
+  std::sort(m_Vector.begin() + nbSortedPairs, m_Vector.end(), lessIndex);
+  std::inplace_merge(m_Vector.begin(), m_Vector.begin() + nbSortedPairs, m_Vector.end(), lessIndex);
+
+  for (std::size_t i = 0; i < m_Vector.size(); ++i)
+    {
+    m_LookupArray[m_Vector[i].first[1] * m_Size[0] + m_Vector[i].first[0]] = static_cast<int>(i);
+    }
+  m_NumberOfSortedPairs = m_Vector.size();
+}
+
 template <class TPixel>
 typename GreyLevelCooccurrenceIndexedList<TPixel>::RelativeFrequencyType
 GreyLevelCooccurrenceIndexedList<TPixel>::
@@ -279,9 +393,9 @@ GetFrequency(IndexValueType i, IndexValueType j, const VectorType& vect) const
 }
 
 template <class TPixel>
-typename GreyLevelCooccurrenceIndexedList<TPixel>::VectorType
+const typename GreyLevelCooccurrenceIndexedList<TPixel>::VectorType &
 GreyLevelCooccurrenceIndexedList<TPixel>
-::GetVector()
+::GetVector() const
 {
   return m_Vector;
 }
@@ -309,6 +423,24 @@ GreyLevelCooccurrenceIndexedList<TPixel>
   m_TotalFrequency = m_TotalFrequency + 1;
 }
 
+template <class TPixel>
+void
+GreyLevelCooccurrenceIndexedList<TPixel>
+::RemovePairFromVector(IndexType index)
+{
+  InstanceIdentifier instanceId = 0;
+  instanceId = index[1] * m_Size[0] + index[0];
+  int vindex = m_LookupArray[instanceId];
+  if( vindex < 0 || m_Vector[vindex].second == 0)
+    {
+    return;
+    }
+  // The pair keeps its place in m_Vector with a zero frequency. It is reused
+  // if the pair is added again, and removed by SortPairs() or Clear().
+  m_Vector[vindex].second--;
+  m_TotalFrequency = m_TotalFrequency - 1;
+}
+
 template <class TPixel>
 void
 GreyLevelCooccurrenceIndexedList<TPixel>
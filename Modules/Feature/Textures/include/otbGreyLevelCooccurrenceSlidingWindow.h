@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbGreyLevelCooccurrenceSlidingWindow_h
+#define otbGreyLevelCooccurrenceSlidingWindow_h
+
+#include "otbGreyLevelCooccurrenceIndexedList.h"
+
+namespace otb
+{
+/** \class GreyLevelCooccurrenceSlidingWindow
+ * \brief Maintain the co-occurrence indexed list of a window sliding over an image
+ *
+ * The co-occurrence list holds the pairs (p, p + offset) for all pixels p of
+ * the window such that p + offset lies in the buffered region of the
+ * image. This is the same list as the one built by iterating a
+ * ConstNeighborhoodIterator over the window.
+ *
+ * When SetWindow() is called with a window covering the same rows as the
+ * previous one and overlapping it, only the columns leaving the window are
+ * removed and the columns entering the window are added, so that the cost of
+ * moving the window by one pixel is proportional to its height instead of its
+ * area. Otherwise, the list is cleared and rebuilt. In both cases, the pairs
+ * of the list are then sorted by bin index (see
+ * GreyLevelCooccurrenceIndexedList::SortPairs()), so that the features
+ * computed from the list are the same whichever way it was built.
+ *
+ * One instance is meant to be used by a single thread, scanning windows in
+ * row-major order.
+ *
+ * \sa GreyLevelCooccurrenceIndexedList
+ *
+ * \ingroup OTBTextures
+ */
+template <class TInputImage>
+class ITK_EXPORT GreyLevelCooccurrenceSlidingWindow : public itk::LightObject
+{
+public:
+  /** Standard typedefs */
+  typedef GreyLevelCooccurrenceSlidingWindow Self;
+  typedef itk::LightObject                   Superclass;
+  typedef itk::SmartPointer<Self>            Pointer;
+  typedef itk::SmartPointer<const Self>      ConstPointer;
+
+  /** Creation through the object factory */
+  itkNewMacro(Self);
+
+  /** RTTI */
+  itkTypeMacro(GreyLevelCooccurrenceSlidingWindow, itk::LightObject);
+
+  typedef TInputImage                             InputImageType;
+  typedef typename InputImageType::PixelType      InputPixelType;
+  typedef typename InputImageType::RegionType     RegionType;
+  typedef typename InputImageType::IndexType      IndexType;
+  typedef typename InputImageType::OffsetType     OffsetType;
+  typedef typename IndexType::IndexValueType      IndexValueType;
+
+  typedef GreyLevelCooccurrenceIndexedList<InputPixelType> CooccurrenceIndexedListType;
+  typedef typename CooccurrenceIndexedListType::Pointer    CooccurrenceIndexedListPointerType;
+  typedef typename CooccurrenceIndexedListType::PixelValueType PixelValueType;
+
+  /** Set the image, the co-occurrence offset and the bins of the list. The
+   * window is reset. */
+  void Initialize(const InputImageType * image, const OffsetType & offset,
+                  const unsigned int nbins, const PixelValueType min,
+                  const PixelValueType max, const bool symmetry = true);
+
+  /** Move the window. The window must be included in the buffered region of
+   * the image. */
+  void SetWindow(const RegionType & window);
+
+  /** Get the co-occurrence list of the current window */
+  CooccurrenceIndexedListType * GetCooccurrenceList()
+  {
+    return m_CooccurrenceList;
+  }
+
+protected:
+  GreyLevelCooccurrenceSlidingWindow();
+  ~GreyLevelCooccurrenceSlidingWindow() override {}
+
+  /** Add (or remove) the pairs of the given window column */
+  void UpdateColumn(IndexValueType column, bool add);
+
+  void PrintSelf(std::ostream & os, itk::Indent indent) const override;
+
+private:
+  GreyLevelCooccurrenceSlidingWindow(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Input image */
+  const InputImageType * m_Image;
+
+  /** Co-occurrence offset */
+  OffsetType m_Offset;
+
+  /** Co-occurrence list of the current window */
+  CooccurrenceIndexedListPointerType m_CooccurrenceList;
+
+  /** Current window, empty when the list is empty */
+  RegionType m_Window;
+
+  /** First and last rows of the window having a neighbor in the buffered
+   * region */
+  IndexValueType m_FirstRow;
+  IndexValueType m_LastRow;
+};
+
+} // End namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbGreyLevelCooccurrenceSlidingWindow.hxx"
+#endif
+
+#endif
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbGreyLevelCooccurrenceSlidingWindow_hxx
+#define otbGreyLevelCooccurrenceSlidingWindow_hxx
+
+#include "otbGreyLevelCooccurrenceSlidingWindow.h"
+#include <algorithm>
+
+namespace otb
+{
+template <class TInputImage>
+GreyLevelCooccurrenceSlidingWindow<TInputImage>
+::GreyLevelCooccurrenceSlidingWindow()
+: m_Image(nullptr)
+, m_Offset()
+, m_Window()
+, m_FirstRow(0)
+, m_LastRow(-1)
+{
+  m_CooccurrenceList = CooccurrenceIndexedListType::New();
+}
+
+template <class TInputImage>
+void
+GreyLevelCooccurrenceSlidingWindow<TInputImage>
+::Initialize(const InputImageType * image, const OffsetType & offset,
+             const unsigned int nbins, const PixelValueType min,
+             const PixelValueType max, const bool symmetry)
+{
+  m_Image = image;
+  m_Offset = offset;
+  m_CooccurrenceList->Initialize(nbins, min, max, symmetry);
+  m_Window = RegionType();
+  m_FirstRow = 0;
+  m_LastRow = -1;
+}
+
+template <class TInputImage>
+void
+GreyLevelCooccurrenceSlidingWindow<TInputImage>
+::SetWindow(const RegionType & window)
+{
+  const IndexValueType newBegin = window.GetIndex(0);
+  const IndexValueType newEnd = newBegin + static_cast<IndexValueType>(window.GetSize(0));
+  const IndexValueType oldBegin = m_Window.GetIndex(0);
+  const IndexValueType oldEnd = oldBegin + static_cast<IndexValueType>(m_Window.GetSize(0));
+
+  const bool slide = m_Window.GetNumberOfPixels() > 0
+    && window.GetNumberOfPixels() > 0
+    && window.GetIndex(1) == m_Window.GetIndex(1)
+    && window.GetSize(1) == m_Window.GetSize(1)
+    && newBegin < oldEnd && oldBegin < newEnd;
+
+  if (!slide)
+    {
+    // Rebuild the list from scratch
+    m_CooccurrenceList->Clear();
+    m_Window = window;
+    if (window.GetNumberOfPixels() == 0)
+      {
+      return;
+      }
+
+    // Rows whose neighbor (given by the offset) is in the buffered region
+    const RegionType & buffered = m_Image->GetBufferedRegion();
+    const IndexValueType bufferedBegin = buffered.GetIndex(1);
+    const IndexValueType bufferedEnd = bufferedBegin + static_cast<IndexValueType>(buffered.GetSize(1));
+    m_FirstRow = std::max(window.GetIndex(1), bufferedBegin - m_Offset[1]);
+    m_LastRow = std::min(window.GetIndex(1) + static_cast<IndexValueType>(window.GetSize(1)),
+                         bufferedEnd - m_Offset[1]) - 1;
+
+    // Pairs are added in raster order, as a neighborhood iterator would do
+    const IndexValueType neighborBegin = std::max(newBegin, buffered.GetIndex(0) - m_Offset[0]);
+    const IndexValueType neighborEnd = std::min(newEnd,
+      buffered.GetIndex(0) + static_cast<IndexValueType>(buffered.GetSize(0)) - m_Offset[0]);
+    if (neighborBegin >= neighborEnd)
+      {
+      return;
+      }
+
+    IndexType index;
+    index.Fill(0);
+    index[0] = neighborBegin;
+    const itk::OffsetValueType stride = m_Image->GetOffsetTable()[1];
+    const itk::OffsetValueType neighborShift = m_Offset[0] + m_Offset[1] * stride;
+    for (IndexValueType row = m_FirstRow; row <= m_LastRow; ++row)
+      {
+      index[1] = row;
+      const InputPixelType * center = m_Image->GetBufferPointer() + m_Image->ComputeOffset(index);
+      for (IndexValueType column = neighborBegin; column < neighborEnd; ++column, ++center)
+        {
+        m_CooccurrenceList->AddPixelPair(*center, center[neighborShift]);
+        }
+      }
+    m_CooccurrenceList->SortPairs();
+    return;
+    }
+
+  // Remove the columns leaving the window
+  for (IndexValueType column = oldBegin; column < std::min(oldEnd, newBegin); ++column)
+    {
+    this->UpdateColumn(column, false);
+    }
+  for (IndexValueType column = std::max(oldBegin, newEnd); column < oldEnd; ++column)
+    {
+    this->UpdateColumn(column, false);
+    }
+
+  // Add the columns entering the window
+  for (IndexValueType column = newBegin; column < std::min(newEnd, oldBegin); ++column)
+    {
+    this->UpdateColumn(column, true);
+    }
+  for (IndexValueType column = std::max(newBegin, oldEnd); column < newEnd; ++column)
+    {
+    this->UpdateColumn(column, true);
+    }
+
+  m_CooccurrenceList->SortPairs();
+  m_Window = window;
+}
+
+template <class TInputImage>
+void
+GreyLevelCooccurrenceSlidingWindow<TInputImage>
+::UpdateColumn(IndexValueType column, bool add)
+{
+  const RegionType & buffered = m_Image->GetBufferedRegion();
+  const IndexValueType neighborColumn = column + m_Offset[0];
+  if (m_FirstRow > m_LastRow
+      || neighborColumn < buffered.GetIndex(0)
+      || neighborColumn >= buffered.GetIndex(0) + static_cast<IndexValueType>(buffered.GetSize(0)))
+    {
+    // no pair in this column
+    return;
+    }
+
+  IndexType index;
+  index.Fill(0);
+  index[0] = column;
+  index[1] = m_FirstRow;
+
+  const itk::OffsetValueType stride = m_Image->GetOffsetTable()[1];
+  const itk::OffsetValueType neighborShift = m_Offset[0] + m_Offset[1] * stride;
+  const InputPixelType * center = m_Image->GetBufferPointer() + m_Image->ComputeOffset(index);
+
+  for (IndexValueType row = m_FirstRow; row <= m_LastRow; ++row, center += stride)
+    {
+    if (add)
+      {
+      m_CooccurrenceList->AddPixelPair(*center, center[neighborShift]);
+      }
+    else
+      {
+      m_CooccurrenceList->RemovePixelPair(*center, center[neighborShift]);
+      }
+    }
+}
+
+template <class TInputImage>
+void
+GreyLevelCooccurrenceSlidingWindow<TInputImage>
+::PrintSelf(std::ostream & os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Offset: " << m_Offset << std::endl;
+  os << indent << "Window: " << m_Window << std::endl;
+}
+
+} // End namespace otb
+
+#endif
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbHaralickTexturesFunctor_h
+#define otbHaralickTexturesFunctor_h
+
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+namespace otb
+{
+namespace Functor
+{
+/** \class HaralickTexturesFunctor
+ * \brief Compute the 8 simple Haralick textures from a co-occurrence indexed list
+ *
+ * The features are, in this order: Energy, Entropy, Correlation, Inverse
+ * Difference Moment, Inertia, Cluster Shade, Cluster Prominence and Haralick
+ * Correlation. See ScalarImageToTexturesFilter for their definition.
+ *
+ * The functor holds the marginal sums buffer so that it is allocated once,
+ * hence an instance should not be shared between threads.
+ *
+ * \sa ScalarImageToTexturesFilter
+ * \sa GreyLevelCooccurrenceIndexedList
+ *
+ * \ingroup OTBTextures
+ */
+template <class TCooccurrenceIndexedList>
+class HaralickTexturesFunctor
+{
+public:
+  typedef TCooccurrenceIndexedList                                   CooccurrenceIndexedListType;
+  typedef typename CooccurrenceIndexedListType::IndexType            CooccurrenceIndexType;
+  typedef typename CooccurrenceIndexedListType::VectorType           VectorType;
+  typedef typename VectorType::const_iterator                        VectorConstIteratorType;
+
+  /** Number of features computed */
+  static const unsigned int NumberOfFeatures = 8;
+
+  HaralickTexturesFunctor()
+  {
+    this->SetNumberOfBinsPerAxis(8);
+  }
+
+  virtual ~HaralickTexturesFunctor() {}
+
+  /** Set the number of bins per axis of the co-occurrence lists */
+  void SetNumberOfBinsPerAxis(unsigned int nbins)
+  {
+    m_NumberOfBinsPerAxis = nbins;
+    m_MarginalSums.resize(nbins);
+  }
+
+  unsigned int GetNumberOfBinsPerAxis() const
+  {
+    return m_NumberOfBinsPerAxis;
+  }
+
+  /** Compute the features of the given co-occurrence list. features must
+   * hold at least NumberOfFeatures values. */
+  void operator ()(CooccurrenceIndexedListType * GLCIList, double * features)
+  {
+    const double log2 = std::log(2.0);
+
+    double pixelMean = 0.;
+    double marginalMean;
+    double marginalDevSquared = 0.;
+    double pixelVariance = 0.;
+
+    //Initialize marginalSums
+    std::fill(m_MarginalSums.begin(), m_MarginalSums.end(), 0.);
+
+    //get co-occurrence vector and totalfrequency
+    const VectorType & glcVector = GLCIList->GetVector();
+    double totalFrequency = static_cast<double> (GLCIList->GetTotalFrequency());
+
+    //Normalize the co-occurrence indexed list and compute mean, marginalSum
+    VectorConstIteratorType it = glcVector.begin();
+    while( it != glcVector.end())
+      {
+      double frequency = (*it).second / totalFrequency;
+      CooccurrenceIndexType index = (*it).first;
+      pixelMean += index[0] * frequency;
+      m_MarginalSums[index[0]] += frequency;
+      ++it;
+      }
+
+    /* Now get the mean and deviaton of the marginal sums.
+       Compute incremental mean and SD, a la Knuth, "The  Art of Computer
+       Programming, Volume 2: Seminumerical Algorithms",  section 4.2.2.
+       Compute mean and standard deviation using the recurrence relation:
+       M(1) = x(1), M(k) = M(k-1) + (x(k) - M(k-1) ) / k
+       S(1) = 0, S(k) = S(k-1) + (x(k) - M(k-1)) * (x(k) - M(k))
+       for 2 <= k <= n, then
+       sigma = std::sqrt(S(n) / n) (or divide by n-1 for sample SD instead of
+       population SD).
+     */
+    std::vector<double>::const_iterator msIt = m_MarginalSums.begin();
+    marginalMean = *msIt;
+    //Increment iterator to start with index 1
+    ++msIt;
+    for(int k= 2; msIt != m_MarginalSums.end(); ++k, ++msIt)
+      {
+      double M_k_minus_1 = marginalMean;
+      double S_k_minus_1 = marginalDevSquared;
+      double x_k = *msIt;
+      double M_k = M_k_minus_1 + ( x_k - M_k_minus_1 ) / k;
+      double S_k = S_k_minus_1 + ( x_k - M_k_minus_1 ) * ( x_k - M_k );
+      marginalMean = M_k;
+      marginalDevSquared = S_k;
+      }
+    marginalDevSquared = marginalDevSquared / m_NumberOfBinsPerAxis;
+
+    VectorConstIteratorType constVectorIt;
+    constVectorIt = glcVector.begin();
+    while( constVectorIt != glcVector.end())
+      {
+      double frequency = (*constVectorIt).second / totalFrequency;
+      CooccurrenceIndexType index = (*constVectorIt).first;
+      pixelVariance += ( index[0] - pixelMean ) * ( index[0] - pixelMean ) * frequency;
+      ++constVectorIt;
+      }
+
+    double pixelVarianceSquared = pixelVariance * pixelVariance;
+    // Variance is only used in correlation. If variance is 0, then (index[0] - pixelMean) * (index[1] - pixelMean)
+    // should be zero as well. In this case, set the variance to 1. in order to
+    // avoid NaN correlation.
+    if(pixelVarianceSquared < GetPixelValueTolerance())
+      {
+      pixelVarianceSquared = 1.;
+      }
+
+    //Initialize texture variables;
+    double energy      = 0.;
+    double entropy     = 0.;
+    double correlation = 0.;
+    double inverseDifferenceMoment      = 0.;
+    double inertia             = 0.;
+    double clusterShade        = 0.;
+    double clusterProminence   = 0.;
+    double haralickCorrelation = 0.;
+
+    //Compute textures
+    constVectorIt = glcVector.begin();
+    while( constVectorIt != glcVector.end())
+      {
+      CooccurrenceIndexType index = (*constVectorIt).first;
+      double frequency = (*constVectorIt).second / totalFrequency;
+      energy += frequency * frequency;
+      entropy -= ( frequency > GetPixelValueTolerance() ) ? frequency *std::log(frequency) / log2 : 0;
+      correlation += ( ( index[0] - pixelMean ) * ( index[1] - pixelMean ) * frequency ) / pixelVarianceSquared;
+      inverseDifferenceMoment += frequency / ( 1.0 + ( index[0] - index[1] ) * ( index[0] - index[1] ) );
+      inertia += ( index[0] - index[1] ) * ( index[0] - index[1] ) * frequency;
+      clusterShade += std::pow( ( index[0] - pixelMean ) + ( index[1] - pixelMean ), 3 ) * frequency;
+      clusterProminence += std::pow( ( index[0] - pixelMean ) + ( index[1] - pixelMean ), 4 ) * frequency;
+      haralickCorrelation += index[0] * index[1] * frequency;
+      ++constVectorIt;
+      }
+
+    haralickCorrelation = (std::fabs(marginalDevSquared) > 1E-8) ?
+      ( haralickCorrelation - marginalMean * marginalMean )  / marginalDevSquared : 0;
+
+    features[0] = energy;
+    features[1] = entropy;
+    features[2] = correlation;
+    features[3] = inverseDifferenceMoment;
+    features[4] = inertia;
+    features[5] = clusterShade;
+    features[6] = clusterProminence;
+    features[7] = haralickCorrelation;
+  }
+
+private:
+  static double GetPixelValueTolerance() {return 0.0001; }
+
+  unsigned int m_NumberOfBinsPerAxis;
+
+  /** Marginal sums, reset for each call */
+  std::vector<double> m_MarginalSums;
+};
+
+} // End namespace Functor
+} // End namespace otb
+
+#endif
@@ -21,7 +21,7 @@
 #ifndef otbScalarImageToAdvancedTexturesFilter_h
 #define otbScalarImageToAdvancedTexturesFilter_h
 
-#include "otbGreyLevelCooccurrenceIndexedList.h"
+#include "otbGreyLevelCooccurrenceSlidingWindow.h"
 #include "itkMacro.h"
 #include "itkImageToImageFilter.h"
 namespace otb
@@ -138,6 +138,8 @@ public:
   typedef typename VectorType::iterator                    VectorIteratorType;
   typedef typename VectorType::const_iterator              VectorConstIteratorType;
 
+  typedef GreyLevelCooccurrenceSlidingWindow< InputImageType > SlidingWindowType;
+
   /** Set the radius of the window on which textures will be computed */
   itkSetMacro(Radius, SizeType);
   /** Get the radius of the window on which textures will be computed */
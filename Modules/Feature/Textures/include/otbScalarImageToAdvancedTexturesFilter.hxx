@@ -23,7 +23,6 @@
 
 #include "otbScalarImageToAdvancedTexturesFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
-#include "itkConstNeighborhoodIterator.h"
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
 #include "itkNumericTraits.h"
@@ -363,6 +362,16 @@ ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>
   // Set-up progress reporting
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
+  // Co-occurrence list of this thread, updated incrementally
+  typename SlidingWindowType::Pointer slidingWindow = SlidingWindowType::New();
+  slidingWindow->Initialize(inputPtr, m_Offset, m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
+
+  // Marginal and sum/difference histograms, reset for each pixel
+  typedef itk::Array<double> DoubleArrayType;
+  DoubleArrayType hx(histSize);
+  DoubleArrayType hy(histSize);
+  DoubleArrayType pdxy(twiceHistSize);
+
   // Iterate on outputs to compute textures
   while (!varianceIt.IsAtEnd()
          && !meanIt.IsAtEnd()
@@ -398,24 +407,10 @@ ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>
     inputRegion.SetSize(inputSize);
     inputRegion.Crop(inputPtr->GetRequestedRegion());
 
-    CooccurrenceIndexedListPointerType GLCIList = CooccurrenceIndexedListType::New();
-    GLCIList->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
-
-    typedef itk::ConstNeighborhoodIterator< InputImageType > NeighborhoodIteratorType;
-    NeighborhoodIteratorType neighborIt;
-    neighborIt = NeighborhoodIteratorType(m_NeighborhoodRadius, inputPtr, inputRegion);
-    for ( neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt )
-    {
-    const InputPixelType centerPixelIntensity = neighborIt.GetCenterPixel();
-    bool pixelInBounds;
-    const InputPixelType pixelIntensity =  neighborIt.GetPixel(m_Offset, pixelInBounds);
-    if ( !pixelInBounds )
-      {
-      continue; // don't put a pixel in the co-occurrence list if the value is
-               // out of bounds
-      }
-    GLCIList->AddPixelPair(centerPixelIntensity, pixelIntensity);
-    }
+    // Slide the co-occurrence window: only the columns entering and leaving
+    // the window are updated when moving along a row
+    slidingWindow->SetWindow(inputRegion);
+    CooccurrenceIndexedListType * GLCIList = slidingWindow->GetCooccurrenceList();
 
     PixelValueType m_Mean                    = itk::NumericTraits< PixelValueType >::Zero;
     PixelValueType m_Variance                = itk::NumericTraits< PixelValueType >::Zero;
@@ -430,27 +425,13 @@ ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>
 
     double Entropy = 0;
 
-    typedef itk::Array<double> DoubleArrayType;
-    DoubleArrayType hx(histSize);
-    DoubleArrayType hy(histSize);
-    DoubleArrayType pdxy(twiceHistSize);
-
-    for(long unsigned int i = 0; i < histSize; i++)
-      {
-      hx[i] = 0.0;
-      hy[i] = 0.0;
-      pdxy[i] = 0.0;
-      }
-    for(long unsigned int i = histSize; i < twiceHistSize; i++)
-      {
-      pdxy[i] = 0.0;
-      }
-
-    /*   hx.Fill(0.0);    hy.Fill(0.0);    pdxy.Fill(0.0);   */
+    hx.Fill(0.0);
+    hy.Fill(0.0);
+    pdxy.Fill(0.0);
     double hxy1 = 0;
 
     //get co-occurrence vector and totalfrequency
-    VectorType glcVector = GLCIList->GetVector();
+    const VectorType & glcVector = GLCIList->GetVector();
     double totalFrequency = static_cast<double> (GLCIList->GetTotalFrequency());
 
     VectorConstIteratorType constVectorIt;
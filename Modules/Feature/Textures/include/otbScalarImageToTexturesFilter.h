@@ -22,7 +22,8 @@
 #ifndef otbScalarImageToTexturesFilter_h
 #define otbScalarImageToTexturesFilter_h
 
-#include "otbGreyLevelCooccurrenceIndexedList.h"
+#include "otbGreyLevelCooccurrenceSlidingWindow.h"
+#include "otbHaralickTexturesFunctor.h"
 #include "itkImageToImageFilter.h"
 
 namespace otb
@@ -140,6 +141,9 @@ public:
   typedef typename VectorType::iterator                    VectorIteratorType;
   typedef typename VectorType::const_iterator              VectorConstIteratorType;
 
+  typedef GreyLevelCooccurrenceSlidingWindow< InputImageType > SlidingWindowType;
+  typedef Functor::HaralickTexturesFunctor< CooccurrenceIndexedListType > TexturesFunctorType;
+
   /** Set the radius of the window on which textures will be computed */
   itkSetMacro(Radius, SizeType);
   /** Get the radius of the window on which textures will be computed */
@@ -24,12 +24,9 @@
 
 #include "otbScalarImageToTexturesFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
-#include "itkConstNeighborhoodIterator.h"
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
 #include "itkNumericTraits.h"
-#include <vector>
-#include <cmath>
 
 namespace otb
 {
@@ -323,13 +320,20 @@ ScalarImageToTexturesFilter<TInputImage, TOutputImage>
   clusterProminenceIt.GoToBegin();
   haralickCorIt.GoToBegin();
 
-  const double log2 = std::log(2.0);
-
   InputRegionType inputLargest = inputPtr->GetLargestPossibleRegion();
 
   // Set-up progress reporting
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
+  // Co-occurrence list of this thread, updated incrementally
+  typename SlidingWindowType::Pointer slidingWindow = SlidingWindowType::New();
+  slidingWindow->Initialize(inputPtr, m_Offset, m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
+
+  // Features computation from the co-occurrence list
+  TexturesFunctorType texturesFunctor;
+  texturesFunctor.SetNumberOfBinsPerAxis(m_NumberOfBinsPerAxis);
+  double features[TexturesFunctorType::NumberOfFeatures];
+
   // Iterate on outputs to compute textures
   while (!energyIt.IsAtEnd()
          && !entropyIt.IsAtEnd()
@@ -362,132 +366,20 @@ ScalarImageToTexturesFilter<TInputImage, TOutputImage>
     inputRegion.SetSize(inputSize);
     inputRegion.Crop(inputPtr->GetRequestedRegion());
 
-    CooccurrenceIndexedListPointerType GLCIList = CooccurrenceIndexedListType::New();
-    GLCIList->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
-
-    typedef itk::ConstNeighborhoodIterator< InputImageType > NeighborhoodIteratorType;
-    NeighborhoodIteratorType neighborIt;
-    neighborIt = NeighborhoodIteratorType(m_NeighborhoodRadius, inputPtr, inputRegion);
-    for ( neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt )
-      {
-      const InputPixelType centerPixelIntensity = neighborIt.GetCenterPixel();
-      bool pixelInBounds;
-      const InputPixelType pixelIntensity =  neighborIt.GetPixel(m_Offset, pixelInBounds);
-      if ( !pixelInBounds )
-        {
-        continue; // don't put a pixel in the co-occurrence list if the value is
-                  // out of bounds
-        }
-      GLCIList->AddPixelPair(centerPixelIntensity, pixelIntensity);
-      }
-
-    double pixelMean = 0.;
-    double marginalMean;
-    double marginalDevSquared = 0.;
-    double pixelVariance = 0.;
-
-    //Create and Initialize marginalSums
-    std::vector<double> marginalSums(m_NumberOfBinsPerAxis, 0);
-
-    //get co-occurrence vector and totalfrequency
-    VectorType glcVector = GLCIList->GetVector();
-    double totalFrequency = static_cast<double> (GLCIList->GetTotalFrequency());
-
-    //Normalize the co-occurrence indexed list and compute mean, marginalSum
-    typename VectorType::iterator it = glcVector.begin();
-    while( it != glcVector.end())
-      {
-      double frequency = (*it).second / totalFrequency;
-      CooccurrenceIndexType index = (*it).first;
-      pixelMean += index[0] * frequency;
-      marginalSums[index[0]] += frequency;
-      ++it;
-      }
-
-    /* Now get the mean and deviaton of the marginal sums.
-       Compute incremental mean and SD, a la Knuth, "The  Art of Computer
-       Programming, Volume 2: Seminumerical Algorithms",  section 4.2.2.
-       Compute mean and standard deviation using the recurrence relation:
-       M(1) = x(1), M(k) = M(k-1) + (x(k) - M(k-1) ) / k
-       S(1) = 0, S(k) = S(k-1) + (x(k) - M(k-1)) * (x(k) - M(k))
-       for 2 <= k <= n, then
-       sigma = std::sqrt(S(n) / n) (or divide by n-1 for sample SD instead of
-       population SD).
-     */
-    std::vector<double>::const_iterator msIt = marginalSums.begin();
-    marginalMean = *msIt;
-    //Increment iterator to start with index 1
-    ++msIt;
-    for(int k= 2; msIt != marginalSums.end(); ++k, ++msIt)
-      {
-      double M_k_minus_1 = marginalMean;
-      double S_k_minus_1 = marginalDevSquared;
-      double x_k = *msIt;
-      double M_k = M_k_minus_1 + ( x_k - M_k_minus_1 ) / k;
-      double S_k = S_k_minus_1 + ( x_k - M_k_minus_1 ) * ( x_k - M_k );
-      marginalMean = M_k;
-      marginalDevSquared = S_k;
-      }
-    marginalDevSquared = marginalDevSquared / m_NumberOfBinsPerAxis;
-
-    VectorConstIteratorType constVectorIt;
-    constVectorIt = glcVector.begin();
-    while( constVectorIt != glcVector.end())
-    {
-    RelativeFrequencyType frequency = (*constVectorIt).second / totalFrequency;
-    CooccurrenceIndexType        index = (*constVectorIt).first;
-    pixelVariance += ( index[0] - pixelMean ) * ( index[0] - pixelMean ) * frequency;
-    ++constVectorIt;
-    }
-
-    double pixelVarianceSquared = pixelVariance * pixelVariance;
-    // Variance is only used in correlation. If variance is 0, then (index[0] - pixelMean) * (index[1] - pixelMean)
-    // should be zero as well. In this case, set the variance to 1. in order to
-    // avoid NaN correlation.
-    if(pixelVarianceSquared < GetPixelValueTolerance())
-      {
-      pixelVarianceSquared = 1.;
-      }
-
-    //Initialize texture variables;
-    PixelValueType energy      = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType entropy     = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType correlation = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType inverseDifferenceMoment      = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType inertia             = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType clusterShade        = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType clusterProminence   = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType haralickCorrelation = itk::NumericTraits< PixelValueType >::Zero;
-
-    //Compute textures
-    constVectorIt = glcVector.begin();
-    while( constVectorIt != glcVector.end())
-      {
-      CooccurrenceIndexType index = (*constVectorIt).first;
-      RelativeFrequencyType frequency = (*constVectorIt).second / totalFrequency;
-      energy += frequency * frequency;
-      entropy -= ( frequency > GetPixelValueTolerance() ) ? frequency *std::log(frequency) / log2 : 0;
-      correlation += ( ( index[0] - pixelMean ) * ( index[1] - pixelMean ) * frequency ) / pixelVarianceSquared;
-      inverseDifferenceMoment += frequency / ( 1.0 + ( index[0] - index[1] ) * ( index[0] - index[1] ) );
-      inertia += ( index[0] - index[1] ) * ( index[0] - index[1] ) * frequency;
-      clusterShade += std::pow( ( index[0] - pixelMean ) + ( index[1] - pixelMean ), 3 ) * frequency;
-      clusterProminence += std::pow( ( index[0] - pixelMean ) + ( index[1] - pixelMean ), 4 ) * frequency;
-      haralickCorrelation += index[0] * index[1] * frequency;
-      ++constVectorIt;
-      }
-
-    haralickCorrelation = (fabs(marginalDevSquared) > 1E-8) ?
-      ( haralickCorrelation - marginalMean * marginalMean )  / marginalDevSquared : 0;
+    // Slide the co-occurrence window: only the columns entering and leaving
+    // the window are updated when moving along a row
+    slidingWindow->SetWindow(inputRegion);
+    texturesFunctor(slidingWindow->GetCooccurrenceList(), features);
 
     // Fill outputs
-    energyIt.Set(energy);
-    entropyIt.Set(entropy);
-    correlationIt.Set(correlation);
-    invDiffMomentIt.Set(inverseDifferenceMoment);
-    inertiaIt.Set(inertia);
-    clusterShadeIt.Set(clusterShade);
-    clusterProminenceIt.Set(clusterProminence);
-    haralickCorIt.Set(haralickCorrelation);
+    energyIt.Set(features[0]);
+    entropyIt.Set(features[1]);
+    correlationIt.Set(features[2]);
+    invDiffMomentIt.Set(features[3]);
+    inertiaIt.Set(features[4]);
+    clusterShadeIt.Set(features[5]);
+    clusterProminenceIt.Set(features[6]);
+    haralickCorIt.Set(features[7]);
 
     // Update progress
     progress.CompletedPixel();
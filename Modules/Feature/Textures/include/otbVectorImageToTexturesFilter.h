@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbVectorImageToTexturesFilter_h
+#define otbVectorImageToTexturesFilter_h
+
+#include "otbGreyLevelCooccurrenceSlidingWindow.h"
+#include "otbHaralickTexturesFunctor.h"
+#include "itkImageToImageFilter.h"
+#include "itkImage.h"
+#include <vector>
+
+namespace otb
+{
+/**
+ * \class VectorImageToTexturesFilter
+ * \brief Compute the 8 local Haralick textures for several bands and offsets in one pass
+ *
+ * This filter computes the same features as ScalarImageToTexturesFilter
+ * (Energy, Entropy, Correlation, Inverse Difference Moment, Inertia, Cluster
+ * Shade, Cluster Prominence and Haralick Correlation) for each band of the
+ * input vector image and for each offset of a list of offsets.
+ *
+ * Each band is quantized once in BeforeThreadedGenerateData(), and all the
+ * co-occurrence lists of an output pixel are computed during a single
+ * traversal of the output region. Co-occurrence lists are updated
+ * incrementally along rows with GreyLevelCooccurrenceSlidingWindow.
+ *
+ * The output is a vector image. Its components are ordered by band, then by
+ * offset, then by feature. If AverageOffsets is on, the features are
+ * averaged over the offsets (for instance to get features invariant to the
+ * direction), and the output has 8 components per band.
+ *
+ * The same quantization parameters (minimum, maximum and number of bins) are
+ * used for all the bands.
+ *
+ * \sa otb::ScalarImageToTexturesFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Threaded
+ *
+ * \ingroup OTBTextures
+ */
+template<class TInputImage, class TOutputImage>
+class ITK_EXPORT VectorImageToTexturesFilter : public itk::ImageToImageFilter
+  <TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs */
+  typedef VectorImageToTexturesFilter                        Self;
+  typedef itk::ImageToImageFilter<TInputImage, TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                            Pointer;
+  typedef itk::SmartPointer<const Self>                      ConstPointer;
+
+  /** Creation through the object factory */
+  itkNewMacro(Self);
+
+  /** RTTI */
+  itkTypeMacro(VectorImageToTexturesFilter, ImageToImageFilter);
+
+  /** Template class typedefs */
+  typedef TInputImage                                 InputImageType;
+  typedef typename InputImageType::Pointer            InputImagePointerType;
+  typedef typename InputImageType::InternalPixelType  InputInternalPixelType;
+  typedef typename InputImageType::RegionType         InputRegionType;
+  typedef typename InputRegionType::SizeType          SizeType;
+  typedef typename InputImageType::OffsetType         OffsetType;
+  typedef std::vector<OffsetType>                     OffsetListType;
+
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::Pointer           OutputImagePointerType;
+  typedef typename OutputImageType::RegionType        OutputRegionType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::InternalPixelType OutputInternalPixelType;
+
+  /** Bands quantized in [0, NumberOfBinsPerAxis - 1], pixels out of
+   * [InputImageMinimum, InputImageMaximum] are set to NumberOfBinsPerAxis */
+  typedef unsigned short                                           QuantizedPixelType;
+  typedef itk::Image<QuantizedPixelType, InputImageType::ImageDimension> QuantizedImageType;
+  typedef typename QuantizedImageType::Pointer                     QuantizedImagePointerType;
+
+  typedef GreyLevelCooccurrenceSlidingWindow< QuantizedImageType > SlidingWindowType;
+  typedef typename SlidingWindowType::CooccurrenceIndexedListType  CooccurrenceIndexedListType;
+  typedef Functor::HaralickTexturesFunctor< CooccurrenceIndexedListType > TexturesFunctorType;
+
+  /** Set the radius of the window on which textures will be computed */
+  itkSetMacro(Radius, SizeType);
+  /** Get the radius of the window on which textures will be computed */
+  itkGetMacro(Radius, SizeType);
+
+  /** Set the offsets for co-occurence computation */
+  void SetOffsets(const OffsetListType & offsets)
+  {
+    m_Offsets = offsets;
+    this->Modified();
+  }
+
+  /** Get the offsets for co-occurence computation */
+  itkGetConstReferenceMacro(Offsets, OffsetListType);
+
+  /** Set the number of bin per axis */
+  itkSetMacro(NumberOfBinsPerAxis, unsigned int);
+
+  /** Get the number of bin per axis */
+  itkGetMacro(NumberOfBinsPerAxis, unsigned int);
+
+  /** Set the input image minimum */
+  itkSetMacro(InputImageMinimum, InputInternalPixelType);
+
+  /** Get the input image minimum */
+  itkGetMacro(InputImageMinimum, InputInternalPixelType);
+
+  /** Set the input image maximum */
+  itkSetMacro(InputImageMaximum, InputInternalPixelType);
+
+  /** Get the input image maximum */
+  itkGetMacro(InputImageMaximum, InputInternalPixelType);
+
+  /** Set the sub-sampling factor */
+  itkSetMacro(SubsampleFactor, SizeType);
+
+  /** Get the sub-sampling factor */
+  itkGetMacro(SubsampleFactor, SizeType);
+
+  /** Set the sub-sampling offset */
+  itkSetMacro(SubsampleOffset, OffsetType);
+
+  /** Get the sub-sampling offset */
+  itkGetMacro(SubsampleOffset, OffsetType);
+
+  /** Average the features over the offsets (off by default) */
+  itkSetMacro(AverageOffsets, bool);
+  itkGetMacro(AverageOffsets, bool);
+  itkBooleanMacro(AverageOffsets);
+
+protected:
+  /** Constructor */
+  VectorImageToTexturesFilter();
+  /** Destructor */
+  ~VectorImageToTexturesFilter() override {}
+  /** Generate the output information */
+  void GenerateOutputInformation() override;
+  /** Generate the input requested region */
+  void GenerateInputRequestedRegion() override;
+  /** Quantize the input bands */
+  void BeforeThreadedGenerateData() override;
+  /** Parallel textures extraction */
+  void ThreadedGenerateData(const OutputRegionType& outputRegion, itk::ThreadIdType threadId) override;
+  /** Release the quantized bands */
+  void AfterThreadedGenerateData() override;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+private:
+  VectorImageToTexturesFilter(const Self&) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Radius of the window on which to compute textures */
+  SizeType m_Radius;
+
+  /** Offsets for co-occurence */
+  OffsetListType m_Offsets;
+
+  /** Number of bins per axis */
+  unsigned int m_NumberOfBinsPerAxis;
+
+  /** Input image minimum */
+  InputInternalPixelType m_InputImageMinimum;
+
+  /** Input image maximum */
+  InputInternalPixelType m_InputImageMaximum;
+
+  /** Sub-sampling factor */
+  SizeType m_SubsampleFactor;
+
+  /** Sub-sampling offset */
+  OffsetType m_SubsampleOffset;
+
+  /** Average features over offsets */
+  bool m_AverageOffsets;
+
+  /** Quantized input bands, shared by all threads */
+  std::vector<QuantizedImagePointerType> m_QuantizedBands;
+};
+} // End namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbVectorImageToTexturesFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbVectorImageToTexturesFilter_hxx
+#define otbVectorImageToTexturesFilter_hxx
+
+#include "otbVectorImageToTexturesFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkProgressReporter.h"
+#include <algorithm>
+
+namespace otb
+{
+template <class TInputImage, class TOutputImage>
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::VectorImageToTexturesFilter()
+: m_Radius()
+, m_Offsets()
+, m_NumberOfBinsPerAxis(8)
+, m_InputImageMinimum(0)
+, m_InputImageMaximum(255)
+, m_SubsampleFactor()
+, m_SubsampleOffset()
+, m_AverageOffsets(false)
+{
+  this->m_SubsampleFactor.Fill(1);
+  this->m_SubsampleOffset.Fill(0);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::GenerateOutputInformation()
+{
+  // First, call superclass implementation
+  Superclass::GenerateOutputInformation();
+
+  if (m_Offsets.empty())
+    {
+    itkExceptionMacro(<< "At least one offset is needed to compute co-occurrences");
+    }
+
+  // Compute output size, origin & spacing
+  InputRegionType inputRegion = this->GetInput()->GetLargestPossibleRegion();
+  OutputRegionType outputRegion;
+  outputRegion.SetIndex(0,0);
+  outputRegion.SetIndex(1,0);
+  outputRegion.SetSize(0, 1 + (inputRegion.GetSize(0) - 1 - m_SubsampleOffset[0]) / m_SubsampleFactor[0]);
+  outputRegion.SetSize(1, 1 + (inputRegion.GetSize(1) - 1 - m_SubsampleOffset[1]) / m_SubsampleFactor[1]);
+
+  typename OutputImageType::SpacingType outSpacing = this->GetInput()->GetSignedSpacing();
+  outSpacing[0] *= m_SubsampleFactor[0];
+  outSpacing[1] *= m_SubsampleFactor[1];
+
+  typename OutputImageType::PointType outOrigin;
+  this->GetInput()->TransformIndexToPhysicalPoint(inputRegion.GetIndex()+m_SubsampleOffset,outOrigin);
+
+  const unsigned int nbOffsets = m_AverageOffsets ? 1 : m_Offsets.size();
+  OutputImagePointerType outputPtr = this->GetOutput();
+  outputPtr->SetLargestPossibleRegion(outputRegion);
+  outputPtr->SetOrigin(outOrigin);
+  outputPtr->SetSignedSpacing(outSpacing);
+  outputPtr->SetNumberOfComponentsPerPixel(this->GetInput()->GetNumberOfComponentsPerPixel()
+                                           * nbOffsets * TexturesFunctorType::NumberOfFeatures);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  // First, call superclass implementation
+  Superclass::GenerateInputRequestedRegion();
+
+  // Retrieve the input and output pointers
+  InputImagePointerType  inputPtr = const_cast<InputImageType *>(this->GetInput());
+  OutputImagePointerType outputPtr = this->GetOutput();
+
+  if (!inputPtr || !outputPtr)
+    {
+    return;
+    }
+
+  OutputRegionType outputRequestedRegion = outputPtr->GetRequestedRegion();
+
+  typename OutputRegionType::IndexType outputIndex = outputRequestedRegion.GetIndex();
+  typename OutputRegionType::SizeType  outputSize   = outputRequestedRegion.GetSize();
+  typename InputRegionType::IndexType  inputIndex;
+  typename InputRegionType::SizeType   inputSize;
+  InputRegionType inputLargest = inputPtr->GetLargestPossibleRegion();
+
+  // Convert index and size to full grid
+  outputIndex[0] = outputIndex[0] * m_SubsampleFactor[0] + m_SubsampleOffset[0] + inputLargest.GetIndex(0);
+  outputIndex[1] = outputIndex[1] * m_SubsampleFactor[1] + m_SubsampleOffset[1] + inputLargest.GetIndex(1);
+  outputSize[0] = 1 + (outputSize[0] - 1) * m_SubsampleFactor[0];
+  outputSize[1] = 1 + (outputSize[1] - 1) * m_SubsampleFactor[1];
+
+  // First, apply the extent of all offsets
+  for (unsigned int dim = 0; dim < InputImageType::ImageDimension; ++dim)
+    {
+    long minOffset = 0;
+    long maxOffset = 0;
+    for (typename OffsetListType::const_iterator it = m_Offsets.begin(); it != m_Offsets.end(); ++it)
+      {
+      minOffset = std::min(minOffset, static_cast<long>((*it)[dim]));
+      maxOffset = std::max(maxOffset, static_cast<long>((*it)[dim]));
+      }
+    inputIndex[dim] = outputIndex[dim] + minOffset;
+    inputSize[dim] = outputSize[dim] + maxOffset - minOffset;
+    }
+
+  // Build the input requested region
+  InputRegionType inputRequestedRegion;
+  inputRequestedRegion.SetIndex(inputIndex);
+  inputRequestedRegion.SetSize(inputSize);
+
+  // Apply the radius
+  inputRequestedRegion.PadByRadius(m_Radius);
+
+  // Try to apply the requested region to the input image
+  if (inputRequestedRegion.Crop(inputPtr->GetLargestPossibleRegion()))
+    {
+    inputPtr->SetRequestedRegion(inputRequestedRegion);
+    }
+  else
+    {
+    // Build an exception
+    itk::InvalidRequestedRegionError e(__FILE__, __LINE__);
+    e.SetLocation(ITK_LOCATION);
+    e.SetDescription("Requested region is (at least partially) outside the largest possible region.");
+    e.SetDataObject(inputPtr);
+    throw e;
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  if (m_NumberOfBinsPerAxis == 0
+      || m_NumberOfBinsPerAxis >= itk::NumericTraits<QuantizedPixelType>::max())
+    {
+    itkExceptionMacro(<< "Invalid number of bins per axis: " << m_NumberOfBinsPerAxis);
+    }
+
+  const InputImageType * inputPtr = this->GetInput();
+  const InputRegionType & bufferedRegion = inputPtr->GetBufferedRegion();
+  const unsigned int nbBands = inputPtr->GetNumberOfComponentsPerPixel();
+
+  // Use the bins of the co-occurrence list to quantize the bands, so that the
+  // features are the same as with ScalarImageToTexturesFilter
+  typedef GreyLevelCooccurrenceIndexedList<InputInternalPixelType> BinningListType;
+  typename BinningListType::Pointer binning = BinningListType::New();
+  binning->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
+
+  m_QuantizedBands.resize(nbBands);
+  std::vector<itk::ImageRegionIterator<QuantizedImageType> > quantizedIts(nbBands);
+  for (unsigned int b = 0; b < nbBands; ++b)
+    {
+    m_QuantizedBands[b] = QuantizedImageType::New();
+    m_QuantizedBands[b]->SetRegions(bufferedRegion);
+    m_QuantizedBands[b]->Allocate();
+    quantizedIts[b] = itk::ImageRegionIterator<QuantizedImageType>(m_QuantizedBands[b], bufferedRegion);
+    quantizedIts[b].GoToBegin();
+    }
+
+  const QuantizedPixelType outOfRange = static_cast<QuantizedPixelType>(m_NumberOfBinsPerAxis);
+  typename BinningListType::IndexValueType bin;
+  itk::ImageRegionConstIterator<InputImageType> inputIt(inputPtr, bufferedRegion);
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
+    {
+    const typename InputImageType::PixelType & pixel = inputIt.Get();
+    for (unsigned int b = 0; b < nbBands; ++b)
+      {
+      quantizedIts[b].Set(binning->GetPixelBin(pixel[b], bin) ?
+                          static_cast<QuantizedPixelType>(bin) : outOfRange);
+      ++quantizedIts[b];
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(const OutputRegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  const InputImageType * inputPtr = this->GetInput();
+  OutputImagePointerType outputPtr = this->GetOutput();
+
+  const unsigned int nbBands = m_QuantizedBands.size();
+  const unsigned int nbOffsets = m_Offsets.size();
+  const unsigned int nbFeatures = TexturesFunctorType::NumberOfFeatures;
+  const unsigned int nbOutputOffsets = m_AverageOffsets ? 1 : nbOffsets;
+  const double offsetWeight = m_AverageOffsets ? 1. / nbOffsets : 1.;
+
+  // One sliding co-occurrence window per band and offset. The quantized
+  // values are the bins, hence the lists use one bin per value.
+  std::vector<typename SlidingWindowType::Pointer> slidingWindows(nbBands * nbOffsets);
+  for (unsigned int b = 0; b < nbBands; ++b)
+    {
+    for (unsigned int o = 0; o < nbOffsets; ++o)
+      {
+      typename SlidingWindowType::Pointer & window = slidingWindows[b * nbOffsets + o];
+      window = SlidingWindowType::New();
+      window->Initialize(m_QuantizedBands[b], m_Offsets[o], m_NumberOfBinsPerAxis, 0, m_NumberOfBinsPerAxis - 1);
+      }
+    }
+
+  // Features computation from the co-occurrence lists
+  TexturesFunctorType texturesFunctor;
+  texturesFunctor.SetNumberOfBinsPerAxis(m_NumberOfBinsPerAxis);
+  double features[TexturesFunctorType::NumberOfFeatures];
+
+  const unsigned int nbComponents = outputPtr->GetNumberOfComponentsPerPixel();
+  std::vector<double> outValues(nbComponents);
+  OutputPixelType outPixel(nbComponents);
+
+  InputRegionType inputLargest = inputPtr->GetLargestPossibleRegion();
+
+  // Set-up progress reporting
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  itk::ImageRegionIteratorWithIndex<OutputImageType> outIt(outputPtr, outputRegionForThread);
+  for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+    {
+    // Compute the region on which co-occurence will be estimated
+    typename InputRegionType::IndexType inputIndex;
+    typename InputRegionType::SizeType inputSize;
+    for (unsigned int dim = 0; dim < InputImageType::ImageDimension; ++dim)
+      {
+      inputIndex[dim] = outIt.GetIndex()[dim] * m_SubsampleFactor[dim] + m_SubsampleOffset[dim]
+        + inputLargest.GetIndex(dim) - m_Radius[dim];
+      inputSize[dim] = 2 * m_Radius[dim] + 1;
+      }
+
+    InputRegionType inputRegion;
+    inputRegion.SetIndex(inputIndex);
+    inputRegion.SetSize(inputSize);
+    inputRegion.Crop(inputPtr->GetRequestedRegion());
+
+    std::fill(outValues.begin(), outValues.end(), 0.);
+    for (unsigned int b = 0; b < nbBands; ++b)
+      {
+      for (unsigned int o = 0; o < nbOffsets; ++o)
+        {
+        SlidingWindowType * window = slidingWindows[b * nbOffsets + o];
+        window->SetWindow(inputRegion);
+        texturesFunctor(window->GetCooccurrenceList(), features);
+
+        const unsigned int first = (b * nbOutputOffsets + (m_AverageOffsets ? 0 : o)) * nbFeatures;
+        for (unsigned int f = 0; f < nbFeatures; ++f)
+          {
+          outValues[first + f] += features[f] * offsetWeight;
+          }
+        }
+      }
+    for (unsigned int c = 0; c < nbComponents; ++c)
+      {
+      outPixel[c] = static_cast<OutputInternalPixelType>(outValues[c]);
+      }
+    outIt.Set(outPixel);
+
+    // Update progress
+    progress.CompletedPixel();
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::AfterThreadedGenerateData()
+{
+  m_QuantizedBands.clear();
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Radius: " << m_Radius << std::endl;
+  os << indent << "Number of offsets: " << m_Offsets.size() << std::endl;
+  os << indent << "Number of bins per axis: " << m_NumberOfBinsPerAxis << std::endl;
+  os << indent << "Input image minimum: " << m_InputImageMinimum << std::endl;
+  os << indent << "Input image maximum: " << m_InputImageMaximum << std::endl;
+  os << indent << "Average offsets: " << m_AverageOffsets << std::endl;
+}
+
+} // End namespace otb
+
+#endif
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbGreyLevelCooccurrenceSlidingWindow.h"
+#include "itkImageRegionIterator.h"
+#include "itkConstNeighborhoodIterator.h"
+#include "itkImage.h"
+#include <algorithm>
+#include <cstdlib>
+
+int otbGreyLevelCooccurrenceSlidingWindow(int, char* [] )
+{
+  typedef unsigned char InputPixelType;
+  typedef itk::Image<InputPixelType, 2> InputImageType;
+  typedef InputImageType::RegionType InputRegionType;
+  typedef otb::GreyLevelCooccurrenceSlidingWindow<InputImageType> SlidingWindowType;
+  typedef SlidingWindowType::CooccurrenceIndexedListType CooccurrenceIndexedListType;
+
+  // Build an image with pseudo-random grey levels in [0, 15]
+  InputImageType::SizeType imageSize = {{ 23, 17 }};
+  InputImageType::IndexType imageIndex = {{ 0, 0 }};
+  InputRegionType imageRegion(imageIndex, imageSize);
+  InputImageType::Pointer image = InputImageType::New();
+  image->SetRegions(imageRegion);
+  image->Allocate();
+
+  unsigned int seed = 12345;
+  itk::ImageRegionIterator<InputImageType> imageIt(image, imageRegion);
+  for (imageIt.GoToBegin(); !imageIt.IsAtEnd(); ++imageIt)
+    {
+    seed = seed * 1103515245 + 12345;
+    imageIt.Set(static_cast<InputPixelType>((seed >> 16) % 16));
+    }
+
+  const unsigned int nbBins = 8;
+  const InputImageType::OffsetType offsets[3] = {{{ 1, 0 }}, {{ 2, -1 }}, {{ -1, 2 }}};
+  const InputImageType::SizeType radius = {{ 3, 2 }};
+  const unsigned int step = 2;
+
+  bool passed = true;
+  for (unsigned int o = 0; o < 3; ++o)
+    {
+    const InputImageType::OffsetType & offset = offsets[o];
+    InputImageType::SizeType neighborhoodRadius;
+    neighborhoodRadius.Fill(std::max(std::abs(offset[0]), std::abs(offset[1])));
+
+    SlidingWindowType::Pointer slidingWindow = SlidingWindowType::New();
+    slidingWindow->Initialize(image, offset, nbBins, 0, 15);
+
+    for (long y = 0; y < static_cast<long>(imageSize[1]); ++y)
+      {
+      for (long x = 0; x < static_cast<long>(imageSize[0]); x += step)
+        {
+        // Cropped window centered on (x, y)
+        InputImageType::IndexType windowIndex = {{ x - static_cast<long>(radius[0]), y - static_cast<long>(radius[1]) }};
+        InputImageType::SizeType windowSize = {{ 2 * radius[0] + 1, 2 * radius[1] + 1 }};
+        InputRegionType window(windowIndex, windowSize);
+        window.Crop(imageRegion);
+
+        slidingWindow->SetWindow(window);
+        CooccurrenceIndexedListType * incremental = slidingWindow->GetCooccurrenceList();
+
+        // Reference list built from the whole window
+        CooccurrenceIndexedListType::Pointer reference = CooccurrenceIndexedListType::New();
+        reference->Initialize(nbBins, 0, 15);
+        typedef itk::ConstNeighborhoodIterator<InputImageType> NeighborhoodIteratorType;
+        NeighborhoodIteratorType neighborIt(neighborhoodRadius, image, window);
+        for (neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt)
+          {
+          bool pixelInBounds;
+          const InputPixelType pixelIntensity = neighborIt.GetPixel(offset, pixelInBounds);
+          if (pixelInBounds)
+            {
+            reference->AddPixelPair(neighborIt.GetCenterPixel(), pixelIntensity);
+            }
+          }
+
+        if (incremental->GetTotalFrequency() != reference->GetTotalFrequency()
+            || incremental->GetVector().size() != reference->GetVector().size())
+          {
+          std::cerr << "Offset " << offset << ", window " << windowIndex << ": expected total frequency "
+                    << reference->GetTotalFrequency() << " and " << reference->GetVector().size()
+                    << " pairs, got " << incremental->GetTotalFrequency() << " and "
+                    << incremental->GetVector().size() << std::endl;
+          passed = false;
+          continue;
+          }
+
+        // Both lists are sorted by bin index, whatever the order in which
+        // their pairs were added and removed
+        reference->SortPairs();
+        if (incremental->GetVector() != reference->GetVector())
+          {
+          std::cerr << "Offset " << offset << ", window " << windowIndex
+                    << ": pairs are not sorted as in the reference" << std::endl;
+          passed = false;
+          }
+
+        for (unsigned int i = 0; i < nbBins; ++i)
+          {
+          for (unsigned int j = 0; j < nbBins; ++j)
+            {
+            if (incremental->GetFrequency(i, j, incremental->GetVector())
+                != reference->GetFrequency(i, j, reference->GetVector()))
+              {
+              std::cerr << "Offset " << offset << ", window " << windowIndex << ": wrong frequency for bins ("
+                        << i << ", " << j << ")" << std::endl;
+              passed = false;
+              }
+            }
+          }
+        }
+      }
+    }
+
+  if (!passed)
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cerr << "Test succeeded" << std::endl;
+  return EXIT_SUCCESS;
+}
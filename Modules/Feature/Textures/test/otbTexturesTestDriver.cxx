@@ -25,8 +25,10 @@ void RegisterTests()
   REGISTER_TEST(otbScalarImageToHigherOrderTexturesFilter);
   REGISTER_TEST(otbHaralickTexturesImageFunction);
   REGISTER_TEST(otbGreyLevelCooccurrenceIndexedList);
+  REGISTER_TEST(otbGreyLevelCooccurrenceSlidingWindow);
   REGISTER_TEST(otbScalarImageToTexturesFilter);
   REGISTER_TEST(otbSFSTexturesImageFilterTest);
   REGISTER_TEST(otbScalarImageToAdvancedTexturesFilter);
   REGISTER_TEST(otbScalarImageToPanTexTextureFilter);
+  REGISTER_TEST(otbVectorImageToTexturesFilter);
 }
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbVectorImageToTexturesFilter.h"
+#include "otbScalarImageToTexturesFilter.h"
+#include "otbVectorImage.h"
+#include "otbImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include <algorithm>
+#include <cmath>
+
+int otbVectorImageToTexturesFilter(int argc, char * argv[])
+{
+  if (argc != 4)
+    {
+    std::cerr << "Usage: " << argv[0] << " nbBins radius step" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const unsigned int nbBins = atoi(argv[1]);
+  const unsigned int radius = atoi(argv[2]);
+  const unsigned int step   = atoi(argv[3]);
+
+  const unsigned int Dimension = 2;
+  typedef float                                  PixelType;
+  typedef otb::VectorImage<PixelType, Dimension> VectorImageType;
+  typedef otb::Image<PixelType, Dimension>       ImageType;
+  typedef otb::VectorImageToTexturesFilter<VectorImageType, VectorImageType> VectorTexturesFilterType;
+  typedef otb::ScalarImageToTexturesFilter<ImageType, ImageType>             ScalarTexturesFilterType;
+
+  // Build a 2 bands image: a smooth pattern with some noise, and pure noise
+  const unsigned int nbBands = 2;
+  VectorImageType::SizeType size = {{ 61, 47 }};
+  VectorImageType::IndexType index = {{ 0, 0 }};
+  VectorImageType::RegionType region(index, size);
+  VectorImageType::Pointer image = VectorImageType::New();
+  image->SetRegions(region);
+  image->SetNumberOfComponentsPerPixel(nbBands);
+  image->Allocate();
+
+  std::vector<ImageType::Pointer> bands(nbBands);
+  for (unsigned int b = 0; b < nbBands; ++b)
+    {
+    bands[b] = ImageType::New();
+    bands[b]->SetRegions(region);
+    bands[b]->Allocate();
+    }
+
+  unsigned int seed = 4242;
+  VectorImageType::PixelType pixel(nbBands);
+  itk::ImageRegionIteratorWithIndex<VectorImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    seed = seed * 1103515245 + 12345;
+    const double noise = static_cast<double>((seed >> 16) % 256);
+    pixel[0] = static_cast<PixelType>(127.5 + 100. * std::cos(0.2 * it.GetIndex()[0]) * std::sin(0.15 * it.GetIndex()[1])
+                                      + 0.1 * noise);
+    pixel[1] = static_cast<PixelType>(noise);
+    it.Set(pixel);
+    for (unsigned int b = 0; b < nbBands; ++b)
+      {
+      bands[b]->SetPixel(it.GetIndex(), pixel[b]);
+      }
+    }
+
+  VectorTexturesFilterType::SizeType sradius;
+  sradius.Fill(radius);
+  VectorTexturesFilterType::SizeType stepping;
+  stepping.Fill(step);
+  VectorTexturesFilterType::OffsetType stepOffset;
+  stepOffset.Fill((step - 1) / 2);
+
+  VectorTexturesFilterType::OffsetListType offsets;
+  VectorTexturesFilterType::OffsetType offset;
+  offset[0] = 1; offset[1] = 0;
+  offsets.push_back(offset);
+  offset[0] = 1; offset[1] = -1;
+  offsets.push_back(offset);
+  offset[0] = 0; offset[1] = 2;
+  offsets.push_back(offset);
+  const unsigned int nbOffsets = offsets.size();
+  const unsigned int nbFeatures = 8;
+
+  VectorTexturesFilterType::Pointer filter = VectorTexturesFilterType::New();
+  filter->SetInput(image);
+  filter->SetRadius(sradius);
+  filter->SetOffsets(offsets);
+  filter->SetNumberOfBinsPerAxis(nbBins);
+  filter->SetInputImageMinimum(0);
+  filter->SetInputImageMaximum(255);
+  filter->SetSubsampleFactor(stepping);
+  filter->SetSubsampleOffset(stepOffset);
+  filter->Update();
+
+  VectorTexturesFilterType::Pointer averageFilter = VectorTexturesFilterType::New();
+  averageFilter->SetInput(image);
+  averageFilter->SetRadius(sradius);
+  averageFilter->SetOffsets(offsets);
+  averageFilter->SetNumberOfBinsPerAxis(nbBins);
+  averageFilter->SetInputImageMinimum(0);
+  averageFilter->SetInputImageMaximum(255);
+  averageFilter->SetSubsampleFactor(stepping);
+  averageFilter->SetSubsampleOffset(stepOffset);
+  averageFilter->AverageOffsetsOn();
+  averageFilter->Update();
+
+  if (filter->GetOutput()->GetNumberOfComponentsPerPixel() != nbBands * nbOffsets * nbFeatures
+      || averageFilter->GetOutput()->GetNumberOfComponentsPerPixel() != nbBands * nbFeatures)
+    {
+    std::cerr << "Wrong number of output components" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Compare each band and offset to the scalar filter
+  bool passed = true;
+  for (unsigned int b = 0; b < nbBands; ++b)
+    {
+    for (unsigned int o = 0; o < nbOffsets; ++o)
+      {
+      ScalarTexturesFilterType::Pointer scalarFilter = ScalarTexturesFilterType::New();
+      scalarFilter->SetInput(bands[b]);
+      scalarFilter->SetRadius(sradius);
+      scalarFilter->SetOffset(offsets[o]);
+      scalarFilter->SetNumberOfBinsPerAxis(nbBins);
+      scalarFilter->SetInputImageMinimum(0);
+      scalarFilter->SetInputImageMaximum(255);
+      scalarFilter->SetSubsampleFactor(stepping);
+      scalarFilter->SetSubsampleOffset(stepOffset);
+      scalarFilter->Update();
+
+      for (unsigned int f = 0; f < nbFeatures && passed; ++f)
+        {
+        const unsigned int component = (b * nbOffsets + o) * nbFeatures + f;
+        ImageType * scalarOutput = static_cast<ImageType *>(scalarFilter->GetOutput(f));
+        if (scalarOutput->GetLargestPossibleRegion() != filter->GetOutput()->GetLargestPossibleRegion())
+          {
+          std::cerr << "Output regions differ" << std::endl;
+          return EXIT_FAILURE;
+          }
+        itk::ImageRegionConstIterator<ImageType> scalarIt(scalarOutput, scalarOutput->GetLargestPossibleRegion());
+        itk::ImageRegionConstIterator<VectorImageType> vectorIt(filter->GetOutput(),
+                                                               scalarOutput->GetLargestPossibleRegion());
+        itk::ImageRegionConstIterator<VectorImageType> averageIt(averageFilter->GetOutput(),
+                                                                scalarOutput->GetLargestPossibleRegion());
+        for (scalarIt.GoToBegin(), vectorIt.GoToBegin(); !scalarIt.IsAtEnd(); ++scalarIt, ++vectorIt)
+          {
+          const double expected = scalarIt.Get();
+          const double value = vectorIt.Get()[component];
+          if (std::abs(value - expected) > 1e-5 * std::max(1., std::abs(expected)))
+            {
+            std::cerr << "Band " << b << ", offset " << offsets[o] << ", feature " << f << " at "
+                      << scalarIt.GetIndex() << ": expected " << expected << ", got " << value << std::endl;
+            passed = false;
+            break;
+            }
+          }
+
+        // Check the average over offsets
+        if (o == 0)
+          {
+          for (averageIt.GoToBegin(), vectorIt.GoToBegin(); !averageIt.IsAtEnd(); ++averageIt, ++vectorIt)
+            {
+            double expectedAverage = 0.;
+            for (unsigned int k = 0; k < nbOffsets; ++k)
+              {
+              expectedAverage += vectorIt.Get()[(b * nbOffsets + k) * nbFeatures + f];
+              }
+            expectedAverage /= nbOffsets;
+            const double average = averageIt.Get()[b * nbFeatures + f];
+            if (std::abs(average - expectedAverage) > 1e-5 * std::max(1., std::abs(expectedAverage)))
+              {
+              std::cerr << "Band " << b << ", feature " << f << " at " << averageIt.GetIndex()
+                        << ": expected average " << expectedAverage << ", got " << average << std::endl;
+              passed = false;
+              break;
+              }
+            }
+          }
+        }
+      }
+    }
+
+  if (!passed)
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
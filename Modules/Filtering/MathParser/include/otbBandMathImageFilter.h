@@ -28,6 +28,7 @@
 #include "itkArray.h"
 
 #include "otbParser.h"
+#include "otbRowParser.h"
 #include <string>
 
 namespace otb
@@ -70,6 +71,10 @@ namespace otb
  * This functionality assumes that all the band involved have the same
  * spacing and origin.
  *
+ * By default, the expression is compiled by a RowParser and evaluated on
+ * whole image rows. If the expression uses a feature this parser does not
+ * support, or if RowEvaluation is off, each pixel is evaluated by a Parser.
+ *
  *
  * \sa Parser
  *
@@ -105,6 +110,7 @@ public:
   typedef typename ImageType::PointType           OrigineType;
   typedef typename ImageType::SpacingType         SpacingType;
   typedef Parser                                  ParserType;
+  typedef RowParser                               RowParserType;
   typedef itk::ProcessObject::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
 
   /** Set the nth filter input with or without a specified associated variable name */
@@ -127,6 +133,11 @@ public:
   /** Return a pointer on the nth filter input */
   ImageType * GetNthInput(DataObjectPointerArraySizeType idx);
 
+  /** Evaluate the expression on whole rows when possible (on by default) */
+  itkSetMacro(RowEvaluation, bool);
+  itkGetConstMacro(RowEvaluation, bool);
+  itkBooleanMacro(RowEvaluation);
+
 protected :
   BandMathImageFilter();
   ~BandMathImageFilter() override;
@@ -136,12 +147,18 @@ protected :
   void ThreadedGenerateData(const ImageRegionType& outputRegionForThread, itk::ThreadIdType threadId ) override;
   void AfterThreadedGenerateData() override;
 
+  /** Evaluate the expression row by row with the RowParser of the thread */
+  void RowThreadedGenerateData(const ImageRegionType& outputRegionForThread, itk::ThreadIdType threadId );
+
 private :
   BandMathImageFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
 
   std::string                           m_Expression;
   std::vector<ParserType::Pointer>      m_VParser;
+  std::vector<RowParserType::Pointer>   m_VRowParser;
+  bool                                  m_RowEvaluation;
+  bool                                  m_UseRowParser;
   std::vector< std::vector<double> >    m_AImage;
   std::vector< std::string >            m_VVarName;
   unsigned int                          m_NbVar;
@@ -24,11 +24,13 @@
 #include "otbBandMathImageFilter.h"
 
 #include "itkImageRegionIterator.h"
+#include "itkImageScanlineIterator.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
 #include "otbMacro.h"
 
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 
@@ -45,6 +47,9 @@ BandMathImageFilter<TImage>
   this->SetNumberOfRequiredInputs( 1 );
   this->InPlaceOff();
 
+  m_RowEvaluation = true;
+  m_UseRowParser = false;
+
   m_UnderflowCount = 0;
   m_OverflowCount = 0;
   m_ThreadUnderflow.SetSize(1);
@@ -65,6 +70,7 @@ void BandMathImageFilter<TImage>
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Expression: "      << m_Expression                  << std::endl;
+  os << indent << "RowEvaluation: "   << m_RowEvaluation               << std::endl;
   os << indent << "Computed values follow:"                            << std::endl;
   os << indent << "UnderflowCount: "  << m_UnderflowCount              << std::endl;
   os << indent << "OverflowCount: "   << m_OverflowCount               << std::endl;
@@ -188,11 +194,37 @@ void BandMathImageFilter<TImage>
   m_ThreadUnderflow.Fill(0);
   m_ThreadOverflow.SetSize(nbThreads);
   m_ThreadOverflow.Fill(0);
-  m_VParser.resize(nbThreads);
-  m_AImage.resize(nbThreads);
   m_NbVar = nbInputImages+nbAccessIndex;
   m_VVarName.resize(m_NbVar);
 
+  for(j=nbInputImages; j < nbInputImages+nbAccessIndex; ++j)
+    {
+    m_VVarName[j] = tmpIdxVarNames[j-nbInputImages];
+    }
+
+  // Try to compile the expression for the row evaluation first
+  m_UseRowParser = false;
+  m_VRowParser.clear();
+  if(m_RowEvaluation)
+    {
+    m_UseRowParser = true;
+    m_VRowParser.resize(nbThreads);
+    for(i = 0; i < nbThreads && m_UseRowParser; ++i)
+      {
+      m_VRowParser[i] = RowParserType::New();
+      m_UseRowParser = m_VRowParser[i]->Compile(m_Expression, m_VVarName);
+      }
+    if(m_UseRowParser)
+      {
+      return;
+      }
+    otbMsgDevMacro(<< "Expression " << m_Expression << " is evaluated pixel by pixel");
+    m_VRowParser.clear();
+    }
+
+  m_VParser.resize(nbThreads);
+  m_AImage.resize(nbThreads);
+
   for(itParser = m_VParser.begin(); itParser < m_VParser.end(); itParser++)
     {
     *itParser = ParserType::New();
@@ -203,16 +235,10 @@ void BandMathImageFilter<TImage>
     m_AImage[i].resize(m_NbVar);
     m_VParser[i]->SetExpr(m_Expression);
 
-    for(j=0; j < nbInputImages; ++j)
+    for(j=0; j < m_NbVar; ++j)
       {
       m_VParser[i]->DefineVar(m_VVarName[j], &(m_AImage[i][j]));
       }
-
-    for(j=nbInputImages; j < nbInputImages+nbAccessIndex; ++j)
-      {
-      m_VVarName[j] = tmpIdxVarNames[j-nbInputImages];
-      m_VParser[i]->DefineVar(m_VVarName[j], &(m_AImage[i][j]));
-      }
     }
 }
 
@@ -248,6 +274,12 @@ void BandMathImageFilter<TImage>
 ::ThreadedGenerateData(const ImageRegionType& outputRegionForThread,
            itk::ThreadIdType threadId)
 {
+  if(m_UseRowParser)
+    {
+    this->RowThreadedGenerateData(outputRegionForThread, threadId);
+    return;
+    }
+
   double value;
   unsigned int j;
   unsigned int nbInputImages = this->GetNumberOfInputs();
@@ -331,6 +363,122 @@ void BandMathImageFilter<TImage>
     }
 }
 
+template< typename TImage >
+void BandMathImageFilter<TImage>
+::RowThreadedGenerateData(const ImageRegionType& outputRegionForThread,
+           itk::ThreadIdType threadId)
+{
+  typedef itk::ImageScanlineConstIterator<TImage> ScanlineConstIteratorType;
+  typedef itk::ImageScanlineIterator<TImage>      ScanlineIteratorType;
+
+  const unsigned int nbInputImages = this->GetNumberOfInputs();
+  const std::size_t width = outputRegionForThread.GetSize(0);
+  const IndexType startIndex = outputRegionForThread.GetIndex();
+  RowParserType * threadParser = m_VRowParser[threadId];
+
+  // One row of values per variable read by the expression
+  std::vector< std::vector<double> > rows(m_NbVar);
+  std::vector< const double * >      rowPointers(m_NbVar, nullptr);
+  for(unsigned int j = 0; j < m_NbVar; ++j)
+    {
+    if(threadParser->IsVariableUsed(j))
+      {
+      rows[j].resize(width);
+      rowPointers[j] = rows[j].data();
+      }
+    }
+
+  std::vector< unsigned int >              usedInputs;
+  std::vector< ScanlineConstIteratorType > Vit;
+  for(unsigned int j = 0; j < nbInputImages; ++j)
+    {
+    if(threadParser->IsVariableUsed(j))
+      {
+      usedInputs.push_back(j);
+      Vit.push_back(ScanlineConstIteratorType(this->GetNthInput(j), outputRegionForThread));
+      }
+    }
+
+  // idxX and idxPhyX do not depend on the row
+  const unsigned int idxX = nbInputImages;
+  const unsigned int idxY = nbInputImages + 1;
+  const unsigned int idxPhyX = nbInputImages + 2;
+  const unsigned int idxPhyY = nbInputImages + 3;
+  for(std::size_t x = 0; x < width; ++x)
+    {
+    const double index = static_cast<double>(startIndex[0] + static_cast<typename IndexType::IndexValueType>(x));
+    if(rowPointers[idxX])
+      {
+      rows[idxX][x] = index;
+      }
+    if(rowPointers[idxPhyX])
+      {
+      rows[idxPhyX][x] = static_cast<double>(m_Origin[0]) + index * static_cast<double>(m_Spacing[0]);
+      }
+    }
+
+  ScanlineIteratorType ot(this->GetOutput(), outputRegionForThread);
+  std::vector<double> values(width);
+
+  // support progress methods/callbacks
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  long & threadUnderflow = m_ThreadUnderflow[threadId];
+  long & threadOverflow  = m_ThreadOverflow[threadId];
+  const double minValue = double(itk::NumericTraits<PixelType>::NonpositiveMin());
+  const double maxValue = double(itk::NumericTraits<PixelType>::max());
+
+  while(!ot.IsAtEnd())
+    {
+    const double index = static_cast<double>(ot.GetIndex()[1]);
+    if(rowPointers[idxY])
+      {
+      std::fill(rows[idxY].begin(), rows[idxY].end(), index);
+      }
+    if(rowPointers[idxPhyY])
+      {
+      std::fill(rows[idxPhyY].begin(), rows[idxPhyY].end(),
+                static_cast<double>(m_Origin[1]) + index * static_cast<double>(m_Spacing[1]));
+      }
+
+    for(unsigned int k = 0; k < usedInputs.size(); ++k)
+      {
+      double * row = rows[usedInputs[k]].data();
+      ScanlineConstIteratorType & it = Vit[k];
+      while(!it.IsAtEndOfLine())
+        {
+        *row++ = static_cast<double>(it.Get());
+        ++it;
+        }
+      it.NextLine();
+      }
+
+    threadParser->Evaluate(rowPointers.data(), width, values.data());
+
+    // Same saturation as the pixel by pixel evaluation
+    for(std::size_t x = 0; x < width; ++x, ++ot)
+      {
+      const double value = values[x];
+      if (value < minValue)
+        {
+        ot.Set(itk::NumericTraits<PixelType>::NonpositiveMin());
+        threadUnderflow++;
+        }
+      else if (value > maxValue)
+        {
+        ot.Set(itk::NumericTraits<PixelType>::max());
+        threadOverflow++;
+        }
+      else
+        {
+        ot.Set(static_cast<PixelType>(value));
+        }
+      progress.CompletedPixel();
+      }
+    ot.NextLine();
+    }
+}
+
 }// end namespace otb
 
 #endif
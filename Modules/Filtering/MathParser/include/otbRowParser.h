@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbRowParser_h
+#define otbRowParser_h
+
+#include "itkLightObject.h"
+#include "itkObjectFactory.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace otb
+{
+
+/** \class RowParser
+ * \brief Evaluate a mathematical expression on whole rows of values.
+ *
+ * This parser compiles an expression into a short program of vector
+ * instructions. Each instruction applies one operator or function to
+ * arrays of values, so that an expression is evaluated on a complete image
+ * row with one tight loop per operator instead of one interpreter call per
+ * pixel. Operands are read directly from the rows of the variables, and
+ * constant sub-expressions are computed once at compile time.
+ *
+ * The accepted syntax is the subset of the muParser syntax used by Parser
+ * which can be evaluated with the same results:
+ * - numbers, variables and the constants e, log2e, log10e, ln2, ln10, pi,
+ *   euler, _e and _pi,
+ * - the operators + - * / ^, the unary minus, the comparison operators
+ *   < > <= >= == !=, the logical operators && || and the ternary
+ *   operator ?:, with the muParser precedences,
+ * - the functions sin cos tan asin acos atan sinh cosh tanh asinh acosh
+ *   atanh log2 log10 ln exp sqrt sign rint abs, the variadic functions
+ *   min max sum avg, and the OTB functions ndvi (or NDVI) and atan2.
+ *
+ * Compile() returns false for any other expression (for instance one using
+ * if(), log, the "and" and "or" operators or chained powers), in which case
+ * the caller is expected to fall back to Parser.
+ *
+ * With SetSyntax(MuParserXSyntax), the accepted syntax is instead the subset
+ * of the muParserX syntax used by ParserX: the constants _e and _pi and the
+ * functions sign, rint, avg, atan2 and NDVI are rejected, and the operators
+ * == and != have a lower precedence than < > <= >=. The caller is then
+ * expected to fall back to ParserX.
+ *
+ * Several expressions can be compiled together into a single program:
+ * identical sub-expressions (up to the order of the operands of commutative
+ * operators) are then computed only once for all the expressions.
+ *
+ * The evaluation uses internal buffers: a RowParser must not be shared by
+ * several threads.
+ *
+ * \sa Parser
+ * \sa BandMathImageFilter
+ *
+ * \ingroup OTBMathParser
+ */
+class ITK_EXPORT RowParser : public itk::LightObject
+{
+public:
+  /** Standard class typedefs. */
+  typedef RowParser                                Self;
+  typedef itk::LightObject                         Superclass;
+  typedef itk::SmartPointer<Self>                  Pointer;
+  typedef itk::SmartPointer<const Self>            ConstPointer;
+
+  /** New macro for creation of through a Smart Pointer */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods) */
+  itkTypeMacro(RowParser, itk::LightObject);
+
+  /** Convenient type definitions */
+  typedef double                                   ValueType;
+
+  /** Grammar of the compiled expressions */
+  typedef enum
+  {
+    MuParserSyntax,
+    MuParserXSyntax
+  } SyntaxType;
+
+  /** Set the grammar used by the next calls to Compile(). The default is
+   * MuParserSyntax. Setting it discards the compiled expressions. */
+  void SetSyntax(SyntaxType syntax);
+
+  /** Get the grammar used by Compile() */
+  SyntaxType GetSyntax() const;
+
+  /** Compile an expression of the given variables. The index of a variable
+   * in varNames is the index of its row in Evaluate(). Returns false if the
+   * expression is not supported. */
+  bool Compile(const std::string & expression, const std::vector<std::string> & varNames);
+
+  /** Compile several expressions sharing their common sub-expressions.
+   * Returns false if one of the expressions is not supported. */
+  bool Compile(const std::vector<std::string> & expressions, const std::vector<std::string> & varNames);
+
+  /** Return true if the last call to Compile() succeeded */
+  bool IsCompiled() const;
+
+  /** Return the number of compiled expressions */
+  unsigned int GetNumberOfExpressions() const;
+
+  /** Return true if the compiled expression reads the variable var */
+  bool IsVariableUsed(unsigned int var) const;
+
+  /** Evaluate the compiled expression on n values:
+   * out[i] = f(vars[0][i], vars[1][i], ...). The rows of the unused
+   * variables may be null. */
+  void Evaluate(const ValueType * const * vars, std::size_t n, ValueType * out);
+
+  /** Evaluate all the compiled expressions on n values: the kth expression
+   * is written in outs[k]. The output rows must not overlap the variable
+   * rows. */
+  void Evaluate(const ValueType * const * vars, std::size_t n, ValueType * const * outs);
+
+protected:
+  RowParser();
+  ~RowParser() override;
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+private:
+  RowParser(const Self &) = delete;
+  void operator =(const Self &) = delete;
+
+  SyntaxType m_Syntax;
+
+  struct Program;
+  std::unique_ptr<Program> m_Program;
+}; // end class
+
+}//end namespace otb
+
+#endif
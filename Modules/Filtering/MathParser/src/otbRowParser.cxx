@@ -0,0 +1,1041 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbMath.h"
+#include "otbRowParser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <locale>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+namespace otb
+{
+
+namespace
+{
+
+/** Number of values processed by each instruction at once, so that the
+ * registers stay in cache */
+const std::size_t RowParserChunkSize = 512;
+
+/** Operations of the row programs */
+enum OpCode
+{
+  OpConstant, OpVariable,
+  OpSelect,
+  OpAdd, OpSub, OpMul, OpDiv, OpPow,
+  OpLess, OpGreater, OpLessEqual, OpGreaterEqual, OpEqual, OpNotEqual,
+  OpAnd, OpOr, OpMin, OpMax, OpAtan2, OpNdvi,
+  OpNeg, OpSquare,
+  OpSin, OpCos, OpTan, OpASin, OpACos, OpATan, OpSinh, OpCosh, OpTanh,
+  OpASinh, OpACosh, OpATanh, OpLog2, OpLog10, OpLn, OpExp, OpSqrt,
+  OpSign, OpRint, OpAbs
+};
+
+unsigned int GetArity(OpCode op)
+{
+  if (op == OpConstant || op == OpVariable)
+    {
+    return 0;
+    }
+  if (op == OpSelect)
+    {
+    return 3;
+    }
+  return op >= OpNeg ? 1 : 2;
+}
+
+template <class TFunction>
+inline void ApplyUnary(std::size_t n, double * d, const double * a, TFunction f)
+{
+  for (std::size_t i = 0; i < n; ++i)
+    {
+    d[i] = f(a[i]);
+    }
+}
+
+template <class TFunction>
+inline void ApplyBinary(std::size_t n, double * d, const double * a, const double * b, TFunction f)
+{
+  for (std::size_t i = 0; i < n; ++i)
+    {
+    d[i] = f(a[i], b[i]);
+    }
+}
+
+/** Apply an operation on n values. The destination may be one of the
+ * operands. The functions follow the muParser definitions, so that both
+ * parsers give the same results. */
+void Execute(OpCode op, std::size_t n, double * d, const double * a, const double * b, const double * c)
+{
+  switch (op)
+    {
+    case OpSelect:
+      for (std::size_t i = 0; i < n; ++i)
+        {
+        d[i] = a[i] != 0. ? b[i] : c[i];
+        }
+      break;
+    case OpAdd:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return x + y; });
+      break;
+    case OpSub:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return x - y; });
+      break;
+    case OpMul:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return x * y; });
+      break;
+    case OpDiv:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return x / y; });
+      break;
+    case OpPow:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return std::pow(x, y); });
+      break;
+    case OpLess:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return x < y ? 1. : 0.; });
+      break;
+    case OpGreater:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return x > y ? 1. : 0.; });
+      break;
+    case OpLessEqual:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return x <= y ? 1. : 0.; });
+      break;
+    case OpGreaterEqual:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return x >= y ? 1. : 0.; });
+      break;
+    case OpEqual:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return x == y ? 1. : 0.; });
+      break;
+    case OpNotEqual:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return x != y ? 1. : 0.; });
+      break;
+    case OpAnd:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return (x != 0. && y != 0.) ? 1. : 0.; });
+      break;
+    case OpOr:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return (x != 0. || y != 0.) ? 1. : 0.; });
+      break;
+    case OpMin:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return std::min(x, y); });
+      break;
+    case OpMax:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return std::max(x, y); });
+      break;
+    case OpAtan2:
+      ApplyBinary(n, d, a, b, [](double x, double y) { return std::atan2(x, y); });
+      break;
+    case OpNdvi:
+      ApplyBinary(n, d, a, b, [](double r, double niri)
+                  { return std::abs(r + niri) < 1E-6 ? 0. : (niri - r) / (niri + r); });
+      break;
+    case OpNeg:
+      ApplyUnary(n, d, a, [](double x) { return -x; });
+      break;
+    case OpSquare:
+      ApplyUnary(n, d, a, [](double x) { return x * x; });
+      break;
+    case OpSin:
+      ApplyUnary(n, d, a, [](double x) { return std::sin(x); });
+      break;
+    case OpCos:
+      ApplyUnary(n, d, a, [](double x) { return std::cos(x); });
+      break;
+    case OpTan:
+      ApplyUnary(n, d, a, [](double x) { return std::tan(x); });
+      break;
+    case OpASin:
+      ApplyUnary(n, d, a, [](double x) { return std::asin(x); });
+      break;
+    case OpACos:
+      ApplyUnary(n, d, a, [](double x) { return std::acos(x); });
+      break;
+    case OpATan:
+      ApplyUnary(n, d, a, [](double x) { return std::atan(x); });
+      break;
+    case OpSinh:
+      ApplyUnary(n, d, a, [](double x) { return std::sinh(x); });
+      break;
+    case OpCosh:
+      ApplyUnary(n, d, a, [](double x) { return std::cosh(x); });
+      break;
+    case OpTanh:
+      ApplyUnary(n, d, a, [](double x) { return std::tanh(x); });
+      break;
+    case OpASinh:
+      ApplyUnary(n, d, a, [](double x) { return std::log(x + std::sqrt(x * x + 1.)); });
+      break;
+    case OpACosh:
+      ApplyUnary(n, d, a, [](double x) { return std::log(x + std::sqrt(x * x - 1.)); });
+      break;
+    case OpATanh:
+      ApplyUnary(n, d, a, [](double x) { return 0.5 * std::log((1. + x) / (1. - x)); });
+      break;
+    case OpLog2:
+      ApplyUnary(n, d, a, [](double x) { return std::log(x) / std::log(2.); });
+      break;
+    case OpLog10:
+      ApplyUnary(n, d, a, [](double x) { return std::log10(x); });
+      break;
+    case OpLn:
+      ApplyUnary(n, d, a, [](double x) { return std::log(x); });
+      break;
+    case OpExp:
+      ApplyUnary(n, d, a, [](double x) { return std::exp(x); });
+      break;
+    case OpSqrt:
+      ApplyUnary(n, d, a, [](double x) { return std::sqrt(x); });
+      break;
+    case OpSign:
+      ApplyUnary(n, d, a, [](double x) { return x < 0. ? -1. : (x > 0. ? 1. : 0.); });
+      break;
+    case OpRint:
+      ApplyUnary(n, d, a, [](double x) { return std::floor(x + 0.5); });
+      break;
+    case OpAbs:
+      ApplyUnary(n, d, a, [](double x) { return std::abs(x); });
+      break;
+    default:
+      break;
+    }
+}
+
+/** Lexical tokens */
+enum TokenKind
+{
+  TokenNumber, TokenIdentifier, TokenOperator, TokenEnd
+};
+
+struct Token
+{
+  TokenKind   Kind;
+  std::string Text;
+  double      Value;
+};
+
+bool IsIdentifierChar(char c)
+{
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool IsDigit(char c)
+{
+  return std::isdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+/** Split an expression into tokens. Returns false on unknown characters. */
+bool Tokenize(const std::string & expression, std::vector<Token> & tokens)
+{
+  static const char * const twoCharOperators[] = {"&&", "||", "<=", ">=", "==", "!="};
+  static const std::string oneCharOperators = "+-*/^<>(),?:";
+
+  const std::size_t size = expression.size();
+  std::size_t pos = 0;
+  while (pos < size)
+    {
+    const char c = expression[pos];
+    if (std::isspace(static_cast<unsigned char>(c)))
+      {
+      ++pos;
+      continue;
+      }
+
+    Token token;
+    token.Value = 0.;
+    const std::size_t start = pos;
+    if (IsDigit(c) || (c == '.' && pos + 1 < size && IsDigit(expression[pos + 1])))
+      {
+      while (pos < size && IsDigit(expression[pos])) ++pos;
+      if (pos < size && expression[pos] == '.')
+        {
+        ++pos;
+        while (pos < size && IsDigit(expression[pos])) ++pos;
+        }
+      if (pos < size && (expression[pos] == 'e' || expression[pos] == 'E'))
+        {
+        std::size_t exponent = pos + 1;
+        if (exponent < size && (expression[exponent] == '+' || expression[exponent] == '-'))
+          {
+          ++exponent;
+          }
+        if (exponent < size && IsDigit(expression[exponent]))
+          {
+          pos = exponent;
+          while (pos < size && IsDigit(expression[pos])) ++pos;
+          }
+        }
+      // Reject numbers glued to a name, such as "2b1"
+      if (pos < size && IsIdentifierChar(expression[pos]))
+        {
+        return false;
+        }
+      token.Kind = TokenNumber;
+      token.Text = expression.substr(start, pos - start);
+      std::istringstream stream(token.Text);
+      stream.imbue(std::locale::classic());
+      stream >> token.Value;
+      if (stream.fail())
+        {
+        return false;
+        }
+      }
+    else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+      {
+      while (pos < size && IsIdentifierChar(expression[pos])) ++pos;
+      token.Kind = TokenIdentifier;
+      token.Text = expression.substr(start, pos - start);
+      }
+    else
+      {
+      token.Kind = TokenOperator;
+      for (const char * op : twoCharOperators)
+        {
+        if (expression.compare(pos, 2, op) == 0)
+          {
+          token.Text = op;
+          break;
+          }
+        }
+      if (token.Text.empty())
+        {
+        if (oneCharOperators.find(c) == std::string::npos)
+          {
+          return false;
+          }
+        token.Text = std::string(1, c);
+        }
+      pos += token.Text.size();
+      }
+    tokens.push_back(token);
+    }
+
+  Token end;
+  end.Kind = TokenEnd;
+  end.Value = 0.;
+  tokens.push_back(end);
+  return true;
+}
+
+/** Node of the expression tree */
+struct Node
+{
+  OpCode       Op;
+  double       Value;
+  unsigned int Variable;
+  int          Args[3];
+};
+
+/** Recursive descent parser building the expression graph, with the
+ * precedences of muParser (from lowest to highest):
+ * ?:, ||, &&, comparisons, + -, * /, unary minus, ^
+ * or of muParserX, where == and != bind less than < > <= >=:
+ * ?:, ||, &&, == !=, < > <= >=, + -, * /, unary minus, ^
+ *
+ * Identical nodes are created only once, also across expressions, so that
+ * common sub-expressions are shared. */
+class TreeBuilder
+{
+public:
+  TreeBuilder(const std::vector<std::string> & varNames,
+              std::vector<Node> & nodes,
+              RowParser::SyntaxType syntax)
+    : m_Tokens(nullptr), m_VarNames(varNames), m_Nodes(nodes), m_Position(0),
+      m_MuParserX(syntax == RowParser::MuParserXSyntax)
+  {
+  }
+
+  /** Parse a whole expression. Returns the root node, or -1 if the
+   * expression is not supported. */
+  int Parse(const std::vector<Token> & tokens)
+  {
+    m_Tokens = &tokens;
+    m_Position = 0;
+    const int root = this->ParseTernary();
+    if (root < 0 || this->Current().Kind != TokenEnd)
+      {
+      return -1;
+      }
+    return root;
+  }
+
+private:
+  typedef std::tuple<int, std::uint64_t, unsigned int, int, int, int> NodeKeyType;
+
+  const Token & Current() const
+  {
+    return (*m_Tokens)[m_Position];
+  }
+
+  bool IsOperator(const char * text) const
+  {
+    const Token & token = this->Current();
+    return token.Kind == TokenOperator && token.Text == text;
+  }
+
+  bool Accept(const char * text)
+  {
+    if (this->IsOperator(text))
+      {
+      ++m_Position;
+      return true;
+      }
+    return false;
+  }
+
+  /** Return the node identical to the given one, creating it if needed */
+  int AddNode(const Node & node)
+  {
+    std::uint64_t bits;
+    std::memcpy(&bits, &node.Value, sizeof(bits));
+    const NodeKeyType key(node.Op, bits, node.Variable, node.Args[0], node.Args[1], node.Args[2]);
+    auto it = m_UniqueNodes.find(key);
+    if (it != m_UniqueNodes.end())
+      {
+      return it->second;
+      }
+    m_Nodes.push_back(node);
+    const int id = static_cast<int>(m_Nodes.size()) - 1;
+    m_UniqueNodes.insert(std::make_pair(key, id));
+    return id;
+  }
+
+  int MakeNode(OpCode op, double value, unsigned int var, int a, int b, int c)
+  {
+    Node node;
+    node.Op = op;
+    node.Value = value;
+    node.Variable = var;
+    node.Args[0] = a;
+    node.Args[1] = b;
+    node.Args[2] = c;
+    return this->AddNode(node);
+  }
+
+  int MakeConstant(double value)
+  {
+    return this->MakeNode(OpConstant, value, 0, -1, -1, -1);
+  }
+
+  int MakeVariable(unsigned int var)
+  {
+    return this->MakeNode(OpVariable, 0., var, -1, -1, -1);
+  }
+
+  bool IsConstant(int id) const
+  {
+    return m_Nodes[id].Op == OpConstant;
+  }
+
+  /** Create an operation node, computing it at once if its operands are
+   * constants */
+  int MakeOperation(OpCode op, int a, int b = -1, int c = -1)
+  {
+    if (a < 0 || (GetArity(op) > 1 && b < 0) || (GetArity(op) > 2 && c < 0))
+      {
+      return -1;
+      }
+    if (op == OpSelect && this->IsConstant(a))
+      {
+      return m_Nodes[a].Value != 0. ? b : c;
+      }
+    if (op == OpPow && this->IsConstant(b) && m_Nodes[b].Value == 2.)
+      {
+      return this->MakeOperation(OpSquare, a);
+      }
+
+    const int args[3] = {a, b, c};
+    bool constant = true;
+    double values[3] = {0., 0., 0.};
+    for (unsigned int k = 0; k < GetArity(op); ++k)
+      {
+      constant = constant && this->IsConstant(args[k]);
+      values[k] = m_Nodes[args[k]].Value;
+      }
+    if (constant)
+      {
+      double result = 0.;
+      Execute(op, 1, &result, &values[0], &values[1], &values[2]);
+      return this->MakeConstant(result);
+      }
+
+    // Commutative operations get a canonical order of their operands, so
+    // that a+b and b+a are shared
+    const bool commutative = op == OpAdd || op == OpMul || op == OpEqual
+                             || op == OpNotEqual || op == OpAnd || op == OpOr;
+    if (commutative && b < a)
+      {
+      std::swap(a, b);
+      }
+    return this->MakeNode(op, 0., 0, a, b, GetArity(op) > 2 ? c : -1);
+  }
+
+  int ParseTernary()
+  {
+    const int condition = this->ParseBinary(0);
+    if (condition < 0 || !this->Accept("?"))
+      {
+      return condition;
+      }
+    const int ifTrue = this->ParseTernary();
+    if (ifTrue < 0 || !this->Accept(":"))
+      {
+      return -1;
+      }
+    const int ifFalse = this->ParseTernary();
+    return this->MakeOperation(OpSelect, condition, ifTrue, ifFalse);
+  }
+
+  /** Binary operators of a precedence level, left associative */
+  bool GetBinaryOperator(unsigned int level, OpCode & op) const
+  {
+    const Token & token = this->Current();
+    if (token.Kind != TokenOperator)
+      {
+      return false;
+      }
+    static const struct
+    {
+      unsigned int Level;
+      unsigned int LevelX;
+      const char * Text;
+      OpCode       Op;
+    } operators[] = {
+      {0, 0, "||", OpOr}, {1, 1, "&&", OpAnd},
+      {2, 3, "<", OpLess}, {2, 3, ">", OpGreater}, {2, 3, "<=", OpLessEqual},
+      {2, 3, ">=", OpGreaterEqual}, {2, 2, "==", OpEqual}, {2, 2, "!=", OpNotEqual},
+      {3, 4, "+", OpAdd}, {3, 4, "-", OpSub}, {4, 5, "*", OpMul}, {4, 5, "/", OpDiv}
+    };
+    for (const auto & entry : operators)
+      {
+      if ((m_MuParserX ? entry.LevelX : entry.Level) == level && token.Text == entry.Text)
+        {
+        op = entry.Op;
+        return true;
+        }
+      }
+    return false;
+  }
+
+  int ParseBinary(unsigned int level)
+  {
+    if (level > (m_MuParserX ? 5u : 4u))
+      {
+      return this->ParseUnary();
+      }
+    int left = this->ParseBinary(level + 1);
+    OpCode op;
+    while (left >= 0 && this->GetBinaryOperator(level, op))
+      {
+      ++m_Position;
+      left = this->MakeOperation(op, left, this->ParseBinary(level + 1));
+      }
+    return left;
+  }
+
+  /** The sign binds less than the power: -2^2 is -4 */
+  int ParseUnary()
+  {
+    if (this->Accept("-"))
+      {
+      return this->MakeOperation(OpNeg, this->ParseUnary());
+      }
+    return this->ParsePower();
+  }
+
+  /** The associativity of the power operator changed between muParser
+   * versions: chained powers are left to Parser. */
+  int ParsePower()
+  {
+    const int base = this->ParsePrimary();
+    if (base < 0 || !this->Accept("^"))
+      {
+      return base;
+      }
+    unsigned int signs = 0;
+    while (this->Accept("-"))
+      {
+      ++signs;
+      }
+    int exponent = this->ParsePrimary();
+    for (; signs > 0; --signs)
+      {
+      exponent = this->MakeOperation(OpNeg, exponent);
+      }
+    if (this->IsOperator("^"))
+      {
+      return -1;
+      }
+    return this->MakeOperation(OpPow, base, exponent);
+  }
+
+  int ParsePrimary()
+  {
+    const Token & token = this->Current();
+    if (token.Kind == TokenNumber)
+      {
+      ++m_Position;
+      return this->MakeConstant(token.Value);
+      }
+    if (this->Accept("("))
+      {
+      const int id = this->ParseTernary();
+      return this->Accept(")") ? id : -1;
+      }
+    if (token.Kind != TokenIdentifier)
+      {
+      return -1;
+      }
+    ++m_Position;
+    if (this->Accept("("))
+      {
+      return this->ParseFunction(token.Text);
+      }
+
+    // Constants are looked up before the variables, as in muParser. The
+    // muParser constants _e and _pi are not defined by muParserX.
+    static const struct
+    {
+      const char * Name;
+      double       Value;
+      bool         MuParserX;
+    } constants[] = {
+      {"e", CONST_E, true}, {"log2e", CONST_LOG2E, true}, {"log10e", CONST_LOG10E, true},
+      {"ln2", CONST_LN2, true}, {"ln10", CONST_LN10, true}, {"pi", CONST_PI, true},
+      {"euler", CONST_EULER, true}, {"_e", CONST_E, false}, {"_pi", CONST_PI, false}
+    };
+    for (const auto & constant : constants)
+      {
+      if (token.Text == constant.Name && (constant.MuParserX || !m_MuParserX))
+        {
+        return this->MakeConstant(constant.Value);
+        }
+      }
+    for (std::size_t var = m_VarNames.size(); var > 0; --var)
+      {
+      if (m_VarNames[var - 1] == token.Text)
+        {
+        return this->MakeVariable(static_cast<unsigned int>(var - 1));
+        }
+      }
+    return -1;
+  }
+
+  /** Parse the arguments of a function, the opening parenthesis being
+   * already read */
+  int ParseFunction(const std::string & name)
+  {
+    std::vector<int> args;
+    if (!this->IsOperator(")"))
+      {
+      do
+        {
+        args.push_back(this->ParseTernary());
+        if (args.back() < 0)
+          {
+          return -1;
+          }
+        }
+      while (this->Accept(","));
+      }
+    if (!this->Accept(")") || args.empty())
+      {
+      return -1;
+      }
+
+    // Functions defined by both muParser and muParserX (with the OTB
+    // plugins of Parser and ParserX), or only by muParser
+    static const struct
+    {
+      const char * Name;
+      OpCode       Op;
+      bool         MuParserX;
+    } functions[] = {
+      {"sin", OpSin, true}, {"cos", OpCos, true}, {"tan", OpTan, true}, {"asin", OpASin, true},
+      {"acos", OpACos, true}, {"atan", OpATan, true}, {"sinh", OpSinh, true}, {"cosh", OpCosh, true},
+      {"tanh", OpTanh, true}, {"asinh", OpASinh, true}, {"acosh", OpACosh, true}, {"atanh", OpATanh, true},
+      {"log2", OpLog2, true}, {"log10", OpLog10, true}, {"ln", OpLn, true}, {"exp", OpExp, true},
+      {"sqrt", OpSqrt, true}, {"sign", OpSign, false}, {"rint", OpRint, false}, {"abs", OpAbs, true},
+      {"atan2", OpAtan2, false}, {"ndvi", OpNdvi, true}, {"NDVI", OpNdvi, false}
+    };
+    for (const auto & function : functions)
+      {
+      if (name == function.Name)
+        {
+        if (m_MuParserX && !function.MuParserX)
+          {
+          return -1;
+          }
+        if (args.size() != GetArity(function.Op))
+          {
+          return -1;
+          }
+        return this->MakeOperation(function.Op, args[0], args.size() > 1 ? args[1] : -1);
+        }
+      }
+
+    // Variadic functions, evaluated from left to right as in muParser
+    OpCode op;
+    if (name == "min")
+      {
+      op = OpMin;
+      }
+    else if (name == "max")
+      {
+      op = OpMax;
+      }
+    else if (name == "sum" || (name == "avg" && !m_MuParserX))
+      {
+      op = OpAdd;
+      }
+    else
+      {
+      return -1;
+      }
+    int result = args[0];
+    for (std::size_t k = 1; k < args.size(); ++k)
+      {
+      result = this->MakeOperation(op, result, args[k]);
+      }
+    if (name == "avg")
+      {
+      result = this->MakeOperation(OpDiv, result, this->MakeConstant(static_cast<double>(args.size())));
+      }
+    return result;
+  }
+
+  const std::vector<Token> *       m_Tokens;
+  const std::vector<std::string> & m_VarNames;
+  std::vector<Node> &              m_Nodes;
+  std::size_t                      m_Position;
+  std::map<NodeKeyType, int>       m_UniqueNodes;
+  bool                             m_MuParserX;
+};
+
+/** Operand of an instruction */
+struct Operand
+{
+  enum KindType
+  {
+    Unused, Register, Variable, Constant, Output
+  };
+  KindType     Kind;
+  unsigned int Index;
+};
+
+/** Instruction of a row program: Destination = Op(Args) */
+struct Instruction
+{
+  OpCode       Op;
+  Operand      Destination;
+  Operand      Args[3];
+};
+
+} // end anonymous namespace
+
+/** Compiled expressions */
+struct RowParser::Program
+{
+  std::vector<Instruction>           Instructions;
+  std::vector<Operand>               Results;
+  std::vector<double>                ConstantValues;
+  std::vector< std::vector<double> > Constants;
+  std::vector< std::vector<double> > Registers;
+  std::vector<bool>                  UsedVariables;
+
+  /** Code generation state */
+  std::vector<unsigned int>          FreeRegisters;
+  std::vector<unsigned int>          RemainingUses;
+  std::vector<int>                   OutputOfNode;
+  std::vector<bool>                  Generated;
+  std::vector<Operand>               NodeOperands;
+
+  /** Generate the instructions computing a node and its arguments, in post
+   * order. Shared nodes are computed once, and their register is released
+   * after their last use, before allocating the destination which may thus
+   * be one of the operands. The root of an expression is directly written
+   * in its output row. */
+  Operand Generate(const std::vector<Node> & nodes, int id)
+  {
+    if (Generated[id])
+      {
+      return NodeOperands[id];
+      }
+    Generated[id] = true;
+
+    const Node & node = nodes[id];
+    Operand & result = NodeOperands[id];
+    if (node.Op == OpConstant)
+      {
+      result.Kind = Operand::Constant;
+      result.Index = static_cast<unsigned int>(ConstantValues.size());
+      ConstantValues.push_back(node.Value);
+      return result;
+      }
+    if (node.Op == OpVariable)
+      {
+      result.Kind = Operand::Variable;
+      result.Index = node.Variable;
+      UsedVariables[node.Variable] = true;
+      return result;
+      }
+
+    Instruction instruction;
+    instruction.Op = node.Op;
+    const unsigned int arity = GetArity(node.Op);
+    for (unsigned int k = 0; k < 3; ++k)
+      {
+      instruction.Args[k].Kind = Operand::Unused;
+      instruction.Args[k].Index = 0;
+      }
+    for (unsigned int k = 0; k < arity; ++k)
+      {
+      instruction.Args[k] = this->Generate(nodes, node.Args[k]);
+      }
+    for (unsigned int k = 0; k < arity; ++k)
+      {
+      if (--RemainingUses[node.Args[k]] == 0 && instruction.Args[k].Kind == Operand::Register)
+        {
+        FreeRegisters.push_back(instruction.Args[k].Index);
+        }
+      }
+
+    if (OutputOfNode[id] >= 0)
+      {
+      instruction.Destination.Kind = Operand::Output;
+      instruction.Destination.Index = static_cast<unsigned int>(OutputOfNode[id]);
+      }
+    else
+      {
+      instruction.Destination.Kind = Operand::Register;
+      if (FreeRegisters.empty())
+        {
+        instruction.Destination.Index = static_cast<unsigned int>(Registers.size());
+        Registers.emplace_back(RowParserChunkSize);
+        }
+      else
+        {
+        instruction.Destination.Index = FreeRegisters.back();
+        FreeRegisters.pop_back();
+        }
+      }
+    Instructions.push_back(instruction);
+
+    result = instruction.Destination;
+    return result;
+  }
+};
+
+RowParser::RowParser()
+  : m_Syntax(MuParserSyntax)
+{
+}
+
+RowParser::~RowParser()
+{
+}
+
+void RowParser::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Syntax: " << (m_Syntax == MuParserXSyntax ? "muParserX" : "muParser") << std::endl;
+  os << indent << "Compiled: " << this->IsCompiled() << std::endl;
+  if (m_Program)
+    {
+    os << indent << "Number of expressions: " << m_Program->Results.size() << std::endl;
+    os << indent << "Number of instructions: " << m_Program->Instructions.size() << std::endl;
+    os << indent << "Number of registers: " << m_Program->Registers.size() << std::endl;
+    }
+}
+
+void RowParser::SetSyntax(SyntaxType syntax)
+{
+  m_Syntax = syntax;
+  m_Program.reset();
+}
+
+RowParser::SyntaxType RowParser::GetSyntax() const
+{
+  return m_Syntax;
+}
+
+bool RowParser::Compile(const std::string & expression, const std::vector<std::string> & varNames)
+{
+  return this->Compile(std::vector<std::string>(1, expression), varNames);
+}
+
+bool RowParser::Compile(const std::vector<std::string> & expressions, const std::vector<std::string> & varNames)
+{
+  m_Program.reset();
+  if (expressions.empty())
+    {
+    return false;
+    }
+
+  // Build the graph of all the expressions
+  std::vector<Node> nodes;
+  std::vector<int> roots;
+  TreeBuilder builder(varNames, nodes, m_Syntax);
+  for (const std::string & expression : expressions)
+    {
+    std::vector<Token> tokens;
+    if (!Tokenize(expression, tokens))
+      {
+      return false;
+      }
+    const int root = builder.Parse(tokens);
+    if (root < 0)
+      {
+      return false;
+      }
+    roots.push_back(root);
+    }
+
+  std::unique_ptr<Program> program(new Program);
+  program->UsedVariables.assign(varNames.size(), false);
+  program->Generated.assign(nodes.size(), false);
+  program->NodeOperands.resize(nodes.size());
+  program->OutputOfNode.assign(nodes.size(), -1);
+
+  // Number of uses of each node reachable from the roots. The roots are
+  // used by the outputs until the end.
+  program->RemainingUses.assign(nodes.size(), 0);
+  std::vector<bool> reached(nodes.size(), false);
+  std::vector<int> stack(roots.begin(), roots.end());
+  while (!stack.empty())
+    {
+    const int id = stack.back();
+    stack.pop_back();
+    if (reached[id])
+      {
+      continue;
+      }
+    reached[id] = true;
+    for (unsigned int k = 0; k < GetArity(nodes[id].Op); ++k)
+      {
+      ++program->RemainingUses[nodes[id].Args[k]];
+      stack.push_back(nodes[id].Args[k]);
+      }
+    }
+  for (std::size_t k = 0; k < roots.size(); ++k)
+    {
+    ++program->RemainingUses[roots[k]];
+    const OpCode op = nodes[roots[k]].Op;
+    if (op != OpConstant && op != OpVariable && program->OutputOfNode[roots[k]] < 0)
+      {
+      program->OutputOfNode[roots[k]] = static_cast<int>(k);
+      }
+    }
+
+  for (int root : roots)
+    {
+    program->Results.push_back(program->Generate(nodes, root));
+    }
+  program->FreeRegisters.clear();
+  program->RemainingUses.clear();
+  program->OutputOfNode.clear();
+  program->Generated.clear();
+  program->NodeOperands.clear();
+
+  // Constants are stored as full chunks, to be read as any other operand
+  program->Constants.resize(program->ConstantValues.size());
+  for (std::size_t k = 0; k < program->ConstantValues.size(); ++k)
+    {
+    program->Constants[k].assign(RowParserChunkSize, program->ConstantValues[k]);
+    }
+
+  m_Program = std::move(program);
+  return true;
+}
+
+bool RowParser::IsCompiled() const
+{
+  return m_Program != nullptr;
+}
+
+unsigned int RowParser::GetNumberOfExpressions() const
+{
+  return m_Program ? static_cast<unsigned int>(m_Program->Results.size()) : 0;
+}
+
+bool RowParser::IsVariableUsed(unsigned int var) const
+{
+  return m_Program && var < m_Program->UsedVariables.size() && m_Program->UsedVariables[var];
+}
+
+void RowParser::Evaluate(const ValueType * const * vars, std::size_t n, ValueType * out)
+{
+  this->Evaluate(vars, n, &out);
+}
+
+void RowParser::Evaluate(const ValueType * const * vars, std::size_t n, ValueType * const * outs)
+{
+  if (!m_Program)
+    {
+    itkExceptionMacro(<< "No expression has been compiled");
+    }
+
+  Program & program = *m_Program;
+
+  for (std::size_t start = 0; start < n; start += RowParserChunkSize)
+    {
+    const std::size_t count = std::min(RowParserChunkSize, n - start);
+    auto data = [&](const Operand & operand) -> double *
+      {
+      switch (operand.Kind)
+        {
+        case Operand::Register:
+          return program.Registers[operand.Index].data();
+        case Operand::Variable:
+          return const_cast<double *>(vars[operand.Index]) + start;
+        case Operand::Constant:
+          return program.Constants[operand.Index].data();
+        case Operand::Output:
+          return outs[operand.Index] + start;
+        default:
+          return nullptr;
+        }
+      };
+
+    for (const Instruction & instruction : program.Instructions)
+      {
+      Execute(instruction.Op, count, data(instruction.Destination),
+              data(instruction.Args[0]), data(instruction.Args[1]), data(instruction.Args[2]));
+      }
+
+    // Outputs which are not written by an instruction: variables, constants
+    // or expressions identical to a previous one
+    for (std::size_t k = 0; k < program.Results.size(); ++k)
+      {
+      const Operand & result = program.Results[k];
+      if (result.Kind != Operand::Output || result.Index != k)
+        {
+        const double * values = data(result);
+        std::copy(values, values + count, outs[k] + start);
+        }
+      }
+    }
+}
+
+} // end namespace otb
@@ -25,6 +25,7 @@ void RegisterTests()
   REGISTER_TEST(otbMaskMuParserFilterTest);
   REGISTER_TEST(otbParserConditionDataNodeFeatureFunction);
   REGISTER_TEST(otbParserTest);
+  REGISTER_TEST(otbRowParserTest);
   REGISTER_TEST(otbImageListToSingleImageFilter);
   REGISTER_TEST(otbBandMathImageFilter);
   REGISTER_TEST(otbBandMathImageFilterWithIdx);
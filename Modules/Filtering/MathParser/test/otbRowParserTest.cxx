@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbParser.h"
+#include "otbRowParser.h"
+
+#include <cmath>
+#include <cstdlib>
+
+/** Compare the row evaluation of an expression with the muParser one */
+void otbRowParserTest_CompareWithParser(const std::string & expression)
+{
+  std::cout << "Running test " << expression << std::endl;
+
+  const std::size_t nbValues = 1500;
+  std::vector<std::string> varNames = {"b1", "b2", "b3"};
+  std::vector< std::vector<double> > rows(varNames.size(), std::vector<double>(nbValues));
+  for (std::size_t i = 0; i < nbValues; ++i)
+    {
+    rows[0][i] = static_cast<double>(i % 97) - 48.;
+    rows[1][i] = 0.25 * static_cast<double>(i % 31);
+    rows[2][i] = std::cos(static_cast<double>(i));
+    }
+
+  otb::RowParser::Pointer rowParser = otb::RowParser::New();
+  if (!rowParser->Compile(expression, varNames))
+    {
+    itkGenericExceptionMacro( << "Expression " << expression << " was not compiled");
+    }
+  std::vector<const double *> rowPointers = {rows[0].data(), rows[1].data(), rows[2].data()};
+  std::vector<double> output(nbValues);
+  rowParser->Evaluate(rowPointers.data(), nbValues, output.data());
+
+  std::vector<double> values(varNames.size());
+  otb::Parser::Pointer parser = otb::Parser::New();
+  for (std::size_t var = 0; var < varNames.size(); ++var)
+    {
+    parser->DefineVar(varNames[var], &values[var]);
+    }
+  parser->SetExpr(expression);
+
+  for (std::size_t i = 0; i < nbValues; ++i)
+    {
+    for (std::size_t var = 0; var < varNames.size(); ++var)
+      {
+      values[var] = rows[var][i];
+      }
+    const double ref = parser->Eval();
+    const bool sameNaN = std::isnan(ref) && std::isnan(output[i]);
+    if (!sameNaN && ref != output[i] && !(std::abs(ref - output[i]) <= 1E-12 * std::abs(ref)))
+      {
+      itkGenericExceptionMacro( << "Got " << output[i] << " while waiting for " << ref
+                                << " at position " << i);
+      }
+    }
+  std::cout << " -- OK" << std::endl;
+}
+
+/** Compare the evaluation of expressions compiled together with their
+ * separate evaluation */
+void otbRowParserTest_SharedSubExpressions(const std::vector<std::string> & expressions)
+{
+  std::cout << "Running test shared sub-expressions" << std::endl;
+
+  const std::size_t nbValues = 700;
+  std::vector<std::string> varNames = {"b1", "b2"};
+  std::vector<double> b1(nbValues), b2(nbValues);
+  for (std::size_t i = 0; i < nbValues; ++i)
+    {
+    b1[i] = static_cast<double>(i % 13) + 1.;
+    b2[i] = 0.5 * static_cast<double>(i % 7);
+    }
+  std::vector<const double *> rowPointers = {b1.data(), b2.data()};
+
+  otb::RowParser::Pointer rowParser = otb::RowParser::New();
+  if (!rowParser->Compile(expressions, varNames)
+      || rowParser->GetNumberOfExpressions() != expressions.size())
+    {
+    itkGenericExceptionMacro( << "Expressions were not compiled");
+    }
+  std::vector< std::vector<double> > outputs(expressions.size(), std::vector<double>(nbValues));
+  std::vector<double *> outputPointers;
+  for (auto & output : outputs)
+    {
+    outputPointers.push_back(output.data());
+    }
+  rowParser->Evaluate(rowPointers.data(), nbValues, outputPointers.data());
+
+  for (std::size_t k = 0; k < expressions.size(); ++k)
+    {
+    otb::RowParser::Pointer singleParser = otb::RowParser::New();
+    singleParser->Compile(expressions[k], varNames);
+    std::vector<double> output(nbValues);
+    singleParser->Evaluate(rowPointers.data(), nbValues, output.data());
+    if (output != outputs[k])
+      {
+      itkGenericExceptionMacro( << "Expression " << expressions[k] << " gives different results when compiled with others");
+      }
+    }
+  std::cout << " -- OK" << std::endl;
+}
+
+void otbRowParserTest_Unsupported(const std::string & expression,
+                                  otb::RowParser::SyntaxType syntax = otb::RowParser::MuParserSyntax)
+{
+  std::cout << "Running test " << expression << " (unsupported)" << std::endl;
+  otb::RowParser::Pointer rowParser = otb::RowParser::New();
+  rowParser->SetSyntax(syntax);
+  if (rowParser->Compile(expression, {"b1", "b2", "b3"}))
+    {
+    itkGenericExceptionMacro( << "Expression " << expression << " should not be compiled");
+    }
+  std::cout << " -- OK" << std::endl;
+}
+
+int otbRowParserTest(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  otbRowParserTest_CompareWithParser("10.0+3");
+  otbRowParserTest_CompareWithParser("(b1+b2-b3)*b2/4");
+  otbRowParserTest_CompareWithParser("-b1^2 + 2^-b2");
+  otbRowParserTest_CompareWithParser("(7+10)/2+cos(pi/4)*10-10*ln10+ndvi(b1, b2)");
+  otbRowParserTest_CompareWithParser("b1 > b2 ? b3 : (b1 <= 0 && b2 != 1 ? -b1 : 1e3)");
+  otbRowParserTest_CompareWithParser("min(b1, b2, b3) + max(b1, 2) + sum(b1, b2, b3) / avg(b2, b3, 5)");
+  otbRowParserTest_CompareWithParser("sqrt(abs(b1)) * exp(b3) + log10(b2 + 1) + log2(b2 + 1) + sign(b1) * rint(b3 * 10)");
+  otbRowParserTest_CompareWithParser("atan2(b1, b2) + asinh(b3) + atanh(b3 / 2) + tanh(b1) + NDVI(b2, b3)");
+  otbRowParserTest_CompareWithParser("b1 == 0 || b2 >= 7 || b3 < -0.5");
+
+  otbRowParserTest_SharedSubExpressions({"(b2-b1)/(b2+b1)", "(b1+b2)*3 + (b2-b1)/(b2+b1)", "b2",
+                                         "2*pi", "(b2-b1)/(b1+b2)", "sqrt((b2-b1)/(b2+b1)+2)*b1"});
+
+  otbRowParserTest_Unsupported("if(b1 > 0, b2, b3)");
+  otbRowParserTest_Unsupported("b1 and b2");
+  otbRowParserTest_Unsupported("b1^2^3");
+  otbRowParserTest_Unsupported("b4 + 1");
+  otbRowParserTest_Unsupported("(b1 + 2");
+
+  // Tokens of muParser which are not defined by muParserX
+  otbRowParserTest_Unsupported("_pi * b1", otb::RowParser::MuParserXSyntax);
+  otbRowParserTest_Unsupported("_e + b1", otb::RowParser::MuParserXSyntax);
+  otbRowParserTest_Unsupported("sign(b1)", otb::RowParser::MuParserXSyntax);
+  otbRowParserTest_Unsupported("rint(b1)", otb::RowParser::MuParserXSyntax);
+  otbRowParserTest_Unsupported("avg(b1, b2)", otb::RowParser::MuParserXSyntax);
+  otbRowParserTest_Unsupported("atan2(b1, b2)", otb::RowParser::MuParserXSyntax);
+  otbRowParserTest_Unsupported("NDVI(b1, b2)", otb::RowParser::MuParserXSyntax);
+  return EXIT_SUCCESS;
+}
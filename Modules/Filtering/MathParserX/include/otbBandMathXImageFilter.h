@@ -29,6 +29,7 @@
 
 #include "otbStreamingStatisticsVectorImageFilter.h"
 #include "otbParserX.h"
+#include "otbRowParser.h"
 
 #include <vector>
 #include <string>
@@ -53,6 +54,19 @@ namespace otb
  * If the jth input image is multidimensional, then the variable imj represents a vector whose components are related to its bands.
  * In order to access the kth band, the variable observes the following pattern : imjbk.
  *
+ * Expressions (or lists of expressions separated by ';') which only read
+ * scalar variables (bands, indices, constants and statistics) are compiled
+ * by a RowParser with the muParserX grammar when possible, and evaluated on
+ * whole image rows instead of calling muParserX at each pixel. Expressions
+ * using functions or operators outside of the grammar supported by the
+ * RowParser are always evaluated by muParserX. All these expressions are compiled
+ * together, so that their common sub-expressions are computed once: for
+ * instance, several spectral indices written as one multi-band output with
+ * "ndvi(im1b3,im1b4);(im1b4-im1b3)/(im1b4+im1b3+0.5)*1.5;..." share their
+ * band differences and sums. This can be disabled with RowEvaluationOff(). The
+ * neighborhood variables (imjbkNpxq) are filled from a sliding window of
+ * input rows, so that each input row is read only once per thread region.
+ *
  * \sa Parser
  *
  * \ingroup Streamed
@@ -90,6 +104,7 @@ public:
   typedef typename ImageType::PointType              OrigineType;
   typedef typename ImageType::SpacingType            SpacingType;
   typedef ParserX                                     ParserType;
+  typedef RowParser                                   RowParserType;
   typedef typename ParserType::ValueType             ValueType;
   typedef itk::ProcessObject::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
 
@@ -130,6 +145,11 @@ public:
   /** Return the variable and constant names */
   std::vector<std::string> GetVarNames() const;
 
+  /** Evaluate the expressions on whole rows when possible (on by default) */
+  itkSetMacro(RowEvaluation, bool);
+  itkGetConstMacro(RowEvaluation, bool);
+  itkBooleanMacro(RowEvaluation);
+
 
 protected :
   BandMathXImageFilter();
@@ -158,6 +178,35 @@ private :
   } adhocStruct;
 
 
+  /** Rows of an input image around the current line, shared by all the
+   * neighborhood variables of this image: 2*Radius[1]+1 rows, stored in a
+   * ring buffer indexed by line, of NbBands bands of RowLength values each */
+  struct NeighborhoodRowsType
+  {
+    unsigned int        Input;
+    RadiusType          Radius;
+    unsigned int        NbBands;
+    std::size_t         RowLength;
+    std::vector<double> Values;
+
+    std::size_t GetRowOffset(long line, unsigned int band) const
+    {
+      const long nbRows = 2 * static_cast<long>(Radius[1]) + 1;
+      const long slot = ((line % nbRows) + nbRows) % nbRows;
+      return (slot * NbBands + band) * RowLength;
+    }
+
+    const double * GetRow(long line, unsigned int band) const
+    {
+      return &Values[GetRowOffset(line, band)];
+    }
+
+    double * GetRow(long line, unsigned int band)
+    {
+      return &Values[GetRowOffset(line, band)];
+    }
+  };
+
   BandMathXImageFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
 
@@ -165,10 +214,16 @@ private :
   void CheckImageDimensions();
   void PrepareParsers();
   void PrepareParsersGlobStats();
+  void PrepareRowParsers();
   void OutputsDimensions();
+  void LoadNeighborhoodRow(NeighborhoodRowsType& rows, const ImageRegionType& region, long line);
 
   std::vector<std::string>                  m_Expression;
   std::vector< std::vector<ParserType::Pointer> > m_VParser;
+  std::vector< std::vector<std::string> >   m_ExpressionComponents; // expressions separated by ';'
+  std::vector< RowParserType::Pointer >     m_VRowParser;  // one program per thread for all row expressions
+  std::vector< int >                        m_RowOutputOffset; // first program output of each expression, -1 for muParserX
+  bool                                      m_RowEvaluation;
   std::vector< std::vector<adhocStruct> >   m_AImage;
   std::vector< adhocStruct >                m_VVarName;
   std::vector< adhocStruct >                m_VAllowedVarNameAuto;
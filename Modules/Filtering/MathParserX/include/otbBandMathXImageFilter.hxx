@@ -28,11 +28,11 @@
 #include "itkImageScanlineConstIterator.h"
 #include "itkImageScanlineIterator.h"
 #include "itkImageRegionConstIteratorWithOnlyIndex.h"
-#include "itkConstNeighborhoodIterator.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
 #include "otbMacro.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -70,6 +70,8 @@ BandMathXImageFilter<TImage>
   
   m_ManyExpressions = true;
 
+  m_RowEvaluation = true;
+
 }
 
 /** Destructor */
@@ -78,6 +80,7 @@ BandMathXImageFilter<TImage>
 ::~BandMathXImageFilter()
 {
   m_Expression.clear();
+  m_ExpressionComponents.clear();
   m_VParser.clear();
 
   for(unsigned int i=0; i<m_AImage.size(); ++i)
@@ -104,6 +107,7 @@ void BandMathXImageFilter<TImage>
   os << indent << "Expressions: " << std::endl;
   for (unsigned int i=0; i<m_Expression.size(); i++)
     os << indent << m_Expression[i] << std::endl;
+  os << indent << "RowEvaluation: "   << m_RowEvaluation               << std::endl;
   os << indent << "Computed values follow:"                            << std::endl;
   os << indent << "UnderflowCount: "  << m_UnderflowCount              << std::endl;
   os << indent << "OverflowCount: "   << m_OverflowCount               << std::endl;
@@ -235,6 +239,13 @@ void BandMathXImageFilter<TImage>
 ::SetExpression(const std::string& expression)
 {
   std::string expressionToBePushed = expression;
+  std::vector<std::string> components(1);
+
+  for(unsigned int i=0; i < expression.size(); ++i)
+    if (expression[i] == ';')
+      components.push_back(std::string());
+    else
+      components.back() += expression[i];
 
   if (expression.find(";") != std::string::npos)
   {
@@ -250,10 +261,11 @@ void BandMathXImageFilter<TImage>
     expressionToBePushed = oss.str();
   }
 
-  if (m_ManyExpressions)
-    m_Expression.push_back(expressionToBePushed);
-  else if (m_Expression.size() == 0)
+  if (m_ManyExpressions || (m_Expression.size() == 0))
+    {
     m_Expression.push_back(expressionToBePushed);
+    m_ExpressionComponents.push_back(components);
+    }
 
   if (m_Expression.size()>1)
     this->SetNthOutput( (DataObjectPointerArraySizeType) (m_Expression.size()) -1, ( TImage::New() ).GetPointer() );
@@ -829,6 +841,110 @@ void BandMathXImageFilter<TImage>
     }
 }
 
+template< typename TImage >
+void BandMathXImageFilter<TImage>
+::PrepareRowParsers()
+{
+  const unsigned int nbExpr = m_Expression.size();
+  m_VRowParser.clear();
+  m_RowOutputOffset.assign(nbExpr, -1);
+  if (!m_RowEvaluation)
+    return;
+
+  // Variables holding one scalar value at each pixel
+  const unsigned int nbVar = m_VVarName.size();
+  std::vector<std::string> varNames(nbVar);
+  std::vector<bool> scalarVar(nbVar, true);
+  for(unsigned int j=0; j < nbVar; ++j)
+    {
+    varNames[j] = m_VVarName[j].name;
+    if ( (m_VVarName[j].type == 4) || (m_VVarName[j].type == 6) ) // vector, neighborhood
+      scalarVar[j] = false;
+    if (m_VVarName[j].type == 7) // user defined variables may be matrices
+      scalarVar[j] = (m_VVarName[j].value.GetType() == 'i') || (m_VVarName[j].value.GetType() == 'f');
+    }
+
+  // Select the expressions whose components are all supported with the
+  // grammar of muParserX (the others are left to ParserX), then
+  // compile them together to share their common sub-expressions
+  std::vector<std::string> rowExpressions;
+  for(unsigned int k=0; k < nbExpr; ++k)
+    {
+    const std::vector<std::string> & components = m_ExpressionComponents[k];
+    if (components.size() != m_outputsDimensions[k])
+      continue;
+
+    RowParserType::Pointer rowParser = RowParserType::New();
+    rowParser->SetSyntax(RowParserType::MuParserXSyntax);
+    if (!rowParser->Compile(components, varNames))
+      continue;
+
+    bool scalar = true;
+    for(unsigned int j=0; j < nbVar; ++j)
+      if (rowParser->IsVariableUsed(j) && !scalarVar[j])
+        scalar = false;
+    if (!scalar)
+      continue;
+
+    otbMsgDevMacro(<< "Expression " << m_Expression[k] << " is evaluated row by row");
+    m_RowOutputOffset[k] = rowExpressions.size();
+    rowExpressions.insert(rowExpressions.end(), components.begin(), components.end());
+    }
+
+  if (rowExpressions.empty())
+    return;
+
+  const unsigned int nbThreads = m_VParser.size();
+  m_VRowParser.resize(nbThreads);
+  for(unsigned int t=0; t < nbThreads; ++t)
+    {
+    m_VRowParser[t] = RowParserType::New();
+    m_VRowParser[t]->SetSyntax(RowParserType::MuParserXSyntax);
+    m_VRowParser[t]->Compile(rowExpressions, varNames);
+    }
+}
+
+template< typename TImage >
+void BandMathXImageFilter<TImage>
+::LoadNeighborhoodRow(NeighborhoodRowsType& rows, const ImageRegionType& region, long line)
+{
+  typedef itk::ImageScanlineConstIterator<TImage> ImageScanlineConstIteratorType;
+
+  // Zero flux Neumann boundary condition, as the neighborhood iterators
+  const ImageType * input = this->GetNthInput(rows.Input);
+  const ImageRegionType & bufferedRegion = input->GetBufferedRegion();
+  const long firstLine = bufferedRegion.GetIndex(1);
+  const long lastLine = firstLine + static_cast<long>(bufferedRegion.GetSize(1)) - 1;
+  const long firstCol = bufferedRegion.GetIndex(0);
+  const long lastCol = firstCol + static_cast<long>(bufferedRegion.GetSize(0)) - 1;
+
+  const long x0 = region.GetIndex(0) - static_cast<long>(rows.Radius[0]);
+  const long begin = std::max(x0, firstCol);
+  const long end = std::min(x0 + static_cast<long>(rows.RowLength) - 1, lastCol);
+
+  ImageRegionType lineRegion;
+  lineRegion.SetIndex(0, begin);
+  lineRegion.SetIndex(1, std::min(std::max(line, firstLine), lastLine));
+  lineRegion.SetSize(0, end - begin + 1);
+  lineRegion.SetSize(1, 1);
+
+  double * values = rows.GetRow(line, 0);
+  ImageScanlineConstIteratorType it(input, lineRegion);
+  for (std::size_t i = begin - x0; !it.IsAtEndOfLine(); ++it, ++i)
+    {
+    const PixelType pixel = it.Get();
+    for(unsigned int b=0; b < rows.NbBands; ++b)
+      values[b * rows.RowLength + i] = pixel[b];
+    }
+
+  for(unsigned int b=0; b < rows.NbBands; ++b)
+    {
+    double * row = values + b * rows.RowLength;
+    std::fill(row, row + (begin - x0), row[begin - x0]);
+    std::fill(row + (end - x0) + 1, row + rows.RowLength, row[end - x0]);
+    }
+}
+
 template< typename TImage >
 void BandMathXImageFilter< TImage >
 ::OutputsDimensions()
@@ -916,6 +1032,7 @@ void BandMathXImageFilter< TImage >
   if (globalStatsDetected())
     PrepareParsersGlobStats();
   OutputsDimensions();
+  PrepareRowParsers();
 
 
   typedef itk::ImageBase< TImage::ImageDimension > ImageBaseType;
@@ -1047,6 +1164,10 @@ void BandMathXImageFilter<TImage>
 
   ValueType value;
   unsigned int nbInputImages = this->GetNumberOfInputs();
+  const unsigned int nbExpr = m_Expression.size();
+  const unsigned int nbVar = m_AImage[threadId].size();
+  const std::size_t width = outputRegionForThread.GetSize(0);
+  const IndexType startIndex = outputRegionForThread.GetIndex();
 
   //----------------- --------- -----------------//
   //----------------- Iterators -----------------//
@@ -1061,23 +1182,11 @@ void BandMathXImageFilter<TImage>
     
 
   std::vector< ImageScanlineIteratorType > VoutIt;
-  VoutIt.resize(m_Expression.size());
+  VoutIt.resize(nbExpr);
   for(unsigned int j=0; j < VoutIt.size(); ++j)
     VoutIt[j] = ImageScanlineIteratorType (this->GetOutput(j), outputRegionForThread);
     
 
-  //Special case : neighborhoods
-  std::vector< itk::ConstNeighborhoodIterator<TImage> > VNit;
-  for(unsigned int j=0; j<m_VVarName.size(); ++j)
-    if (m_VVarName[j].type == 6)
-     {
-        RadiusType radius;
-        radius[0]=(int) ((m_VVarName[j].info[2]-1)/2); // Size x direction (otb convention)
-        radius[1]=(int) ((m_VVarName[j].info[3]-1)/2); // Size y direction (otb convention)
-        VNit.push_back( itk::ConstNeighborhoodIterator<TImage>(radius, this->GetNthInput(m_VVarName[j].info[0]),outputRegionForThread)); // info[0] = Input image ID
-        VNit.back().NeedToUseBoundaryConditionOn();
-     }
-
   // Index only iterator
   IndexIteratorType indexIterator(this->GetNthInput(0), outputRegionForThread);
 
@@ -1093,122 +1202,243 @@ void BandMathXImageFilter<TImage>
     iterVarStart;
 
   // temporary output vectors
-  std::vector<PixelType> tmpOutputs(m_Expression.size());
-  for(unsigned int k=0; k<m_Expression.size(); ++k)
+  std::vector<PixelType> tmpOutputs(nbExpr);
+  for(unsigned int k=0; k<nbExpr; ++k)
     tmpOutputs[k].SetSize(m_outputsDimensions[k]);
 
+  //----------------- -------------- -----------------//
+  //----------------- Row evaluation -----------------//
+  //----------------- -------------- -----------------//
+  // Program evaluating the row expressions, and rows of the variables it reads
+  RowParserType * rowParser = m_VRowParser.empty() ? nullptr : m_VRowParser[threadId].GetPointer();
+  const unsigned int nbRowOutputs = rowParser ? rowParser->GetNumberOfExpressions() : 0;
+  std::vector< std::vector<double> > rowOutputs(nbRowOutputs, std::vector<double>(width));
+  std::vector< double * > rowOutputPointers(nbRowOutputs);
+  for(unsigned int k=0; k<nbRowOutputs; ++k)
+    rowOutputPointers[k] = rowOutputs[k].data();
+
+  std::vector< std::vector<double> > rows(nbVar);
+  std::vector< const double * > rowPointers(nbVar, nullptr);
+  for(unsigned int j=0; j < nbVar; ++j)
+    if (rowParser && rowParser->IsVariableUsed(j))
+      {
+      rows[j].resize(width);
+      rowPointers[j] = rows[j].data();
+      }
+
+  bool pixelExpressions = false;
+  for(unsigned int k=0; k<nbExpr; ++k)
+    if (m_RowOutputOffset[k] < 0)
+      pixelExpressions = true;
+
+  // Rows which do not depend on the line
+  for(unsigned int j=0; j < nbVar; ++j)
+    {
+    if (!rowPointers[j])
+      continue;
+    switch (m_AImage[threadId][j].type)
+      {
+      case 0 : //idxX
+        for(std::size_t x=0; x < width; ++x)
+          rows[j][x] = static_cast<double>(startIndex[0] + static_cast<long>(x));
+      break;
+
+      case 2 : //Spacing X (imiPhyX)
+      case 3 : //Spacing Y (imiPhyY)
+      case 7 : //user defined constant
+      case 8 : //global statistics
+        std::fill(rows[j].begin(), rows[j].end(), m_AImage[threadId][j].value.GetFloat());
+      break;
+
+      default :
+      break;
+      }
+    }
+
+  //----------------- ------------- -----------------//
+  //----------------- Neighborhoods -----------------//
+  //----------------- ------------- -----------------//
+  // One sliding window of rows per input image with neighborhood variables
+  std::vector< NeighborhoodRowsType > neighborhoods;
+  std::vector< int > neighborhoodOfVar(nbVar, -1);
+  if (pixelExpressions)
+    {
+    for(unsigned int j=0; j < nbVar; ++j)
+      {
+      if (m_AImage[threadId][j].type != 6)
+        continue;
+      const unsigned int input = m_AImage[threadId][j].info[0];
+      for(unsigned int r=0; r < neighborhoods.size(); ++r)
+        if (neighborhoods[r].Input == input)
+          neighborhoodOfVar[j] = r;
+      if (neighborhoodOfVar[j] < 0)
+        {
+        NeighborhoodRowsType neighborhood;
+        neighborhood.Input = input;
+        neighborhood.Radius = m_NeighExtremaSizes[input];
+        neighborhood.NbBands = this->GetNthInput(input)->GetNumberOfComponentsPerPixel();
+        neighborhood.RowLength = width + 2 * neighborhood.Radius[0];
+        neighborhood.Values.resize((2 * neighborhood.Radius[1] + 1) * neighborhood.NbBands * neighborhood.RowLength);
+        neighborhoodOfVar[j] = neighborhoods.size();
+        neighborhoods.push_back(neighborhood);
+        }
+      }
+    }
+
   //----------------- --------------------- -----------------//
   //----------------- Variable affectations -----------------//
   //----------------- --------------------- -----------------//
   for(unsigned int j=0; j < nbInputImages; ++j)       {  Vit[j].GoToBegin();     }
-  for(unsigned int j=0; j < m_Expression.size(); ++j) {  VoutIt[j].GoToBegin();  }
-  for(unsigned int j=0; j < VNit.size(); ++j)         {  VNit[j].GoToBegin();    }
+  for(unsigned int j=0; j < nbExpr; ++j)              {  VoutIt[j].GoToBegin();  }
   indexIterator.GoToBegin();
 
-  while(!Vit[0].IsAtEnd()) // For each pixel
+  long line = startIndex[1];
+  while(!Vit[0].IsAtEnd()) // For each line
     {
-    while(!Vit[0].IsAtEndOfLine()) // For each line
+    // Evaluate the row expressions on the whole line
+    if (rowParser)
       {
-      int ngbhNameIndex=0; int index;
-
-      iterVar = iterVarStart;
-      while (iterVar != iterVarEnd)
+      for(unsigned int j=0; j < nbVar; ++j)
         {
-        switch (iterVar->type)
+        if (!rowPointers[j])
+          continue;
+        if (m_AImage[threadId][j].type == 1) //idxY
+          std::fill(rows[j].begin(), rows[j].end(), static_cast<double>(line));
+        if (m_AImage[threadId][j].type == 5) //pixel
           {
-          case 0 : //idxX
-            iterVar->value = static_cast<double>(indexIterator.GetIndex()[0]);
-          break;
-
-          case 1 : //idxY
-            iterVar->value = static_cast<double>(indexIterator.GetIndex()[1]);
-          break;
-
-          case 2 : //Spacing X (imiPhyX)
-            //Nothing to do (already set inside BeforeThreadedGenerateData)"
-          break;
-
-          case 3 : //Spacing Y (imiPhyY)
-            //Nothing to do (already set inside BeforeThreadedGenerateData)"
-          break;
-
-          case 4 : //vector
-            // iterVar->info[0] : Input image #ID
-            for(int p=0; p < iterVar->value.GetCols(); ++p)
-              iterVar->value.At(0,p) = Vit[iterVar->info[0]].Get()[p];
-          break;
-
-          case 5 : //pixel
-            // iterVar->info[0] : Input image #ID
-            // iterVar->info[1] : Band #ID
-            iterVar->value = Vit[iterVar->info[0]].Get()[iterVar->info[1]];
-          break;
+          ImageScanlineConstIteratorType it = Vit[m_AImage[threadId][j].info[0]];
+          const int band = m_AImage[threadId][j].info[1];
+          for(double * row = rows[j].data(); !it.IsAtEndOfLine(); ++it, ++row)
+            *row = it.Get()[band];
+          }
+        }
+      rowParser->Evaluate(rowPointers.data(), width, rowOutputPointers.data());
+      }
 
-          case 6 : //neighborhood
-    
-          // iterVar->info[1] : Band #ID
-          if (iterVar->info[2]*iterVar->info[3] != (int) VNit[ngbhNameIndex].Size() )
-            itkExceptionMacro(<< "Size of muparserx variable is different from its related otb neighborhood iterator")
+    // Slide the neighborhood windows: only the new bottom row is read,
+    // except on the first line
+    for(unsigned int r=0; r < neighborhoods.size(); ++r)
+      {
+      const long radiusY = neighborhoods[r].Radius[1];
+      const long firstRow = (line == startIndex[1]) ? line - radiusY : line + radiusY;
+      for(long row = firstRow; row <= line + radiusY; ++row)
+        this->LoadNeighborhoodRow(neighborhoods[r], outputRegionForThread, row);
+      }
 
-          index=0;
-          for(int rows=0; rows<iterVar->info[3]; ++rows)
-            for(int cols=0; cols<iterVar->info[2]; ++cols)
+    std::size_t x = 0;
+    while(!Vit[0].IsAtEndOfLine()) // For each pixel
+      {
+      if (pixelExpressions)
+        {
+        iterVar = iterVarStart;
+        unsigned int j = 0;
+        while (iterVar != iterVarEnd)
+          {
+          switch (iterVar->type)
+            {
+            case 0 : //idxX
+              iterVar->value = static_cast<double>(indexIterator.GetIndex()[0]);
+            break;
+
+            case 1 : //idxY
+              iterVar->value = static_cast<double>(indexIterator.GetIndex()[1]);
+            break;
+
+            case 2 : //Spacing X (imiPhyX)
+              //Nothing to do (already set inside BeforeThreadedGenerateData)"
+            break;
+
+            case 3 : //Spacing Y (imiPhyY)
+              //Nothing to do (already set inside BeforeThreadedGenerateData)"
+            break;
+
+            case 4 : //vector
+              // iterVar->info[0] : Input image #ID
+              for(int p=0; p < iterVar->value.GetCols(); ++p)
+                iterVar->value.At(0,p) = Vit[iterVar->info[0]].Get()[p];
+            break;
+
+            case 5 : //pixel
+              // iterVar->info[0] : Input image #ID
+              // iterVar->info[1] : Band #ID
+              iterVar->value = Vit[iterVar->info[0]].Get()[iterVar->info[1]];
+            break;
+
+            case 6 : //neighborhood
               {
-                iterVar->value.At(rows,cols) = VNit[ngbhNameIndex].GetPixel(index)[iterVar->info[1]];
-                index++;
+              // iterVar->info[1] : Band #ID
+              // iterVar->info[2], iterVar->info[3] : Size x and y directions
+              const NeighborhoodRowsType & neighborhood = neighborhoods[neighborhoodOfVar[j]];
+              const long radiusX = (iterVar->info[2]-1)/2;
+              const long radiusY = (iterVar->info[3]-1)/2;
+              const std::size_t firstCol = x + neighborhood.Radius[0] - radiusX;
+              for(int r=0; r<iterVar->info[3]; ++r)
+                {
+                const double * row = neighborhood.GetRow(line - radiusY + r, iterVar->info[1]) + firstCol;
+                for(int c=0; c<iterVar->info[2]; ++c)
+                  iterVar->value.At(r,c) = row[c];
+                }
               }
+            break;
 
-          ngbhNameIndex++;
-          break;
-
-          case 7 :
-          //Nothing to do : user defined variable or constant, which have already been set inside PrepareParsers (see above)
-          break;
+            case 7 :
+            //Nothing to do : user defined variable or constant, which have already been set inside PrepareParsers (see above)
+            break;
 
-          case 8 :
-          //Nothing to do : variable has already been set inside PrepareParsersGlobStats method (see above)
-          break;
+            case 8 :
+            //Nothing to do : variable has already been set inside PrepareParsersGlobStats method (see above)
+            break;
 
-          default :
-            itkExceptionMacro(<< "Type of the variable is unknown");
-          break;
-          }
+            default :
+              itkExceptionMacro(<< "Type of the variable is unknown");
+            break;
+            }
 
-        iterVar++;
-        }//End while on vars
+          iterVar++;
+          j++;
+          }//End while on vars
+        }
 
       //----------------- ----------- -----------------//
       //----------------- Evaluations -----------------//
       //----------------- ----------- -----------------//
-      for(unsigned int IDExpression=0; IDExpression<m_Expression.size(); ++IDExpression)
+      for(unsigned int IDExpression=0; IDExpression<nbExpr; ++IDExpression)
         {
-        value = m_VParser[threadId][IDExpression]->EvalRef();
+        if (m_RowOutputOffset[IDExpression] >= 0)
+          {
+          for(unsigned int p=0; p<m_outputsDimensions[IDExpression]; ++p)
+            tmpOutputs[IDExpression][p] = rowOutputs[m_RowOutputOffset[IDExpression] + p][x];
+          }
+        else
+          {
+          value = m_VParser[threadId][IDExpression]->EvalRef();
 
-        switch (value.GetType())
-          {   //ValueType
-          case 'i':
-          tmpOutputs[IDExpression][0] = value.GetInteger();
-          break;
+          switch (value.GetType())
+            {   //ValueType
+            case 'i':
+            tmpOutputs[IDExpression][0] = value.GetInteger();
+            break;
 
-          case 'f':
-          tmpOutputs[IDExpression][0] = value.GetFloat();
-          break;
+            case 'f':
+            tmpOutputs[IDExpression][0] = value.GetFloat();
+            break;
 
-          case 'c':
-          itkExceptionMacro(<< "Complex numbers are not supported." << std::endl);
-          break;
+            case 'c':
+            itkExceptionMacro(<< "Complex numbers are not supported." << std::endl);
+            break;
 
-          case 'm':
-            {
-            const mup::matrix_type &vect = value.GetArray();
+            case 'm':
+              {
+              const mup::matrix_type &vect = value.GetArray();
   
-            if ( vect.GetRows() == 1 ) //Vector
-              for(int p=0; p<vect.GetCols(); ++p)
-                tmpOutputs[IDExpression][p] = vect.At(0,p).GetFloat();
-            else //Matrix
-              itkExceptionMacro(<< "Result of the evaluation can't be a matrix." << std::endl);
+              if ( vect.GetRows() == 1 ) //Vector
+                for(int p=0; p<vect.GetCols(); ++p)
+                  tmpOutputs[IDExpression][p] = vect.At(0,p).GetFloat();
+              else //Matrix
+                itkExceptionMacro(<< "Result of the evaluation can't be a matrix." << std::endl);
+              }
+            break;
             }
-          break;
           }
  
         //----------------- Pixel affectations -----------------//
@@ -1233,14 +1463,15 @@ void BandMathXImageFilter<TImage>
         }
 
       for(unsigned int j=0; j < nbInputImages; ++j)        {   ++Vit[j];    }
-      for(unsigned int j=0; j < m_Expression.size(); ++j)  {   ++VoutIt[j]; }
-      for(unsigned int j=0; j < VNit.size(); ++j)          {   ++VNit[j];   }
+      for(unsigned int j=0; j < nbExpr; ++j)               {   ++VoutIt[j]; }
       ++indexIterator;
+      ++x;
 
       progress.CompletedPixel();
       }
     for(unsigned int j=0; j < nbInputImages; ++j)        {   Vit[j].NextLine();    }
-    for(unsigned int j=0; j < m_Expression.size(); ++j)  {   VoutIt[j].NextLine(); }
+    for(unsigned int j=0; j < nbExpr; ++j)               {   VoutIt[j].NextLine(); }
+    ++line;
     }
 
 }
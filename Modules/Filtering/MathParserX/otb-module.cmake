@@ -24,6 +24,7 @@ otb_module(OTBMathParserX
   DEPENDS
     OTBCommon
     OTBITK
+    OTBMathParser
     OTBMuParserX
     OTBStatistics
 
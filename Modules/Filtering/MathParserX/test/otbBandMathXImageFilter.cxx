@@ -23,6 +23,7 @@
 #include "itkMacro.h"
 #include <iostream>
 #include <complex>  //only for the isnan() test line 148
+#include <algorithm>
 
 #include "otbMath.h"
 #include "otbVectorImage.h"
@@ -552,3 +553,126 @@ int otbBandMathXImageFilterWithIdx( int itkNotUsed(argc), char* argv[])
 
   return EXIT_SUCCESS;
 }
+
+
+int otbBandMathXImageFilterRowEvaluation( int itkNotUsed(argc), char* itkNotUsed(argv) [])
+{
+  typedef otb::VectorImage<double, 2>              ImageType;
+  typedef otb::BandMathXImageFilter<ImageType>      FilterType;
+
+  const unsigned int N = 100, D1=2;
+
+  ImageType::SizeType size;
+  size.Fill(N);
+  ImageType::IndexType index;
+  index.Fill(0);
+  ImageType::RegionType region;
+  region.SetSize(size);
+  region.SetIndex(index);
+
+  ImageType::Pointer image1 = ImageType::New();
+  image1->SetLargestPossibleRegion( region );
+  image1->SetBufferedRegion( region );
+  image1->SetRequestedRegion( region );
+  image1->SetNumberOfComponentsPerPixel(D1);
+  image1->Allocate();
+
+  typedef itk::ImageRegionIteratorWithIndex<ImageType> IteratorType;
+  IteratorType it1(image1, region);
+  for (it1.GoToBegin(); !it1.IsAtEnd(); ++it1)
+  {
+    ImageType::IndexType i1 = it1.GetIndex();
+    it1.Get()[0] = (i1[0] * 7 + i1[1] * 13) % 23 - 11;
+    it1.Get()[1] = std::cos(0.1 * i1[0]) * i1[1];
+  }
+
+  // First and third expressions : row evaluation, the third one sharing
+  // sub-expressions between its components. Second one : muParserX with a
+  // neighborhood
+  const std::string expression1 = "(im1b1 * im1b2 + idxX - idxY > 10) ? im1b1 : sqrt(abs(im1b2))";
+  const std::string expression2 = "mean(im1b1N3x5) + im1b2";
+  const std::string expression3 = "(im1b2 - im1b1) / (im1b1 + im1b2 + 100);"
+                                  "(im1b2 - im1b1) / (im1b2 + im1b1 + 100) * 1.5;"
+                                  "im1b1 + im1b2";
+  // Fourth expression : row evaluation, with the precedences of muParserX
+  // where == and != bind less than < and >
+  const std::string expression4 = "im1b1 > 0 == im1b2 < 1 ? im1b1 + 0.5 : (im1b1 < -5 != idxX > 50 ? 2.5 : -2.5)";
+
+  FilterType::Pointer rowFilter = FilterType::New();
+  rowFilter->SetNthInput(0, image1);
+  rowFilter->SetExpression(expression1);
+  rowFilter->SetExpression(expression2);
+  rowFilter->SetExpression(expression3);
+  rowFilter->SetExpression(expression4);
+  rowFilter->Update();
+
+  FilterType::Pointer pixelFilter = FilterType::New();
+  pixelFilter->RowEvaluationOff();
+  pixelFilter->SetNthInput(0, image1);
+  pixelFilter->SetExpression(expression1);
+  pixelFilter->SetExpression(expression3);
+  pixelFilter->SetExpression(expression4);
+  pixelFilter->Update();
+
+  if (rowFilter->GetOutput(2)->GetNumberOfComponentsPerPixel() != 3)
+    {
+    itkGenericExceptionMacro( << "Wrong number of components for " << expression3);
+    }
+
+  IteratorType itRow(rowFilter->GetOutput(0), region);
+  IteratorType itPixel(pixelFilter->GetOutput(0), region);
+  IteratorType itNeighborhood(rowFilter->GetOutput(1), region);
+  IteratorType itRowMulti(rowFilter->GetOutput(2), region);
+  IteratorType itPixelMulti(pixelFilter->GetOutput(1), region);
+  IteratorType itRowPrecedence(rowFilter->GetOutput(3), region);
+  IteratorType itPixelPrecedence(pixelFilter->GetOutput(2), region);
+  for (itRow.GoToBegin(), itPixel.GoToBegin(), itNeighborhood.GoToBegin(), itRowMulti.GoToBegin(), itPixelMulti.GoToBegin(),
+       itRowPrecedence.GoToBegin(), itPixelPrecedence.GoToBegin();
+       !itRow.IsAtEnd(); ++itRow, ++itPixel, ++itNeighborhood, ++itRowMulti, ++itPixelMulti,
+       ++itRowPrecedence, ++itPixelPrecedence)
+  {
+    const ImageType::IndexType idx = itRow.GetIndex();
+    if (itRow.Get()[0] != itPixel.Get()[0])
+      {
+      itkGenericExceptionMacro( << "Row evaluation gives " << itRow.Get()[0]
+                                << " while muParserX gives " << itPixel.Get()[0] << " at " << idx);
+      }
+    if (itRowMulti.Get() != itPixelMulti.Get())
+      {
+      itkGenericExceptionMacro( << "Row evaluation gives " << itRowMulti.Get()
+                                << " while muParserX gives " << itPixelMulti.Get() << " at " << idx);
+      }
+
+    const double b1 = image1->GetPixel(idx)[0];
+    const double b2 = image1->GetPixel(idx)[1];
+    const double expectedPrecedence = ((b1 > 0) == (b2 < 1)) ? b1 + 0.5
+                                      : (((b1 < -5) != (idx[0] > 50)) ? 2.5 : -2.5);
+    if (itRowPrecedence.Get()[0] != itPixelPrecedence.Get()[0]
+        || itPixelPrecedence.Get()[0] != expectedPrecedence)
+      {
+      itkGenericExceptionMacro( << "Precedences differ: row evaluation gives " << itRowPrecedence.Get()[0]
+                                << ", muParserX gives " << itPixelPrecedence.Get()[0]
+                                << " while waiting for " << expectedPrecedence << " at " << idx);
+      }
+
+    // 3 columns by 5 rows, with the zero flux Neumann boundary condition
+    double expected = 0.;
+    for (int dy = -2; dy <= 2; ++dy)
+      for (int dx = -1; dx <= 1; ++dx)
+      {
+        ImageType::IndexType n;
+        n[0] = std::min(std::max(idx[0] + dx, 0L), static_cast<long>(N) - 1);
+        n[1] = std::min(std::max(idx[1] + dy, 0L), static_cast<long>(N) - 1);
+        expected += image1->GetPixel(n)[0];
+      }
+    expected = expected / 15. + image1->GetPixel(idx)[1];
+
+    if (std::abs(itNeighborhood.Get()[0] - expected) > 1E-9)
+      {
+      itkGenericExceptionMacro( << "Neighborhood expression gives " << itNeighborhood.Get()[0]
+                                << " while waiting for " << expected << " at " << idx);
+      }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -27,6 +27,7 @@
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include <algorithm>
+#include <vector>
 
 
 namespace otb
@@ -608,10 +609,15 @@ protected:
   /** PrintSelf method */
   void PrintSelf(std::ostream& os, itk::Indent indent) const override;
 
-  virtual void CalculateMeanShiftVector(const typename RealVectorImageType::Pointer inputImagePtr,
-                                        const RealVector& jointPixel, const OutputRegionType& outputRegion,
+  /** Compute the mean shift vector at the position given by jointPixel.
+   * Neighbors are read line by line from the component planes of the joint
+   * image, so that distances and weights are computed with contiguous loops
+   * over each line. lineBuffer is a working buffer owned by the calling
+   * thread. */
+  virtual void CalculateMeanShiftVector(const RealVector& jointPixel, const OutputRegionType& outputRegion,
                                         const RealVector& bandwidth,
-                                        RealVector& meanShiftVector);
+                                        RealVector& meanShiftVector,
+                                        std::vector<RealType>& lineBuffer);
 #if 0
   virtual void CalculateMeanShiftVectorBucket(const RealVector& jointPixel, RealVector& meanShiftVector);
 #endif
@@ -648,6 +654,14 @@ private:
   /** Input data in the joint spatial-range domain, scaled by the bandwidths */
   typename RealVectorImageType::Pointer m_JointImage;
 
+  /** Copy of m_JointImage stored component by component (structure of
+   * arrays) : component c of the pixel at offset p is
+   * m_JointPlanes[c * m_JointPlaneSize + p] */
+  std::vector<RealType> m_JointPlanes;
+
+  /** Number of pixels in each component plane */
+  std::size_t m_JointPlaneSize;
+
   /** Image to store the status at each pixel:
    * 0 : no mode has been found yet
    * 1 : a mode has been assigned to this pixel
@@ -24,6 +24,7 @@
 
 #include "otbMeanShiftSmoothingImageFilter.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithOnlyIndex.h"
 #include "otbUnaryFunctorWithIndexWithOutputSizeImageFilter.h"
 #include "otbMacro.h"
 
@@ -40,6 +41,7 @@ MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterati
       // , m_Kernel(...)
       , m_NumberOfComponentsPerPixel(0)
       // , m_JointImage(0)
+      , m_JointPlaneSize(0)
       // , m_ModeTable(0)
       , m_ModeSearch(false)
       , m_ThreadIdNumberOfBits(0)
@@ -257,6 +259,19 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
   jointImageFunctor->Update();
   m_JointImage = jointImageFunctor->GetOutput();
 
+  // Transpose the joint image into component planes
+  const unsigned int jointDimension = ImageDimension + m_NumberOfComponentsPerPixel;
+  m_JointPlaneSize = m_JointImage->GetBufferedRegion().GetNumberOfPixels();
+  m_JointPlanes.resize(jointDimension * m_JointPlaneSize);
+  const RealType * jointBuffer = m_JointImage->GetBufferPointer();
+  for (std::size_t p = 0; p < m_JointPlaneSize; ++p)
+    {
+    for (unsigned int comp = 0; comp < jointDimension; ++comp)
+      {
+      m_JointPlanes[comp * m_JointPlaneSize + p] = jointBuffer[p * jointDimension + comp];
+      }
+    }
+
 #if 0
   if (m_BucketOptimization)
     {
@@ -344,11 +359,11 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
 // Calculates the mean shift vector at the position given by jointPixel
 template<class TInputImage, class TOutputImage, class TKernel, class TOutputIterationImage>
 void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterationImage>::CalculateMeanShiftVector(
-                                                                                                                        const typename RealVectorImageType::Pointer jointImage,
                                                                                                                         const RealVector& jointPixel,
                                                                                                                         const OutputRegionType& outputRegion,
                                                                                                                         const RealVector & bandwidth,
-                                                                                                                        RealVector& meanShiftVector)
+                                                                                                                        RealVector& meanShiftVector,
+                                                                                                                        std::vector<RealType>& lineBuffer)
 {
   const unsigned int jointDimension = ImageDimension + m_NumberOfComponentsPerPixel;
 
@@ -374,76 +389,68 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
     regionSize[comp] = std::max(0l, indexRight - static_cast<long int> (regionIndex[comp]) + 1);
     }
 
-  RegionType neighborhoodRegion;
-  neighborhoodRegion.SetIndex(regionIndex);
-  neighborhoodRegion.SetSize(regionSize);
+  const std::size_t lineLength = regionSize[0];
+  if (lineLength == 0)
+    {
+    return;
+    }
 
-  RealType weightSum = 0;
-  RealVector shifts(jointDimension);
+  // One iteration per line of the neighborhood (along the first dimension)
+  RegionType lineRegion;
+  lineRegion.SetIndex(regionIndex);
+  regionSize[0] = 1;
+  lineRegion.SetSize(regionSize);
+
+  lineBuffer.resize(2 * lineLength);
+  RealType * norm2 = &lineBuffer[0];
+  RealType * weights = norm2 + lineLength;
 
-  // An iterator on the neighborhood of the current pixel (in joint
-  // spatial-range domain)
-  otb::Meanshift::FastImageRegionConstIterator<RealVectorImageType> it(jointImage, neighborhoodRegion);
-  //itk::ImageRegionConstIterator<RealVectorImageType> it(jointImage, neighborhoodRegion);
+  RealType weightSum = 0;
 
-  it.GoToBegin();
-  while (!it.IsAtEnd())
+  itk::ImageRegionConstIteratorWithOnlyIndex<RealVectorImageType> lineIt(m_JointImage, lineRegion);
+  for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
     {
-    const RealType *jointNeighbor = it.GetPixelPointer();
+    const RealType * lineStart = &m_JointPlanes[0] + m_JointImage->ComputeOffset(lineIt.GetIndex());
 
-    // Compute the squared norm of the difference
+    // Compute the squared norm of the difference for each pixel of the line,
+    // one component at a time
     // This is the L2 norm, TODO: replace by the templated norm
-    RealType norm2 = 0;
+    std::fill(norm2, norm2 + lineLength, 0.);
     for (unsigned int comp = 0; comp < jointDimension; comp++)
       {
-      shifts[comp] = jointNeighbor[comp] - jointPixel[comp];
-      double d = shifts[comp] / bandwidth[comp];
-      norm2 += d*d;
+      const RealType * plane = lineStart + comp * m_JointPlaneSize;
+      const RealType center = jointPixel[comp];
+      const RealType compBandwidth = bandwidth[comp];
+      for (std::size_t i = 0; i < lineLength; ++i)
+        {
+        const RealType d = (plane[i] - center) / compBandwidth;
+        norm2[i] += d * d;
+        }
       }
 
-    // Compute pixel weight from kernel
-    const RealType weight = m_Kernel(norm2);
-    /*
-     // The following code is an alternative way to compute norm2 and weight
-     // It separates the norms of spatial and range elements
-     RealType spatialNorm2;
-     RealType rangeNorm2;
-     spatialNorm2 = 0;
-     for (unsigned int comp = 0; comp < ImageDimension; comp++)
-     {
-     RealType d;
-     d = jointNeighbor[comp] - jointPixel[comp];
-     spatialNorm2 += d*d;
-     }
-
-     if(spatialNorm2 >= 1.0)
-     {
-     weight = 0;
-     }
-     else
-     {
-     rangeNorm2 = 0;
-     for (unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; comp++)
-     {
-     RealType d;
-     d = jointNeighbor[ImageDimension + comp] - jointPixel[ImageDimension + comp];
-     rangeNorm2 += d*d;
-     }
-
-     weight = (rangeNorm2 <= 1.0)? 1.0 : 0.0;
-     }
-     */
-
-    // Update sum of weights
-    weightSum += weight;
-
-    // Update mean shift vector
-    for (unsigned int comp = 0; comp < jointDimension; comp++)
+    // Compute pixel weights from kernel, and update sum of weights
+    for (std::size_t i = 0; i < lineLength; ++i)
       {
-      meanShiftVector[comp] += weight * shifts[comp];
+      weights[i] = m_Kernel(norm2[i]);
+      }
+    for (std::size_t i = 0; i < lineLength; ++i)
+      {
+      weightSum += weights[i];
       }
 
-    ++it;
+    // Update mean shift vector. Pixels are accumulated in the same order as
+    // a pixel by pixel loop, so that results do not depend on the layout.
+    for (unsigned int comp = 0; comp < jointDimension; comp++)
+      {
+      const RealType * plane = lineStart + comp * m_JointPlaneSize;
+      const RealType center = jointPixel[comp];
+      RealType sum = meanShiftVector[comp];
+      for (std::size_t i = 0; i < lineLength; ++i)
+        {
+        sum += weights[i] * (plane[i] - center);
+        }
+      meanShiftVector[comp] = sum;
+      }
     }
 
   if (weightSum > 0)
@@ -591,6 +598,9 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
   // Mean shift vector, updating the joint pixel at each iteration
   RealVector meanShiftVector(jointDimension);
 
+  // Working buffer for the mean shift vector computation
+  std::vector<RealType> lineBuffer;
+
   // Variables used by mode search optimization
   // List of indices where the current pixel passes through
   std::vector<InputIndexType> pointList;
@@ -697,7 +707,7 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
       else
         {
 #endif
-        this->CalculateMeanShiftVector(m_JointImage, jointPixel, requestedRegion, bandwidth, meanShiftVector);
+        this->CalculateMeanShiftVector(jointPixel, requestedRegion, bandwidth, meanShiftVector, lineBuffer);
 
 #if 0
         }
@@ -774,6 +784,10 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
 template<class TInputImage, class TOutputImage, class TKernel, class TOutputIterationImage>
 void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterationImage>::AfterThreadedGenerateData()
 {
+  // Release the component planes of the joint image
+  std::vector<RealType>().swap(m_JointPlanes);
+  m_JointPlaneSize = 0;
+
   typename OutputLabelImageType::Pointer labelOutput = this->GetLabelOutput();
   typedef itk::ImageRegionIterator<OutputLabelImageType> OutputLabelIteratorType;
   OutputLabelIteratorType labelIt(labelOutput, labelOutput->GetRequestedRegion());
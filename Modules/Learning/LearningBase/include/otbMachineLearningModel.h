@@ -111,6 +111,14 @@ public:
   /** Train the machine learning model */
   virtual void Train() =0;
 
+  /** Update the machine learning model with the current input (and target)
+   * list samples, considered as one minibatch. The first call after
+   * construction or Train() initializes the model, the following calls
+   * refine it. This allows training on data sets that do not fit in memory,
+   * for models supporting it (see IsIncrementalTrainingSupported()).
+   * Default implementation throws. */
+  virtual void TrainIncrement();
+
   /** Predict a single sample
     * \param input The sample
     * \param quality A pointer to the quality variable were to store
@@ -157,6 +165,8 @@ public:
   bool HasConfidenceIndex() const {return m_ConfidenceIndex;}
   /** Query capacity to produce probability values */
   bool HasProbaIndex() const {return m_ProbaIndex;}
+  /** Query capacity to be trained incrementally with TrainIncrement() */
+  bool IsIncrementalTrainingSupported() const {return m_IsIncrementalTrainingSupported;}
 
 /**\name Input list of samples accessors */
 //@{
@@ -210,6 +220,11 @@ protected:
    *  regression mode */
   bool m_IsRegressionSupported;
 
+  /** flag that indicates if the model supports incremental training, child
+   *  classes should modify it in their constructor if they implement
+   *  TrainIncrement() */
+  bool m_IsIncrementalTrainingSupported;
+
   /** flag that tells if the model support confidence index output */
   bool m_ConfidenceIndex;
 
@@ -37,6 +37,7 @@ MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
 ::MachineLearningModel() :
   m_RegressionMode(false),
   m_IsRegressionSupported(false),
+  m_IsIncrementalTrainingSupported(false),
   m_ConfidenceIndex(false),
   m_ProbaIndex(false),
   m_IsDoPredictBatchMultiThreaded(false),
@@ -65,6 +66,14 @@ MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
     }
 }
 
+template <class TInputValue, class TOutputValue, class TConfidenceValue>
+void
+MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
+::TrainIncrement()
+{
+  itkExceptionMacro(<< "Incremental training not implemented for this model.");
+}
+
 template <class TInputValue, class TOutputValue, class TConfidenceValue>
 typename MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
 ::TargetSampleType
@@ -175,6 +175,14 @@ public:
   void SetClassFieldName(const std::string &name);
   std::string GetClassFieldName(void);
 
+  /** Sort the input features by image position before dispatching them to the threads */
+  void SetSpatialSorting(bool sorting);
+  bool GetSpatialSorting();
+
+  /** Maximum number of features written within one transaction (0 : one transaction per division) */
+  void SetTransactionSize(unsigned long size);
+  unsigned long GetTransactionSize();
+
 protected:
   /** Constructor */
   ImageSampleExtractorFilter() {}
@@ -176,6 +176,21 @@ PersistentImageSampleExtractorFilter<TInputImage>
   PixelType imgPixel;
   double imgComp;
 
+  // Resolve field indexes once for the whole thread, instead of matching
+  // field names for each feature
+  OGRFeatureDefn &inLayerDefn = layerForThread.GetLayerDefn();
+  OGRFeatureDefn &outLayerDefn = outputLayer.GetLayerDefn();
+  std::vector<int> fieldMap(inLayerDefn.GetFieldCount());
+  for (int f=0 ; f < inLayerDefn.GetFieldCount() ; f++)
+    {
+    fieldMap[f] = outLayerDefn.GetFieldIndex(inLayerDefn.GetFieldDefn(f)->GetNameRef());
+    }
+  std::vector<int> sampleFieldIndex(nbBand);
+  for (unsigned int i=0 ; i<nbBand ; ++i)
+    {
+    sampleFieldIndex[i] = outLayerDefn.GetFieldIndex(m_SampleFieldNames[i].c_str());
+    }
+
   ogr::Layer::const_iterator featIt = layerForThread.begin();
   for(; featIt!=layerForThread.end(); ++featIt)
     {
@@ -196,14 +211,14 @@ PersistentImageSampleExtractorFilter<TInputImage>
         inputImage->TransformPhysicalPointToIndex(imgPoint,imgIndex);
         imgPixel = inputImage->GetPixel(imgIndex);
 
-        ogr::Feature dstFeature(outputLayer.GetLayerDefn());
-        dstFeature.SetFrom( *featIt, TRUE );
+        ogr::Feature dstFeature(outLayerDefn);
+        dstFeature.SetFrom( *featIt, fieldMap.empty() ? nullptr : &fieldMap[0], TRUE );
         dstFeature.SetFID(featIt->GetFID());
         for (unsigned int i=0 ; i<nbBand ; ++i)
           {
           imgComp = static_cast<double>(itk::DefaultConvertPixelTraits<PixelType>::GetNthComponent(i,imgPixel));
           // Fill the output OGRDataSource
-          dstFeature[m_SampleFieldNames[i]].SetValue(imgComp);
+          dstFeature[sampleFieldIndex[i]].SetValue(imgComp);
           }
         outputLayer.CreateFeature( dstFeature );
         break;
@@ -346,6 +361,38 @@ ImageSampleExtractorFilter<TInputImage>
   return this->GetFilter()->GetFieldName();
 }
 
+template<class TInputImage>
+void
+ImageSampleExtractorFilter<TInputImage>
+::SetSpatialSorting(bool sorting)
+{
+  this->GetFilter()->SetSpatialSorting(sorting);
+}
+
+template<class TInputImage>
+bool
+ImageSampleExtractorFilter<TInputImage>
+::GetSpatialSorting()
+{
+  return this->GetFilter()->GetSpatialSorting();
+}
+
+template<class TInputImage>
+void
+ImageSampleExtractorFilter<TInputImage>
+::SetTransactionSize(unsigned long size)
+{
+  this->GetFilter()->SetTransactionSize(size);
+}
+
+template<class TInputImage>
+unsigned long
+ImageSampleExtractorFilter<TInputImage>
+::GetTransactionSize()
+{
+  return this->GetFilter()->GetTransactionSize();
+}
+
 } // end of namespace otb
 
 #endif
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbOGRLayerGridIndex_h
+#define otbOGRLayerGridIndex_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "otbOGRLayerWrapper.h"
+#include "OTBSamplingExport.h"
+#include <vector>
+
+namespace otb
+{
+
+/** \class OGRLayerGridIndex
+ *  \brief In-memory spatial index of the feature envelopes of an OGR layer
+ *
+ * The envelopes of all the features of a layer are read once and stored
+ * in a regular grid covering the layer extent. The grid size is chosen so
+ * that each cell holds a few features on average. A query returns the FIDs
+ * of the features whose envelope intersects a given envelope, in the
+ * order of the layer.
+ *
+ * This index is used by the sampling filters to select the features
+ * intersecting each streaming division, instead of asking the OGR driver
+ * to scan the whole layer for each division.
+ *
+ * \ingroup OTBSampling
+ */
+class OTBSampling_EXPORT OGRLayerGridIndex : public itk::Object
+{
+public:
+  /** Standard typedefs */
+  typedef OGRLayerGridIndex             Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(OGRLayerGridIndex, itk::Object);
+
+  typedef std::vector<GIntBig> FIDListType;
+
+  /** Set/Get the targeted average number of features per cell */
+  itkSetMacro(FeaturesPerCell, unsigned int);
+  itkGetConstMacro(FeaturesPerCell, unsigned int);
+
+  /** Index all the features of a layer. The spatial filter of the layer
+   *  is reset. */
+  void Build(ogr::Layer& layer);
+
+  /** Remove all indexed features */
+  void Clear();
+
+  /** Get the number of indexed features */
+  unsigned long GetNumberOfFeatures() const
+  {
+    return m_FIDs.size();
+  }
+
+  /** Get the FIDs of the features whose envelope intersects the given
+   *  envelope, in the layer order */
+  void Query(const OGREnvelope& envelope, FIDListType& fids) const;
+
+protected:
+  OGRLayerGridIndex();
+  ~OGRLayerGridIndex() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+private:
+  OGRLayerGridIndex(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Compute the cell range covered by an envelope, returns false if the
+   *  envelope is outside the grid */
+  bool GetCellRange(const OGREnvelope& envelope,
+                    unsigned int& x0, unsigned int& y0,
+                    unsigned int& x1, unsigned int& y1) const;
+
+  unsigned int m_FeaturesPerCell;
+
+  /** Extent of the indexed features */
+  OGREnvelope m_Extent;
+
+  /** Number of cells along each axis */
+  unsigned int m_GridSizeX;
+  unsigned int m_GridSizeY;
+
+  /** Envelope and FID of each feature, in layer order */
+  std::vector<OGREnvelope> m_Envelopes;
+  FIDListType m_FIDs;
+
+  /** Content of each cell (positions in m_FIDs), stored contiguously :
+   *  cell c holds m_CellContent[m_CellStart[c]] to
+   *  m_CellContent[m_CellStart[c+1]-1] */
+  std::vector<unsigned long> m_CellStart;
+  std::vector<unsigned long> m_CellContent;
+};
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbOGRListSampleChunkReader_h
+#define otbOGRListSampleChunkReader_h
+
+#include "itkObject.h"
+#include "itkVariableLengthVector.h"
+#include "otbOGRDataSourceWrapper.h"
+#include <string>
+#include <vector>
+
+namespace otb
+{
+/** \class OGRListSampleChunkReader
+ *  \brief Read samples stored in OGR layers by chunks of bounded size
+ *
+ * The samples are read from the fields of one layer in a list of vector
+ * files. Each call to ReadNextChunk() fills the output list samples with at
+ * most ChunkSize samples, so that the memory used stays bounded whatever the
+ * total number of samples. When all the files have been read, Rewind()
+ * restarts from the first feature of the first file, which allows several
+ * passes (epochs) over the data.
+ *
+ * Feature values can be centered and reduced on the fly, with the same
+ * convention as ShiftScaleSampleListFilter : (value - shift) / scale.
+ *
+ * The chunk size can be set directly, or deduced from an amount of
+ * available memory with SetAvailableRAM().
+ *
+ * \sa ShiftScaleSampleListFilter
+ *
+ * \ingroup OTBSampling
+ */
+template <class TListSample, class TTargetListSample>
+class ITK_EXPORT OGRListSampleChunkReader : public itk::Object
+{
+public:
+  /** Standard typedefs */
+  typedef OGRListSampleChunkReader      Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(OGRListSampleChunkReader, itk::Object);
+
+  /** List sample typedefs */
+  typedef TListSample                                       ListSampleType;
+  typedef typename ListSampleType::Pointer                  ListSamplePointerType;
+  typedef typename ListSampleType::MeasurementVectorType    SampleType;
+  typedef typename SampleType::ValueType                    ValueType;
+
+  typedef TTargetListSample                                 TargetListSampleType;
+  typedef typename TargetListSampleType::Pointer            TargetListSamplePointerType;
+  typedef typename TargetListSampleType::MeasurementVectorType TargetSampleType;
+  typedef typename TargetSampleType::ValueType              TargetValueType;
+
+  typedef itk::VariableLengthVector<double>                 MeasurementType;
+
+  /** Set the list of vector files to read */
+  void SetFileNames(const std::vector<std::string> & fileNames);
+
+  /** Set/Get the index of the layer to read in each file */
+  itkSetMacro(LayerIndex, unsigned int);
+  itkGetConstMacro(LayerIndex, unsigned int);
+
+  /** Set the names of the fields used as sample features */
+  void SetFieldNames(const std::vector<std::string> & fieldNames);
+  itkGetConstReferenceMacro(FieldNames, std::vector<std::string>);
+
+  /** Set/Get the name of the field containing the class label. If empty,
+   *  all targets are set to 0. */
+  itkSetMacro(ClassFieldName, std::string);
+  itkGetConstReferenceMacro(ClassFieldName, std::string);
+
+  /** Set/Get the shift applied to each feature (optional) */
+  itkSetMacro(Shifts, MeasurementType);
+  itkGetConstReferenceMacro(Shifts, MeasurementType);
+
+  /** Set/Get the scale applied to each feature (optional) */
+  itkSetMacro(Scales, MeasurementType);
+  itkGetConstReferenceMacro(Scales, MeasurementType);
+
+  /** Set/Get the maximum number of samples in a chunk */
+  itkSetMacro(ChunkSize, unsigned long);
+  itkGetConstMacro(ChunkSize, unsigned long);
+
+  /** Deduce the chunk size from an amount of available memory (in MB).
+   *  The field names must be set before calling this method. */
+  void SetAvailableRAM(unsigned int ram);
+
+  /** Conservative estimation of the memory (in bytes) used by one sample,
+   *  including the copy made by the learning libraries during training */
+  static unsigned long EstimateSampleMemorySize(unsigned int nbFeatures);
+
+  /** Restart reading from the first feature of the first file */
+  void Rewind();
+
+  /** Read the next chunk of samples. Returns false when there is no more
+   *  sample to read. */
+  bool ReadNextChunk();
+
+  /** Scan all the files and return the sorted list of distinct class labels.
+   *  Only the class field is read, and the reading position is rewound. */
+  std::vector<TargetValueType> ReadClassLabels();
+
+  /** Get the samples of the last chunk read */
+  itkGetObjectMacro(ListSample, ListSampleType);
+
+  /** Get the targets of the last chunk read */
+  itkGetObjectMacro(TargetListSample, TargetListSampleType);
+
+  /** Get the number of samples read since the last Rewind() */
+  itkGetConstMacro(NumberOfSamplesRead, unsigned long);
+
+protected:
+  /** Constructor */
+  OGRListSampleChunkReader();
+  /** Destructor */
+  ~OGRListSampleChunkReader() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+private:
+  OGRListSampleChunkReader(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Open the next file to read, returns false if all files are done */
+  bool OpenNextFile();
+
+  /** Release the current file */
+  void CloseCurrentFile();
+
+  std::vector<std::string> m_FileNames;
+
+  unsigned int m_LayerIndex;
+
+  std::vector<std::string> m_FieldNames;
+
+  std::string m_ClassFieldName;
+
+  MeasurementType m_Shifts;
+
+  MeasurementType m_Scales;
+
+  unsigned long m_ChunkSize;
+
+  ListSamplePointerType m_ListSample;
+
+  TargetListSamplePointerType m_TargetListSample;
+
+  unsigned long m_NumberOfSamplesRead;
+
+  /** Index of the next file to open */
+  unsigned int m_NextFileIndex;
+
+  /** Current data source, null when no file is opened */
+  ogr::DataSource::Pointer m_DataSource;
+
+  /** Current layer, owned by m_DataSource */
+  OGRLayer* m_Layer;
+
+  /** Indexes of the feature fields in the current layer */
+  std::vector<int> m_FieldIndex;
+
+  /** Index of the class field in the current layer */
+  int m_ClassFieldIndex;
+
+  /** Inverted scales used to reduce the values */
+  MeasurementType m_InvertedScales;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbOGRListSampleChunkReader.hxx"
+#endif
+
+#endif
@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbOGRListSampleChunkReader_hxx
+#define otbOGRListSampleChunkReader_hxx
+
+#include "otbOGRListSampleChunkReader.h"
+#include "otbOGRFeatureWrapper.h"
+#include <algorithm>
+#include <set>
+
+namespace otb
+{
+
+template <class TListSample, class TTargetListSample>
+OGRListSampleChunkReader<TListSample, TTargetListSample>
+::OGRListSampleChunkReader() :
+  m_LayerIndex(0),
+  m_ChunkSize(100000),
+  m_NumberOfSamplesRead(0),
+  m_NextFileIndex(0),
+  m_Layer(nullptr),
+  m_ClassFieldIndex(-1)
+{
+  m_ListSample = ListSampleType::New();
+  m_TargetListSample = TargetListSampleType::New();
+}
+
+template <class TListSample, class TTargetListSample>
+void
+OGRListSampleChunkReader<TListSample, TTargetListSample>
+::SetFileNames(const std::vector<std::string> & fileNames)
+{
+  m_FileNames = fileNames;
+  this->Rewind();
+  this->Modified();
+}
+
+template <class TListSample, class TTargetListSample>
+void
+OGRListSampleChunkReader<TListSample, TTargetListSample>
+::SetFieldNames(const std::vector<std::string> & fieldNames)
+{
+  m_FieldNames = fieldNames;
+  this->Modified();
+}
+
+template <class TListSample, class TTargetListSample>
+unsigned long
+OGRListSampleChunkReader<TListSample, TTargetListSample>
+::EstimateSampleMemorySize(unsigned int nbFeatures)
+{
+  // Sample as stored in the list sample (vector header, buffer and
+  // allocator overhead), then the same sample converted to double by the
+  // learning library, then the target.
+  const unsigned long overhead = 16;
+  const unsigned long stored = sizeof(SampleType) + nbFeatures * sizeof(ValueType) + overhead;
+  const unsigned long converted = sizeof(SampleType) + nbFeatures * sizeof(double) + overhead;
+  return stored + converted + 2 * sizeof(TargetSampleType);
+}
+
+template <class TListSample, class TTargetListSample>
+void
+OGRListSampleChunkReader<TListSample, TTargetListSample>
+::SetAvailableRAM(unsigned int ram)
+{
+  if (m_FieldNames.empty())
+    {
+    itkExceptionMacro(<< "Field names must be set before computing the chunk size");
+    }
+  const unsigned long sampleSize =
+    EstimateSampleMemorySize(static_cast<unsigned int>(m_FieldNames.size()));
+  const unsigned long budget = static_cast<unsigned long>(ram) * 1024UL * 1024UL;
+  this->SetChunkSize(std::max(1UL, budget / sampleSize));
+}
+
+template <class TListSample, class TTargetListSample>
+void
+OGRListSampleChunkReader<TListSample, TTargetListSample>
+::Rewind()
+{
+  this->CloseCurrentFile();
+  m_NextFileIndex = 0;
+  m_NumberOfSamplesRead = 0;
+  m_ListSample->Clear();
+  m_TargetListSample->Clear();
+}
+
+template <class TListSample, class TTargetListSample>
+void
+OGRListSampleChunkReader<TListSample, TTargetListSample>
+::CloseCurrentFile()
+{
+  m_Layer = nullptr;
+  m_DataSource = nullptr;
+  m_FieldIndex.clear();
+  m_ClassFieldIndex = -1;
+}
+
+template <class TListSample, class TTargetListSample>
+bool
+OGRListSampleChunkReader<TListSample, TTargetListSample>
+::OpenNextFile()
+{
+  this->CloseCurrentFile();
+  if (m_NextFileIndex >= m_FileNames.size())
+    {
+    return false;
+    }
+
+  const std::string & fileName = m_FileNames[m_NextFileIndex];
+  ++m_NextFileIndex;
+
+  m_DataSource = ogr::DataSource::New(fileName, ogr::DataSource::Modes::Read);
+  if (static_cast<int>(m_LayerIndex) >= m_DataSource->GetLayersCount())
+    {
+    itkExceptionMacro(<< "Layer " << m_LayerIndex << " not found in " << fileName);
+    }
+  m_Layer = &(m_DataSource->GetLayer(m_LayerIndex).ogr());
+  m_Layer->ResetReading();
+
+  OGRFeatureDefn & defn = *(m_Layer->GetLayerDefn());
+  m_ClassFieldIndex = -1;
+  if (!m_ClassFieldName.empty())
+    {
+    m_ClassFieldIndex = defn.GetFieldIndex(m_ClassFieldName.c_str());
+    if (m_ClassFieldIndex < 0)
+      {
+      itkExceptionMacro(<< "The field name for class label (" << m_ClassFieldName
+                        << ") has not been found in the vector file " << fileName);
+      }
+    }
+
+  m_FieldIndex.assign(m_FieldNames.size(), -1);
+  for (unsigned int i = 0; i < m_FieldNames.size(); ++i)
+    {
+    m_FieldIndex[i] = defn.GetFieldIndex(m_FieldNames[i].c_str());
+    if (m_FieldIndex[i] < 0)
+      {
+      itkExceptionMacro(<< "The field name for feature " << m_FieldNames[i]
+                        << " has not been found in the vector file " << fileName);
+      }
+    }
+  return true;
+}
+
+template <class TListSample, class TTargetListSample>
+bool
+OGRListSampleChunkReader<TListSample, TTargetListSample>
+::ReadNextChunk()
+{
+  const unsigned int nbFeatures = static_cast<unsigned int>(m_FieldNames.size());
+
+  // Prepare the shift and scale, defaulting to identity
+  MeasurementType shifts(nbFeatures);
+  shifts.Fill(0.);
+  m_InvertedScales.SetSize(nbFeatures);
+  m_InvertedScales.Fill(1.);
+  if (m_Shifts.Size() == nbFeatures)
+    {
+    shifts = m_Shifts;
+    }
+  if (m_Scales.Size() == nbFeatures)
+    {
+    for (unsigned int idx = 0; idx < nbFeatures; ++idx)
+      {
+      m_InvertedScales[idx] = (m_Scales[idx] - 1e-10 < 0.) ? 0. : 1. / m_Scales[idx];
+      }
+    }
+
+  m_ListSample->Clear();
+  m_TargetListSample->Clear();
+  m_ListSample->SetMeasurementVectorSize(nbFeatures);
+
+  SampleType mv;
+  mv.SetSize(nbFeatures);
+  TargetSampleType target;
+
+  while (m_ListSample->Size() < m_ChunkSize)
+    {
+    if (m_Layer == nullptr && !this->OpenNextFile())
+      {
+      break;
+      }
+
+    ogr::Feature feature(m_Layer->GetNextFeature());
+    if (feature.addr() == nullptr)
+      {
+      this->CloseCurrentFile();
+      continue;
+      }
+
+    for (unsigned int idx = 0; idx < nbFeatures; ++idx)
+      {
+      mv[idx] = static_cast<ValueType>(
+        (feature.ogr().GetFieldAsDouble(m_FieldIndex[idx]) - shifts[idx]) * m_InvertedScales[idx]);
+      }
+    m_ListSample->PushBack(mv);
+
+    if (m_ClassFieldIndex >= 0 && ogr::Field(feature, m_ClassFieldIndex).HasBeenSet())
+      {
+      target[0] = static_cast<TargetValueType>(feature.ogr().GetFieldAsInteger(m_ClassFieldIndex));
+      }
+    else
+      {
+      target[0] = static_cast<TargetValueType>(0);
+      }
+    m_TargetListSample->PushBack(target);
+    }
+
+  m_NumberOfSamplesRead += m_ListSample->Size();
+  return m_ListSample->Size() > 0;
+}
+
+template <class TListSample, class TTargetListSample>
+std::vector<typename OGRListSampleChunkReader<TListSample, TTargetListSample>::TargetValueType>
+OGRListSampleChunkReader<TListSample, TTargetListSample>
+::ReadClassLabels()
+{
+  std::set<TargetValueType> labels;
+  this->Rewind();
+  if (!m_ClassFieldName.empty())
+    {
+    while (this->OpenNextFile())
+      {
+      for (ogr::Feature feature(m_Layer->GetNextFeature()); feature.addr() != nullptr;
+           feature = ogr::Feature(m_Layer->GetNextFeature()))
+        {
+        if (ogr::Field(feature, m_ClassFieldIndex).HasBeenSet())
+          {
+          labels.insert(static_cast<TargetValueType>(feature.ogr().GetFieldAsInteger(m_ClassFieldIndex)));
+          }
+        else
+          {
+          labels.insert(static_cast<TargetValueType>(0));
+          }
+        }
+      }
+    }
+  this->Rewind();
+  return std::vector<TargetValueType>(labels.begin(), labels.end());
+}
+
+template <class TListSample, class TTargetListSample>
+void
+OGRListSampleChunkReader<TListSample, TTargetListSample>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of files: " << m_FileNames.size() << std::endl;
+  os << indent << "Layer index: " << m_LayerIndex << std::endl;
+  os << indent << "Number of fields: " << m_FieldNames.size() << std::endl;
+  os << indent << "Class field: " << m_ClassFieldName << std::endl;
+  os << indent << "Chunk size: " << m_ChunkSize << std::endl;
+  os << indent << "Samples read: " << m_NumberOfSamplesRead << std::endl;
+}
+
+} // end namespace otb
+
+#endif
@@ -23,6 +23,7 @@
 
 #include "otbPersistentImageFilter.h"
 #include "otbOGRDataSourceWrapper.h"
+#include "otbOGRLayerGridIndex.h"
 #include "otbImage.h"
 #include <string>
 
@@ -94,6 +95,30 @@ public:
   itkSetMacro(OutLayerName, std::string);
   itkGetMacro(OutLayerName, std::string);
 
+  /** Set/Get macro for the spatial sorting of input features. When enabled,
+   *  the features of each streaming division are sorted by image row (then
+   *  column) before being dispatched to the threads, so that each thread
+   *  works on a compact band of the division. Default is false, which keeps
+   *  the order of the input layer. */
+  itkSetMacro(SpatialSorting, bool);
+  itkGetMacro(SpatialSorting, bool);
+  itkBooleanMacro(SpatialSorting);
+
+  /** Set/Get macro for the maximum number of features written to an output
+   *  layer within one transaction. Default is 0 : one transaction for each
+   *  streaming division. */
+  itkSetMacro(TransactionSize, unsigned long);
+  itkGetMacro(TransactionSize, unsigned long);
+
+  /** Set/Get macro for the use of an in-memory spatial index. When enabled
+   *  (default) and the input layer supports random reading, the envelopes
+   *  of all features are indexed once, and each streaming division only
+   *  reads the features it intersects. Otherwise, the features are selected
+   *  with an OGR spatial filter for each division. */
+  itkSetMacro(UseSpatialIndex, bool);
+  itkGetMacro(UseSpatialIndex, bool);
+  itkBooleanMacro(UseSpatialIndex);
+
 protected:
   /** Constructor */
   PersistentSamplingFilterBase();
@@ -163,6 +188,9 @@ protected:
    *  each thread.*/
   virtual void DispatchInputVectors(void);
 
+  /** Build the spatial index of the input layer, if not up to date */
+  void UpdateSpatialIndex();
+
   /** Gather the content of in-memory output layer into the filter outputs */
   virtual void GatherOutputVectors(void);
 
@@ -225,6 +253,22 @@ private:
   /** Creation option for output layers */
   std::vector<std::string> m_OGRLayerCreationOptions;
 
+  /** Sort features by position before dispatching them */
+  bool m_SpatialSorting;
+
+  /** Maximum number of features per transaction (0 for no limit) */
+  unsigned long m_TransactionSize;
+
+  /** Use an in-memory spatial index to select features */
+  bool m_UseSpatialIndex;
+
+  /** Spatial index of the input layer */
+  OGRLayerGridIndex::Pointer m_SpatialIndex;
+
+  /** Data source and layer index used to build the spatial index */
+  const ogr::DataSource* m_SpatialIndexData;
+  int m_SpatialIndexLayer;
+
   /** Additional field definitions to add in output data sources */
   std::vector<SimpleFieldDefn> m_AdditionalFields;
 
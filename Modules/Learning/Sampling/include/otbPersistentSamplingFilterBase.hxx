@@ -28,6 +28,7 @@
 #include "otbMacro.h"
 #include "otbStopwatch.h"
 #include "itkProgressReporter.h"
+#include <algorithm>
 
 namespace otb
 {
@@ -40,6 +41,11 @@ PersistentSamplingFilterBase<TInputImage,TMaskImage>
   , m_LayerIndex(0)
   , m_OutLayerName(std::string("output"))
   , m_OGRLayerCreationOptions()
+  , m_SpatialSorting(false)
+  , m_TransactionSize(0)
+  , m_UseSpatialIndex(true)
+  , m_SpatialIndexData(nullptr)
+  , m_SpatialIndexLayer(-1)
   , m_AdditionalFields()
   , m_InMemoryInputs()
   , m_InMemoryOutputs()
@@ -315,6 +321,7 @@ PersistentSamplingFilterBase<TInputImage,TMaskImage>
     itkExceptionMacro(<< "Unable to start transaction for OGR layer " << outLayer.ogr().GetName() << ".");
     }
 
+  unsigned long featuresInTransaction = 0;
   unsigned int numberOfThreads = this->GetNumberOfThreads();
   for (unsigned int thread=0 ; thread < numberOfThreads ; thread++)
     {
@@ -324,25 +331,44 @@ PersistentSamplingFilterBase<TInputImage,TMaskImage>
       continue;
       }
 
+    // In-memory layers may not have their fields in the same order as the
+    // output layer : compute the field mapping once instead of matching
+    // the field names for each feature.
+    OGRFeatureDefn &inLayerDefn = inLayer.GetLayerDefn();
+    OGRFeatureDefn &outLayerDefn = outLayer.GetLayerDefn();
+    std::vector<int> fieldMap(inLayerDefn.GetFieldCount());
+    for (int f=0 ; f < inLayerDefn.GetFieldCount() ; f++)
+      {
+      fieldMap[f] = outLayerDefn.GetFieldIndex(inLayerDefn.GetFieldDefn(f)->GetNameRef());
+      }
+
     ogr::Layer::const_iterator tmpIt = inLayer.begin();
-    // This test only uses 1 input, not compatible with multiple OGRData inputs
-    if (update)
+    for(; tmpIt!=inLayer.end(); ++tmpIt)
       {
-      // Update mode
-      for(; tmpIt!=inLayer.end(); ++tmpIt)
+      // This test only uses 1 input, not compatible with multiple OGRData inputs
+      if (update)
         {
+        // Update mode
         outLayer.SetFeature( *tmpIt );
         }
-      }
-    else
-      {
-      // Copy mode
-      for(; tmpIt!=inLayer.end(); ++tmpIt)
+      else
         {
-        ogr::Feature dstFeature(outLayer.GetLayerDefn());
-        dstFeature.SetFrom( *tmpIt, TRUE );
+        // Copy mode
+        ogr::Feature dstFeature(outLayerDefn);
+        dstFeature.SetFrom( *tmpIt, fieldMap.empty() ? nullptr : &fieldMap[0], TRUE );
         outLayer.CreateFeature( dstFeature );
         }
+
+      // Split in several transactions if requested
+      if (m_TransactionSize > 0 && ++featuresInTransaction >= m_TransactionSize)
+        {
+        featuresInTransaction = 0;
+        if (outLayer.ogr().CommitTransaction() != OGRERR_NONE ||
+            outLayer.ogr().StartTransaction() != OGRERR_NONE)
+          {
+          itkExceptionMacro(<< "Unable to flush transaction for OGR layer " << outLayer.ogr().GetName() << ".");
+          }
+        }
       }
     }
 
@@ -536,50 +562,102 @@ PersistentSamplingFilterBase<TInputImage,TMaskImage>
                  itk::ThreadIdType& threadid)
 {
   const TInputImage* img = this->GetInput();
-  TMaskImage* mask = const_cast<TMaskImage*>(this->GetMask());
+  const TMaskImage* mask = this->GetMask();
   typename TInputImage::IndexType imgIndex;
   typename TInputImage::PointType imgPoint;
-  OGRPoint tmpPoint;
 
-  if (mask)
+  // The polygon is scanned row by row in image index space : for each
+  // row, the crossings between the row and each ring are computed once,
+  // and each pixel parity is deduced from the crossings on its right.
+  // This is the crossing rule of OGRLinearRing::isPointInRing(), expressed
+  // in index space. The orientation of physical axes along index axes is
+  // used to keep the same convention for pixels on a ring boundary.
+  typename TInputImage::PointType origin, nextCol, nextRow;
+  imgIndex.Fill(0);
+  img->TransformIndexToPhysicalPoint(imgIndex, origin);
+  imgIndex[0] = 1;
+  img->TransformIndexToPhysicalPoint(imgIndex, nextCol);
+  imgIndex[0] = 0;
+  imgIndex[1] = 1;
+  img->TransformIndexToPhysicalPoint(imgIndex, nextRow);
+  const bool flipX = (nextCol[0] < origin[0]);
+  const bool flipY = (nextRow[1] < origin[1]);
+
+  // Convert the rings vertices into continuous indexes
+  const int nbRings = 1 + polygon->getNumInteriorRings();
+  std::vector<std::vector<itk::ContinuousIndex<double, 2> > > rings(nbRings);
+  itk::ContinuousIndex<double, 2> cIndex;
+  for (int r = 0; r < nbRings; ++r)
     {
-    // For pixels in consideredRegion and not masked
-    typedef MaskedIteratorDecorator<
-      itk::ImageRegionConstIterator<TMaskImage>,
-      itk::ImageRegionConstIterator<TMaskImage> > MaskedIteratorType;
-    MaskedIteratorType it(mask, mask, region);
-    it.GoToBegin();
-    while (!it.IsAtEnd())
+    OGRLinearRing* ring = (r == 0 ? polygon->getExteriorRing() : polygon->getInteriorRing(r - 1));
+    rings[r].reserve(ring->getNumPoints());
+    for (int k = 0; k < ring->getNumPoints(); ++k)
       {
-      imgIndex = it.GetIndex();
-      img->TransformIndexToPhysicalPoint(imgIndex,imgPoint);
-      tmpPoint.setX(imgPoint[0]);
-      tmpPoint.setY(imgPoint[1]);
-      bool isInside = this->IsSampleInsidePolygon(polygon,&tmpPoint);
-      if (isInside)
-        {
-        this->ProcessSample(feature,imgIndex, imgPoint, threadid);
-        }
-      ++it;
+      imgPoint[0] = ring->getX(k);
+      imgPoint[1] = ring->getY(k);
+      img->TransformPhysicalPointToContinuousIndex(imgPoint, cIndex);
+      rings[r].push_back(cIndex);
       }
     }
-  else
+
+  std::vector<std::vector<double> > crossings(nbRings);
+  const long startX = region.GetIndex(0);
+  const long endX = startX + static_cast<long>(region.GetSize(0));
+  const long startY = region.GetIndex(1);
+  const long endY = startY + static_cast<long>(region.GetSize(1));
+  for (long y = startY; y < endY; ++y)
     {
-    typedef itk::ImageRegionConstIteratorWithOnlyIndex<TInputImage> NoValueIteratorType;
-    NoValueIteratorType it(img,region);
-    it.GoToBegin();
-    while (!it.IsAtEnd())
+    // Compute the crossings of each ring with the row
+    for (int r = 0; r < nbRings; ++r)
       {
-      imgIndex = it.GetIndex();
-      img->TransformIndexToPhysicalPoint(imgIndex,imgPoint);
-      tmpPoint.setX(imgPoint[0]);
-      tmpPoint.setY(imgPoint[1]);
-      bool isInside = this->IsSampleInsidePolygon(polygon,&tmpPoint);
-      if (isInside)
+      crossings[r].clear();
+      const std::vector<itk::ContinuousIndex<double, 2> >& pts = rings[r];
+      for (unsigned int k = 1; k < pts.size(); ++k)
         {
-        this->ProcessSample(feature,imgIndex, imgPoint, threadid);
+        const double y1 = pts[k][1] - y;
+        const double y2 = pts[k - 1][1] - y;
+        const bool above1 = flipY ? (y1 < 0) : (y1 > 0);
+        const bool above2 = flipY ? (y2 < 0) : (y2 > 0);
+        if (above1 != above2)
+          {
+          crossings[r].push_back((pts[k][0] * y2 - pts[k - 1][0] * y1) / (y2 - y1));
+          }
         }
-      ++it;
+      std::sort(crossings[r].begin(), crossings[r].end());
+      }
+    if (crossings[0].empty())
+      {
+      continue;
+      }
+
+    imgIndex[1] = y;
+    for (long x = startX; x < endX; ++x)
+      {
+      bool isInside = true;
+      for (int r = 0; r < nbRings; ++r)
+        {
+        const std::vector<double>& cross = crossings[r];
+        const std::size_t nbOnSide = flipX ?
+          std::lower_bound(cross.begin(), cross.end(), static_cast<double>(x)) - cross.begin() :
+          cross.end() - std::upper_bound(cross.begin(), cross.end(), static_cast<double>(x));
+        // inside the exterior ring and outside the interior rings
+        if ((nbOnSide % 2 == 1) != (r == 0))
+          {
+          isInside = false;
+          break;
+          }
+        }
+      if (!isInside)
+        {
+        continue;
+        }
+      imgIndex[0] = x;
+      if (mask && mask->GetPixel(imgIndex) == 0)
+        {
+        continue;
+        }
+      img->TransformIndexToPhysicalPoint(imgIndex, imgPoint);
+      this->ProcessSample(feature, imgIndex, imgPoint, threadid);
       }
     }
 }
@@ -728,7 +806,40 @@ PersistentSamplingFilterBase<TInputImage,TMaskImage>
   ring.addPoint(startPoint[0],startPoint[1],0.0);
   tmpPolygon.addRing(&ring);
 
-  inLayer.SetSpatialFilter(&tmpPolygon);
+  // Select the features intersecting the division
+  std::vector<ogr::Feature> features;
+  if (m_UseSpatialIndex && inLayer.ogr().TestCapability(OLCRandomRead))
+    {
+    this->UpdateSpatialIndex();
+    OGREnvelope divisionEnvelope;
+    tmpPolygon.getEnvelope(&divisionEnvelope);
+    OGRLayerGridIndex::FIDListType fids;
+    m_SpatialIndex->Query(divisionEnvelope, fids);
+    features.reserve(fids.size());
+    OGREnvelope envelope;
+    for (unsigned long k=0 ; k < fids.size() ; k++)
+      {
+      ogr::Feature feat = inLayer.GetFeature(static_cast<long>(fids[k]));
+      // Same test as the OGR spatial filter : the feature is kept if its
+      // envelope is inside the division, or if its geometry intersects it
+      OGRGeometry const* geom = feat.GetGeometry();
+      geom->getEnvelope(&envelope);
+      if (divisionEnvelope.Contains(envelope) || geom->Intersects(&tmpPolygon))
+        {
+        features.push_back(feat);
+        }
+      }
+    }
+  else
+    {
+    inLayer.SetSpatialFilter(&tmpPolygon);
+    ogr::Layer::const_iterator featIt = inLayer.begin();
+    for(; featIt!=inLayer.end(); ++featIt)
+      {
+      features.push_back(featIt->Clone());
+      }
+    inLayer.SetSpatialFilter(nullptr);
+    }
 
   unsigned int numberOfThreads = this->GetNumberOfThreads();
   std::vector<ogr::Layer> tmpLayers;
@@ -738,18 +849,56 @@ PersistentSamplingFilterBase<TInputImage,TMaskImage>
     tmpLayers.push_back(this->GetInMemoryInput(i));
     }
 
-  const unsigned int nbFeatThread = std::ceil(inLayer.GetFeatureCount(true) / (float) numberOfThreads);
+  // Order in which the features are dispatched
+  std::vector<unsigned long> order(features.size());
+  for (unsigned long k=0 ; k < features.size() ; k++)
+    {
+    order[k] = k;
+    }
+  if (m_SpatialSorting)
+    {
+    // Sort the features of the division by the image index of the
+    // lower-left corner of their envelope (row first)
+    typedef std::pair<std::pair<long, long>, unsigned long> SortKeyType;
+    std::vector<SortKeyType> keys;
+    keys.reserve(features.size());
+    OGREnvelope envelope;
+    itk::Point<double, 2> corner;
+    typename TInputImage::IndexType cornerIndex;
+    for (unsigned long k=0 ; k < features.size() ; k++)
+      {
+      OGRGeometry const* geom = features[k].GetGeometry();
+      cornerIndex = requestedRegion.GetIndex();
+      if (geom)
+        {
+        geom->getEnvelope(&envelope);
+        corner[0] = envelope.MinX;
+        corner[1] = envelope.MinY;
+        outputImage->TransformPhysicalPointToIndex(corner, cornerIndex);
+        }
+      keys.push_back(SortKeyType(std::make_pair(static_cast<long>(cornerIndex[1]),
+                                                static_cast<long>(cornerIndex[0])),
+                                 k));
+      }
+    std::stable_sort(keys.begin(), keys.end());
+    for (unsigned long k=0 ; k < keys.size() ; k++)
+      {
+      order[k] = keys[k].second;
+      }
+    }
+
+  const unsigned int nbFeatThread = std::ceil(features.size() / (float) numberOfThreads);
   //assert(nbFeatThread > 0);
 
   OGRFeatureDefn &layerDefn = inLayer.GetLayerDefn();
-  ogr::Layer::const_iterator featIt = inLayer.begin();
   unsigned int counter=0;
   unsigned int cptFeat = 0;
-  for(; featIt!=inLayer.end(); ++featIt)
+  for (unsigned long k=0 ; k < order.size() ; k++)
     {
+    const ogr::Feature& srcFeature = features[order[k]];
     ogr::Feature dstFeature(layerDefn);
-    dstFeature.SetFrom( *featIt, TRUE );
-    dstFeature.SetFID(featIt->GetFID());
+    dstFeature.SetFrom( srcFeature, TRUE );
+    dstFeature.SetFID(srcFeature.GetFID());
     tmpLayers[counter].CreateFeature( dstFeature );
     cptFeat++;
     if (cptFeat > nbFeatThread && (counter + 1) < numberOfThreads)
@@ -758,8 +907,30 @@ PersistentSamplingFilterBase<TInputImage,TMaskImage>
       cptFeat=0;
       }
     }
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentSamplingFilterBase<TInputImage,TMaskImage>
+::UpdateSpatialIndex()
+{
+  const ogr::DataSource* vectors = this->GetOGRData();
+  if (m_SpatialIndex.IsNull())
+    {
+    m_SpatialIndex = OGRLayerGridIndex::New();
+    }
+  else if (m_SpatialIndexData == vectors &&
+           m_SpatialIndexLayer == m_LayerIndex &&
+           m_SpatialIndex->GetMTime() > vectors->GetMTime())
+    {
+    // index is up to date
+    return;
+    }
 
-  inLayer.SetSpatialFilter(nullptr);
+  ogr::Layer inLayer = const_cast<ogr::DataSource*>(vectors)->GetLayer(m_LayerIndex);
+  m_SpatialIndex->Build(inLayer);
+  m_SpatialIndexData = vectors;
+  m_SpatialIndexLayer = m_LayerIndex;
 }
 
 template<class TInputImage, class TMaskImage>
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbOGRLayerGridIndex.h"
+#include "otbOGRFeatureWrapper.h"
+#include <algorithm>
+#include <cmath>
+
+namespace otb
+{
+
+OGRLayerGridIndex::OGRLayerGridIndex()
+  : m_FeaturesPerCell(4)
+  , m_GridSizeX(0)
+  , m_GridSizeY(0)
+{
+}
+
+void
+OGRLayerGridIndex::Clear()
+{
+  m_Extent = OGREnvelope();
+  m_GridSizeX = 0;
+  m_GridSizeY = 0;
+  m_Envelopes.clear();
+  m_FIDs.clear();
+  m_CellStart.clear();
+  m_CellContent.clear();
+  this->Modified();
+}
+
+void
+OGRLayerGridIndex::Build(ogr::Layer& layer)
+{
+  this->Clear();
+
+  // Read all the envelopes
+  layer.SetSpatialFilter(nullptr);
+  OGREnvelope envelope;
+  ogr::Layer::const_iterator featIt = layer.begin();
+  for(; featIt!=layer.end(); ++featIt)
+    {
+    OGRGeometry const* geom = featIt->GetGeometry();
+    if (!geom)
+      {
+      continue;
+      }
+    geom->getEnvelope(&envelope);
+    m_Envelopes.push_back(envelope);
+    m_FIDs.push_back(featIt->GetFID());
+    m_Extent.Merge(envelope);
+    }
+
+  if (m_FIDs.empty())
+    {
+    return;
+    }
+
+  // Choose a grid with about m_FeaturesPerCell features per cell, with
+  // cells as square as possible
+  const double width = std::max(m_Extent.MaxX - m_Extent.MinX, 1e-12);
+  const double height = std::max(m_Extent.MaxY - m_Extent.MinY, 1e-12);
+  const double nbCells = std::max(1.0,
+    static_cast<double>(m_FIDs.size()) / std::max(1u, m_FeaturesPerCell));
+  const double cellSize = std::sqrt(width * height / nbCells);
+  m_GridSizeX = static_cast<unsigned int>(
+    std::min(4096.0, std::max(1.0, std::ceil(width / cellSize))));
+  m_GridSizeY = static_cast<unsigned int>(
+    std::min(4096.0, std::max(1.0, std::ceil(height / cellSize))));
+
+  // Count the features in each cell, then fill the cells
+  const unsigned long totalCells =
+    static_cast<unsigned long>(m_GridSizeX) * m_GridSizeY;
+  m_CellStart.assign(totalCells + 1, 0);
+  unsigned int x0, y0, x1, y1;
+  for (unsigned long k = 0; k < m_Envelopes.size(); ++k)
+    {
+    GetCellRange(m_Envelopes[k], x0, y0, x1, y1);
+    for (unsigned int y = y0; y <= y1; ++y)
+      {
+      for (unsigned int x = x0; x <= x1; ++x)
+        {
+        ++m_CellStart[static_cast<unsigned long>(y) * m_GridSizeX + x + 1];
+        }
+      }
+    }
+  for (unsigned long c = 0; c < totalCells; ++c)
+    {
+    m_CellStart[c + 1] += m_CellStart[c];
+    }
+  m_CellContent.resize(m_CellStart[totalCells]);
+  std::vector<unsigned long> cursor(m_CellStart.begin(), m_CellStart.end() - 1);
+  for (unsigned long k = 0; k < m_Envelopes.size(); ++k)
+    {
+    GetCellRange(m_Envelopes[k], x0, y0, x1, y1);
+    for (unsigned int y = y0; y <= y1; ++y)
+      {
+      for (unsigned int x = x0; x <= x1; ++x)
+        {
+        m_CellContent[cursor[static_cast<unsigned long>(y) * m_GridSizeX + x]++] = k;
+        }
+      }
+    }
+  this->Modified();
+}
+
+bool
+OGRLayerGridIndex::GetCellRange(const OGREnvelope& envelope,
+                                unsigned int& x0, unsigned int& y0,
+                                unsigned int& x1, unsigned int& y1) const
+{
+  if (m_GridSizeX == 0 || !envelope.Intersects(m_Extent))
+    {
+    return false;
+    }
+  const double cellWidth = (m_Extent.MaxX - m_Extent.MinX) / m_GridSizeX;
+  const double cellHeight = (m_Extent.MaxY - m_Extent.MinY) / m_GridSizeY;
+  const double lastX = static_cast<double>(m_GridSizeX - 1);
+  const double lastY = static_cast<double>(m_GridSizeY - 1);
+  x0 = static_cast<unsigned int>(cellWidth > 0.0 ? std::min(lastX,
+    std::max(0.0, std::floor((envelope.MinX - m_Extent.MinX) / cellWidth))) : 0.0);
+  x1 = static_cast<unsigned int>(cellWidth > 0.0 ? std::min(lastX,
+    std::max(0.0, std::floor((envelope.MaxX - m_Extent.MinX) / cellWidth))) : 0.0);
+  y0 = static_cast<unsigned int>(cellHeight > 0.0 ? std::min(lastY,
+    std::max(0.0, std::floor((envelope.MinY - m_Extent.MinY) / cellHeight))) : 0.0);
+  y1 = static_cast<unsigned int>(cellHeight > 0.0 ? std::min(lastY,
+    std::max(0.0, std::floor((envelope.MaxY - m_Extent.MinY) / cellHeight))) : 0.0);
+  return true;
+}
+
+void
+OGRLayerGridIndex::Query(const OGREnvelope& envelope, FIDListType& fids) const
+{
+  fids.clear();
+  unsigned int x0, y0, x1, y1;
+  if (!GetCellRange(envelope, x0, y0, x1, y1))
+    {
+    return;
+    }
+
+  std::vector<unsigned long> found;
+  for (unsigned int y = y0; y <= y1; ++y)
+    {
+    for (unsigned int x = x0; x <= x1; ++x)
+      {
+      const unsigned long cell = static_cast<unsigned long>(y) * m_GridSizeX + x;
+      for (unsigned long p = m_CellStart[cell]; p < m_CellStart[cell + 1]; ++p)
+        {
+        if (m_Envelopes[m_CellContent[p]].Intersects(envelope))
+          {
+          found.push_back(m_CellContent[p]);
+          }
+        }
+      }
+    }
+
+  // Features spanning several cells are found several times
+  std::sort(found.begin(), found.end());
+  found.erase(std::unique(found.begin(), found.end()), found.end());
+  fids.reserve(found.size());
+  for (unsigned long k = 0; k < found.size(); ++k)
+    {
+    fids.push_back(m_FIDs[found[k]]);
+    }
+}
+
+void
+OGRLayerGridIndex::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of features: " << m_FIDs.size() << std::endl;
+  os << indent << "Grid size: " << m_GridSizeX << " x " << m_GridSizeY << std::endl;
+  os << indent << "Features per cell: " << m_FeaturesPerCell << std::endl;
+}
+
+} // end namespace otb
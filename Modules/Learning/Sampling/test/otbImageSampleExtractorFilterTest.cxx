@@ -89,13 +89,23 @@ int otbImageSampleExtractorFilterUpdate(int argc, char* argv[])
 
   if (argc < 3)
     {
-    std::cout << "Usage : "<<argv[0]<< "  input_vector  output" << std::endl;
+    std::cout << "Usage : "<<argv[0]<< "  input_vector  output  [transaction_size]" << std::endl;
     return EXIT_FAILURE;
     }
 
   std::string vectorPath(argv[1]);
   std::string outputPath(argv[2]);
 
+  // When a transaction size is given, also enable the spatial sorting :
+  // in update mode, the output must stay identical
+  bool spatialSorting = false;
+  unsigned long transactionSize = 0;
+  if (argc > 3)
+    {
+    spatialSorting = true;
+    transactionSize = atoi(argv[3]);
+    }
+
   otb::ogr::DataSource::Pointer vectors = otb::ogr::DataSource::New(vectorPath);
   otb::ogr::DataSource::Pointer output =
     otb::ogr::DataSource::New(outputPath,otb::ogr::DataSource::Modes::Overwrite);
@@ -157,6 +167,8 @@ int otbImageSampleExtractorFilterUpdate(int argc, char* argv[])
       filter->SetOutputSamples(outputUpdate);
       filter->SetClassFieldName(classFieldName);
       filter->SetOutputFieldPrefix(outputPrefix);
+      filter->GetFilter()->SetSpatialSorting(spatialSorting);
+      filter->GetFilter()->SetTransactionSize(transactionSize);
 
       otb::Stopwatch chrono = otb::Stopwatch::StartNew();
       filter->Update();
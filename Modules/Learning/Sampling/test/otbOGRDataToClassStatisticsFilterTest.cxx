@@ -22,6 +22,7 @@
 #include "otbOGRDataToClassStatisticsFilter.h"
 #include "otbVectorImage.h"
 #include "otbImage.h"
+#include "otbStopwatch.h"
 #include <fstream>
 
 
@@ -139,3 +140,124 @@ int otbOGRDataToClassStatisticsFilter(int argc, char* argv[])
   ofs.close();
   return EXIT_SUCCESS;
 }
+
+// Build a grid of square parcels of 5x5 pixels. Parcels with an even
+// position have a hole covering 1 pixel.
+static otb::ogr::DataSource::Pointer CreateParcels(unsigned int nbParcels)
+{
+  otb::ogr::DataSource::Pointer parcels = otb::ogr::DataSource::New();
+  otb::ogr::Layer layer = parcels->CreateLayer("parcels", nullptr, wkbPolygon);
+  OGRFieldDefn classField("Label", OFTInteger);
+  layer.CreateField(classField, true);
+
+  for (unsigned int q = 0; q < nbParcels; ++q)
+    {
+    for (unsigned int p = 0; p < nbParcels; ++p)
+      {
+      const double x = 5.0 * p;
+      const double y = 5.0 * q;
+      OGRPolygon polygon;
+      OGRLinearRing exterior;
+      exterior.addPoint(x, y);
+      exterior.addPoint(x + 5.0, y);
+      exterior.addPoint(x + 5.0, y + 5.0);
+      exterior.addPoint(x, y + 5.0);
+      exterior.addPoint(x, y);
+      polygon.addRing(&exterior);
+      if ((p + q) % 2 == 0)
+        {
+        OGRLinearRing hole;
+        hole.addPoint(x + 2.0, y + 2.0);
+        hole.addPoint(x + 3.0, y + 2.0);
+        hole.addPoint(x + 3.0, y + 3.0);
+        hole.addPoint(x + 2.0, y + 3.0);
+        hole.addPoint(x + 2.0, y + 2.0);
+        polygon.addRing(&hole);
+        }
+      otb::ogr::Feature feature(layer.GetLayerDefn());
+      feature[0].SetValue<int>((p + q) % 2);
+      feature.SetGeometry(&polygon);
+      layer.CreateFeature(feature);
+      }
+    }
+  return parcels;
+}
+
+int otbOGRDataToClassStatisticsFilterParcels(int argc, char* argv[])
+{
+  typedef otb::VectorImage<float> InputImageType;
+  typedef otb::Image<unsigned char> MaskImageType;
+  typedef otb::OGRDataToClassStatisticsFilter<InputImageType,MaskImageType> FilterType;
+
+  if (argc < 2)
+    {
+    std::cout << "Usage : "<<argv[0]<< " number_of_parcels_per_row" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int nbParcels = atoi(argv[1]);
+  otb::ogr::DataSource::Pointer parcels = CreateParcels(nbParcels);
+
+  InputImageType::RegionType region;
+  region.SetSize(0, 5 * nbParcels);
+  region.SetSize(1, 5 * nbParcels);
+
+  InputImageType::PointType origin;
+  origin.Fill(0.5);
+
+  InputImageType::SpacingType spacing;
+  spacing.Fill(1.0);
+
+  InputImageType::Pointer inputImage = InputImageType::New();
+  inputImage->SetNumberOfComponentsPerPixel(3);
+  inputImage->SetLargestPossibleRegion(region);
+  inputImage->SetOrigin(origin);
+  inputImage->SetSignedSpacing(spacing);
+
+  const unsigned long nbEven = (static_cast<unsigned long>(nbParcels) * nbParcels + 1) / 2;
+  const unsigned long nbOdd = static_cast<unsigned long>(nbParcels) * nbParcels - nbEven;
+
+  std::string fieldName("Label");
+  int status = EXIT_SUCCESS;
+  for (unsigned int useIndex = 0; useIndex < 2; ++useIndex)
+    {
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput(inputImage);
+    filter->SetOGRData(parcels);
+    filter->SetFieldName(fieldName);
+    filter->SetLayerIndex(0);
+    filter->GetFilter()->SetUseSpatialIndex(useIndex == 1);
+    filter->GetStreamer()->SetNumberOfDivisionsTiledStreaming(16);
+
+    otb::Stopwatch chrono = otb::Stopwatch::StartNew();
+    filter->Update();
+    chrono.Stop();
+    std::cout << "Statistics with" << (useIndex ? "" : "out") << " spatial index took "
+              << chrono.GetElapsedMilliseconds() << " ms" << std::endl;
+
+    FilterType::ClassCountMapType &classCount = filter->GetClassCountOutput()->Get();
+    FilterType::PolygonSizeMapType &polySize = filter->GetPolygonSizeOutput()->Get();
+    if (classCount["0"] != 24 * nbEven || classCount["1"] != 25 * nbOdd)
+      {
+      std::cout << "Wrong class counts : " << classCount["0"] << " / " << classCount["1"]
+                << " instead of " << 24 * nbEven << " / " << 25 * nbOdd << std::endl;
+      status = EXIT_FAILURE;
+      }
+    if (polySize.size() != nbEven + nbOdd)
+      {
+      std::cout << "Wrong number of polygons : " << polySize.size() << std::endl;
+      status = EXIT_FAILURE;
+      }
+    FilterType::PolygonSizeMapType::const_iterator itPoly;
+    for (itPoly = polySize.begin() ; itPoly != polySize.end() ; ++itPoly)
+      {
+      if (itPoly->second != 24 && itPoly->second != 25)
+        {
+        std::cout << "Wrong size for feature " << itPoly->first << " : " << itPoly->second << std::endl;
+        status = EXIT_FAILURE;
+        break;
+        }
+      }
+    }
+  return status;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbOGRListSampleChunkReader.h"
+#include "itkListSample.h"
+#include "itkFixedArray.h"
+#include <vector>
+
+
+int otbOGRListSampleChunkReader(int argc, char* argv[])
+{
+  typedef itk::VariableLengthVector<float>            SampleType;
+  typedef itk::Statistics::ListSample<SampleType>     ListSampleType;
+  typedef itk::FixedArray<int,1>                      TargetSampleType;
+  typedef itk::Statistics::ListSample<TargetSampleType> TargetListSampleType;
+  typedef otb::OGRListSampleChunkReader<ListSampleType, TargetListSampleType> ReaderType;
+
+  if (argc < 4)
+    {
+    std::cout << "Usage : "<<argv[0]<< " input_vector class_field feature_field1 ..." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::vector<std::string> fileNames(1, std::string(argv[1]));
+  std::vector<std::string> fieldNames;
+  for (int i = 3; i < argc; ++i)
+    {
+    fieldNames.push_back(std::string(argv[i]));
+    }
+
+  // Read everything in a single chunk as reference
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileNames(fileNames);
+  reader->SetFieldNames(fieldNames);
+  reader->SetClassFieldName(std::string(argv[2]));
+  reader->SetChunkSize(itk::NumericTraits<unsigned long>::max());
+  reader->ReadNextChunk();
+
+  ListSampleType::Pointer refSamples = reader->GetListSample();
+  TargetListSampleType::Pointer refTargets = reader->GetTargetListSample();
+  const unsigned long nbSamples = refSamples->Size();
+  if (nbSamples == 0 || reader->ReadNextChunk())
+    {
+    std::cout << "Reference read failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Read again in small chunks, twice to check Rewind()
+  ReaderType::Pointer chunkReader = ReaderType::New();
+  chunkReader->SetFileNames(fileNames);
+  chunkReader->SetFieldNames(fieldNames);
+  chunkReader->SetClassFieldName(std::string(argv[2]));
+  chunkReader->SetChunkSize(7);
+
+  for (unsigned int pass = 0; pass < 2; ++pass)
+    {
+    chunkReader->Rewind();
+    unsigned long id = 0;
+    while (chunkReader->ReadNextChunk())
+      {
+      ListSampleType::Pointer samples = chunkReader->GetListSample();
+      TargetListSampleType::Pointer targets = chunkReader->GetTargetListSample();
+      if (samples->Size() > chunkReader->GetChunkSize())
+        {
+        std::cout << "Chunk larger than chunk size: " << samples->Size() << std::endl;
+        return EXIT_FAILURE;
+        }
+      for (unsigned int i = 0; i < samples->Size(); ++i, ++id)
+        {
+        if (samples->GetMeasurementVector(i) != refSamples->GetMeasurementVector(id) ||
+            targets->GetMeasurementVector(i)[0] != refTargets->GetMeasurementVector(id)[0])
+          {
+          std::cout << "Sample " << id << " differs from reference" << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    if (id != nbSamples || chunkReader->GetNumberOfSamplesRead() != nbSamples)
+      {
+      std::cout << "Read " << id << " samples instead of " << nbSamples << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Memory budget gives a bounded chunk size
+  chunkReader->SetAvailableRAM(1);
+  if (chunkReader->GetChunkSize() * ReaderType::EstimateSampleMemorySize(static_cast<unsigned int>(fieldNames.size())) > 1024*1024)
+    {
+    std::cout << "Chunk size exceeds the memory budget" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::vector<int> labels = chunkReader->ReadClassLabels();
+  std::cout << "Found " << labels.size() << " classes in " << nbSamples << " samples" << std::endl;
+  if (labels.empty())
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
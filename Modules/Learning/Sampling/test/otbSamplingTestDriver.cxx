@@ -26,7 +26,9 @@ void RegisterTests()
   REGISTER_TEST(otbOGRDataToSamplePositionFilter);
   REGISTER_TEST(otbOGRDataToSamplePositionFilterPattern);
   REGISTER_TEST(otbOGRDataToClassStatisticsFilter);
+  REGISTER_TEST(otbOGRDataToClassStatisticsFilterParcels);
   REGISTER_TEST(otbImageSampleExtractorFilter);
   REGISTER_TEST(otbImageSampleExtractorFilterUpdate);
   REGISTER_TEST(otbSamplingRateCalculatorList);
+  REGISTER_TEST(otbOGRListSampleChunkReader);
 }
@@ -155,6 +155,17 @@ public:
   /** Train the machine learning model */
   void Train() override;
 
+  /** Update the network weights with the current input and target list
+   *  samples. The first call creates the network, the following ones start
+   *  from the current weights. In classification mode, the complete set of
+   *  labels must be known before the first call : either all classes are
+   *  present in the first minibatch, or SetClassLabels() has been called. */
+  void TrainIncrement() override;
+
+  /** Set the complete list of class labels, needed by TrainIncrement() when
+   *  a minibatch may not contain all the classes */
+  void SetClassLabels(const std::vector<TargetValueType> & labels);
+
   /** Save the model to file */
   void Save(const std::string & filename, const std::string & name="") override;
 
@@ -190,7 +201,7 @@ private:
   void operator =(const Self&) = delete;
 
   void CreateNetwork();
-  void SetupNetworkAndTrain(cv::Mat& labels);
+  void SetupNetworkAndTrain(cv::Mat& labels, bool updateWeights = false);
 #ifdef OTB_OPENCV_3
   cv::Ptr<cv::ml::ANN_MLP> m_ANNModel;
 #else
@@ -213,6 +224,9 @@ private:
   CvMat*             m_CvMatOfLabels;
   MapOfLabelsType    m_MapOfLabels;
 
+  /** True once TrainIncrement() has created the network */
+  bool               m_IncrementalTrainingStarted;
+
 };
 } // end namespace otb
 
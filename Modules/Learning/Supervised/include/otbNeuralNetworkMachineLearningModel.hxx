@@ -47,10 +47,12 @@ NeuralNetworkMachineLearningModel<TInputValue, TOutputValue>::NeuralNetworkMachi
   m_TermCriteriaType(CV_TERMCRIT_ITER + CV_TERMCRIT_EPS),
   m_MaxIter(1000),
   m_Epsilon(0.01),
-  m_CvMatOfLabels(nullptr)
+  m_CvMatOfLabels(nullptr),
+  m_IncrementalTrainingStarted(false)
 {
   this->m_ConfidenceIndex = true;
   this->m_IsRegressionSupported = true;
+  this->m_IsIncrementalTrainingSupported = true;
 }
 
 template<class TInputValue, class TOutputValue>
@@ -184,14 +186,22 @@ CvANN_MLP_TrainParams NeuralNetworkMachineLearningModel<TInputValue, TOutputValu
 #endif
 
 template<class TInputValue, class TOutputValue>
-void NeuralNetworkMachineLearningModel<TInputValue, TOutputValue>::SetupNetworkAndTrain(cv::Mat& labels)
+void NeuralNetworkMachineLearningModel<TInputValue, TOutputValue>::SetupNetworkAndTrain(cv::Mat& labels,
+                                                                                        bool updateWeights)
 {
   //convert listsample to opencv matrix
   cv::Mat samples;
   otb::ListSampleToMat<InputListSampleType>(this->GetInputListSample(), samples);
-  this->CreateNetwork();
+  if (!updateWeights)
+    {
+    this->CreateNetwork();
+    }
 #ifdef OTB_OPENCV_3
   int flags = (this->m_RegressionMode ? 0 : cv::ml::ANN_MLP::NO_OUTPUT_SCALE);
+  if (updateWeights)
+    {
+    flags |= cv::ml::ANN_MLP::UPDATE_WEIGHTS;
+    }
   m_ANNModel->setTrainMethod(m_TrainMethod);
   m_ANNModel->setBackpropMomentumScale(m_BackPropMomentScale);
   m_ANNModel->setBackpropWeightScale(m_BackPropDWScale);
@@ -209,7 +219,8 @@ void NeuralNetworkMachineLearningModel<TInputValue, TOutputValue>::SetupNetworkA
 #else
   CvANN_MLP_TrainParams params = this->SetNetworkParameters();
   //train the Neural network model
-  m_ANNModel->train(samples, labels, cv::Mat(), cv::Mat(), params);
+  m_ANNModel->train(samples, labels, cv::Mat(), cv::Mat(), params,
+                    updateWeights ? CvANN_MLP::UPDATE_WEIGHTS : 0);
 #endif
 }
 
@@ -230,6 +241,49 @@ void NeuralNetworkMachineLearningModel<TInputValue, TOutputValue>::Train()
     LabelsToMat(this->GetTargetListSample(), matOutputANN);
     }
   this->SetupNetworkAndTrain(matOutputANN);
+  m_IncrementalTrainingStarted = false;
+}
+
+template<class TInputValue, class TOutputValue>
+void NeuralNetworkMachineLearningModel<TInputValue, TOutputValue>::SetClassLabels(
+  const std::vector<TargetValueType> & labels)
+{
+  m_MapOfLabels.clear();
+  for (unsigned int i = 0; i < labels.size(); ++i)
+    {
+    m_MapOfLabels[labels[i]] = i;
+    }
+}
+
+/** Update the machine learning model with a minibatch */
+template<class TInputValue, class TOutputValue>
+void NeuralNetworkMachineLearningModel<TInputValue, TOutputValue>::TrainIncrement()
+{
+  cv::Mat matOutputANN;
+  if (this->m_RegressionMode)
+    {
+    otb::ListSampleToMat<TargetListSampleType>(this->GetTargetListSample(), matOutputANN);
+    }
+  else
+    {
+    // The output layer is fixed once the network is created : the mapping
+    // between labels and output neurons must not change between minibatches
+    if (m_IncrementalTrainingStarted || !m_MapOfLabels.empty())
+      {
+      const TargetListSampleType * labels = this->GetTargetListSample();
+      for (unsigned int i = 0; i < labels->Size(); ++i)
+        {
+        const TargetValueType classLabel = labels->GetMeasurementVector(i)[0];
+        if (m_MapOfLabels.count(classLabel) == 0)
+          {
+          itkExceptionMacro(<< "Class label " << classLabel << " was not known when the network was created.");
+          }
+        }
+      }
+    LabelsToMat(this->GetTargetListSample(), matOutputANN);
+    }
+  this->SetupNetworkAndTrain(matOutputANN, m_IncrementalTrainingStarted);
+  m_IncrementalTrainingStarted = true;
 }
 
 template<class TInputValue, class TOutputValue>
@@ -99,6 +99,14 @@ public:
   /** Train the machine learning model */
   virtual void Train() override;
 
+  /** Update the centroids with the current input list sample (minibatch
+   * k-means). The first call runs a regular k-means on the minibatch to
+   * initialize the centroids, the following ones move each centroid towards
+   * its assigned samples with a per-centroid learning rate equal to the
+   * inverse of the number of samples it has received so far.
+   * Input normalization is not applied in this mode. */
+  virtual void TrainIncrement() override;
+
   /** Save the model to file */
   virtual void Save(const std::string &filename, const std::string &name = "") override;
 
@@ -162,6 +170,14 @@ private:
   /** Centroids results form kMeans */
   shark::Centroids m_Centroids;
 
+  /** Centroids and number of samples assigned to each of them, updated
+   *  by TrainIncrement() */
+  std::vector<shark::RealVector> m_IncrementalCentroids;
+  std::vector<unsigned long> m_IncrementalClusterSizes;
+
+  /** Index of the closest centroid of m_IncrementalCentroids */
+  unsigned int FindClosestCentroid(const shark::RealVector & sample) const;
+
 
   /** shark Model could be SoftClusteringModel or HardClusteringModel */
   boost::shared_ptr<ClusteringModelType> m_ClusteringModel;
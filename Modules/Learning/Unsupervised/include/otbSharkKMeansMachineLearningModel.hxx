@@ -21,6 +21,7 @@
 #define otbSharkKMeansMachineLearningModel_hxx
 
 #include <fstream>
+#include <limits>
 #include "boost/make_shared.hpp"
 #include "itkMacro.h"
 #include "otbSharkKMeansMachineLearningModel.h"
@@ -56,6 +57,7 @@ SharkKMeansMachineLearningModel<TInputValue, TOutputValue>
 {
   // Default set HardClusteringModel
   this->m_ConfidenceIndex = true;
+  this->m_IsIncrementalTrainingSupported = true;
   m_ClusteringModel = boost::make_shared<ClusteringModelType>( &m_Centroids );
 }
 
@@ -84,6 +86,79 @@ SharkKMeansMachineLearningModel<TInputValue, TOutputValue>
   // Use a Hard Clustering Model for classification
   shark::kMeans( data, m_K, m_Centroids, m_MaximumNumberOfIterations );
   m_ClusteringModel = boost::make_shared<ClusteringModelType>( &m_Centroids );
+
+  // Any further incremental training starts from scratch
+  m_IncrementalCentroids.clear();
+  m_IncrementalClusterSizes.clear();
+}
+
+template<class TInputValue, class TOutputValue>
+void
+SharkKMeansMachineLearningModel<TInputValue, TOutputValue>
+::TrainIncrement()
+{
+  std::vector<shark::RealVector> vector_data;
+  otb::Shark::ListSampleToSharkVector( this->GetInputListSample(), vector_data );
+
+  if( m_IncrementalCentroids.empty() )
+    {
+    // First minibatch : initialize the centroids with a regular kMeans
+    if( vector_data.size() < m_K )
+      {
+      itkExceptionMacro( << "The first minibatch contains " << vector_data.size()
+                         << " samples, at least " << m_K << " are needed to initialize the centroids." );
+      }
+    shark::Data<shark::RealVector> data = shark::createDataFromRange( vector_data );
+    shark::kMeans( data, m_K, m_Centroids, m_MaximumNumberOfIterations );
+    for( const auto & c : m_Centroids.centroids().elements() )
+      {
+      m_IncrementalCentroids.push_back( shark::RealVector( c ) );
+      }
+    m_IncrementalClusterSizes.assign( m_IncrementalCentroids.size(), 0 );
+    for( const auto & sample : vector_data )
+      {
+      ++m_IncrementalClusterSizes[FindClosestCentroid( sample )];
+      }
+    }
+  else
+    {
+    // Assign the whole minibatch with the current centroids, then apply
+    // the gradient steps (Sculley, "Web-scale k-means clustering", 2010)
+    std::vector<unsigned int> assignments( vector_data.size() );
+    for( size_t i = 0; i < vector_data.size(); ++i )
+      {
+      assignments[i] = FindClosestCentroid( vector_data[i] );
+      }
+    for( size_t i = 0; i < vector_data.size(); ++i )
+      {
+      const unsigned int c = assignments[i];
+      ++m_IncrementalClusterSizes[c];
+      const double eta = 1. / static_cast<double>( m_IncrementalClusterSizes[c] );
+      m_IncrementalCentroids[c] = ( 1. - eta ) * m_IncrementalCentroids[c] + eta * vector_data[i];
+      }
+    m_Centroids.setCentroids( shark::createDataFromRange( m_IncrementalCentroids ) );
+    }
+
+  m_ClusteringModel = boost::make_shared<ClusteringModelType>( &m_Centroids );
+}
+
+template<class TInputValue, class TOutputValue>
+unsigned int
+SharkKMeansMachineLearningModel<TInputValue, TOutputValue>
+::FindClosestCentroid(const shark::RealVector & sample) const
+{
+  unsigned int closest = 0;
+  double minDistance = std::numeric_limits<double>::max();
+  for( unsigned int c = 0; c < m_IncrementalCentroids.size(); ++c )
+    {
+    const double distance = shark::distanceSqr( sample, m_IncrementalCentroids[c] );
+    if( distance < minDistance )
+      {
+      minDistance = distance;
+      closest = c;
+      }
+    }
+  return closest;
 }
 
 template<class TInputValue, class TOutputValue>
@@ -28,6 +28,8 @@
 #include "itkTranslationTransform.h"
 #include "itkImageToImageMetric.h"
 
+#include <vector>
+
 namespace otb
 {
 
@@ -63,6 +65,15 @@ namespace otb
  *
  * The FineRegistrationImageFilter allows using the full range of itk::ImageToImageMetric provided by itk.
  *
+ * If the number of levels is set higher than 1 (SetNumberOfLevels()), a coarse-to-fine strategy is used
+ * instead: both images are reduced by 2x2 averaging into a pyramid, the full search radius is only explored
+ * at the coarsest level, and the displacement is then refined at each finer level within a small radius
+ * (SetRefinementRadius(), default is 1 pixel). In this mode, the metric is always the normalized
+ * cross-correlation with subtracted mean, computed from integral images so that its cost does not depend
+ * on the search radius. The metric output holds the opposite of the correlation (as the CCSM metric does)
+ * and the sub-pixel refinement is a parabola fit. The Metric, Minimize and accuracy settings are ignored,
+ * and the Interpolator is only used to sample the moving image on the fixed image grid.
+ *
  * \example DisparityMap/FineRegistrationImageFilterExample.cxx
  *
  * \sa      FastCorrelationImageFilter, DisparityMapEstimationMethod
@@ -185,6 +196,15 @@ public:
   itkSetObjectMacro(Transform, TransformType);
   itkGetConstObjectMacro(Transform, TransformType);
 
+  /** Set/Get the number of pyramid levels (1 means full resolution search only) */
+  itkSetClampMacro(NumberOfLevels, unsigned int, 1, 8);
+  itkGetMacro(NumberOfLevels, unsigned int);
+
+  /** Set/Get the search radius used to refine the displacement at each
+   * finer pyramid level (in pixels of that level) */
+  itkSetMacro(RefinementRadius, unsigned int);
+  itkGetMacro(RefinementRadius, unsigned int);
+
 protected:
   /** Constructor */
   FineRegistrationImageFilter();
@@ -211,6 +231,69 @@ private:
                            double& out1, double& out2, double& out3, double& out4); //outputs
   inline void updateMinimize(double& a, double& b);
 
+  /** One level of the multi-resolution pyramid: image buffer with a validity
+   * flag per pixel, and integral images used for the window statistics */
+  struct PyramidLevelType
+  {
+    long                       Index[2];
+    long                       Size[2];
+    std::vector<double>        Values;
+    std::vector<unsigned char> Valid;
+    std::vector<double>        Sum;
+    std::vector<double>        SquaredSum;
+    std::vector<double>        ValidCount;
+  };
+
+  /** Integer displacement map over a region of a pyramid level */
+  struct LevelDisplacementType
+  {
+    long              Index[2];
+    long              Size[2];
+    std::vector<long> X;
+    std::vector<long> Y;
+  };
+
+  /** Padding of the fixed requested region (metric windows), and of the
+   * search region on top of it */
+  void ComputePadding(SizeType & fixedPad, SizeType & searchPad) const;
+
+  /** Coarse-to-fine estimation, used when NumberOfLevels > 1 */
+  void GenerateDataMultiResolution();
+
+  /** Floor of value / 2 */
+  static long FloorHalf(long value);
+
+  /** Zero-mean normalized cross-correlation from window sums */
+  static double NCCFromSums(double n, double sf, double sff, double sm, double smm, double sfm);
+
+  /** Compute the integral images of a pyramid level */
+  void ComputeIntegralImages(PyramidLevelType & level) const;
+
+  /** Reduce a pyramid level by 2x2 averaging */
+  void DownsampleLevel(const PyramidLevelType & in, PyramidLevelType & out) const;
+
+  /** Sum and squared sum on the metric window centered on (x, y). Returns
+   * false if the window is not fully valid. */
+  bool WindowStatistics(const PyramidLevelType & level, long x, long y,
+                        double & sum, double & squaredSum) const;
+
+  /** Normalized cross-correlation between the fixed window centered on (x, y)
+   * and the moving window shifted by (dx, dy). Returns false if it can not
+   * be computed. */
+  bool ComputeNCC(const PyramidLevelType & fixed, const PyramidLevelType & moving,
+                  long x, long y, long dx, long dy, double & ncc) const;
+
+  /** Exhaustive search at the coarsest level, for all the pixels of the
+   * displacement map at once */
+  void SearchCoarsestLevel(const PyramidLevelType & fixed, const PyramidLevelType & moving,
+                           const long searchRadius[2], LevelDisplacementType & displacement) const;
+
+  /** Search around the displacements predicted by the coarser level. Returns
+   * false if no candidate could be evaluated. */
+  bool RefineDisplacement(const PyramidLevelType & fixed, const PyramidLevelType & moving,
+                          const LevelDisplacementType & parent, long x, long y,
+                          long & bestX, long & bestY, double & bestNcc) const;
+
   /** The radius for correlation */
   SizeType                      m_Radius;
 
@@ -248,6 +331,12 @@ private:
   /** Transform for initial offset */
   TransformPointerType          m_Transform;
 
+  /** Number of pyramid levels */
+  unsigned int                  m_NumberOfLevels;
+
+  /** Search radius at the finer pyramid levels */
+  unsigned int                  m_RefinementRadius;
+
 };
 
 } // end namespace otb
@@ -29,6 +29,10 @@
 #include "itkNormalizedCorrelationImageToImageMetric.h"
 #include "itkMacro.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
 namespace otb
 {
 /**
@@ -74,6 +78,10 @@ FineRegistrationImageFilter<TInputImage, T0utputCorrelation, TOutputDisplacement
   m_InitialOffset.Fill(0);
 
   m_Transform = nullptr;
+
+  // Full resolution search only
+  m_NumberOfLevels = 1;
+  m_RefinementRadius = 1;
  }
 
 template <class TInputImage, class T0utputCorrelation, class TOutputDisplacementField>
@@ -200,14 +208,17 @@ FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacement
   fixedRequestedRegion.SetSize(fixedRequestedSize);
   fixedRequestedRegion.SetIndex(fixedRequestedIndex);
 
-  // pad the input requested region by the operator radius
-  fixedRequestedRegion.PadByRadius( m_Radius );
+  // pad the input requested region by the operator radius (enlarged at the
+  // coarser levels of the pyramid)
+  SizeType fixedPad, searchPad;
+  this->ComputePadding(fixedPad, searchPad);
+  fixedRequestedRegion.PadByRadius( fixedPad );
 
 
   // get a copy of the moving requested region (should equal the output
   // requested region)
   InputImageRegionType searchFixedRequestedRegion = fixedRequestedRegion;
-  searchFixedRequestedRegion.PadByRadius(m_SearchRadius);
+  searchFixedRequestedRegion.PadByRadius(searchPad);
 
 
   // Find corners of the search window
@@ -364,6 +375,12 @@ FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacement
   // Allocate outputs
   this->AllocateOutputs();
 
+  if (m_NumberOfLevels > 1)
+    {
+    this->GenerateDataMultiResolution();
+    return;
+    }
+
   // Get the image pointers
   const TInputImage * fixedPtr = this->GetFixedInput();
   const TInputImage * movingPtr = this->GetMovingInput();
@@ -591,6 +608,593 @@ FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacement
     progress.CompletedPixel();
     }
  }
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDisplacementField>
+void
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacementField>
+::ComputePadding(SizeType & fixedPad, SizeType & searchPad) const
+{
+  if (m_NumberOfLevels <= 1)
+    {
+    fixedPad = m_Radius;
+    searchPad = m_SearchRadius;
+    return;
+    }
+
+  // Metric windows of the coarsest level cover (radius * factor) full
+  // resolution pixels, and its displacements are scaled by factor
+  const unsigned long factor = 1UL << (m_NumberOfLevels - 1);
+  for(unsigned int dim = 0; dim < TInputImage::ImageDimension; ++dim)
+    {
+    const unsigned long coarseSearchRadius = (m_SearchRadius[dim] + factor - 1) / factor;
+    fixedPad[dim] = (m_Radius[dim] + 2) * factor;
+    searchPad[dim] = (coarseSearchRadius + m_RefinementRadius + 1) * factor;
+    }
+}
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDisplacementField>
+void
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacementField>
+::ComputeIntegralImages(PyramidLevelType & level) const
+{
+  const long width = level.Size[0];
+  const long height = level.Size[1];
+  const std::size_t integralSize = static_cast<std::size_t>((width + 1) * (height + 1));
+
+  level.Sum.assign(integralSize, 0.);
+  level.SquaredSum.assign(integralSize, 0.);
+  level.ValidCount.assign(integralSize, 0.);
+
+  for (long y = 0; y < height; ++y)
+    {
+    double rowSum = 0., rowSquaredSum = 0., rowCount = 0.;
+    for (long x = 0; x < width; ++x)
+      {
+      const std::size_t in = y * width + x;
+      if (level.Valid[in])
+        {
+        rowSum += level.Values[in];
+        rowSquaredSum += level.Values[in] * level.Values[in];
+        rowCount += 1.;
+        }
+      const std::size_t out = (y + 1) * (width + 1) + x + 1;
+      const std::size_t up = y * (width + 1) + x + 1;
+      level.Sum[out] = level.Sum[up] + rowSum;
+      level.SquaredSum[out] = level.SquaredSum[up] + rowSquaredSum;
+      level.ValidCount[out] = level.ValidCount[up] + rowCount;
+      }
+    }
+}
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDisplacementField>
+void
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacementField>
+::DownsampleLevel(const PyramidLevelType & in, PyramidLevelType & out) const
+{
+  // Pixel q of the reduced level averages pixels 2q and 2q+1 of the input
+  // level, in each dimension. Only fully covered pixels are kept.
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    const long first = FloorHalf(in.Index[dim] + 1);
+    const long last = FloorHalf(in.Index[dim] + in.Size[dim] - 2);
+    out.Index[dim] = first;
+    out.Size[dim] = std::max(0L, last - first + 1);
+    }
+
+  const std::size_t nbPixels = static_cast<std::size_t>(out.Size[0] * out.Size[1]);
+  out.Values.assign(nbPixels, 0.);
+  out.Valid.assign(nbPixels, 0);
+
+  for (long y = 0; y < out.Size[1]; ++y)
+    {
+    const long inY = 2 * (out.Index[1] + y) - in.Index[1];
+    for (long x = 0; x < out.Size[0]; ++x)
+      {
+      const long inX = 2 * (out.Index[0] + x) - in.Index[0];
+      const std::size_t i00 = inY * in.Size[0] + inX;
+      const std::size_t i10 = i00 + 1;
+      const std::size_t i01 = i00 + in.Size[0];
+      const std::size_t i11 = i01 + 1;
+      const std::size_t o = y * out.Size[0] + x;
+      if (in.Valid[i00] && in.Valid[i10] && in.Valid[i01] && in.Valid[i11])
+        {
+        out.Values[o] = 0.25 * (in.Values[i00] + in.Values[i10] + in.Values[i01] + in.Values[i11]);
+        out.Valid[o] = 1;
+        }
+      }
+    }
+
+  this->ComputeIntegralImages(out);
+}
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDisplacementField>
+bool
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacementField>
+::WindowStatistics(const PyramidLevelType & level, long x, long y,
+                   double & sum, double & squaredSum) const
+{
+  const long x0 = x - static_cast<long>(m_Radius[0]) - level.Index[0];
+  const long y0 = y - static_cast<long>(m_Radius[1]) - level.Index[1];
+  const long x1 = x + static_cast<long>(m_Radius[0]) + 1 - level.Index[0];
+  const long y1 = y + static_cast<long>(m_Radius[1]) + 1 - level.Index[1];
+
+  if (x0 < 0 || y0 < 0 || x1 > level.Size[0] || y1 > level.Size[1])
+    {
+    return false;
+    }
+
+  const long w = level.Size[0] + 1;
+  const std::size_t a = y0 * w + x0, b = y0 * w + x1, c = y1 * w + x0, d = y1 * w + x1;
+
+  const double count = level.ValidCount[d] - level.ValidCount[b] - level.ValidCount[c] + level.ValidCount[a];
+  if (count < static_cast<double>((x1 - x0) * (y1 - y0)))
+    {
+    return false;
+    }
+
+  sum = level.Sum[d] - level.Sum[b] - level.Sum[c] + level.Sum[a];
+  squaredSum = level.SquaredSum[d] - level.SquaredSum[b] - level.SquaredSum[c] + level.SquaredSum[a];
+  return true;
+}
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDisplacementField>
+long
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacementField>
+::FloorHalf(long value)
+{
+  return value >= 0 ? value / 2 : -((1 - value) / 2);
+}
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDisplacementField>
+double
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacementField>
+::NCCFromSums(double n, double sf, double sff, double sm, double smm, double sfm)
+{
+  const double vf = sff - sf * sf / n;
+  const double vm = smm - sm * sm / n;
+  if (vf <= 1e-12 * sff || vm <= 1e-12 * smm)
+    {
+    // flat window, the correlation is undefined
+    return 0.;
+    }
+  return (sfm - sf * sm / n) / std::sqrt(vf * vm);
+}
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDisplacementField>
+bool
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacementField>
+::ComputeNCC(const PyramidLevelType & fixed, const PyramidLevelType & moving,
+             long x, long y, long dx, long dy, double & ncc) const
+{
+  double sf, sff, sm, smm;
+  if (!this->WindowStatistics(fixed, x, y, sf, sff) || !this->WindowStatistics(moving, x + dx, y + dy, sm, smm))
+    {
+    return false;
+    }
+
+  const long rx = static_cast<long>(m_Radius[0]);
+  const long ry = static_cast<long>(m_Radius[1]);
+  double sfm = 0.;
+  for (long j = -ry; j <= ry; ++j)
+    {
+    const double * fixedRow = &fixed.Values[(y + j - fixed.Index[1]) * fixed.Size[0] + x - fixed.Index[0]];
+    const double * movingRow = &moving.Values[(y + dy + j - moving.Index[1]) * moving.Size[0]
+                                              + x + dx - moving.Index[0]];
+    for (long i = -rx; i <= rx; ++i)
+      {
+      sfm += fixedRow[i] * movingRow[i];
+      }
+    }
+
+  const double n = static_cast<double>((2 * rx + 1) * (2 * ry + 1));
+  ncc = NCCFromSums(n, sf, sff, sm, smm, sfm);
+  return true;
+}
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDisplacementField>
+void
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacementField>
+::SearchCoarsestLevel(const PyramidLevelType & fixed, const PyramidLevelType & moving,
+                      const long searchRadius[2], LevelDisplacementType & displacement) const
+{
+  const long rx = static_cast<long>(m_Radius[0]);
+  const long ry = static_cast<long>(m_Radius[1]);
+  const long width = displacement.Size[0];
+  const long height = displacement.Size[1];
+  const std::size_t nbPixels = static_cast<std::size_t>(width * height);
+  const double n = static_cast<double>((2 * rx + 1) * (2 * ry + 1));
+
+  displacement.X.assign(nbPixels, 0);
+  displacement.Y.assign(nbPixels, 0);
+  std::vector<double> bestNcc(nbPixels, 0.);
+  std::vector<unsigned char> found(nbPixels, 0);
+
+  // Fixed window statistics do not depend on the displacement
+  std::vector<unsigned char> fixedValid(nbPixels, 0);
+  std::vector<double> fixedSum(nbPixels, 0.), fixedSquaredSum(nbPixels, 0.);
+  for (long y = 0; y < height; ++y)
+    {
+    for (long x = 0; x < width; ++x)
+      {
+      const std::size_t p = y * width + x;
+      fixedValid[p] = this->WindowStatistics(fixed, displacement.Index[0] + x, displacement.Index[1] + y,
+                                             fixedSum[p], fixedSquaredSum[p]);
+      }
+    }
+
+  // For each candidate, the cross term of all the windows is read from the
+  // integral image of the product of the fixed and shifted moving images
+  const long productWidth = width + 2 * rx;
+  const long productHeight = height + 2 * ry;
+  std::vector<double> product(static_cast<std::size_t>((productWidth + 1) * (productHeight + 1)), 0.);
+
+  for (long dy = -searchRadius[1]; dy <= searchRadius[1]; ++dy)
+    {
+    for (long dx = -searchRadius[0]; dx <= searchRadius[0]; ++dx)
+      {
+      for (long j = 0; j < productHeight; ++j)
+        {
+        const long fy = displacement.Index[1] - ry + j - fixed.Index[1];
+        const long my = fy + fixed.Index[1] + dy - moving.Index[1];
+        double rowSum = 0.;
+        for (long i = 0; i < productWidth; ++i)
+          {
+          const long fx = displacement.Index[0] - rx + i - fixed.Index[0];
+          const long mx = fx + fixed.Index[0] + dx - moving.Index[0];
+          if (fx >= 0 && fy >= 0 && fx < fixed.Size[0] && fy < fixed.Size[1]
+              && mx >= 0 && my >= 0 && mx < moving.Size[0] && my < moving.Size[1])
+            {
+            rowSum += fixed.Values[fy * fixed.Size[0] + fx] * moving.Values[my * moving.Size[0] + mx];
+            }
+          product[(j + 1) * (productWidth + 1) + i + 1] = product[j * (productWidth + 1) + i + 1] + rowSum;
+          }
+        }
+
+      for (long y = 0; y < height; ++y)
+        {
+        for (long x = 0; x < width; ++x)
+          {
+          const std::size_t p = y * width + x;
+          double sm, smm;
+          if (!fixedValid[p]
+              || !this->WindowStatistics(moving, displacement.Index[0] + x + dx, displacement.Index[1] + y + dy,
+                                         sm, smm))
+            {
+            continue;
+            }
+          const std::size_t a = y * (productWidth + 1) + x;
+          const std::size_t b = a + 2 * rx + 1;
+          const std::size_t c = a + (2 * ry + 1) * (productWidth + 1);
+          const std::size_t d = c + 2 * rx + 1;
+          const double sfm = product[d] - product[b] - product[c] + product[a];
+
+          const double ncc = NCCFromSums(n, fixedSum[p], fixedSquaredSum[p], sm, smm, sfm);
+          if (!found[p] || ncc > bestNcc[p])
+            {
+            found[p] = 1;
+            bestNcc[p] = ncc;
+            displacement.X[p] = dx;
+            displacement.Y[p] = dy;
+            }
+          }
+        }
+      }
+    }
+
+  // Pixels whose windows were never fully valid (close to the image borders)
+  // take the displacement of the nearest estimated pixel of their row, and
+  // rows without any estimate take the one of the nearest estimated row
+  std::vector<long> rowSource(height, -1);
+  std::vector<long> left(width);
+  for (long y = 0; y < height; ++y)
+    {
+    long previous = -1;
+    for (long x = 0; x < width; ++x)
+      {
+      if (found[y * width + x])
+        {
+        previous = x;
+        }
+      left[x] = previous;
+      }
+    if (previous < 0)
+      {
+      continue;
+      }
+    rowSource[y] = y;
+    long next = -1;
+    for (long x = width - 1; x >= 0; --x)
+      {
+      const std::size_t p = y * width + x;
+      if (found[p])
+        {
+        next = x;
+        continue;
+        }
+      const long source = (left[x] < 0 || (next >= 0 && next - x < x - left[x])) ? next : left[x];
+      displacement.X[p] = displacement.X[y * width + source];
+      displacement.Y[p] = displacement.Y[y * width + source];
+      }
+    }
+  for (long y = 0; y < height; ++y)
+    {
+    if (rowSource[y] >= 0)
+      {
+      continue;
+      }
+    long best = -1;
+    for (long other = 0; other < height; ++other)
+      {
+      if (rowSource[other] == other && (best < 0 || std::abs(other - y) < std::abs(best - y)))
+        {
+        best = other;
+        }
+      }
+    if (best < 0)
+      {
+      return;
+      }
+    std::copy(displacement.X.begin() + best * width, displacement.X.begin() + (best + 1) * width,
+              displacement.X.begin() + y * width);
+    std::copy(displacement.Y.begin() + best * width, displacement.Y.begin() + (best + 1) * width,
+              displacement.Y.begin() + y * width);
+    }
+}
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDisplacementField>
+bool
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacementField>
+::RefineDisplacement(const PyramidLevelType & fixed, const PyramidLevelType & moving,
+                     const LevelDisplacementType & parent, long x, long y,
+                     long & bestX, long & bestY, double & bestNcc) const
+{
+  const long radius = static_cast<long>(m_RefinementRadius);
+  const long px = FloorHalf(x) - parent.Index[0];
+  const long py = FloorHalf(y) - parent.Index[1];
+
+  bool found = false;
+  bestX = 2 * parent.X[py * parent.Size[0] + px];
+  bestY = 2 * parent.Y[py * parent.Size[0] + px];
+  bestNcc = 0.;
+
+  // The displacements of the neighbours of the parent pixel are also tried,
+  // so that a wrong estimate at a coarser level can still be recovered
+  long predictions[9][2];
+  unsigned int nbPredictions = 0;
+  for (long j = std::max(0L, py - 1); j <= std::min(parent.Size[1] - 1, py + 1); ++j)
+    {
+    for (long i = std::max(0L, px - 1); i <= std::min(parent.Size[0] - 1, px + 1); ++i)
+      {
+      const long predX = 2 * parent.X[j * parent.Size[0] + i];
+      const long predY = 2 * parent.Y[j * parent.Size[0] + i];
+      bool known = false;
+      for (unsigned int k = 0; k < nbPredictions && !known; ++k)
+        {
+        known = (predictions[k][0] == predX && predictions[k][1] == predY);
+        }
+      if (!known)
+        {
+        predictions[nbPredictions][0] = predX;
+        predictions[nbPredictions][1] = predY;
+        ++nbPredictions;
+        }
+      }
+    }
+
+  for (unsigned int k = 0; k < nbPredictions; ++k)
+    {
+    for (long dy = predictions[k][1] - radius; dy <= predictions[k][1] + radius; ++dy)
+      {
+      for (long dx = predictions[k][0] - radius; dx <= predictions[k][0] + radius; ++dx)
+        {
+        double ncc;
+        if (this->ComputeNCC(fixed, moving, x, y, dx, dy, ncc) && (!found || ncc > bestNcc))
+          {
+          found = true;
+          bestNcc = ncc;
+          bestX = dx;
+          bestY = dy;
+          }
+        }
+      }
+    }
+  return found;
+}
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDisplacementField>
+void
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDisplacementField>
+::GenerateDataMultiResolution()
+{
+  if (m_Transform.IsNotNull())
+    {
+    itkExceptionMacro(<< "A transform for the initial offset can not be used with more than one level");
+    }
+
+  const TInputImage * fixedPtr = this->GetFixedInput();
+  const TInputImage * movingPtr = this->GetMovingInput();
+  TOutputCorrelation * outputPtr = this->GetOutput();
+  TOutputDisplacementField * outputDfPtr = this->GetOutputDisplacementField();
+
+  const unsigned int nbLevels = m_NumberOfLevels;
+  const OutputImageRegionType outputRegion = outputPtr->GetRequestedRegion();
+  const SpacingType fixedSpacing = fixedPtr->GetSignedSpacing();
+
+  // Full resolution pixels where the displacement is estimated
+  std::vector<LevelDisplacementType> displacements(nbLevels);
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    displacements[0].Index[dim] = outputRegion.GetIndex()[dim] * m_GridStep[dim];
+    displacements[0].Size[dim] = (static_cast<long>(outputRegion.GetSize()[dim]) - 1) * m_GridStep[dim] + 1;
+    }
+  for (unsigned int level = 1; level < nbLevels; ++level)
+    {
+    for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+      const long first = displacements[level - 1].Index[dim];
+      const long last = first + displacements[level - 1].Size[dim] - 1;
+      displacements[level].Index[dim] = FloorHalf(first);
+      displacements[level].Size[dim] = FloorHalf(last) - FloorHalf(first) + 1;
+      }
+    }
+
+  // Full resolution buffers. The moving image is sampled on the fixed image
+  // grid, shifted by the initial offset.
+  SizeType fixedPad, searchPad;
+  this->ComputePadding(fixedPad, searchPad);
+
+  std::vector<PyramidLevelType> fixedLevels(nbLevels), movingLevels(nbLevels);
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    fixedLevels[0].Index[dim] = displacements[0].Index[dim] - static_cast<long>(fixedPad[dim]);
+    fixedLevels[0].Size[dim] = displacements[0].Size[dim] + 2 * static_cast<long>(fixedPad[dim]);
+    movingLevels[0].Index[dim] = fixedLevels[0].Index[dim] - static_cast<long>(searchPad[dim]);
+    movingLevels[0].Size[dim] = fixedLevels[0].Size[dim] + 2 * static_cast<long>(searchPad[dim]);
+    }
+
+  m_Interpolator->SetInputImage(movingPtr);
+  const InputImageRegionType fixedBufferedRegion = fixedPtr->GetBufferedRegion();
+
+  for (unsigned int image = 0; image < 2; ++image)
+    {
+    PyramidLevelType & level = (image == 0) ? fixedLevels[0] : movingLevels[0];
+    const std::size_t nbPixels = static_cast<std::size_t>(level.Size[0] * level.Size[1]);
+    level.Values.assign(nbPixels, 0.);
+    level.Valid.assign(nbPixels, 0);
+
+    IndexType index;
+    PointType point;
+    for (long y = 0; y < level.Size[1]; ++y)
+      {
+      index[1] = level.Index[1] + y;
+      for (long x = 0; x < level.Size[0]; ++x)
+        {
+        index[0] = level.Index[0] + x;
+        const std::size_t p = y * level.Size[0] + x;
+        if (image == 0)
+          {
+          if (fixedBufferedRegion.IsInside(index))
+            {
+            level.Values[p] = static_cast<double>(fixedPtr->GetPixel(index));
+            level.Valid[p] = 1;
+            }
+          }
+        else
+          {
+          fixedPtr->TransformIndexToPhysicalPoint(index, point);
+          point += m_InitialOffset;
+          if (m_Interpolator->IsInsideBuffer(point))
+            {
+            level.Values[p] = m_Interpolator->Evaluate(point);
+            level.Valid[p] = 1;
+            }
+          }
+        }
+      }
+    this->ComputeIntegralImages(level);
+    }
+
+  for (unsigned int level = 1; level < nbLevels; ++level)
+    {
+    this->DownsampleLevel(fixedLevels[level - 1], fixedLevels[level]);
+    this->DownsampleLevel(movingLevels[level - 1], movingLevels[level]);
+    }
+
+  // Full search at the coarsest level
+  const unsigned int coarsest = nbLevels - 1;
+  const long factor = 1L << coarsest;
+  long coarseSearchRadius[2];
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    coarseSearchRadius[dim] = (static_cast<long>(m_SearchRadius[dim]) + factor - 1) / factor;
+    }
+  this->SearchCoarsestLevel(fixedLevels[coarsest], movingLevels[coarsest], coarseSearchRadius,
+                            displacements[coarsest]);
+
+  // Refinement of the intermediate levels, from the displacement of the
+  // parent pixel
+  for (unsigned int level = coarsest - 1; level >= 1; --level)
+    {
+    const LevelDisplacementType & parent = displacements[level + 1];
+    LevelDisplacementType & current = displacements[level];
+    current.X.assign(static_cast<std::size_t>(current.Size[0] * current.Size[1]), 0);
+    current.Y.assign(current.X.size(), 0);
+
+    for (long y = 0; y < current.Size[1]; ++y)
+      {
+      for (long x = 0; x < current.Size[0]; ++x)
+        {
+        const std::size_t pos = y * current.Size[0] + x;
+        double ncc;
+        this->RefineDisplacement(fixedLevels[level], movingLevels[level], parent,
+                                 current.Index[0] + x, current.Index[1] + y,
+                                 current.X[pos], current.Y[pos], ncc);
+        }
+      }
+    }
+
+  // Full resolution: refine at the output grid positions only, then sub-pixel
+  // parabola fit
+  itk::ImageRegionIteratorWithIndex<TOutputCorrelation> outputIt(outputPtr, outputRegion);
+  itk::ImageRegionIterator<TOutputDisplacementField> outputDfIt(outputDfPtr, outputRegion);
+  itk::ProgressReporter progress(this, 0, outputRegion.GetNumberOfPixels());
+
+  const LevelDisplacementType & parent = displacements[1];
+  DisplacementValueType displacementValue;
+
+  for (outputIt.GoToBegin(), outputDfIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt, ++outputDfIt)
+    {
+    IndexType currentIndex = outputIt.GetIndex();
+    for(unsigned int dim = 0; dim < TInputImage::ImageDimension; ++dim)
+      {
+      currentIndex[dim] *= m_GridStep[dim];
+      }
+    const long x = currentIndex[0];
+    const long y = currentIndex[1];
+
+    long bestX, bestY;
+    double bestNcc;
+    double subPixel[2] = { 0., 0. };
+    if (this->RefineDisplacement(fixedLevels[0], movingLevels[0], parent, x, y, bestX, bestY, bestNcc))
+      {
+      double previous, next;
+      if (this->ComputeNCC(fixedLevels[0], movingLevels[0], x, y, bestX - 1, bestY, previous)
+          && this->ComputeNCC(fixedLevels[0], movingLevels[0], x, y, bestX + 1, bestY, next)
+          && (previous - 2. * bestNcc + next) < 0.)
+        {
+        subPixel[0] = 0.5 * (previous - next) / (previous - 2. * bestNcc + next);
+        }
+      if (this->ComputeNCC(fixedLevels[0], movingLevels[0], x, y, bestX, bestY - 1, previous)
+          && this->ComputeNCC(fixedLevels[0], movingLevels[0], x, y, bestX, bestY + 1, next)
+          && (previous - 2. * bestNcc + next) < 0.)
+        {
+        subPixel[1] = 0.5 * (previous - next) / (previous - 2. * bestNcc + next);
+        }
+      subPixel[0] = std::max(-0.5, std::min(0.5, subPixel[0]));
+      subPixel[1] = std::max(-0.5, std::min(0.5, subPixel[1]));
+      }
+
+    // Same sign convention as the normalized correlation metric
+    outputIt.Set(-bestNcc);
+
+    const double offsetX = m_InitialOffset[0] + (static_cast<double>(bestX) + subPixel[0]) * fixedSpacing[0];
+    const double offsetY = m_InitialOffset[1] + (static_cast<double>(bestY) + subPixel[1]) * fixedSpacing[1];
+    if(m_UseSpacing)
+      {
+      displacementValue[0] = offsetX;
+      displacementValue[1] = offsetY;
+      }
+    else
+      {
+      displacementValue[0] = offsetX/fixedSpacing[0];
+      displacementValue[1] = offsetY/fixedSpacing[1];
+      }
+    outputDfIt.Set(displacementValue);
+
+    progress.CompletedPixel();
+    }
+}
+
 } // end namespace otb
 
 #endif
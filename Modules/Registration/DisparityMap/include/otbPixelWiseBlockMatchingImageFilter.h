@@ -27,6 +27,9 @@
 #include "itkImageRegionIterator.h"
 #include "otbImage.h"
 
+#include <type_traits>
+#include <vector>
+
 namespace otb
 {
 
@@ -63,6 +66,22 @@ public:
 
     return ssd;
   }
+
+  /** Number of per-pixel terms whose sums over the window give the metric */
+  static const unsigned int NumberOfBoxSums = 1;
+
+  /** Compute the per-pixel terms from the left and right pixel values */
+  inline void ComputePixelTerms(double a, double b, double * terms) const
+  {
+    terms[0] = (a-b)*(a-b);
+  }
+
+  /** Compute the metric from the sums of the terms over a window of
+   * windowSize pixels */
+  inline MetricValueType ComputeFromBoxSums(const double * sums, double itkNotUsed(windowSize)) const
+  {
+    return static_cast<MetricValueType>(sums[0]);
+  }
 };
 
 
@@ -179,6 +198,38 @@ public:
 
     return static_cast<MetricValueType>(ncc);
   }
+
+  /** Number of per-pixel terms whose sums over the window give the metric */
+  static const unsigned int NumberOfBoxSums = 5;
+
+  /** Compute the per-pixel terms from the left and right pixel values */
+  inline void ComputePixelTerms(double a, double b, double * terms) const
+  {
+    terms[0] = a;
+    terms[1] = b;
+    terms[2] = a*a;
+    terms[3] = b*b;
+    terms[4] = a*b;
+  }
+
+  /** Compute the metric from the sums of the terms over a window of
+   * windowSize pixels */
+  inline MetricValueType ComputeFromBoxSums(const double * sums, double windowSize) const
+  {
+    // Centered moments multiplied by windowSize * (windowSize - 1), which
+    // are exact for integer pixel values
+    const double cov = windowSize * sums[4] - sums[0] * sums[1];
+    const double varA = windowSize * sums[2] - sums[0] * sums[0];
+    const double varB = windowSize * sums[3] - sums[1] * sums[1];
+    const double norm = windowSize * (windowSize - 1);
+
+    // Same thresholds on the standard deviations as operator()
+    if(varA > 1e-40 * norm && varB > 1e-40 * norm)
+      {
+      return static_cast<MetricValueType>(std::abs(cov) / std::sqrt(varA * varB));
+      }
+    return static_cast<MetricValueType>(0);
+  }
 };
 
 /** \class LPBlockMatching
@@ -229,11 +280,67 @@ public:
     return score;
   }
 
+  /** Number of per-pixel terms whose sums over the window give the metric */
+  static const unsigned int NumberOfBoxSums = 1;
+
+  /** Compute the per-pixel terms from the left and right pixel values */
+  inline void ComputePixelTerms(double a, double b, double * terms) const
+  {
+    terms[0] = std::pow(std::abs(a-b), m_P);
+  }
+
+  /** Compute the metric from the sums of the terms over a window of
+   * windowSize pixels */
+  inline MetricValueType ComputeFromBoxSums(const double * sums, double itkNotUsed(windowSize)) const
+  {
+    return static_cast<MetricValueType>(sums[0]);
+  }
+
 private:
 
   double m_P;
 };
 
+/** \class BlockMatchingBoxSumTraits
+ *  \brief Tell if a block-matching functor can be evaluated from box sums
+ *
+ *  A block-matching functor supporting box sums computes its metric from the
+ *  sums, over the window, of NumberOfBoxSums per-pixel terms. It provides
+ *  ComputePixelTerms(), which computes these terms from a pair of left and
+ *  right pixel values, and ComputeFromBoxSums(), which gives the metric from
+ *  their sums. The PixelWiseBlockMatchingImageFilter then aggregates the
+ *  terms with running sums instead of visiting the whole window for each
+ *  pixel and each disparity.
+ *
+ *  Specialize this class with Supported set to true to enable box sums for
+ *  a new functor.
+ *
+ * \ingroup OTBDisparityMap
+ */
+template <class TBlockMatchingFunctor>
+struct BlockMatchingBoxSumTraits
+{
+  static const bool Supported = false;
+};
+
+template <class TInputImage, class TOutputMetricImage>
+struct BlockMatchingBoxSumTraits< SSDBlockMatching<TInputImage,TOutputMetricImage> >
+{
+  static const bool Supported = true;
+};
+
+template <class TInputImage, class TOutputMetricImage>
+struct BlockMatchingBoxSumTraits< NCCBlockMatching<TInputImage,TOutputMetricImage> >
+{
+  static const bool Supported = true;
+};
+
+template <class TInputImage, class TOutputMetricImage>
+struct BlockMatchingBoxSumTraits< LPBlockMatching<TInputImage,TOutputMetricImage> >
+{
+  static const bool Supported = true;
+};
+
 } // End Namespace Functor
 
 /** \class PixelWiseBlockMatchingImageFilter
@@ -284,6 +391,15 @@ private:
  *  an exploration radius indicates the disparity range to be explored around
  *  the initial estimate (global minimum and maximum values are still in use).
  *
+ *  When the functor supports it (see Functor::BlockMatchingBoxSumTraits, which
+ *  is the case of the SSD, NCC and Lp functors), the metric is computed
+ *  incrementally: for each disparity, per-pixel terms are computed once and
+ *  summed over the blocks with running column sums along the lines and
+ *  prefix sums across the columns. The cost per pixel and per disparity no
+ *  longer depends on the radius. This can be disabled with
+ *  IncrementalMetricOff(), in which case the functor is evaluated on
+ *  neighborhood iterators.
+ *
  *  \sa FineRegistrationImageFilter
  *  \sa StereorectificationDisplacementFieldSource
  *  \sa SubPixelDisparityImageFilter
@@ -406,6 +522,12 @@ public:
   itkSetMacro(InitVerticalDisparity,int);
   itkGetConstReferenceMacro(InitVerticalDisparity,int);
 
+  /** Set/Get the incremental evaluation of the metric with box sums, used
+   * when the functor supports it (on by default) */
+  itkSetMacro(IncrementalMetric, bool);
+  itkGetConstReferenceMacro(IncrementalMetric, bool);
+  itkBooleanMacro(IncrementalMetric);
+
   /** Get the functor for parameters setting */
   BlockMatchingFunctorType &  GetFunctor()
   {
@@ -465,6 +587,21 @@ private:
   PixelWiseBlockMatchingImageFilter(const Self&) = delete;
   void operator=(const Self&); //purposely not implemeFnted
 
+  typedef std::integral_constant<bool,
+    Functor::BlockMatchingBoxSumTraits<TBlockMatchingFunctor>::Supported> BoxSumSupportedType;
+
+  /** Threaded generate data with box sums */
+  void IncrementalThreadedGenerateData(const RegionType & outputRegionForThread,
+                                       itk::ThreadIdType threadId, std::true_type);
+
+  /** The functor does not support box sums */
+  void IncrementalThreadedGenerateData(const RegionType &, itk::ThreadIdType, std::false_type) {}
+
+  /** Copy size values of a line of the image, starting at column start, to
+   * row. Pixels outside the buffered region are set to 0, as done by the
+   * constant boundary condition of the neighborhood iterators. */
+  static void LoadRow(const TInputImage * image, long line, long start, unsigned int size, double * row);
+
   /** The radius of the blocks */
   SizeType                      m_Radius;
 
@@ -505,6 +642,9 @@ private:
    */
   IndexType                     m_GridIndex;
 
+  /** Use box sums to evaluate the metric when the functor supports it */
+  bool                          m_IncrementalMetric;
+
 };
 } // end namespace otb
 
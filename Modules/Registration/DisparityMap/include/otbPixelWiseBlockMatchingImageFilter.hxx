@@ -25,6 +25,8 @@
 #include "itkProgressReporter.h"
 #include "itkConstantBoundaryCondition.h"
 
+#include <algorithm>
+
 namespace otb
 {
 template <class TInputImage, class TOutputMetricImage,
@@ -68,6 +70,9 @@ TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
   // Default grid index
   m_GridIndex[0] = 0;
   m_GridIndex[1] = 0;
+
+  // Use box sums when the functor supports them
+  m_IncrementalMetric = true;
 }
 
 
@@ -541,6 +546,12 @@ PixelWiseBlockMatchingImageFilter<TInputImage,TOutputMetricImage,
 TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
 ::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
 {
+  if (m_IncrementalMetric && BoxSumSupportedType::value)
+    {
+    this->IncrementalThreadedGenerateData(outputRegionForThread, threadId, BoxSumSupportedType());
+    return;
+    }
+
   // Retrieve pointers
   const TInputImage *     inLeftPtr    = this->GetLeftInput();
   const TInputImage *     inRightPtr   = this->GetRightInput();
@@ -766,6 +777,304 @@ TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
     }
 }
 
+template <class TInputImage, class TOutputMetricImage,
+class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
+void
+PixelWiseBlockMatchingImageFilter<TInputImage,TOutputMetricImage,
+TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
+::IncrementalThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId, std::true_type)
+{
+  // Retrieve pointers
+  const TInputImage *     inLeftPtr    = this->GetLeftInput();
+  const TInputImage *     inRightPtr   = this->GetRightInput();
+  const TMaskImage  *     inLeftMaskPtr    = this->GetLeftMaskInput();
+  const TMaskImage  *     inRightMaskPtr    = this->GetRightMaskInput();
+  const TOutputDisparityImage * inHDispPtr = this->GetHorizontalDisparityInput();
+  const TOutputDisparityImage * inVDispPtr = this->GetVerticalDisparityInput();
+  TOutputMetricImage    * outMetricPtr = this->GetMetricOutput();
+  TOutputDisparityImage * outHDispPtr   = this->GetHorizontalDisparityOutput();
+  TOutputDisparityImage * outVDispPtr   = this->GetVerticalDisparityOutput();
+
+  // Set-up progress reporting (this is not exact, since we do not
+  // account for pixels that are out of range for a given disparity
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels()*(m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity + 1)*(m_MaximumVerticalDisparity - m_MinimumVerticalDisparity + 1),100);
+
+  // Handle initialization properly
+  std::vector<unsigned char> initialized(outputRegionForThread.GetNumberOfPixels(), 0);
+
+  // Check if we use initial disparities and exploration radius
+  bool useExplorationRadius = false;
+  bool useInitDispMaps = false;
+  if (m_ExplorationRadius[0] >= 1 || m_ExplorationRadius[1] >= 1)
+    {
+    useExplorationRadius = true;
+    if (inHDispPtr && inVDispPtr)
+      {
+      useInitDispMaps = true;
+      }
+    }
+
+  // step value as disparityType
+  DisparityPixelType stepDisparityInv = 1. / static_cast<DisparityPixelType>(this->m_Step);
+
+  // Compute region for thread at full resolution
+  RegionType fullRegionForThread = this->ConvertSubsampledToFullRegion(outputRegionForThread, this->m_Step, this->m_GridIndex);
+
+  const unsigned int nbSums = TBlockMatchingFunctor::NumberOfBoxSums;
+  const long step = this->m_Step;
+  const long radiusX = m_Radius[0];
+  const long radiusY = m_Radius[1];
+  const long windowHeight = 2 * radiusY + 1;
+  const double windowSize = static_cast<double>((2 * radiusX + 1) * windowHeight);
+
+  // Buffers sized for the widest row of blocks of the thread
+  const unsigned int maxLength = fullRegionForThread.GetSize(0) + 2 * radiusX;
+  std::vector<double> leftRow(maxLength);
+  std::vector<double> rightRow(maxLength);
+  // Per-pixel terms of the lines of the current blocks, in a ring buffer
+  std::vector<double> terms(windowHeight * nbSums * maxLength);
+  // Sums of the terms over the lines of the current blocks, for each column
+  std::vector<double> columnSums(nbSums * maxLength);
+  // Prefix sums of the column sums
+  std::vector<double> prefixSums(nbSums * (maxLength + 1));
+  std::vector<double> pixelTerms(nbSums);
+  std::vector<double> sums(nbSums);
+
+  // We loop on disparities
+  for(int vdisparity = m_MinimumVerticalDisparity; vdisparity <= m_MaximumVerticalDisparity; ++vdisparity)
+    {
+  for(int hdisparity = m_MinimumHorizontalDisparity; hdisparity <= m_MaximumHorizontalDisparity; ++hdisparity)
+    {
+    // First, we cast output region to the right image
+    IndexType rightRequestedRegionIndex = fullRegionForThread.GetIndex();
+    rightRequestedRegionIndex[0]+=hdisparity;
+    rightRequestedRegionIndex[1]+=vdisparity;
+
+    // We crop
+    RegionType inputRightRegion;
+    inputRightRegion.SetIndex(rightRequestedRegionIndex);
+    inputRightRegion.SetSize(fullRegionForThread.GetSize());
+    if (!inputRightRegion.Crop(inRightPtr->GetLargestPossibleRegion()))
+      {
+      continue;
+      }
+
+    // And then cast back
+    IndexType leftRequestedRegionIndex = inputRightRegion.GetIndex();
+    leftRequestedRegionIndex[0]-=hdisparity;
+    leftRequestedRegionIndex[1]-=vdisparity;
+
+    RegionType inputLeftRegion;
+    inputLeftRegion.SetIndex(leftRequestedRegionIndex);
+    inputLeftRegion.SetSize(inputRightRegion.GetSize());
+
+    // Compute the equivalent region in subsampled grid
+    RegionType outputRegion = this->ConvertFullToSubsampledRegion(inputLeftRegion, this->m_Step, this->m_GridIndex);
+    if (outputRegion.GetNumberOfPixels() == 0)
+      {
+      continue;
+      }
+
+    // Columns of the blocks centered on the grid locations of the region
+    const long firstX = outputRegion.GetIndex(0) * step + this->m_GridIndex[0];
+    const long lastX = (outputRegion.GetIndex(0) + static_cast<long>(outputRegion.GetSize(0)) - 1) * step
+                       + this->m_GridIndex[0];
+    const long startX = firstX - radiusX;
+    const unsigned int length = lastX - firstX + 2 * radiusX + 1;
+
+    // Compute the terms of a line of the left image and add them to (or
+    // remove them from) the column sums
+    auto updateColumnSums = [&](long line, double sign, bool compute)
+      {
+      double * lineTerms = &terms[((line % windowHeight + windowHeight) % windowHeight) * nbSums * maxLength];
+      if (compute)
+        {
+        LoadRow(inLeftPtr, line, startX, length, leftRow.data());
+        LoadRow(inRightPtr, line + vdisparity, startX + hdisparity, length, rightRow.data());
+        for(unsigned int c = 0; c < length; ++c)
+          {
+          m_Functor.ComputePixelTerms(leftRow[c], rightRow[c], pixelTerms.data());
+          for(unsigned int k = 0; k < nbSums; ++k)
+            {
+            lineTerms[k * maxLength + c] = pixelTerms[k];
+            }
+          }
+        }
+      for(unsigned int k = 0; k < nbSums; ++k)
+        {
+        const double * src = lineTerms + k * maxLength;
+        double * dst = &columnSums[k * maxLength];
+        for(unsigned int c = 0; c < length; ++c)
+          {
+          dst[c] += sign * src[c];
+          }
+        }
+      };
+
+    for(long oy = 0; oy < static_cast<long>(outputRegion.GetSize(1)); ++oy)
+      {
+      const long y = (outputRegion.GetIndex(1) + oy) * step + this->m_GridIndex[1];
+
+      // Slide the blocks down by step lines, or recompute the column sums
+      // when the blocks do not overlap
+      if (oy == 0 || step >= windowHeight)
+        {
+        std::fill(columnSums.begin(), columnSums.end(), 0.);
+        for(long line = y - radiusY; line <= y + radiusY; ++line)
+          {
+          updateColumnSums(line, 1., true);
+          }
+        }
+      else
+        {
+        for(long line = y - radiusY - step; line < y - radiusY; ++line)
+          {
+          updateColumnSums(line, -1., false);
+          }
+        for(long line = y + radiusY - step + 1; line <= y + radiusY; ++line)
+          {
+          updateColumnSums(line, 1., true);
+          }
+        }
+
+      for(unsigned int k = 0; k < nbSums; ++k)
+        {
+        const double * src = &columnSums[k * maxLength];
+        double * dst = &prefixSums[k * (maxLength + 1)];
+        dst[0] = 0.;
+        for(unsigned int c = 0; c < length; ++c)
+          {
+          dst[c + 1] = dst[c] + src[c];
+          }
+        }
+
+      // Output pixels of the line
+      IndexType outIndex;
+      outIndex[0] = outputRegion.GetIndex(0);
+      outIndex[1] = outputRegion.GetIndex(1) + oy;
+      MetricValueType * outMetric = outMetricPtr->GetBufferPointer() + outMetricPtr->ComputeOffset(outIndex);
+      DisparityPixelType * outHDisp = outHDispPtr->GetBufferPointer() + outHDispPtr->ComputeOffset(outIndex);
+      DisparityPixelType * outVDisp = outVDispPtr->GetBufferPointer() + outVDispPtr->ComputeOffset(outIndex);
+      unsigned char * init = &initialized[(outIndex[1] - outputRegionForThread.GetIndex(1)) * outputRegionForThread.GetSize(0)
+                                          + (outIndex[0] - outputRegionForThread.GetIndex(0))];
+
+      for(unsigned int ox = 0; ox < outputRegion.GetSize(0); ++ox)
+        {
+        progress.CompletedPixel();
+
+        IndexType leftIndex;
+        leftIndex[0] = firstX + ox * step;
+        leftIndex[1] = y;
+        IndexType rightIndex;
+        rightIndex[0] = leftIndex[0] + hdisparity;
+        rightIndex[1] = leftIndex[1] + vdisparity;
+
+        // If the mask is present and valid
+        if((inLeftMaskPtr && !(inLeftMaskPtr->GetPixel(leftIndex) > 0))
+           || (inRightMaskPtr && !(inRightMaskPtr->GetPixel(rightIndex) > 0)))
+          {
+          continue;
+          }
+
+        int estimatedMinHDisp = m_MinimumHorizontalDisparity;
+        int estimatedMinVDisp = m_MinimumVerticalDisparity;
+        int estimatedMaxHDisp = m_MaximumHorizontalDisparity;
+        int estimatedMaxVDisp = m_MaximumVerticalDisparity;
+        if (useExplorationRadius)
+          {
+          // compute disparity bounds from initial position and exploration radius
+          if (useInitDispMaps)
+            {
+            estimatedMinHDisp = inHDispPtr->GetPixel(leftIndex) - m_ExplorationRadius[0];
+            estimatedMinVDisp = inVDispPtr->GetPixel(leftIndex) - m_ExplorationRadius[1];
+            estimatedMaxHDisp = inHDispPtr->GetPixel(leftIndex) + m_ExplorationRadius[0];
+            estimatedMaxVDisp = inVDispPtr->GetPixel(leftIndex) + m_ExplorationRadius[1];
+            }
+          else
+            {
+            estimatedMinHDisp = m_InitHorizontalDisparity - m_ExplorationRadius[0];
+            estimatedMinVDisp = m_InitVerticalDisparity - m_ExplorationRadius[1];
+            estimatedMaxHDisp = m_InitHorizontalDisparity + m_ExplorationRadius[0];
+            estimatedMaxVDisp = m_InitVerticalDisparity + m_ExplorationRadius[1];
+            }
+          // clamp to the minimum disparities
+          if (estimatedMinHDisp < m_MinimumHorizontalDisparity)
+            {
+            estimatedMinHDisp = m_MinimumHorizontalDisparity;
+            }
+          if (estimatedMinVDisp < m_MinimumVerticalDisparity)
+            {
+            estimatedMinVDisp = m_MinimumVerticalDisparity;
+            }
+          }
+
+        if (vdisparity < estimatedMinVDisp || vdisparity > estimatedMaxVDisp ||
+            hdisparity < estimatedMinHDisp || hdisparity > estimatedMaxHDisp)
+          {
+          continue;
+          }
+
+        // Sums of the terms over the block
+        const unsigned int column = ox * step;
+        for(unsigned int k = 0; k < nbSums; ++k)
+          {
+          const double * prefix = &prefixSums[k * (maxLength + 1)];
+          sums[k] = prefix[column + 2 * radiusX + 1] - prefix[column];
+          }
+        double metric = m_Functor.ComputeFromBoxSums(sums.data(), windowSize);
+
+        // If we are at first loop, fill both outputs
+        // We adapt the disparity value to keep consistent with disparity map index space
+        if(!init[ox]
+           || (m_Minimize && metric < outMetric[ox])
+           || (!m_Minimize && metric > outMetric[ox]))
+          {
+          outHDisp[ox] = static_cast<DisparityPixelType>(hdisparity) * stepDisparityInv;
+          outVDisp[ox] = static_cast<DisparityPixelType>(vdisparity) * stepDisparityInv;
+          outMetric[ox] = metric;
+          init[ox] = 1;
+          }
+        }
+      }
+    }
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage,
+class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
+void
+PixelWiseBlockMatchingImageFilter<TInputImage,TOutputMetricImage,
+TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
+::LoadRow(const TInputImage * image, long line, long start, unsigned int size, double * row)
+{
+  std::fill(row, row + size, 0.);
+
+  const RegionType & buffered = image->GetBufferedRegion();
+  const long bufferStartX = buffered.GetIndex(0);
+  const long bufferEndX = bufferStartX + static_cast<long>(buffered.GetSize(0));
+  if (line < buffered.GetIndex(1) || line >= buffered.GetIndex(1) + static_cast<long>(buffered.GetSize(1)))
+    {
+    return;
+    }
+
+  const long first = std::max(start, bufferStartX);
+  const long last = std::min(start + static_cast<long>(size), bufferEndX);
+  if (first >= last)
+    {
+    return;
+    }
+
+  IndexType index;
+  index[0] = first;
+  index[1] = line;
+  const typename TInputImage::PixelType * pixel = image->GetBufferPointer() + image->ComputeOffset(index);
+  double * dst = row + (first - start);
+  for(long x = first; x < last; ++x, ++pixel, ++dst)
+    {
+    *dst = static_cast<double>(*pixel);
+    }
+}
+
 template <class TInputImage, class TOutputMetricImage,
 class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
 typename PixelWiseBlockMatchingImageFilter<TInputImage,TOutputMetricImage,
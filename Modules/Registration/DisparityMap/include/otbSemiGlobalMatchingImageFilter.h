@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbSemiGlobalMatchingImageFilter_h
+#define otbSemiGlobalMatchingImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkProgressReporter.h"
+#include "otbImage.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace otb
+{
+
+/** \class SemiGlobalMatchingImageFilter
+ *  \brief Estimate horizontal disparities between two epipolar images with
+ *  semi-global matching (SGM)
+ *
+ *  The matching cost of a pixel of the left image and a pixel of the right
+ *  image is the Hamming distance between their census transforms over a
+ *  (2r+1)x(2r+1) window, r being set with SetCensusRadius(). The costs of all
+ *  the disparities in [MinimumHorizontalDisparity, MaximumHorizontalDisparity]
+ *  are then aggregated along 8 or 16 directions (SetNumberOfPaths()), with a
+ *  penalty P1 for disparity changes of one pixel between neighbours and a
+ *  penalty P2 for larger changes. The disparity of each pixel is the one
+ *  minimizing the sum of the aggregated costs, refined with a parabolic fit
+ *  unless SubPixelInterpolationOff() is called.
+ *
+ *  The left-right consistency is checked from the same aggregated costs: the
+ *  disparity of each right pixel is the one minimizing the aggregated costs
+ *  along the corresponding diagonal of the cost volume, and left pixels whose
+ *  disparity differs by more than LeftRightTolerance from the disparity of
+ *  their match are marked invalid in the mask output. This replaces the
+ *  reverse block-matching pass used with PixelWiseBlockMatchingImageFilter.
+ *
+ *  The filter is streamed: each thread splits its output region into blocks
+ *  of at most BlockSize x BlockSize pixels, which are processed with a halo of
+ *  TileHalo pixels in every direction so that the aggregation paths enter
+ *  the block with a meaningful history. The memory used by a thread is thus
+ *  bounded by 3 bytes per pixel of the padded block and per disparity.
+ *
+ *  Masks are not mandatory. Costs of left pixels whose mask value is null
+ *  are uniform, so that the aggregation propagates through them, and these
+ *  pixels get the minimum disparity, a null metric and a null mask value.
+ *  Right pixels whose mask value is null, or which are outside the right
+ *  image, get the maximum cost.
+ *
+ *  This filter has four outputs, in the same order as the outputs of
+ *  PixelWiseBlockMatchingImageFilter followed by the mask: the metric image,
+ *  which contains the aggregated cost of the estimated disparity divided by
+ *  the number of paths, the horizontal and vertical disparity maps (the
+ *  vertical disparity is null, as images are expected in epipolar geometry)
+ *  and the validity mask (255 for valid disparities, 0 otherwise).
+ *
+ *  \sa PixelWiseBlockMatchingImageFilter
+ *
+ *  \ingroup Streamed
+ *  \ingroup Threaded
+ *
+ * \ingroup OTBDisparityMap
+ */
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage = TOutputMetricImage,
+          class TMaskImage = otb::Image<unsigned char> >
+class ITK_EXPORT SemiGlobalMatchingImageFilter :
+    public itk::ImageToImageFilter<TInputImage,TOutputDisparityImage>
+{
+public:
+  /** Standard class typedef */
+  typedef SemiGlobalMatchingImageFilter                     Self;
+  typedef itk::ImageToImageFilter<TInputImage,
+                                  TOutputDisparityImage>    Superclass;
+  typedef itk::SmartPointer<Self>                           Pointer;
+  typedef itk::SmartPointer<const Self>                     ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SemiGlobalMatchingImageFilter, ImageToImageFilter);
+
+  /** Useful typedefs */
+  typedef TInputImage                                       InputImageType;
+  typedef TOutputMetricImage                                OutputMetricImageType;
+  typedef TOutputDisparityImage                             OutputDisparityImageType;
+  typedef TMaskImage                                        MaskImageType;
+
+  typedef typename InputImageType::SizeType                 SizeType;
+  typedef typename InputImageType::IndexType                IndexType;
+  typedef typename InputImageType::RegionType               RegionType;
+
+  typedef typename TOutputMetricImage::ValueType            MetricValueType;
+  typedef typename OutputDisparityImageType::PixelType      DisparityPixelType;
+  typedef typename MaskImageType::PixelType                 MaskPixelType;
+
+  /** Census transform of a pixel */
+  typedef std::uint64_t                                     CensusType;
+  /** Matching cost of a pair of pixels */
+  typedef std::uint8_t                                      CostType;
+  /** Aggregated cost */
+  typedef std::uint16_t                                     AggregatedCostType;
+
+  /** Set left input */
+  void SetLeftInput( const TInputImage * image);
+
+  /** Set right input */
+  void SetRightInput( const TInputImage * image);
+
+  /** Set mask input (optional) */
+  void SetLeftMaskInput(const TMaskImage * image);
+
+  /** Set right mask input (optional) */
+  void SetRightMaskInput(const TMaskImage * image);
+
+  /** Get the inputs */
+  const TInputImage * GetLeftInput() const;
+  const TInputImage * GetRightInput() const;
+  const TMaskImage  * GetLeftMaskInput() const;
+  const TMaskImage  * GetRightMaskInput() const;
+
+  /** Get the metric output */
+  TOutputMetricImage * GetMetricOutput();
+
+  /** Get the horizontal disparity output */
+  TOutputDisparityImage * GetHorizontalDisparityOutput();
+
+  /** Get the vertical disparity output (null disparities) */
+  TOutputDisparityImage * GetVerticalDisparityOutput();
+
+  /** Get the validity mask output */
+  TMaskImage * GetValidityMaskOutput();
+
+  /*** Set/Get the minimum disparity to explore */
+  itkSetMacro(MinimumHorizontalDisparity,int);
+  itkGetConstReferenceMacro(MinimumHorizontalDisparity,int);
+
+  /*** Set/Get the maximum disparity to explore */
+  itkSetMacro(MaximumHorizontalDisparity,int);
+  itkGetConstReferenceMacro(MaximumHorizontalDisparity,int);
+
+  /** Set/Get the radius of the census transform window (at most 3) */
+  itkSetMacro(CensusRadius, unsigned int);
+  itkGetConstReferenceMacro(CensusRadius, unsigned int);
+
+  /** Set/Get the penalty of one pixel disparity changes */
+  itkSetMacro(P1, unsigned int);
+  itkGetConstReferenceMacro(P1, unsigned int);
+
+  /** Set/Get the penalty of larger disparity changes */
+  itkSetMacro(P2, unsigned int);
+  itkGetConstReferenceMacro(P2, unsigned int);
+
+  /** Set/Get the number of aggregation paths (8 or 16) */
+  itkSetMacro(NumberOfPaths, unsigned int);
+  itkGetConstReferenceMacro(NumberOfPaths, unsigned int);
+
+  /** Set/Get the size of the halo added around each block */
+  itkSetMacro(TileHalo, unsigned int);
+  itkGetConstReferenceMacro(TileHalo, unsigned int);
+
+  /** Set/Get the maximum size of the blocks processed by the threads */
+  itkSetMacro(BlockSize, unsigned int);
+  itkGetConstReferenceMacro(BlockSize, unsigned int);
+
+  /** Set/Get the parabolic sub-pixel refinement of the disparities */
+  itkSetMacro(SubPixelInterpolation, bool);
+  itkGetConstReferenceMacro(SubPixelInterpolation, bool);
+  itkBooleanMacro(SubPixelInterpolation);
+
+  /** Set/Get the left-right consistency check */
+  itkSetMacro(LeftRightCheck, bool);
+  itkGetConstReferenceMacro(LeftRightCheck, bool);
+  itkBooleanMacro(LeftRightCheck);
+
+  /** Set/Get the maximum difference between the left and right disparities
+   * of consistent matches */
+  itkSetMacro(LeftRightTolerance, unsigned int);
+  itkGetConstReferenceMacro(LeftRightTolerance, unsigned int);
+
+protected:
+  /** Constructor */
+  SemiGlobalMatchingImageFilter();
+
+  /** Destructor */
+  ~SemiGlobalMatchingImageFilter() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  /** Generate output information */
+  void GenerateOutputInformation() override;
+
+  /** The left input is padded by the halo and the census radius, and the
+   * right input is extended by the disparity range */
+  void GenerateInputRequestedRegion() override;
+
+  /** Threaded generate data */
+  void ThreadedGenerateData(const RegionType & outputRegionForThread, itk::ThreadIdType threadId) override;
+
+private:
+  SemiGlobalMatchingImageFilter(const Self&) = delete;
+  void operator=(const Self&) = delete;
+
+  /** Estimate the disparities of a block */
+  void ProcessBlock(const RegionType & block, itk::ProgressReporter & progress);
+
+  /** Aggregate the costs along a path: compute the path costs of a pixel
+   * from its matching costs and the path costs of the previous pixel on the
+   * path, and return their minimum */
+  AggregatedCostType UpdatePathCosts(const CostType * costs, const AggregatedCostType * previous,
+                                     AggregatedCostType previousMinimum, AggregatedCostType * current,
+                                     unsigned int nbDisparities) const;
+
+  /** Number of bits set in a census transform */
+  static unsigned int HammingWeight(CensusType value)
+  {
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<unsigned int>((value * 0x0101010101010101ULL) >> 56);
+  }
+
+  /** Compute the census transforms of size pixels of a line of an image,
+   * starting at column start. Neighbours outside the buffered region are
+   * clamped to it, and census of pixels outside the largest possible region
+   * are not computed. */
+  void ComputeCensusRow(const TInputImage * image, long line, long start, unsigned int size,
+                        CensusType * census) const;
+
+  /** The min disparity to explore */
+  int                           m_MinimumHorizontalDisparity;
+
+  /** The max disparity to explore */
+  int                           m_MaximumHorizontalDisparity;
+
+  /** Radius of the census transform */
+  unsigned int                  m_CensusRadius;
+
+  /** Penalty of one pixel disparity changes */
+  unsigned int                  m_P1;
+
+  /** Penalty of larger disparity changes */
+  unsigned int                  m_P2;
+
+  /** Number of aggregation paths */
+  unsigned int                  m_NumberOfPaths;
+
+  /** Halo added around each block */
+  unsigned int                  m_TileHalo;
+
+  /** Maximum size of the blocks */
+  unsigned int                  m_BlockSize;
+
+  /** Refine the disparities with a parabolic fit */
+  bool                          m_SubPixelInterpolation;
+
+  /** Check the left-right consistency */
+  bool                          m_LeftRightCheck;
+
+  /** Tolerance of the left-right consistency check */
+  unsigned int                  m_LeftRightTolerance;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbSemiGlobalMatchingImageFilter.hxx"
+#endif
+
+#endif
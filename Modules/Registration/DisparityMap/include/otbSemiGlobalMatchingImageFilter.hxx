@@ -0,0 +1,649 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbSemiGlobalMatchingImageFilter_hxx
+#define otbSemiGlobalMatchingImageFilter_hxx
+
+#include "otbSemiGlobalMatchingImageFilter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+namespace otb
+{
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::SemiGlobalMatchingImageFilter()
+{
+  // Set the number of inputs
+  this->SetNumberOfRequiredInputs(2);
+
+  // Set the outputs
+  this->SetNumberOfRequiredOutputs(4);
+  this->SetNthOutput(0,TOutputMetricImage::New());
+  this->SetNthOutput(1,TOutputDisparityImage::New());
+  this->SetNthOutput(2,TOutputDisparityImage::New());
+  this->SetNthOutput(3,TMaskImage::New());
+
+  // Default disparity range
+  m_MinimumHorizontalDisparity = -10;
+  m_MaximumHorizontalDisparity =  10;
+
+  // Default census window : 5x5
+  m_CensusRadius = 2;
+
+  // Default penalties, scaled for 24 bits census transforms
+  m_P1 = 4;
+  m_P2 = 48;
+
+  m_NumberOfPaths = 8;
+
+  m_TileHalo = 32;
+  m_BlockSize = 256;
+
+  m_SubPixelInterpolation = true;
+
+  m_LeftRightCheck = true;
+  m_LeftRightTolerance = 1;
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::SetLeftInput(const TInputImage * image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(0, const_cast<TInputImage *>( image ));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::SetRightInput(const TInputImage * image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(1, const_cast<TInputImage *>( image ));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::SetLeftMaskInput(const TMaskImage * image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(2, const_cast<TMaskImage *>( image ));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::SetRightMaskInput(const TMaskImage * image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(3, const_cast<TMaskImage *>( image ));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TInputImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetLeftInput() const
+{
+  if (this->GetNumberOfInputs()<1)
+    {
+    return nullptr;
+    }
+  return static_cast<const TInputImage *>(this->itk::ProcessObject::GetInput(0));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TInputImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetRightInput() const
+{
+  if (this->GetNumberOfInputs()<2)
+    {
+    return nullptr;
+    }
+  return static_cast<const TInputImage *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TMaskImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetLeftMaskInput() const
+{
+  if (this->GetNumberOfInputs()<3)
+    {
+    return nullptr;
+    }
+  return static_cast<const TMaskImage *>(this->itk::ProcessObject::GetInput(2));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TMaskImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetRightMaskInput() const
+{
+  if (this->GetNumberOfInputs()<4)
+    {
+    return nullptr;
+    }
+  return static_cast<const TMaskImage *>(this->itk::ProcessObject::GetInput(3));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+TOutputMetricImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetMetricOutput()
+{
+  return static_cast<TOutputMetricImage *>(this->itk::ProcessObject::GetOutput(0));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+TOutputDisparityImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetHorizontalDisparityOutput()
+{
+  return static_cast<TOutputDisparityImage *>(this->itk::ProcessObject::GetOutput(1));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+TOutputDisparityImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetVerticalDisparityOutput()
+{
+  return static_cast<TOutputDisparityImage *>(this->itk::ProcessObject::GetOutput(2));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+TMaskImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetValidityMaskOutput()
+{
+  return static_cast<TMaskImage *>(this->itk::ProcessObject::GetOutput(3));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const TInputImage * inLeftPtr  = this->GetLeftInput();
+  const TInputImage * inRightPtr = this->GetRightInput();
+  const TMaskImage  * inLeftMaskPtr  = this->GetLeftMaskInput();
+  const TMaskImage  * inRightMaskPtr = this->GetRightMaskInput();
+
+  if(inLeftPtr->GetLargestPossibleRegion() != inRightPtr->GetLargestPossibleRegion())
+    {
+    itkExceptionMacro(<<"Left and right images do not have the same size ! Left largest region: "<<inLeftPtr->GetLargestPossibleRegion()<<", right largest region: "<<inRightPtr->GetLargestPossibleRegion());
+    }
+  if(inLeftMaskPtr && inLeftPtr->GetLargestPossibleRegion() != inLeftMaskPtr->GetLargestPossibleRegion())
+    {
+    itkExceptionMacro(<<"Left and mask images do not have the same size ! Left largest region: "<<inLeftPtr->GetLargestPossibleRegion()<<", mask largest region: "<<inLeftMaskPtr->GetLargestPossibleRegion());
+    }
+  if(inRightMaskPtr && inRightPtr->GetLargestPossibleRegion() != inRightMaskPtr->GetLargestPossibleRegion())
+    {
+    itkExceptionMacro(<<"Right and mask images do not have the same size ! Right largest region: "<<inRightPtr->GetLargestPossibleRegion()<<", mask largest region: "<<inRightMaskPtr->GetLargestPossibleRegion());
+    }
+
+  // Check the parameters
+  if (m_MinimumHorizontalDisparity > m_MaximumHorizontalDisparity)
+    {
+    itkExceptionMacro(<<"Minimum disparity "<<m_MinimumHorizontalDisparity<<" is greater than maximum disparity "<<m_MaximumHorizontalDisparity);
+    }
+  if (m_CensusRadius < 1 || m_CensusRadius > 3)
+    {
+    itkExceptionMacro(<<"Census radius must be 1, 2 or 3, got "<<m_CensusRadius);
+    }
+  if (m_NumberOfPaths != 8 && m_NumberOfPaths != 16)
+    {
+    itkExceptionMacro(<<"Number of paths must be 8 or 16, got "<<m_NumberOfPaths);
+    }
+  if (m_P2 < m_P1)
+    {
+    itkExceptionMacro(<<"P2 ("<<m_P2<<") must be greater or equal to P1 ("<<m_P1<<")");
+    }
+  // Path costs are bounded by the maximum matching cost plus P2
+  const unsigned int maxCost = (2 * m_CensusRadius + 1) * (2 * m_CensusRadius + 1) - 1;
+  if (m_NumberOfPaths * (maxCost + m_P2) > std::numeric_limits<AggregatedCostType>::max())
+    {
+    itkExceptionMacro(<<"P2 ("<<m_P2<<") is too large for the aggregated costs");
+    }
+  if (m_BlockSize == 0)
+    {
+    itkExceptionMacro(<<"Block size must be positive");
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GenerateInputRequestedRegion()
+{
+  // Call the superclass implementation
+  Superclass::GenerateInputRequestedRegion();
+
+  // Retrieve input pointers
+  TInputImage * inLeftPtr  = const_cast<TInputImage *>(this->GetLeftInput());
+  TInputImage * inRightPtr = const_cast<TInputImage *>(this->GetRightInput());
+  TMaskImage  * inLeftMaskPtr  = const_cast<TMaskImage * >(this->GetLeftMaskInput());
+  TMaskImage  * inRightMaskPtr = const_cast<TMaskImage * >(this->GetRightMaskInput());
+
+  // Pad the requested region by the halo and by the census window
+  RegionType inputLeftRegion = this->GetHorizontalDisparityOutput()->GetRequestedRegion();
+  SizeType padding;
+  padding.Fill(m_TileHalo + m_CensusRadius);
+  inputLeftRegion.PadByRadius(padding);
+
+  // Now, we must find the corresponding region in moving image
+  RegionType inputRightRegion = inputLeftRegion;
+  IndexType rightRequestedRegionIndex = inputRightRegion.GetIndex();
+  rightRequestedRegionIndex[0] += m_MinimumHorizontalDisparity;
+  SizeType rightRequestedRegionSize = inputRightRegion.GetSize();
+  rightRequestedRegionSize[0] += m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity;
+  inputRightRegion.SetIndex(rightRequestedRegionIndex);
+  inputRightRegion.SetSize(rightRequestedRegionSize);
+
+  if ( !inputLeftRegion.Crop(inLeftPtr->GetLargestPossibleRegion()))
+    {
+    inLeftPtr->SetRequestedRegion( inputLeftRegion );
+
+    itk::InvalidRequestedRegionError e(__FILE__, __LINE__);
+    std::ostringstream msg;
+    msg << this->GetNameOfClass() << "::GenerateInputRequestedRegion()";
+    e.SetLocation(msg.str());
+    e.SetDescription("Requested region is (at least partially) outside the largest possible region of left image.");
+    e.SetDataObject(inLeftPtr);
+    throw e;
+    }
+  if ( !inputRightRegion.Crop(inRightPtr->GetLargestPossibleRegion()))
+    {
+    inRightPtr->SetRequestedRegion( inputRightRegion );
+
+    itk::InvalidRequestedRegionError e(__FILE__, __LINE__);
+    std::ostringstream msg;
+    msg << this->GetNameOfClass() << "::GenerateInputRequestedRegion()";
+    e.SetLocation(msg.str());
+    e.SetDescription("Requested region is (at least partially) outside the largest possible region of right image.");
+    e.SetDataObject(inRightPtr);
+    throw e;
+    }
+
+  inLeftPtr->SetRequestedRegion( inputLeftRegion );
+  inRightPtr->SetRequestedRegion( inputRightRegion );
+
+  if(inLeftMaskPtr)
+    {
+    inLeftMaskPtr->SetRequestedRegion( inputLeftRegion );
+    }
+  if(inRightMaskPtr)
+    {
+    inRightMaskPtr->SetRequestedRegion( inputRightRegion );
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels(), 100);
+
+  // Split the region of the thread into blocks
+  const SizeType size = outputRegionForThread.GetSize();
+  for (unsigned long by = 0; by < size[1]; by += m_BlockSize)
+    {
+    for (unsigned long bx = 0; bx < size[0]; bx += m_BlockSize)
+      {
+      IndexType blockIndex = outputRegionForThread.GetIndex();
+      blockIndex[0] += bx;
+      blockIndex[1] += by;
+      SizeType blockSize;
+      blockSize[0] = std::min(static_cast<unsigned long>(m_BlockSize), size[0] - bx);
+      blockSize[1] = std::min(static_cast<unsigned long>(m_BlockSize), size[1] - by);
+      RegionType block(blockIndex, blockSize);
+
+      this->ProcessBlock(block, progress);
+      }
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::ProcessBlock(const RegionType& block, itk::ProgressReporter & progress)
+{
+  // Retrieve pointers
+  const TInputImage * inLeftPtr  = this->GetLeftInput();
+  const TInputImage * inRightPtr = this->GetRightInput();
+  const TMaskImage  * inLeftMaskPtr  = this->GetLeftMaskInput();
+  const TMaskImage  * inRightMaskPtr = this->GetRightMaskInput();
+  TOutputMetricImage    * outMetricPtr = this->GetMetricOutput();
+  TOutputDisparityImage * outHDispPtr  = this->GetHorizontalDisparityOutput();
+  TOutputDisparityImage * outVDispPtr  = this->GetVerticalDisparityOutput();
+  TMaskImage            * outMaskPtr   = this->GetValidityMaskOutput();
+
+  // Block padded by the halo
+  RegionType padded = block;
+  SizeType halo;
+  halo.Fill(m_TileHalo);
+  padded.PadByRadius(halo);
+  padded.Crop(inLeftPtr->GetLargestPossibleRegion());
+
+  const long startX = padded.GetIndex(0);
+  const long startY = padded.GetIndex(1);
+  const unsigned int width = padded.GetSize(0);
+  const unsigned int height = padded.GetSize(1);
+  const int minDisparity = m_MinimumHorizontalDisparity;
+  const unsigned int nbDisparities = m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity + 1;
+  const unsigned int rightWidth = width + nbDisparities - 1;
+  const CostType maxCost = static_cast<CostType>((2 * m_CensusRadius + 1) * (2 * m_CensusRadius + 1) - 1);
+
+  const long rightStartX = inRightPtr->GetLargestPossibleRegion().GetIndex(0);
+  const long rightEndX = rightStartX + static_cast<long>(inRightPtr->GetLargestPossibleRegion().GetSize(0));
+
+  //----------------- ------------- -----------------//
+  //----------------- Matching costs -----------------//
+  //----------------- ------------- -----------------//
+  std::vector<CostType> costs(static_cast<std::size_t>(width) * height * nbDisparities);
+  std::vector<CensusType> leftCensus(width);
+  std::vector<CensusType> rightCensus(rightWidth);
+  std::vector<unsigned char> rightValid(rightWidth);
+  for (unsigned int y = 0; y < height; ++y)
+    {
+    const long line = startY + y;
+    this->ComputeCensusRow(inLeftPtr, line, startX, width, leftCensus.data());
+    this->ComputeCensusRow(inRightPtr, line, startX + minDisparity, rightWidth, rightCensus.data());
+
+    // Right pixels outside the image or the mask get the maximum cost
+    for (unsigned int q = 0; q < rightWidth; ++q)
+      {
+      IndexType rightIndex;
+      rightIndex[0] = startX + minDisparity + q;
+      rightIndex[1] = line;
+      rightValid[q] = rightIndex[0] >= rightStartX && rightIndex[0] < rightEndX
+                      && (!inRightMaskPtr || inRightMaskPtr->GetPixel(rightIndex) > 0);
+      }
+
+    CostType * cost = &costs[static_cast<std::size_t>(y) * width * nbDisparities];
+    for (unsigned int x = 0; x < width; ++x, cost += nbDisparities)
+      {
+      IndexType leftIndex;
+      leftIndex[0] = startX + x;
+      leftIndex[1] = line;
+      // Masked left pixels have uniform costs
+      if (inLeftMaskPtr && !(inLeftMaskPtr->GetPixel(leftIndex) > 0))
+        {
+        std::fill(cost, cost + nbDisparities, 0);
+        continue;
+        }
+      for (unsigned int d = 0; d < nbDisparities; ++d)
+        {
+        cost[d] = rightValid[x + d] ? static_cast<CostType>(HammingWeight(leftCensus[x] ^ rightCensus[x + d])) : maxCost;
+        }
+      }
+    }
+
+  //----------------- ----------- -----------------//
+  //----------------- Aggregation -----------------//
+  //----------------- ----------- -----------------//
+  // Directions of the paths whose previous pixel comes first in raster
+  // order. The forward pass follows them, the backward pass follows their
+  // opposites.
+  static const int directions[8][2] = { {1, 0}, {0, 1}, {1, 1}, {-1, 1},
+                                        {2, 1}, {1, 2}, {-1, 2}, {-2, 1} };
+  const unsigned int nbDirections = m_NumberOfPaths / 2;
+
+  std::vector<AggregatedCostType> sums(costs.size(), 0);
+
+  // Path costs of the last three lines of each direction (paths go back two
+  // lines at most)
+  std::vector<AggregatedCostType> pathCosts(static_cast<std::size_t>(nbDirections) * 3 * width * nbDisparities);
+  std::vector<AggregatedCostType> pathMinimums(static_cast<std::size_t>(nbDirections) * 3 * width);
+
+  for (int sign = 1; sign >= -1; sign -= 2)
+    {
+    for (unsigned int i = 0; i < height; ++i)
+      {
+      const long y = sign > 0 ? i : height - 1 - i;
+      for (unsigned int j = 0; j < width; ++j)
+        {
+        const long x = sign > 0 ? j : width - 1 - j;
+        const std::size_t pixel = static_cast<std::size_t>(y) * width + x;
+        const CostType * cost = &costs[pixel * nbDisparities];
+        AggregatedCostType * sum = &sums[pixel * nbDisparities];
+
+        for (unsigned int dir = 0; dir < nbDirections; ++dir)
+          {
+          const std::size_t slot = (dir * 3 + y % 3) * width + x;
+          AggregatedCostType * current = &pathCosts[slot * nbDisparities];
+
+          const long previousX = x - sign * directions[dir][0];
+          const long previousY = y - sign * directions[dir][1];
+          if (previousX < 0 || previousX >= static_cast<long>(width) || previousY < 0 || previousY >= static_cast<long>(height))
+            {
+            // First pixel of the path
+            std::copy(cost, cost + nbDisparities, current);
+            pathMinimums[slot] = *std::min_element(cost, cost + nbDisparities);
+            }
+          else
+            {
+            const std::size_t previousSlot = (dir * 3 + previousY % 3) * width + previousX;
+            pathMinimums[slot] = this->UpdatePathCosts(cost, &pathCosts[previousSlot * nbDisparities],
+                                                       pathMinimums[previousSlot], current, nbDisparities);
+            }
+
+          for (unsigned int d = 0; d < nbDisparities; ++d)
+            {
+            sum[d] += current[d];
+            }
+          }
+        }
+      }
+    }
+
+  //----------------- ---------------- -----------------//
+  //----------------- Winner takes all -----------------//
+  //----------------- ---------------- -----------------//
+  std::vector<AggregatedCostType> rightMinimums(rightWidth);
+  std::vector<int> rightDisparities(rightWidth);
+  const long blockStartX = block.GetIndex(0) - startX;
+  const long blockStartY = block.GetIndex(1) - startY;
+  for (unsigned int by = 0; by < block.GetSize(1); ++by)
+    {
+    const long y = blockStartY + by;
+    const AggregatedCostType * lineSums = &sums[static_cast<std::size_t>(y) * width * nbDisparities];
+
+    // Disparities of the right pixels, along the diagonals of the volume
+    if (m_LeftRightCheck)
+      {
+      std::fill(rightMinimums.begin(), rightMinimums.end(), std::numeric_limits<AggregatedCostType>::max());
+      std::fill(rightDisparities.begin(), rightDisparities.end(), -1);
+      for (unsigned int x = 0; x < width; ++x)
+        {
+        const AggregatedCostType * sum = lineSums + x * nbDisparities;
+        for (unsigned int d = 0; d < nbDisparities; ++d)
+          {
+          if (sum[d] < rightMinimums[x + d])
+            {
+            rightMinimums[x + d] = sum[d];
+            rightDisparities[x + d] = d;
+            }
+          }
+        }
+      }
+
+    for (unsigned int bx = 0; bx < block.GetSize(0); ++bx)
+      {
+      const long x = blockStartX + bx;
+      IndexType index;
+      index[0] = startX + x;
+      index[1] = startY + y;
+
+      outVDispPtr->SetPixel(index, static_cast<DisparityPixelType>(0));
+      if (inLeftMaskPtr && !(inLeftMaskPtr->GetPixel(index) > 0))
+        {
+        outMetricPtr->SetPixel(index, static_cast<MetricValueType>(0));
+        outHDispPtr->SetPixel(index, static_cast<DisparityPixelType>(minDisparity));
+        outMaskPtr->SetPixel(index, static_cast<MaskPixelType>(0));
+        progress.CompletedPixel();
+        continue;
+        }
+
+      const AggregatedCostType * sum = lineSums + x * nbDisparities;
+      const unsigned int best = std::min_element(sum, sum + nbDisparities) - sum;
+
+      double disparity = static_cast<double>(minDisparity + static_cast<int>(best));
+      if (m_SubPixelInterpolation && best > 0 && best + 1 < nbDisparities)
+        {
+        const double previous = sum[best - 1];
+        const double next = sum[best + 1];
+        const double curvature = previous - 2. * sum[best] + next;
+        if (curvature > 0.)
+          {
+          disparity += (previous - next) / (2. * curvature);
+          }
+        }
+
+      bool valid = true;
+      if (m_LeftRightCheck)
+        {
+        valid = std::abs(rightDisparities[x + best] - static_cast<int>(best)) <= static_cast<int>(m_LeftRightTolerance);
+        }
+
+      outMetricPtr->SetPixel(index, static_cast<MetricValueType>(static_cast<double>(sum[best]) / m_NumberOfPaths));
+      outHDispPtr->SetPixel(index, static_cast<DisparityPixelType>(disparity));
+      outMaskPtr->SetPixel(index, static_cast<MaskPixelType>(valid ? 255 : 0));
+      progress.CompletedPixel();
+      }
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+typename SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>::AggregatedCostType
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::UpdatePathCosts(const CostType * costs, const AggregatedCostType * previous,
+                  AggregatedCostType previousMinimum, AggregatedCostType * current,
+                  unsigned int nbDisparities) const
+{
+  // Branch-free loops on contiguous arrays, which the compiler vectorizes
+  const unsigned int p1 = m_P1;
+  const unsigned int jump = previousMinimum + m_P2;
+  if (nbDisparities == 1)
+    {
+    current[0] = costs[0];
+    return current[0];
+    }
+
+  current[0] = costs[0] + std::min(std::min<unsigned int>(previous[0], previous[1] + p1), jump) - previousMinimum;
+  for (unsigned int d = 1; d + 1 < nbDisparities; ++d)
+    {
+    const unsigned int neighbour = std::min<unsigned int>(previous[d - 1], previous[d + 1]) + p1;
+    current[d] = costs[d] + std::min(std::min<unsigned int>(previous[d], neighbour), jump) - previousMinimum;
+    }
+  const unsigned int last = nbDisparities - 1;
+  current[last] = costs[last] + std::min(std::min<unsigned int>(previous[last], previous[last - 1] + p1), jump) - previousMinimum;
+
+  AggregatedCostType minimum = current[0];
+  for (unsigned int d = 1; d < nbDisparities; ++d)
+    {
+    minimum = std::min(minimum, current[d]);
+    }
+  return minimum;
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::ComputeCensusRow(const TInputImage * image, long line, long start, unsigned int size, CensusType * census) const
+{
+  typedef typename TInputImage::PixelType PixelType;
+
+  const RegionType & buffered = image->GetBufferedRegion();
+  const RegionType & largest = image->GetLargestPossibleRegion();
+  const long radius = m_CensusRadius;
+  const long bufferStartX = buffered.GetIndex(0);
+  const long bufferEndX = bufferStartX + static_cast<long>(buffered.GetSize(0));
+  const long bufferStartY = buffered.GetIndex(1);
+  const long bufferEndY = bufferStartY + static_cast<long>(buffered.GetSize(1));
+  const long firstX = std::max(std::max(start, largest.GetIndex(0)), bufferStartX);
+  const long lastX = std::min(std::min(start + static_cast<long>(size),
+                                       largest.GetIndex(0) + static_cast<long>(largest.GetSize(0))), bufferEndX);
+
+  std::fill(census, census + size, 0);
+  if (line < bufferStartY || line >= bufferEndY)
+    {
+    return;
+    }
+
+  // Lines of the window, clamped to the buffered region
+  std::vector<const PixelType *> lines(2 * radius + 1);
+  for (long dy = -radius; dy <= radius; ++dy)
+    {
+    IndexType index;
+    index[0] = bufferStartX;
+    index[1] = std::min(std::max(line + dy, bufferStartY), bufferEndY - 1);
+    lines[dy + radius] = image->GetBufferPointer() + image->ComputeOffset(index);
+    }
+
+  for (long x = firstX; x < lastX; ++x)
+    {
+    const PixelType center = lines[radius][x - bufferStartX];
+    CensusType value = 0;
+    for (long dy = -radius; dy <= radius; ++dy)
+      {
+      const PixelType * pixels = lines[dy + radius];
+      for (long dx = -radius; dx <= radius; ++dx)
+        {
+        if (dx == 0 && dy == 0)
+          {
+          continue;
+          }
+        const long neighbour = std::min(std::max(x + dx, bufferStartX), bufferEndX - 1);
+        value = (value << 1) | (pixels[neighbour - bufferStartX] < center ? 1 : 0);
+        }
+      }
+    census[x - start] = value;
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Horizontal disparity range: [" << m_MinimumHorizontalDisparity << ", "
+     << m_MaximumHorizontalDisparity << "]" << std::endl;
+  os << indent << "Census radius: " << m_CensusRadius << std::endl;
+  os << indent << "P1: " << m_P1 << ", P2: " << m_P2 << std::endl;
+  os << indent << "Number of paths: " << m_NumberOfPaths << std::endl;
+  os << indent << "Tile halo: " << m_TileHalo << ", block size: " << m_BlockSize << std::endl;
+  os << indent << "Sub-pixel interpolation: " << m_SubPixelInterpolation << std::endl;
+  os << indent << "Left-right check: " << m_LeftRightCheck << " (tolerance " << m_LeftRightTolerance << ")" << std::endl;
+}
+
+} // end namespace otb
+
+#endif
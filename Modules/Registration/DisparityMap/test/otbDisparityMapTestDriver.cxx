@@ -30,7 +30,10 @@ void RegisterTests()
   REGISTER_TEST(otbDisparityMapTo3DFilter);
   REGISTER_TEST(otbMultiDisparityMapTo3DFilter);
   REGISTER_TEST(otbFineRegistrationImageFilterTest);
+  REGISTER_TEST(otbFineRegistrationImageFilterPyramidTest);
   REGISTER_TEST(otbNCCRegistrationFilter);
   REGISTER_TEST(otbPixelWiseBlockMatchingImageFilter);
   REGISTER_TEST(otbPixelWiseBlockMatchingImageFilterNCC);
+  REGISTER_TEST(otbPixelWiseBlockMatchingImageFilterIncremental);
+  REGISTER_TEST(otbSemiGlobalMatchingImageFilter);
 }
@@ -27,6 +27,8 @@
 #include "otbStandardFilterWatcher.h"
 #include "otbStopwatch.h"
 #include "otbExtractROI.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
 
 
 #include "itkNormalizedCorrelationImageToImageMetric.h"
@@ -173,3 +175,86 @@ int otbFineRegistrationImageFilterTest( int argc, char * argv[] )
 
   return EXIT_SUCCESS;
 }
+
+int otbFineRegistrationImageFilterPyramidTest( int itkNotUsed(argc), char * itkNotUsed(argv) [] )
+{
+  typedef double      PixelType;
+  const unsigned int  Dimension = 2;
+
+  typedef itk::FixedArray<PixelType, Dimension>                                 DisplacementValueType;
+  typedef otb::Image< PixelType,  Dimension >                                  ImageType;
+  typedef otb::Image<DisplacementValueType, Dimension>                           FieldImageType;
+  typedef otb::FineRegistrationImageFilter<ImageType, ImageType, FieldImageType> RegistrationFilterType;
+
+  // Smooth non periodic texture, and the same texture translated
+  const double shiftX = 13.;
+  const double shiftY = -9.;
+
+  ImageType::RegionType region;
+  region.SetIndex(0, 0);
+  region.SetIndex(1, 0);
+  region.SetSize(0, 120);
+  region.SetSize(1, 120);
+
+  ImageType::Pointer fixed = ImageType::New();
+  fixed->SetRegions(region);
+  fixed->Allocate();
+  ImageType::Pointer moving = ImageType::New();
+  moving->SetRegions(region);
+  moving->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> fixedIt(fixed, region);
+  itk::ImageRegionIteratorWithIndex<ImageType> movingIt(moving, region);
+  for (fixedIt.GoToBegin(), movingIt.GoToBegin(); !fixedIt.IsAtEnd(); ++fixedIt, ++movingIt)
+    {
+    const double x = fixedIt.GetIndex()[0];
+    const double y = fixedIt.GetIndex()[1];
+    for (unsigned int image = 0; image < 2; ++image)
+      {
+      const double u = (image == 0) ? x : x - shiftX;
+      const double v = (image == 0) ? y : y - shiftY;
+      const double value = 100. + 20. * std::sin(0.21 * u + 0.13 * v) + 15. * std::sin(0.07 * u - 0.17 * v + 1.)
+        + 10. * std::cos(0.31 * u + 0.05 * v + 2.) + 12. * std::cos(0.11 * u + 0.29 * v + 0.5);
+      if (image == 0)
+        {
+        fixedIt.Set(value);
+        }
+      else
+        {
+        movingIt.Set(value);
+        }
+      }
+    }
+
+  RegistrationFilterType::Pointer registration = RegistrationFilterType::New();
+  registration->SetFixedInput(fixed);
+  registration->SetMovingInput(moving);
+  registration->SetRadius(3);
+  registration->SetSearchRadius(20);
+  registration->SetNumberOfLevels(3);
+  registration->Update();
+
+  // Check the estimated translation away from the borders
+  FieldImageType::RegionType checkRegion = region;
+  checkRegion.ShrinkByRadius(30);
+
+  itk::ImageRegionConstIterator<FieldImageType> fieldIt(registration->GetOutputDisplacementField(), checkRegion);
+  unsigned int nbGood = 0;
+  for (fieldIt.GoToBegin(); !fieldIt.IsAtEnd(); ++fieldIt)
+    {
+    if (std::abs(fieldIt.Get()[0] - shiftX) < 0.5 && std::abs(fieldIt.Get()[1] - shiftY) < 0.5)
+      {
+      ++nbGood;
+      }
+    }
+
+  const double ratio = static_cast<double>(nbGood) / static_cast<double>(checkRegion.GetNumberOfPixels());
+  std::cout << "Ratio of correct displacements: " << ratio << std::endl;
+  if (ratio < 0.95)
+    {
+    std::cerr << "Too many wrong displacements" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -23,6 +23,12 @@
 #include "otbImageFileReader.h"
 #include "otbImageFileWriter.h"
 #include "otbStandardWriterWatcher.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
 
 typedef otb::Image<unsigned short>                    ImageType;
 typedef otb::Image<float>                             FloatImageType;
@@ -35,6 +41,10 @@ typedef otb::Functor::NCCBlockMatching<ImageType,FloatImageType> NCCBlockMatchin
 
 typedef otb::PixelWiseBlockMatchingImageFilter<ImageType,FloatImageType,FloatImageType,ImageType, NCCBlockMatchingFunctorType> PixelWiseNCCBlockMatchingImageFilterType;
 
+typedef otb::Functor::LPBlockMatching<ImageType,FloatImageType> LPBlockMatchingFunctorType;
+
+typedef otb::PixelWiseBlockMatchingImageFilter<ImageType,FloatImageType,FloatImageType,ImageType, LPBlockMatchingFunctorType> PixelWiseLPBlockMatchingImageFilterType;
+
 
 int otbPixelWiseBlockMatchingImageFilter(int argc, char * argv[])
 {
@@ -119,3 +129,112 @@ int otbPixelWiseBlockMatchingImageFilterNCC(int argc, char * argv[])
 
   return EXIT_SUCCESS;
 }
+
+/** Set the exponent of the Lp functor, no-op for the other functors */
+template <class TFunctor>
+void SetLPExponent(TFunctor &, double)
+{
+}
+
+void SetLPExponent(LPBlockMatchingFunctorType & functor, double p)
+{
+  functor.SetP(p);
+}
+
+/** Run the block matching with and without box sums, and compare the outputs */
+template <class TFilter>
+void CompareIncrementalMetric(const std::string & name, const ImageType * left, const ImageType * right,
+                              const ImageType * mask, bool minimize, double p, unsigned int step)
+{
+  typename TFilter::Pointer filters[2];
+  for (unsigned int i = 0; i < 2; ++i)
+    {
+    filters[i] = TFilter::New();
+    filters[i]->SetLeftInput(left);
+    filters[i]->SetRightInput(right);
+    filters[i]->SetLeftMaskInput(mask);
+    filters[i]->SetRadius(2);
+    filters[i]->SetMinimumHorizontalDisparity(-4);
+    filters[i]->SetMaximumHorizontalDisparity(6);
+    filters[i]->SetMinimumVerticalDisparity(-1);
+    filters[i]->SetMaximumVerticalDisparity(1);
+    filters[i]->SetMinimize(minimize);
+    filters[i]->SetStep(step);
+    ImageType::IndexType gridIndex;
+    gridIndex.Fill(step - 1);
+    filters[i]->SetGridIndex(gridIndex);
+    filters[i]->SetIncrementalMetric(i == 0);
+    SetLPExponent(filters[i]->GetFunctor(), p);
+    filters[i]->Update();
+    }
+
+  itk::ImageRegionConstIterator<FloatImageType> metric0(filters[0]->GetMetricOutput(), filters[0]->GetMetricOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<FloatImageType> metric1(filters[1]->GetMetricOutput(), filters[1]->GetMetricOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<FloatImageType> hDisp0(filters[0]->GetHorizontalDisparityOutput(), filters[0]->GetMetricOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<FloatImageType> hDisp1(filters[1]->GetHorizontalDisparityOutput(), filters[1]->GetMetricOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<FloatImageType> vDisp0(filters[0]->GetVerticalDisparityOutput(), filters[0]->GetMetricOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<FloatImageType> vDisp1(filters[1]->GetVerticalDisparityOutput(), filters[1]->GetMetricOutput()->GetLargestPossibleRegion());
+  for (metric0.GoToBegin(), metric1.GoToBegin(), hDisp0.GoToBegin(), hDisp1.GoToBegin(), vDisp0.GoToBegin(), vDisp1.GoToBegin();
+       !metric0.IsAtEnd(); ++metric0, ++metric1, ++hDisp0, ++hDisp1, ++vDisp0, ++vDisp1)
+    {
+    if (std::abs(metric0.Get() - metric1.Get()) > 1e-6 * std::max(1.f, std::abs(metric1.Get()))
+        || hDisp0.Get() != hDisp1.Get() || vDisp0.Get() != vDisp1.Get())
+      {
+      itkGenericExceptionMacro(<< name
+                               << " at " << metric0.GetIndex() << ": box sums give metric " << metric0.Get()
+                               << " and disparity (" << hDisp0.Get() << ", " << vDisp0.Get()
+                               << ") instead of " << metric1.Get()
+                               << " and (" << hDisp1.Get() << ", " << vDisp1.Get() << ")");
+      }
+    }
+}
+
+int otbPixelWiseBlockMatchingImageFilterIncremental(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  // Random texture, shifted by (3, 1) in the right image
+  ImageType::SizeType size;
+  size[0] = 47;
+  size[1] = 31;
+  ImageType::RegionType region;
+  region.SetSize(size);
+
+  ImageType::Pointer left = ImageType::New();
+  ImageType::Pointer right = ImageType::New();
+  ImageType::Pointer mask = ImageType::New();
+  left->SetRegions(region);
+  left->Allocate();
+  right->SetRegions(region);
+  right->Allocate();
+  mask->SetRegions(region);
+  mask->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> leftIt(left, region);
+  for (leftIt.GoToBegin(); !leftIt.IsAtEnd(); ++leftIt)
+    {
+    const ImageType::IndexType idx = leftIt.GetIndex();
+    leftIt.Set(static_cast<ImageType::PixelType>((idx[0] * 7919 + idx[1] * 104729 + idx[0] * idx[1] * 31) % 251));
+    }
+  itk::ImageRegionIteratorWithIndex<ImageType> rightIt(right, region);
+  for (rightIt.GoToBegin(); !rightIt.IsAtEnd(); ++rightIt)
+    {
+    ImageType::IndexType idx = rightIt.GetIndex();
+    idx[0] -= 3;
+    idx[1] -= 1;
+    rightIt.Set(region.IsInside(idx) ? left->GetPixel(idx) + (idx[0] % 3) : 0);
+    }
+  itk::ImageRegionIteratorWithIndex<ImageType> maskIt(mask, region);
+  for (maskIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt)
+    {
+    maskIt.Set((maskIt.GetIndex()[0] + maskIt.GetIndex()[1]) % 11 == 0 ? 0 : 255);
+    }
+
+  for (unsigned int step = 1; step <= 2; ++step)
+    {
+    CompareIncrementalMetric<PixelWiseBlockMatchingImageFilterType>("SSD", left, right, mask, true, 1., step);
+    CompareIncrementalMetric<PixelWiseNCCBlockMatchingImageFilterType>("NCC", left, right, mask, false, 1., step);
+    CompareIncrementalMetric<PixelWiseLPBlockMatchingImageFilterType>("L1", left, right, mask, true, 1., step);
+    CompareIncrementalMetric<PixelWiseLPBlockMatchingImageFilterType>("L2", left, right, mask, true, 2., step);
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbSemiGlobalMatchingImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <cmath>
+
+typedef otb::Image<unsigned short>                    ImageType;
+typedef otb::Image<float>                             FloatImageType;
+typedef otb::Image<unsigned char>                     MaskImageType;
+
+typedef otb::SemiGlobalMatchingImageFilter<ImageType,FloatImageType,FloatImageType,MaskImageType> SemiGlobalMatchingImageFilterType;
+
+int otbSemiGlobalMatchingImageFilter(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  // Random texture on two fronto-parallel planes, with disparities 3 (left
+  // half) and 6 (right half)
+  ImageType::SizeType size;
+  size[0] = 96;
+  size[1] = 64;
+  ImageType::RegionType region;
+  region.SetSize(size);
+
+  ImageType::Pointer left = ImageType::New();
+  ImageType::Pointer right = ImageType::New();
+  left->SetRegions(region);
+  left->Allocate();
+  right->SetRegions(region);
+  right->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> leftIt(left, region);
+  for (leftIt.GoToBegin(); !leftIt.IsAtEnd(); ++leftIt)
+    {
+    const ImageType::IndexType idx = leftIt.GetIndex();
+    leftIt.Set(static_cast<ImageType::PixelType>((idx[0] * 7919 + idx[1] * 104729 + idx[0] * idx[1] * 31) % 251));
+    }
+  // A left pixel x matches the right pixel x + disparity
+  right->FillBuffer(0);
+  for (leftIt.GoToBegin(); !leftIt.IsAtEnd(); ++leftIt)
+    {
+    ImageType::IndexType idx = leftIt.GetIndex();
+    idx[0] += idx[0] < static_cast<long>(size[0] / 2) ? 3 : 6;
+    if (region.IsInside(idx))
+      {
+      right->SetPixel(idx, leftIt.Get());
+      }
+    }
+
+  const unsigned int paths[2] = {8, 16};
+  for (unsigned int i = 0; i < 2; ++i)
+    {
+    SemiGlobalMatchingImageFilterType::Pointer sgmFilter = SemiGlobalMatchingImageFilterType::New();
+    sgmFilter->SetLeftInput(left);
+    sgmFilter->SetRightInput(right);
+    sgmFilter->SetMinimumHorizontalDisparity(-2);
+    sgmFilter->SetMaximumHorizontalDisparity(10);
+    sgmFilter->SetNumberOfPaths(paths[i]);
+    // Small blocks, so that the halo is exercised
+    sgmFilter->SetBlockSize(24);
+    sgmFilter->SetTileHalo(16);
+    sgmFilter->Update();
+
+    // Check the pixels away from the image borders and the discontinuity
+    unsigned int nbPixels = 0;
+    unsigned int nbCorrect = 0;
+    unsigned int nbValid = 0;
+    itk::ImageRegionIteratorWithIndex<FloatImageType> dispIt(sgmFilter->GetHorizontalDisparityOutput(), region);
+    for (dispIt.GoToBegin(); !dispIt.IsAtEnd(); ++dispIt)
+      {
+      const ImageType::IndexType idx = dispIt.GetIndex();
+      const long distanceToEdge = std::abs(idx[0] - static_cast<long>(size[0] / 2));
+      if (idx[0] < 8 || idx[0] >= static_cast<long>(size[0]) - 12 || idx[1] < 3
+          || idx[1] >= static_cast<long>(size[1]) - 3 || distanceToEdge < 8)
+        {
+        continue;
+        }
+      const float expected = idx[0] < static_cast<long>(size[0] / 2) ? 3. : 6.;
+      ++nbPixels;
+      if (std::abs(dispIt.Get() - expected) < 0.5)
+        {
+        ++nbCorrect;
+        }
+      if (sgmFilter->GetValidityMaskOutput()->GetPixel(idx) > 0)
+        {
+        ++nbValid;
+        }
+      }
+
+    std::cout << paths[i] << " paths: " << nbCorrect << " correct and " << nbValid
+              << " valid disparities out of " << nbPixels << std::endl;
+    if (nbCorrect < 0.95 * nbPixels || nbValid < 0.9 * nbPixels)
+      {
+      std::cerr << "Too few correct disparities with " << paths[i] << " paths" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -29,7 +29,10 @@
 #include "otbImage.h"
 #include "itkImageRegionSplitter.h"
 #include "otbObjectList.h"
+#include "otbParallelFor.h"
 #include <string>
+#include <vector>
+#include <functional>
 
 namespace otb
 {
@@ -40,7 +43,8 @@ enum CellFusionMode {
   MIN = 0,
   MAX = 1,
   MEAN = 2,
-  ACC = 3 //return accumulator for debug purpose
+  ACC = 3, //return accumulator for debug purpose
+  MEDIAN = 4
   };
 }
 
@@ -56,6 +60,7 @@ enum CellFusionMode {
  * - 1 MAX : we keep the maximum altitude
  * - 2 MEAN : mean is computed
  * - 3 ACC : returns cell count (useful to create mask from output)
+ * - 4 MEDIAN : median altitude (mean of the two central values for even counts)
  *
  *  empty cell are filled with the NoDataValue (-32768 by default)
  *
@@ -69,6 +74,13 @@ enum CellFusionMode {
  *  Origin, Spacing, Size, StartIndex, ProjectionRef
  *  thus DEMGridStep parameter is ignored in this case (replaced by Spacing)
  *
+ *  The rasterization is done in two parallel passes. First, each thread
+ *  projects the valid points of its share of the 3D maps and bins them by
+ *  row band of the output requested region. Then each band is reduced by a
+ *  single thread, directly into the output buffer. The memory used is
+ *  proportional to the number of points falling in the requested region,
+ *  instead of one full copy of the requested region per thread.
+ *
  *  \sa FineRegistrationImageFilter
  *  \sa MultiDisparityMapTo3DFilter
  *
@@ -244,10 +256,10 @@ protected:
   /** Before threaded generate data */
   void BeforeThreadedGenerateData() override;
 
-  /** Threaded generate data */
+  /** Threaded generate data : bin the points of the maps by output band */
   void ThreadedGenerateData(const RegionType & outputRegionForThread, itk::ThreadIdType threadId) override;
 
-  /** After threaded generate data */
+  /** After threaded generate data : reduce each output band */
   void AfterThreadedGenerateData() override;
 
   /** Override VerifyInputInformation() since this filter's inputs do
@@ -265,6 +277,19 @@ private:
   Multi3DMapToDEMFilter(const Self&) = delete;
   void operator=(const Self&) = delete;
 
+  /** Point projected in the output requested region */
+  struct CellValueType
+  {
+    /** Offset of the cell in its output band */
+    std::size_t  Offset;
+    DEMPixelType Height;
+  };
+
+  typedef std::vector<CellValueType> CellValueListType;
+
+  /** Fuse the points binned in a band, and write the band in the output */
+  void ReduceBand(unsigned int band);
+
   /** Keywordlist of each map */
  // std::vector<ImageKeywordListType> m_MapKeywordLists;
 
@@ -280,10 +305,18 @@ private:
   /** DEM grid step (in meters) */
   double m_DEMGridStep;
 
-  /** Temporary DEMs for multithreading */
-   std::vector<typename OutputImageType::Pointer>      m_TempDEMRegions;
-   /** Temporary accumulator for multithreading and mean calculus*/
-   std::vector<typename AccumulatorImageType::Pointer> m_TempDEMAccumulatorRegions;
+  /** Number of threads used to bin the points */
+  unsigned int m_NumberOfBinningThreads;
+
+  /** First row of each output band, relative to the requested region (one
+   * more element for the end) */
+  std::vector<std::size_t> m_BandRows;
+
+  /** Band of each row of the output requested region */
+  std::vector<unsigned int> m_RowToBand;
+
+  /** Points binned by thread and band, at [threadId * nbBands + band] */
+  std::vector<CellValueListType> m_BinnedCells;
 
 
   std::vector<unsigned int> m_NumberOfSplit; // number of split for each map
@@ -26,6 +26,7 @@
 #include "itkImageRegionIterator.h"
 #include "otbStreamingStatisticsVectorImageFilter.h"
 #include "otbInverseSensorModel.h"
+#include <algorithm>
 
 namespace otb
 {
@@ -50,6 +51,7 @@ Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::Multi3DMapToDEMFil
   m_CellFusionMode = otb::CellFusionMode::MAX;
   m_OutputParametersFrom3DMap = -2;
   m_IsGeographic=true;
+  m_NumberOfBinningThreads = 1;
 
   m_Margin[0]=10;
   m_Margin[1]=10;
@@ -496,17 +498,26 @@ template<class T3DImage, class TMaskImage, class TOutputDEMImage>
 void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::BeforeThreadedGenerateData()
 {
   const TOutputDEMImage * outputDEM = this->GetDEMOutput();
+  const RegionType outputRequestedRegion = outputDEM->GetRequestedRegion();
+
+  if (this->m_CellFusionMode < otb::CellFusionMode::MIN || this->m_CellFusionMode > otb::CellFusionMode::MEDIAN)
+    {
+    itkExceptionMacro(<< "Unexpected value cell fusion mode :"<<this->m_CellFusionMode);
+    }
+
+  // Number of threads that will actually call ThreadedGenerateData()
+  RegionType dummyRegion;
+  m_NumberOfBinningThreads = this->SplitRequestedRegion(0, this->GetNumberOfThreads(), dummyRegion);
 
   //create splits
-  // for each map we check if the input region can be split into threadNb
+  // for each map we check if the input region can be split into m_NumberOfBinningThreads
   m_NumberOfSplit.resize(this->GetNumberOf3DMaps());
-
-  unsigned int maximumRegionsNumber = 1;
+  m_MapSplitterList->Clear();
 
   for (unsigned int k = 0; k < this->GetNumberOf3DMaps(); ++k)
     {
     m_MapSplitterList->PushBack(SplitterType::New());
-    T3DImage *imgPtr = const_cast<T3DImage *> (this->Get3DMapInput(k));
+    const T3DImage *imgPtr = this->Get3DMapInput(k);
 
     typename T3DImage::RegionType requestedRegion = imgPtr->GetRequestedRegion();
 
@@ -514,38 +525,33 @@ void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::BeforeThreade
     unsigned int regionsNumber =0;
     if(requestedSize[0]*requestedSize[1]!=0)
       {
-    regionsNumber = m_MapSplitterList->GetNthElement(k)->GetNumberOfSplits(requestedRegion,
-                                                                                        this->GetNumberOfThreads());
+      regionsNumber = m_MapSplitterList->GetNthElement(k)->GetNumberOfSplits(requestedRegion,
+                                                                             m_NumberOfBinningThreads);
       }
     m_NumberOfSplit[k] = regionsNumber;
     otbMsgDevMacro( "map " << k << " will be split into " << regionsNumber << " regions" );
-    if (maximumRegionsNumber < regionsNumber) maximumRegionsNumber = regionsNumber;
-
     }
 
-  m_TempDEMRegions.clear();
-  m_TempDEMAccumulatorRegions.clear();
-  //m_ThreadProcessed.resize(maximumRegionsNumber);
+  // Split the output requested region into bands of rows, each band will be
+  // reduced by a single thread
+  const std::size_t nbRows = outputRequestedRegion.GetSize(1);
+  const std::size_t nbBands = std::max<std::size_t>(1,
+    std::min<std::size_t>(this->GetNumberOfThreads(), nbRows));
 
-  for (unsigned int i = 0; i < maximumRegionsNumber; i++)
+  m_BandRows.resize(nbBands + 1);
+  m_RowToBand.resize(nbRows);
+  for (std::size_t b = 0; b <= nbBands; ++b)
     {
-    //m_ThreadProcessed[i] = 0;
-    typename TOutputDEMImage::Pointer tmpImg = TOutputDEMImage::New();
-    tmpImg->SetNumberOfComponentsPerPixel(1); //Two components for mean calculus ?
-    tmpImg->SetRegions(outputDEM->GetRequestedRegion());
-    tmpImg->Allocate();
-
-    tmpImg->FillBuffer(m_NoDataValue);
-    m_TempDEMRegions.push_back(tmpImg);
-
-    typename AccumulatorImageType::Pointer tmpImg2 = AccumulatorImageType::New();
-    tmpImg2->SetNumberOfComponentsPerPixel(1); //Two components for mean calculus ?
-    tmpImg2->SetRegions(outputDEM->GetRequestedRegion());
-    tmpImg2->Allocate();
-
-    tmpImg2->FillBuffer(0.);
-    m_TempDEMAccumulatorRegions.push_back(tmpImg2);
+    m_BandRows[b] = nbRows * b / nbBands;
     }
+  for (std::size_t b = 0; b < nbBands; ++b)
+    {
+    std::fill(m_RowToBand.begin() + m_BandRows[b], m_RowToBand.begin() + m_BandRows[b + 1],
+              static_cast<unsigned int>(b));
+    }
+
+  m_BinnedCells.clear();
+  m_BinnedCells.resize(m_NumberOfBinningThreads * nbBands);
 
   if (!this->m_IsGeographic)
     {
@@ -562,191 +568,91 @@ void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::ThreadedGener
   const RegionType & itkNotUsed(outputRegionForThread),
   itk::ThreadIdType threadId)
 {
-  TOutputDEMImage * outputPtr = this->GetOutput();
-
-  typename OutputImageType::PointType pointRef;
-  typename OutputImageType::PointType pointRefStep;
-  typename OutputImageType::RegionType requestedRegion = outputPtr->GetRequestedRegion();
-
-//  typename TOutputDEMImage::SpacingType step = outputPtr->GetSignedSpacing();
+  const TOutputDEMImage * outputPtr = this->GetOutput();
 
-  //convert requested region to Long/Lat
+  const RegionType outputRequestedRegion = outputPtr->GetRequestedRegion();
+  const IndexType outputIndex = outputRequestedRegion.GetIndex();
+  const std::size_t width = outputRequestedRegion.GetSize(0);
 
-//  typename TOutputDEMImage::SizeType size = requestedRegion.GetSize();
-
-  typename TOutputDEMImage::IndexType index = requestedRegion.GetIndex();
-  outputPtr->TransformIndexToPhysicalPoint(index, pointRef);
-  /*
-  InputInternalPixelType regionLong1 = pointRef[0];
-  InputInternalPixelType regionLat1 = pointRef[1];
-  InputInternalPixelType regionLong2 = pointRef[0] + size[0] * step[0];
-  InputInternalPixelType regionLat2 = pointRef[1] + size[1] * step[1];
-  InputInternalPixelType minLong = std::min(regionLong1, regionLong2);
-  InputInternalPixelType minLat = std::min(regionLat1, regionLat2);
-  InputInternalPixelType maxLong = std::max(regionLong1, regionLong2);
-  InputInternalPixelType maxLat = std::max(regionLat1, regionLat2);
-  */
-
-  TOutputDEMImage * tmpDEM = nullptr;
-  AccumulatorImageType *tmpAcc = nullptr;
-  typename TOutputDEMImage::RegionType outputRequestedRegion = outputPtr->GetRequestedRegion();
+  // Bins of this thread, one per output band
+  const std::size_t nbBands = m_BandRows.size() - 1;
+  CellValueListType * bins = &m_BinnedCells[threadId * nbBands];
 
   typename T3DImage::RegionType splitRegion;
 
   MapPixelType position;
 
-  itk::ImageRegionConstIterator<InputMapType> mapIt;
   for (unsigned int k = 0; k < this->GetNumberOf3DMaps(); ++k)
     {
-    if (m_NumberOfSplit[k] > 0)
+    if (static_cast<unsigned int> (threadId) >= m_NumberOfSplit[k])
       {
-      T3DImage *imgPtr = const_cast<T3DImage *> (this->Get3DMapInput(k));
-      TMaskImage *mskPtr = const_cast<TMaskImage *> (this->GetMaskInput(k));
+      continue;
+      }
 
-      typename InputMapType::PointType origin;
-      origin = imgPtr->GetOrigin();
-      typename InputMapType::SpacingType spacing;
-      spacing = imgPtr->GetSignedSpacing();
+    const T3DImage *imgPtr = this->Get3DMapInput(k);
+    const TMaskImage *mskPtr = this->GetMaskInput(k);
 
-      if (static_cast<unsigned int> (threadId) < m_NumberOfSplit[k])
-        {
-        splitRegion = m_MapSplitterList->GetNthElement(k)->GetSplit(threadId, m_NumberOfSplit[k],
-                                                                    imgPtr->GetRequestedRegion());
+    splitRegion = m_MapSplitterList->GetNthElement(k)->GetSplit(threadId, m_NumberOfSplit[k],
+                                                                imgPtr->GetRequestedRegion());
 
-        tmpDEM = m_TempDEMRegions[threadId];
-        tmpAcc = m_TempDEMAccumulatorRegions[threadId];
+    itk::ImageRegionConstIterator<InputMapType> mapIt(imgPtr, splitRegion);
+    mapIt.GoToBegin();
+    itk::ImageRegionConstIterator<MaskImageType> maskIt;
+    bool useMask = false;
+    if (mskPtr)
+      {
+      useMask = true;
+      maskIt = itk::ImageRegionConstIterator<MaskImageType>(mskPtr, splitRegion);
+      maskIt.GoToBegin();
+      }
 
-        mapIt = itk::ImageRegionConstIterator<InputMapType>(imgPtr, splitRegion);
-        mapIt.GoToBegin();
-        itk::ImageRegionConstIterator<MaskImageType> maskIt;
-        bool useMask = false;
-        if (mskPtr)
+    for (; !mapIt.IsAtEnd(); ++mapIt)
+      {
+      // check mask value if any
+      if (useMask)
+        {
+        const bool isValid = maskIt.Get() > 0;
+        ++maskIt;
+        if (!isValid)
           {
-          useMask = true;
-          maskIt = itk::ImageRegionConstIterator<MaskImageType>(mskPtr, splitRegion);
-          maskIt.GoToBegin();
+          continue;
           }
+        }
 
-        while (!mapIt.IsAtEnd())
-          {
-          // check mask value if any
-          if (useMask)
-            {
-            if (!(maskIt.Get() > 0))
-              {
-              ++mapIt;
-              ++maskIt;
-              continue;
-              }
-            }
-
-          position = mapIt.Get();
-
-          //std::cout<<"position"<<position<<std::endl;
-          if (!this->m_IsGeographic)
-            {
-            //std::cout<<"is geographic "<<std::endl;
-            typename RSTransform2DType::InputPointType tmpPoint;
-            tmpPoint[0] = position[0];
-            tmpPoint[1] = position[1];
-            RSTransform2DType::OutputPointType groundPosition = m_GroundTransform->TransformPoint(tmpPoint);
-            position[0] = groundPosition[0];
-            position[1] = groundPosition[1];
-            }
-
-          //test if position is in DEM BBOX
-          /**    -Wunused-variable
-          bool isInDEM = (position[0] >= minLong) && (position[0] < maxLong) && (position[1] >= minLat) && (position[1]
-                      < maxLat);
-          **/
-          // Is point inside DEM area ?
-          typename OutputImageType::PointType point2D;
-          point2D[0] = position[0];
-          point2D[1] = position[1];
-          itk::ContinuousIndex<double, 2> continuousIndex;
-
-          //std::cout<<"point2D "<<point2D<<std::endl;
-          // The DEM cell at index 'n' contains continuous indexes from 'n-0.5' to 'n+0.5'
-          outputPtr->TransformPhysicalPointToContinuousIndex(point2D, continuousIndex);
-          typename OutputImageType::IndexType cellIndex;
-          cellIndex[0] = static_cast<int> (std::floor(continuousIndex[0] + 0.5));
-          cellIndex[1] = static_cast<int> (std::floor(continuousIndex[1] + 0.5));
-          //std::cout<<"cellindex "<<cellIndex<<std::endl;
-          //index from physical
-          /** -Wunused-variable
-            typename OutputImageType::IndexType physCellIndex;
-
-          //double CellIndexLong=(position[0]-outOrigin[0])/step[0];
-          //double CellIndexLat=(position[1]-outOrigin[1])/step[1];
-          typename OutputImageType::IndexType cellIndex2;
-          **/
-          if (outputRequestedRegion.IsInside(cellIndex))
-            {
-            //std::cout<<"is inside "<<std::endl;
-            // Add point to its corresponding cell (keep maximum)
-            DEMPixelType cellHeight = static_cast<DEMPixelType> (position[2]);
-            //if (cellHeight > tmpDEM->GetPixel(cellIndex) && cellHeight < static_cast<DEMPixelType>(m_ElevationMax))
-            //  {
-            // tmpDEM->SetPixel(cellIndex,tmpDEM->GetPixel(cellIndex)+1);
-
-            AccumulatorPixelType accPixel = tmpAcc->GetPixel(cellIndex);
-            tmpAcc->SetPixel(cellIndex, tmpAcc->GetPixel(cellIndex) + 1);
-
-            if (accPixel == 0)
-              {
-              tmpDEM->SetPixel(cellIndex, cellHeight);
-              }
-            else
-              {
-              DEMPixelType cellCurrentValue = tmpDEM->GetPixel(cellIndex);
-
-              switch (this->m_CellFusionMode)
-                {
-                case otb::CellFusionMode::MIN:
-                  {
-                  if (cellHeight < cellCurrentValue)
-                    {
-                    tmpDEM->SetPixel(cellIndex, cellHeight);
-                    }
-                  }
-                  break;
-                case otb::CellFusionMode::MAX:
-                  {
-                  if (cellHeight > cellCurrentValue)
-                    {
-                    tmpDEM->SetPixel(cellIndex, cellHeight);
-                    }
-                  }
-                  break;
-                case otb::CellFusionMode::MEAN:
-                  {
-                  tmpDEM->SetPixel(cellIndex, cellCurrentValue + cellHeight);
-                  }
-                  break;
-                case otb::CellFusionMode::ACC:
-                  {
-                  }
-                  break;
-                default:
-
-                  itkExceptionMacro(<< "Unexpected value cell fusion mode :"<<this->m_CellFusionMode)
-;
-                  break;
-                }
-              }
+      position = mapIt.Get();
 
-            }
+      if (!this->m_IsGeographic)
+        {
+        typename RSTransform2DType::InputPointType tmpPoint;
+        tmpPoint[0] = position[0];
+        tmpPoint[1] = position[1];
+        RSTransform2DType::OutputPointType groundPosition = m_GroundTransform->TransformPoint(tmpPoint);
+        position[0] = groundPosition[0];
+        position[1] = groundPosition[1];
+        }
 
-          ++mapIt;
+      // Is point inside DEM area ?
+      typename OutputImageType::PointType point2D;
+      point2D[0] = position[0];
+      point2D[1] = position[1];
+      itk::ContinuousIndex<double, 2> continuousIndex;
 
-          if (useMask) ++maskIt;
+      // The DEM cell at index 'n' contains continuous indexes from 'n-0.5' to 'n+0.5'
+      outputPtr->TransformPhysicalPointToContinuousIndex(point2D, continuousIndex);
+      typename OutputImageType::IndexType cellIndex;
+      cellIndex[0] = static_cast<int> (std::floor(continuousIndex[0] + 0.5));
+      cellIndex[1] = static_cast<int> (std::floor(continuousIndex[1] + 0.5));
 
-          }
-        }
-      else
+      if (outputRequestedRegion.IsInside(cellIndex))
         {
-        splitRegion = requestedRegion;
-        otbMsgDevMacro( "map " << k << " will not be split " );
+        // Bin the point in the band of its cell
+        const std::size_t row = static_cast<std::size_t>(cellIndex[1] - outputIndex[1]);
+        const unsigned int band = m_RowToBand[row];
+
+        CellValueType cell;
+        cell.Offset = (row - m_BandRows[band]) * width + static_cast<std::size_t>(cellIndex[0] - outputIndex[0]);
+        cell.Height = static_cast<DEMPixelType> (position[2]);
+        bins[band].push_back(cell);
         }
       }
     }
@@ -755,150 +661,142 @@ void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::ThreadedGener
 template<class T3DImage, class TMaskImage, class TOutputDEMImage>
 void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::AfterThreadedGenerateData()
 {
+  // Bands are disjoint, so they can be reduced in parallel
+  ParallelFor(m_BandRows.size() - 1, this->GetNumberOfThreads(),
+    [this](std::size_t begin, std::size_t end, itk::ThreadIdType)
+    {
+    for (std::size_t band = begin; band < end; ++band)
+      {
+      this->ReduceBand(static_cast<unsigned int>(band));
+      }
+    });
 
-  TOutputDEMImage * outputDEM = this->GetOutput();
+  m_BinnedCells.clear();
+}
 
-  //check is that case can occur
-  if (m_TempDEMRegions.size() < 1)
-    {
-    outputDEM->FillBuffer(m_NoDataValue);
-    return;
-    }
+template<class T3DImage, class TMaskImage, class TOutputDEMImage>
+void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::ReduceBand(unsigned int band)
+{
+  TOutputDEMImage * outputPtr = this->GetOutput();
 
-  itk::ImageRegionIterator<OutputImageType> outputDEMIt(outputDEM, outputDEM->GetRequestedRegion());
-  itk::ImageRegionIterator<OutputImageType> firstDEMIt(m_TempDEMRegions[0], outputDEM->GetRequestedRegion());
-  itk::ImageRegionIterator<AccumulatorImageType> firstDEMAccIt(m_TempDEMAccumulatorRegions[0],
-                                                               outputDEM->GetRequestedRegion());
-  //we use the first accumulator as global accumulator over tmpAcc for mean calculus
+  const std::size_t nbBands = m_BandRows.size() - 1;
 
-  outputDEMIt.GoToBegin();
-  firstDEMIt.GoToBegin();
-  firstDEMAccIt.GoToBegin();
-  // Copy first DEM
+  RegionType bandRegion = outputPtr->GetRequestedRegion();
+  bandRegion.SetIndex(1, bandRegion.GetIndex(1) + static_cast<typename IndexType::IndexValueType>(m_BandRows[band]));
+  bandRegion.SetSize(1, m_BandRows[band + 1] - m_BandRows[band]);
+  const std::size_t nbCells = bandRegion.GetNumberOfPixels();
 
-  while (!outputDEMIt.IsAtEnd() && !firstDEMIt.IsAtEnd() && !firstDEMAccIt.IsAtEnd())
-    {
+  std::vector<AccumulatorPixelType> count(nbCells, 0);
+  std::vector<PrecisionType> value(nbCells, 0.);
 
-    AccumulatorPixelType accPixel = firstDEMAccIt.Get();
-    //useless test tempDEm is initialized with NoDataValue
-    if (accPixel == 0)
+  if (this->m_CellFusionMode == otb::CellFusionMode::MEDIAN)
+    {
+    // Sort the heights by cell (counting sort on the cell offsets)
+    for (unsigned int t = 0; t < m_NumberOfBinningThreads; ++t)
       {
-      outputDEMIt.Set(m_NoDataValue);
+      for (const CellValueType & cell : m_BinnedCells[t * nbBands + band])
+        {
+        ++count[cell.Offset];
+        }
       }
-    else
-      {
 
-      DEMPixelType pixelValue = firstDEMIt.Get();
+    std::vector<std::size_t> first(nbCells + 1, 0);
+    for (std::size_t c = 0; c < nbCells; ++c)
+      {
+      first[c + 1] = first[c] + count[c];
+      }
 
-      outputDEMIt.Set(pixelValue);
+    std::vector<DEMPixelType> heights(first[nbCells]);
+    std::vector<std::size_t> next(first.begin(), first.end() - 1);
+    for (unsigned int t = 0; t < m_NumberOfBinningThreads; ++t)
+      {
+      CellValueListType & bin = m_BinnedCells[t * nbBands + band];
+      for (const CellValueType & cell : bin)
+        {
+        heights[next[cell.Offset]++] = cell.Height;
+        }
+      CellValueListType().swap(bin);
+      }
 
-      if ((this->m_CellFusionMode == otb::CellFusionMode::MEAN) && (m_TempDEMRegions.size() == 1))
+    for (std::size_t c = 0; c < nbCells; ++c)
+      {
+      if (count[c] == 0)
         {
-        outputDEMIt.Set(firstDEMIt.Get() / static_cast<DEMPixelType> (accPixel));
+        continue;
         }
-      if (this->m_CellFusionMode == otb::CellFusionMode::ACC)
+      typename std::vector<DEMPixelType>::iterator cellBegin = heights.begin() + first[c];
+      typename std::vector<DEMPixelType>::iterator cellEnd = heights.begin() + first[c + 1];
+      typename std::vector<DEMPixelType>::iterator middle = cellBegin + count[c] / 2;
+      std::nth_element(cellBegin, middle, cellEnd);
+      value[c] = static_cast<PrecisionType>(*middle);
+      if (count[c] % 2 == 0)
         {
-        outputDEMIt.Set(static_cast<DEMPixelType> (accPixel));
+        // lower central value is the largest one before the middle
+        value[c] = 0.5 * (value[c] + static_cast<PrecisionType>(*std::max_element(cellBegin, middle)));
         }
       }
-    ++outputDEMIt;
-    ++firstDEMIt;
-    ++firstDEMAccIt;
     }
-
-  // Check DEMs from other threads and keep the maximum elevation
-  for (unsigned int i = 1; i < m_TempDEMRegions.size(); i++)
+  else
     {
-
-    itk::ImageRegionIterator<OutputImageType> tmpDEMIt(m_TempDEMRegions[i], outputDEM->GetRequestedRegion());
-    itk::ImageRegionIterator<AccumulatorImageType> tmpDEMAccIt(m_TempDEMAccumulatorRegions[i],
-                                                               outputDEM->GetRequestedRegion());
-
-    outputDEMIt.GoToBegin();
-    tmpDEMIt.GoToBegin();
-    tmpDEMAccIt.GoToBegin();
-    firstDEMAccIt.GoToBegin(); //Global Accumulator
-    while (!outputDEMIt.IsAtEnd() && !tmpDEMIt.IsAtEnd() && !tmpDEMAccIt.IsAtEnd() && !firstDEMAccIt.IsAtEnd())
+    for (unsigned int t = 0; t < m_NumberOfBinningThreads; ++t)
       {
-
-      // get the accumulator value
-      AccumulatorPixelType accPixel = tmpDEMAccIt.Get();
-      if (accPixel != 0)
+      CellValueListType & bin = m_BinnedCells[t * nbBands + band];
+      for (const CellValueType & cell : bin)
         {
+        AccumulatorPixelType & accPixel = count[cell.Offset];
+        PrecisionType & cellValue = value[cell.Offset];
+        const PrecisionType cellHeight = static_cast<PrecisionType>(cell.Height);
 
-        DEMPixelType cellCurrentValue = outputDEMIt.Get();
-        DEMPixelType cellHeight = tmpDEMIt.Get();
-        switch (this->m_CellFusionMode)
+        if (accPixel == 0)
           {
-          case otb::CellFusionMode::MIN:
-            {
-            if ((cellHeight < cellCurrentValue) || (cellCurrentValue == m_NoDataValue))
-              {
-              outputDEMIt.Set(cellHeight);
-              }
-            }
-            break;
-          case otb::CellFusionMode::MAX:
-            {
-            if ((cellHeight > cellCurrentValue) || ((cellCurrentValue == m_NoDataValue)))
-              {
-              outputDEMIt.Set(cellHeight);
-              }
-            }
-            break;
-          case otb::CellFusionMode::MEAN:
-            {
-
-            outputDEMIt.Set(
-                            cellCurrentValue * static_cast<DEMPixelType> (cellCurrentValue != m_NoDataValue)
-                                + cellHeight);
-            firstDEMAccIt.Set(firstDEMAccIt.Get() + accPixel);
-
-            }
-            break;
-          case otb::CellFusionMode::ACC:
-            {
-            firstDEMAccIt.Set(firstDEMAccIt.Get() + accPixel);
-            }
-            break;
-
-          default:
-            itkExceptionMacro(<< "Unexpected value cell fusion mode :"<<this->m_CellFusionMode);
-            break;
+          cellValue = cellHeight;
           }
-        }
-
-      if (i == (m_TempDEMRegions.size() - 1))
-        {
-        if (this->m_CellFusionMode == otb::CellFusionMode::MEAN)
+        else
           {
-          if (static_cast<DEMPixelType> (firstDEMAccIt.Get()) != 0)
-            {
-            outputDEMIt.Set(outputDEMIt.Get() / static_cast<DEMPixelType> (firstDEMAccIt.Get()));
-            }
-          else
+          switch (this->m_CellFusionMode)
             {
-            outputDEMIt.Set(m_NoDataValue);
+            case otb::CellFusionMode::MIN:
+              cellValue = std::min(cellValue, cellHeight);
+              break;
+            case otb::CellFusionMode::MAX:
+              cellValue = std::max(cellValue, cellHeight);
+              break;
+            case otb::CellFusionMode::MEAN:
+              cellValue += cellHeight;
+              break;
+            default:
+              break;
             }
           }
-        else
-          if (this->m_CellFusionMode == otb::CellFusionMode::ACC)
-            {
-            outputDEMIt.Set(static_cast<DEMPixelType> (firstDEMAccIt.Get()));
-            }
-
+        ++accPixel;
         }
-      ++outputDEMIt;
-      ++tmpDEMIt;
-      ++tmpDEMAccIt;
-      ++firstDEMAccIt;
+      CellValueListType().swap(bin);
       }
-
     }
 
+  itk::ImageRegionIterator<OutputImageType> outputDEMIt(outputPtr, bandRegion);
+  std::size_t c = 0;
+  for (outputDEMIt.GoToBegin(); !outputDEMIt.IsAtEnd(); ++outputDEMIt, ++c)
+    {
+    if (count[c] == 0)
+      {
+      outputDEMIt.Set(m_NoDataValue);
+      }
+    else if (this->m_CellFusionMode == otb::CellFusionMode::MEAN)
+      {
+      outputDEMIt.Set(static_cast<DEMPixelType>(value[c] / static_cast<PrecisionType>(count[c])));
+      }
+    else if (this->m_CellFusionMode == otb::CellFusionMode::ACC)
+      {
+      outputDEMIt.Set(static_cast<DEMPixelType>(count[c]));
+      }
+    else
+      {
+      outputDEMIt.Set(static_cast<DEMPixelType>(value[c]));
+      }
+    }
 }
 
 }
 
-
 #endif
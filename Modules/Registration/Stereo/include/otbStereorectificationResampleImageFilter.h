@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStereorectificationResampleImageFilter_h
+#define otbStereorectificationResampleImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkInterpolateImageFunction.h"
+
+namespace otb
+{
+
+/** \class StereorectificationResampleImageFilter
+ *  \brief Resample both images of a stereo pair in epipolar geometry in a single pass
+ *
+ *  This filter takes the left and right sensor images along with the coarse
+ *  deformation grids computed by StereorectificationDisplacementFieldSource,
+ *  and produces the left (output 0) and right (output 1) epipolar images.
+ *  It replaces a pair of StreamingWarpImageFilter in stereo pipelines:
+ *
+ *  - Both epipolar tiles are produced by the same execution. The requested
+ *  region is enlarged by OutputMargin and copied to both outputs, so that
+ *  the downstream consumers of the two images (block-matching windows,
+ *  disparity range, masks, local variance) are all served by a single
+ *  resampling of the tile, instead of one resampling per consumer and per
+ *  image.
+ *  - The coarse grids are interpolated incrementally: grid rows are
+ *  interpolated once per output line, and displacements are then linearly
+ *  interpolated along the line, instead of locating each output pixel in
+ *  the grid.
+ *
+ *  The displacement grids are expressed in the epipolar geometry defined by
+ *  OutputOrigin, OutputSpacing and OutputSize. Like in StreamingWarpImageFilter,
+ *  pixels outside the grids or mapped outside the input buffers are set to
+ *  EdgePaddingValue. Memory usage is bounded by the size of the requested tile
+ *  plus the margin. Only scalar images are supported.
+ *
+ *  \sa StereorectificationDisplacementFieldSource
+ *  \sa StreamingWarpImageFilter
+ *
+ *  \ingroup Streamed
+ *  \ingroup Threaded
+ *
+ * \ingroup OTBStereo
+ */
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+class ITK_EXPORT StereorectificationResampleImageFilter :
+    public itk::ImageToImageFilter<TInputImage,TOutputImage>
+{
+public:
+  /** Standard class typedef */
+  typedef StereorectificationResampleImageFilter            Self;
+  typedef itk::ImageToImageFilter<TInputImage,
+                                  TOutputImage>             Superclass;
+  typedef itk::SmartPointer<Self>                           Pointer;
+  typedef itk::SmartPointer<const Self>                     ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(StereorectificationResampleImageFilter, ImageToImageFilter);
+
+  /** Useful typedefs */
+  typedef TInputImage                                       InputImageType;
+  typedef TOutputImage                                      OutputImageType;
+  typedef TDisplacementField                                DisplacementFieldType;
+
+  typedef typename OutputImageType::PixelType               OutputPixelType;
+  typedef typename OutputImageType::RegionType              RegionType;
+  typedef typename OutputImageType::SizeType                SizeType;
+  typedef typename OutputImageType::IndexType               IndexType;
+  typedef typename OutputImageType::SpacingType             SpacingType;
+  typedef typename OutputImageType::PointType               PointType;
+
+  typedef typename DisplacementFieldType::PixelType         DisplacementType;
+
+  typedef itk::InterpolateImageFunction<InputImageType, double> InterpolatorType;
+  typedef typename InterpolatorType::Pointer                InterpolatorPointerType;
+
+  /** Set the left sensor image */
+  void SetLeftInput( const TInputImage * image );
+
+  /** Set the right sensor image */
+  void SetRightInput( const TInputImage * image );
+
+  /** Set the deformation grid from left epipolar to left sensor geometry */
+  void SetLeftDisplacementField( const TDisplacementField * field );
+
+  /** Set the deformation grid from right epipolar to right sensor geometry */
+  void SetRightDisplacementField( const TDisplacementField * field );
+
+  /** Get the inputs */
+  const TInputImage * GetLeftInput() const;
+  const TInputImage * GetRightInput() const;
+  const TDisplacementField * GetLeftDisplacementField() const;
+  const TDisplacementField * GetRightDisplacementField() const;
+
+  /** Get the left epipolar image */
+  TOutputImage * GetLeftOutput();
+
+  /** Get the right epipolar image */
+  TOutputImage * GetRightOutput();
+
+  /** Set/Get the epipolar geometry */
+  itkSetMacro(OutputSize, SizeType);
+  itkGetConstReferenceMacro(OutputSize, SizeType);
+
+  itkSetMacro(OutputSpacing, SpacingType);
+  itkGetConstReferenceMacro(OutputSpacing, SpacingType);
+
+  itkSetMacro(OutputOrigin, PointType);
+  itkGetConstReferenceMacro(OutputOrigin, PointType);
+
+  /** Set/Get the value of pixels outside the grids or the input images */
+  itkSetMacro(EdgePaddingValue, OutputPixelType);
+  itkGetConstReferenceMacro(EdgePaddingValue, OutputPixelType);
+
+  /** Set/Get the margin added to the requested region of the outputs. It
+   *  should cover the needs of the downstream filters around a tile (for a
+   *  block-matching: the window radius plus the disparity range). */
+  itkSetMacro(OutputMargin, SizeType);
+  itkGetConstReferenceMacro(OutputMargin, SizeType);
+
+  /** Set/Get the interpolators. The two images need distinct interpolators,
+   *  defaults are linear. */
+  itkSetObjectMacro(LeftInterpolator, InterpolatorType);
+  itkGetObjectMacro(LeftInterpolator, InterpolatorType);
+
+  itkSetObjectMacro(RightInterpolator, InterpolatorType);
+  itkGetObjectMacro(RightInterpolator, InterpolatorType);
+
+protected:
+  /** Constructor */
+  StereorectificationResampleImageFilter();
+
+  /** Destructor */
+  ~StereorectificationResampleImageFilter() override{};
+
+  /** Generate output information */
+  void GenerateOutputInformation() override;
+
+  /** Pad the requested region by the margin, it is then copied to both outputs */
+  void EnlargeOutputRequestedRegion(itk::DataObject * output) override;
+
+  /** Generate input requested region */
+  void GenerateInputRequestedRegion() override;
+
+  /** Set the interpolators inputs */
+  void BeforeThreadedGenerateData() override;
+
+  /** Threaded generate data */
+  void ThreadedGenerateData(const RegionType & outputRegionForThread, itk::ThreadIdType threadId) override;
+
+  /** Override VerifyInputInformation() since this filter's inputs do
+    * not need to occupy the same physical space.
+    *
+    * \sa ProcessObject::VerifyInputInformation
+    */
+  void VerifyInputInformation() override {}
+
+  /** PrintSelf method */
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+private:
+  StereorectificationResampleImageFilter(const Self&) = delete;
+  void operator=(const Self&) = delete;
+
+  /** Compute the region of a sensor image needed to resample an epipolar region */
+  typename InputImageType::RegionType ComputeInputRequestedRegion(const InputImageType * input,
+                                                                  const DisplacementFieldType * field,
+                                                                  const InterpolatorType * interpolator,
+                                                                  const RegionType & outputRegion) const;
+
+  /** Resample one epipolar image over a region */
+  void ResampleRegion(const DisplacementFieldType * field, const InterpolatorType * interpolator,
+                      OutputImageType * output, const RegionType & region) const;
+
+  /** Epipolar geometry */
+  SizeType    m_OutputSize;
+  SpacingType m_OutputSpacing;
+  PointType   m_OutputOrigin;
+
+  /** Padding value */
+  OutputPixelType m_EdgePaddingValue;
+
+  /** Margin around requested regions */
+  SizeType m_OutputMargin;
+
+  /** Interpolators */
+  InterpolatorPointerType m_LeftInterpolator;
+  InterpolatorPointerType m_RightInterpolator;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStereorectificationResampleImageFilter.hxx"
+#endif
+
+#endif
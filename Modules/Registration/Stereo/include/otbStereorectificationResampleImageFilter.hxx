@@ -0,0 +1,505 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStereorectificationResampleImageFilter_hxx
+#define otbStereorectificationResampleImageFilter_hxx
+
+#include "otbStereorectificationResampleImageFilter.h"
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkProgressReporter.h"
+#include "itkMetaDataObject.h"
+#include "otbMetaDataKey.h"
+#include "otbStreamingTraits.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace otb
+{
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::StereorectificationResampleImageFilter()
+{
+  // Left and right images, left and right grids
+  this->SetNumberOfRequiredInputs(4);
+
+  // Left and right epipolar images
+  this->SetNumberOfRequiredOutputs(2);
+  this->SetNthOutput(0,TOutputImage::New());
+  this->SetNthOutput(1,TOutputImage::New());
+
+  m_OutputSize.Fill(0);
+  m_OutputSpacing.Fill(1.);
+  m_OutputOrigin.Fill(0.);
+  m_OutputMargin.Fill(0);
+  m_EdgePaddingValue = itk::NumericTraits<OutputPixelType>::ZeroValue();
+
+  m_LeftInterpolator = itk::LinearInterpolateImageFunction<TInputImage, double>::New();
+  m_RightInterpolator = itk::LinearInterpolateImageFunction<TInputImage, double>::New();
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::SetLeftInput( const TInputImage * image )
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(0, const_cast<TInputImage *>( image ));
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::SetRightInput( const TInputImage * image )
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(1, const_cast<TInputImage *>( image ));
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::SetLeftDisplacementField( const TDisplacementField * field )
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(2, const_cast<TDisplacementField *>( field ));
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::SetRightDisplacementField( const TDisplacementField * field )
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(3, const_cast<TDisplacementField *>( field ));
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+const TInputImage *
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::GetLeftInput() const
+{
+  if (this->GetNumberOfInputs()<1)
+    {
+    return nullptr;
+    }
+  return static_cast<const TInputImage *>(this->itk::ProcessObject::GetInput(0));
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+const TInputImage *
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::GetRightInput() const
+{
+  if (this->GetNumberOfInputs()<2)
+    {
+    return nullptr;
+    }
+  return static_cast<const TInputImage *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+const TDisplacementField *
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::GetLeftDisplacementField() const
+{
+  if (this->GetNumberOfInputs()<3)
+    {
+    return nullptr;
+    }
+  return static_cast<const TDisplacementField *>(this->itk::ProcessObject::GetInput(2));
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+const TDisplacementField *
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::GetRightDisplacementField() const
+{
+  if (this->GetNumberOfInputs()<4)
+    {
+    return nullptr;
+    }
+  return static_cast<const TDisplacementField *>(this->itk::ProcessObject::GetInput(3));
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+TOutputImage *
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::GetLeftOutput()
+{
+  return static_cast<TOutputImage *>(this->itk::ProcessObject::GetOutput(0));
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+TOutputImage *
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::GetRightOutput()
+{
+  return static_cast<TOutputImage *>(this->itk::ProcessObject::GetOutput(1));
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::GenerateOutputInformation()
+{
+  this->Superclass::GenerateOutputInformation();
+
+  if (!this->GetLeftDisplacementField() || !this->GetRightDisplacementField())
+    {
+    itkExceptionMacro(<<"Left and right displacement fields are required");
+    }
+
+  RegionType largest;
+  largest.SetSize(m_OutputSize);
+
+  for (unsigned int i = 0; i < 2; ++i)
+    {
+    TOutputImage * outputPtr = static_cast<TOutputImage *>(this->itk::ProcessObject::GetOutput(i));
+    outputPtr->SetLargestPossibleRegion(largest);
+    outputPtr->SetSignedSpacing(m_OutputSpacing);
+    outputPtr->SetOrigin(m_OutputOrigin);
+
+    // Set the NoData flag to the edge padding value
+    itk::MetaDataDictionary& dict = outputPtr->GetMetaDataDictionary();
+    std::vector<bool> noDataValueAvailable(1, true);
+    std::vector<double> noDataValue(1, static_cast<double>(m_EdgePaddingValue));
+    itk::EncapsulateMetaData<std::vector<bool> >(dict,MetaDataKey::NoDataValueAvailable,noDataValueAvailable);
+    itk::EncapsulateMetaData<std::vector<double> >(dict,MetaDataKey::NoDataValue,noDataValue);
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::EnlargeOutputRequestedRegion(itk::DataObject * output)
+{
+  TOutputImage * outputPtr = dynamic_cast<TOutputImage *>(output);
+  if (!outputPtr)
+    {
+    return;
+    }
+
+  // The enlarged region is then copied to the other output by
+  // GenerateOutputRequestedRegion()
+  RegionType requested = outputPtr->GetRequestedRegion();
+  requested.PadByRadius(m_OutputMargin);
+  if (requested.Crop(outputPtr->GetLargestPossibleRegion()))
+    {
+    outputPtr->SetRequestedRegion(requested);
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::GenerateInputRequestedRegion()
+{
+  this->Superclass::GenerateInputRequestedRegion();
+
+  TInputImage * leftPtr  = const_cast<TInputImage *>(this->GetLeftInput());
+  TInputImage * rightPtr = const_cast<TInputImage *>(this->GetRightInput());
+  TDisplacementField * leftFieldPtr  = const_cast<TDisplacementField *>(this->GetLeftDisplacementField());
+  TDisplacementField * rightFieldPtr = const_cast<TDisplacementField *>(this->GetRightDisplacementField());
+
+  // The grids are coarse, they are requested entirely. They must be
+  // available here since the requested regions of the images depend on the
+  // displacement values.
+  leftFieldPtr->SetRequestedRegionToLargestPossibleRegion();
+  leftFieldPtr->PropagateRequestedRegion();
+  leftFieldPtr->UpdateOutputData();
+  rightFieldPtr->SetRequestedRegionToLargestPossibleRegion();
+  rightFieldPtr->PropagateRequestedRegion();
+  rightFieldPtr->UpdateOutputData();
+
+  const RegionType outputRegion = this->GetLeftOutput()->GetRequestedRegion();
+
+  leftPtr->SetRequestedRegion(
+    this->ComputeInputRequestedRegion(leftPtr, leftFieldPtr, m_LeftInterpolator, outputRegion));
+  rightPtr->SetRequestedRegion(
+    this->ComputeInputRequestedRegion(rightPtr, rightFieldPtr, m_RightInterpolator, outputRegion));
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+typename TInputImage::RegionType
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::ComputeInputRequestedRegion(const InputImageType * input,
+                              const DisplacementFieldType * field,
+                              const InterpolatorType * interpolator,
+                              const RegionType & outputRegion) const
+{
+  typedef typename InputImageType::RegionType InputRegionType;
+  typedef typename DisplacementFieldType::RegionType FieldRegionType;
+
+  InputRegionType inputRegion;
+  if (outputRegion.GetNumberOfPixels() == 0)
+    {
+    return inputRegion;
+    }
+
+  // Grid nodes covering the output region
+  const TOutputImage * outputPtr = static_cast<const TOutputImage *>(this->itk::ProcessObject::GetOutput(0));
+  IndexType outIndexEnd = outputRegion.GetIndex();
+  outIndexEnd[0] += outputRegion.GetSize(0) - 1;
+  outIndexEnd[1] += outputRegion.GetSize(1) - 1;
+  PointType outPointStart, outPointEnd;
+  outputPtr->TransformIndexToPhysicalPoint(outputRegion.GetIndex(), outPointStart);
+  outputPtr->TransformIndexToPhysicalPoint(outIndexEnd, outPointEnd);
+
+  typename DisplacementFieldType::IndexType fieldIndexStart, fieldIndexEnd;
+  field->TransformPhysicalPointToIndex(outPointStart, fieldIndexStart);
+  field->TransformPhysicalPointToIndex(outPointEnd, fieldIndexEnd);
+
+  FieldRegionType fieldRegion;
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    fieldRegion.SetIndex(dim, std::min(fieldIndexStart[dim], fieldIndexEnd[dim]));
+    fieldRegion.SetSize(dim, std::max(fieldIndexStart[dim], fieldIndexEnd[dim]) - fieldRegion.GetIndex(dim) + 1);
+    }
+  // Nodes around the region are used by the interpolation
+  fieldRegion.PadByRadius(1);
+  if (!fieldRegion.Crop(field->GetLargestPossibleRegion()))
+    {
+    // The tile is outside the grid: it will be filled with padding value
+    return inputRegion;
+    }
+
+  // Bounding box of the displaced nodes
+  PointType inputStartPoint, inputEndPoint;
+  bool first = true;
+  itk::ImageRegionConstIteratorWithIndex<DisplacementFieldType> fieldIt(field, fieldRegion);
+  for (fieldIt.GoToBegin(); !fieldIt.IsAtEnd(); ++fieldIt)
+    {
+    PointType point;
+    field->TransformIndexToPhysicalPoint(fieldIt.GetIndex(), point);
+    const DisplacementType displacement = fieldIt.Get();
+    for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+      point[dim] += displacement[dim];
+      if (first || point[dim] < inputStartPoint[dim])
+        {
+        inputStartPoint[dim] = point[dim];
+        }
+      if (first || point[dim] > inputEndPoint[dim])
+        {
+        inputEndPoint[dim] = point[dim];
+        }
+      }
+    first = false;
+    }
+
+  typename InputImageType::IndexType inputStartIndex, inputEndIndex;
+  input->TransformPhysicalPointToIndex(inputStartPoint, inputStartIndex);
+  input->TransformPhysicalPointToIndex(inputEndPoint, inputEndIndex);
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    inputRegion.SetIndex(dim, std::min(inputStartIndex[dim], inputEndIndex[dim]));
+    inputRegion.SetSize(dim, std::max(inputStartIndex[dim], inputEndIndex[dim]) - inputRegion.GetIndex(dim) + 1);
+    }
+
+  // Pad by the interpolator radius (and one pixel for rounding)
+  inputRegion.PadByRadius(
+    StreamingTraits<InputImageType>::CalculateNeededRadiusForInterpolator(interpolator) + 1);
+
+  if (!inputRegion.Crop(input->GetLargestPossibleRegion()))
+    {
+    // Empty region: the tile maps outside the image
+    InputRegionType emptyRegion;
+    return emptyRegion;
+    }
+  return inputRegion;
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::BeforeThreadedGenerateData()
+{
+  if (!m_LeftInterpolator || !m_RightInterpolator)
+    {
+    itkExceptionMacro(<<"Left and right interpolators are required");
+    }
+  if (m_LeftInterpolator == m_RightInterpolator)
+    {
+    itkExceptionMacro(<<"Left and right images need distinct interpolators");
+    }
+  m_LeftInterpolator->SetInputImage(this->GetLeftInput());
+  m_RightInterpolator->SetInputImage(this->GetRightInput());
+
+  // Grid lines are interpolated once per epipolar line, which requires the
+  // grids to be aligned with the epipolar geometry
+  IndexType index;
+  index.Fill(0);
+  IndexType nextIndex = index;
+  ++nextIndex[0];
+  PointType point, nextPoint;
+  this->GetLeftOutput()->TransformIndexToPhysicalPoint(index, point);
+  this->GetLeftOutput()->TransformIndexToPhysicalPoint(nextIndex, nextPoint);
+  const DisplacementFieldType * fields[2] = {this->GetLeftDisplacementField(), this->GetRightDisplacementField()};
+  for (unsigned int i = 0; i < 2; ++i)
+    {
+    itk::ContinuousIndex<double, 2> gridIndex, nextGridIndex;
+    fields[i]->TransformPhysicalPointToContinuousIndex(point, gridIndex);
+    fields[i]->TransformPhysicalPointToContinuousIndex(nextPoint, nextGridIndex);
+    if (std::abs(nextGridIndex[1] - gridIndex[1]) > 1e-6)
+      {
+      itkExceptionMacro(<<"Displacement field rows must be aligned with the epipolar lines");
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::ThreadedGenerateData(const RegionType & outputRegionForThread, itk::ThreadIdType threadId)
+{
+  // Progress is reported by lines of the two images
+  itk::ProgressReporter progress(this, threadId, 2 * outputRegionForThread.GetSize(1));
+
+  RegionType lineRegion = outputRegionForThread;
+  lineRegion.SetSize(1, 1);
+  for (unsigned int line = 0; line < outputRegionForThread.GetSize(1); ++line)
+    {
+    lineRegion.SetIndex(1, outputRegionForThread.GetIndex(1) + line);
+    this->ResampleRegion(this->GetLeftDisplacementField(), m_LeftInterpolator, this->GetLeftOutput(), lineRegion);
+    progress.CompletedPixel();
+    this->ResampleRegion(this->GetRightDisplacementField(), m_RightInterpolator, this->GetRightOutput(), lineRegion);
+    progress.CompletedPixel();
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::ResampleRegion(const DisplacementFieldType * field, const InterpolatorType * interpolator,
+                 OutputImageType * output, const RegionType & region) const
+{
+  typedef typename DisplacementFieldType::IndexType FieldIndexType;
+  typedef itk::ContinuousIndex<double, 2> ContinuousIndexType;
+
+  const typename DisplacementFieldType::RegionType & fieldRegion = field->GetLargestPossibleRegion();
+  const long fieldStartX = fieldRegion.GetIndex(0);
+  const long fieldStartY = fieldRegion.GetIndex(1);
+  const long fieldSizeX = fieldRegion.GetSize(0);
+  const long fieldSizeY = fieldRegion.GetSize(1);
+  const unsigned int width = region.GetSize(0);
+
+  // Displacements of the nodes of the current grid line
+  std::vector<double> lineDisplacements(2 * fieldSizeX);
+
+  for (unsigned int y = 0; y < region.GetSize(1); ++y)
+    {
+    IndexType index = region.GetIndex();
+    index[1] += y;
+
+    // Physical position and grid position of the first pixel, and their
+    // increments along the line
+    PointType startPoint, nextPoint;
+    output->TransformIndexToPhysicalPoint(index, startPoint);
+    IndexType nextIndex = index;
+    ++nextIndex[0];
+    output->TransformIndexToPhysicalPoint(nextIndex, nextPoint);
+
+    ContinuousIndexType startGrid, nextGrid;
+    field->TransformPhysicalPointToContinuousIndex(startPoint, startGrid);
+    field->TransformPhysicalPointToContinuousIndex(nextPoint, nextGrid);
+
+    OutputPixelType * outLine = output->GetBufferPointer() + output->ComputeOffset(index);
+
+    // Lines outside the grid are padded. The grid line is constant along
+    // the epipolar line (checked in BeforeThreadedGenerateData()).
+    const double gridY = startGrid[1];
+    if (gridY < fieldStartY || gridY > fieldStartY + fieldSizeY - 1)
+      {
+      std::fill(outLine, outLine + width, m_EdgePaddingValue);
+      continue;
+      }
+
+    // Interpolate the grid line once
+    const long row0 = std::min(static_cast<long>(std::floor(gridY)), fieldStartY + std::max(fieldSizeY - 2, 0L));
+    const long row1 = std::min(row0 + 1, fieldStartY + fieldSizeY - 1);
+    const double wy = gridY - row0;
+    FieldIndexType node0, node1;
+    node0[1] = row0;
+    node1[1] = row1;
+    for (long i = 0; i < fieldSizeX; ++i)
+      {
+      node0[0] = node1[0] = fieldStartX + i;
+      const DisplacementType & d0 = field->GetPixel(node0);
+      const DisplacementType & d1 = field->GetPixel(node1);
+      lineDisplacements[2 * i]     = (1. - wy) * d0[0] + wy * d1[0];
+      lineDisplacements[2 * i + 1] = (1. - wy) * d0[1] + wy * d1[1];
+      }
+
+    const double gridStepX = nextGrid[0] - startGrid[0];
+    const double pointStepX = nextPoint[0] - startPoint[0];
+    const double pointStepY = nextPoint[1] - startPoint[1];
+    const double lastColumn = static_cast<double>(fieldSizeX - 1);
+
+    for (unsigned int x = 0; x < width; ++x)
+      {
+      const double u = startGrid[0] + x * gridStepX - fieldStartX;
+      if (u < 0. || u > lastColumn)
+        {
+        outLine[x] = m_EdgePaddingValue;
+        continue;
+        }
+      const long column = std::min(static_cast<long>(u), std::max(fieldSizeX - 2, 0L));
+      const long nextColumn = std::min(column + 1, fieldSizeX - 1);
+      const double wx = u - column;
+
+      PointType inputPoint;
+      inputPoint[0] = startPoint[0] + x * pointStepX
+        + (1. - wx) * lineDisplacements[2 * column] + wx * lineDisplacements[2 * nextColumn];
+      inputPoint[1] = startPoint[1] + x * pointStepY
+        + (1. - wx) * lineDisplacements[2 * column + 1] + wx * lineDisplacements[2 * nextColumn + 1];
+
+      if (interpolator->IsInsideBuffer(inputPoint))
+        {
+        outLine[x] = static_cast<OutputPixelType>(interpolator->Evaluate(inputPoint));
+        }
+      else
+        {
+        outLine[x] = m_EdgePaddingValue;
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StereorectificationResampleImageFilter<TInputImage,TOutputImage,TDisplacementField>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Output size: " << m_OutputSize << std::endl;
+  os << indent << "Output spacing: " << m_OutputSpacing << std::endl;
+  os << indent << "Output origin: " << m_OutputOrigin << std::endl;
+  os << indent << "Output margin: " << m_OutputMargin << std::endl;
+  os << indent << "Edge padding value: " << m_EdgePaddingValue << std::endl;
+}
+
+} // end namespace otb
+
+#endif
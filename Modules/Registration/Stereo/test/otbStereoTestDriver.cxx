@@ -29,4 +29,5 @@ void RegisterTests()
   REGISTER_TEST(otbAdhesionCorrectionFilter);
   REGISTER_TEST(otbStereoSensorModelToElevationMapFilter);
   REGISTER_TEST(otbStereorectificationDisplacementFieldSource);
+  REGISTER_TEST(otbStereorectificationResampleImageFilter);
 }
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbImage.h"
+#include "otbStereorectificationResampleImageFilter.h"
+#include "otbStreamingWarpImageFilter.h"
+#include "otbBCOInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <cmath>
+
+typedef itk::Vector<float,2>                                DisplacementType;
+typedef otb::Image<DisplacementType>                         DisplacementFieldType;
+typedef otb::Image<float>                                   ImageType;
+typedef otb::StereorectificationResampleImageFilter
+   <ImageType,ImageType,DisplacementFieldType>               ResampleFilterType;
+typedef otb::StreamingWarpImageFilter
+   <ImageType,ImageType,DisplacementFieldType>               WarpFilterType;
+typedef otb::BCOInterpolateImageFunction<ImageType>         InterpolatorType;
+
+/** Build a coarse grid with a smooth deformation */
+DisplacementFieldType::Pointer CreateGrid(double shiftX, double shiftY, double shear)
+{
+  DisplacementFieldType::SizeType size;
+  size[0] = 7;
+  size[1] = 6;
+  DisplacementFieldType::RegionType region;
+  region.SetSize(size);
+  DisplacementFieldType::SpacingType spacing;
+  spacing.Fill(8.);
+
+  DisplacementFieldType::Pointer grid = DisplacementFieldType::New();
+  grid->SetRegions(region);
+  grid->SetSignedSpacing(spacing);
+  grid->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<DisplacementFieldType> it(grid, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    DisplacementFieldType::PointType point;
+    grid->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+    DisplacementType displacement;
+    displacement[0] = shiftX + shear * point[1] + 0.002 * point[0] * point[1];
+    displacement[1] = shiftY + 0.05 * point[0];
+    it.Set(displacement);
+    }
+  return grid;
+}
+
+int otbStereorectificationResampleImageFilter(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  // Smooth sensor images
+  ImageType::SizeType size;
+  size[0] = 80;
+  size[1] = 70;
+  ImageType::RegionType region;
+  region.SetSize(size);
+
+  ImageType::Pointer images[2];
+  for (unsigned int i = 0; i < 2; ++i)
+    {
+    images[i] = ImageType::New();
+    images[i]->SetRegions(region);
+    images[i]->Allocate();
+    itk::ImageRegionIteratorWithIndex<ImageType> it(images[i], region);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      {
+      const ImageType::IndexType idx = it.GetIndex();
+      it.Set(100. + 50. * std::sin(0.3 * idx[0] + i) * std::cos(0.2 * idx[1]) + idx[0]);
+      }
+    }
+
+  DisplacementFieldType::Pointer grids[2];
+  grids[0] = CreateGrid(4., 3., 0.1);
+  grids[1] = CreateGrid(-2., 5., -0.05);
+
+  // Epipolar geometry, larger than the grids so that padding is tested
+  ImageType::SizeType epiSize;
+  epiSize[0] = 52;
+  epiSize[1] = 44;
+  ImageType::SpacingType epiSpacing;
+  epiSpacing.Fill(1.);
+  ImageType::PointType epiOrigin;
+  epiOrigin.Fill(0.);
+  const float padding = -1.;
+
+  ResampleFilterType::Pointer resampler = ResampleFilterType::New();
+  resampler->SetLeftInput(images[0]);
+  resampler->SetRightInput(images[1]);
+  resampler->SetLeftDisplacementField(grids[0]);
+  resampler->SetRightDisplacementField(grids[1]);
+  resampler->SetLeftInterpolator(InterpolatorType::New());
+  resampler->SetRightInterpolator(InterpolatorType::New());
+  resampler->SetOutputSize(epiSize);
+  resampler->SetOutputSpacing(epiSpacing);
+  resampler->SetOutputOrigin(epiOrigin);
+  resampler->SetEdgePaddingValue(padding);
+  ImageType::SizeType margin;
+  margin.Fill(3);
+  resampler->SetOutputMargin(margin);
+  resampler->Update();
+
+  ImageType * outputs[2] = {resampler->GetLeftOutput(), resampler->GetRightOutput()};
+  for (unsigned int i = 0; i < 2; ++i)
+    {
+    // Reference: the streaming warp filter
+    WarpFilterType::Pointer warper = WarpFilterType::New();
+    warper->SetInput(images[i]);
+    warper->SetDisplacementField(grids[i]);
+    warper->SetInterpolator(InterpolatorType::New());
+    warper->SetOutputSize(epiSize);
+    warper->SetOutputSpacing(epiSpacing);
+    warper->SetOutputOrigin(epiOrigin);
+    warper->SetEdgePaddingValue(padding);
+    warper->Update();
+
+    unsigned int nbPadded = 0;
+    itk::ImageRegionIteratorWithIndex<ImageType> refIt(warper->GetOutput(), warper->GetOutput()->GetLargestPossibleRegion());
+    for (refIt.GoToBegin(); !refIt.IsAtEnd(); ++refIt)
+      {
+      const float value = outputs[i]->GetPixel(refIt.GetIndex());
+      if (std::abs(value - refIt.Get()) > 1e-3 * std::max(1.f, std::abs(refIt.Get())))
+        {
+        std::cerr << "Image " << i << " at " << refIt.GetIndex() << ": got " << value
+                  << " instead of " << refIt.Get() << std::endl;
+        return EXIT_FAILURE;
+        }
+      if (value == padding)
+        {
+        ++nbPadded;
+        }
+      }
+    if (nbPadded == 0 || nbPadded == epiSize[0] * epiSize[1])
+      {
+      std::cerr << "Image " << i << ": unexpected number of padded pixels " << nbPadded << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
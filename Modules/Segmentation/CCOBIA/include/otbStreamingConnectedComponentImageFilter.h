@@ -0,0 +1,355 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingConnectedComponentImageFilter_h
+#define otbStreamingConnectedComponentImageFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "itkImageToImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "otbConnectedComponentMuParserFunctor.h"
+#include "otbParallelFor.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace otb
+{
+
+namespace Functor
+{
+
+/** \class ConnectedComponentBinaryFunctor
+ *  \brief Functor connecting any two neighbour pixels
+ *
+ * Used with a StreamingConnectedComponentImageFilter, the components are
+ * the connected components of the mask image. The expression is ignored.
+ *
+ * \ingroup OTBCCOBIA
+ */
+template<class TInput>
+class ConnectedComponentBinaryFunctor
+{
+public:
+  inline bool operator()(const TInput &, const TInput &) const
+  {
+    return true;
+  }
+
+  void SetExpression(const std::string &) {}
+};
+
+} // end namespace Functor
+
+/** \class PersistentConnectedComponentEquivalenceFilter
+ * \brief [internal] First pass of the StreamingConnectedComponentImageFilter
+ *
+ * Each region processed by a thread (a block) is labelled independently.
+ * Only the data lying on the border of the blocks is kept: the local labels
+ * of the perimeter pixels, and the pairs of connected pixels on both sides
+ * of the block boundaries. Synthetize() resolves the equivalences of the
+ * border components with a union-find and gives a consecutive global label
+ * to each component, so that the blocks can be relabelled independently by
+ * the second pass.
+ *
+ * Blocks are ordered by their starting index, so that the labels do not
+ * depend on the order in which the threads processed them.
+ *
+ * \sa StreamingConnectedComponentImageFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBCCOBIA
+ */
+template <class TInputImage, class TMaskImage, class TFunctor>
+class ITK_EXPORT PersistentConnectedComponentEquivalenceFilter
+  : public PersistentImageFilter<TInputImage, TInputImage>
+{
+public:
+  /** Standard class typedefs */
+  typedef PersistentConnectedComponentEquivalenceFilter   Self;
+  typedef PersistentImageFilter<TInputImage, TInputImage> Superclass;
+  typedef itk::SmartPointer<Self>                         Pointer;
+  typedef itk::SmartPointer<const Self>                   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentConnectedComponentEquivalenceFilter, PersistentImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+  static_assert(TInputImage::ImageDimension == 2, "Only 2D images are supported");
+
+  typedef TInputImage                               InputImageType;
+  typedef typename InputImageType::PixelType        PixelType;
+  typedef typename InputImageType::RegionType       RegionType;
+  typedef typename InputImageType::IndexType        IndexType;
+  typedef TMaskImage                                MaskImageType;
+  typedef TFunctor                                  FunctorType;
+
+  /** Label of a component inside a block */
+  typedef std::uint32_t                             LocalLabelType;
+  /** Global label of a component */
+  typedef std::uint64_t                             ObjectLabelType;
+
+  /** A region labelled independently */
+  struct BlockType
+  {
+    RegionType     Region;
+    LocalLabelType NumberOfComponents;
+    /** Global label of the first component of the block which is not
+     * connected to a component of a previous block */
+    ObjectLabelType FirstNewLabel;
+    /** Global labels of the components touching the border of the block,
+     * sorted by local label */
+    std::vector<std::pair<LocalLabelType, ObjectLabelType> > BorderLabels;
+    /** Perimeter pixels (linear index in the image, local label) */
+    std::vector<std::pair<std::uint64_t, LocalLabelType> > Perimeter;
+    /** Connections with pixels of other blocks (local label, linear index) */
+    std::vector<std::pair<LocalLabelType, std::uint64_t> > Links;
+  };
+
+  /** Set the mask image (optional). Pixels where the mask is 0 are not
+   * labelled. */
+  void SetMaskImage(const MaskImageType * mask);
+
+  /** Get the mask image */
+  const MaskImageType * GetMaskImage() const;
+
+  /** Set/Get the expression of the functor */
+  itkSetStringMacro(Expression);
+  itkGetStringMacro(Expression);
+
+  /** Set/Get whether the diagonal neighbours are connected */
+  itkSetMacro(FullyConnected, bool);
+  itkGetConstMacro(FullyConnected, bool);
+  itkBooleanMacro(FullyConnected);
+
+  /** Blocks with their global labels, available after Synthetize() */
+  const std::vector<BlockType> & GetBlocks() const
+  {
+    return m_Blocks;
+  }
+
+  /** Number of connected components, available after Synthetize() */
+  ObjectLabelType GetNumberOfObjects() const
+  {
+    return m_NumberOfObjects;
+  }
+
+  /** Create a functor with the current expression */
+  std::unique_ptr<FunctorType> CreateFunctor() const;
+
+  /** Label the connected components of a block, in raster order of their
+   * first pixel. Background pixels get the label 0.
+   * \return the number of components */
+  LocalLabelType LabelBlock(const RegionType & block,
+                            FunctorType & functor,
+                            std::vector<LocalLabelType> & labels) const;
+
+  void Reset(void) override;
+
+  void Synthetize(void) override;
+
+protected:
+  PersistentConnectedComponentEquivalenceFilter();
+  ~PersistentConnectedComponentEquivalenceFilter() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  void GenerateOutputInformation() override;
+
+  /** The input is padded by one pixel to read the neighbour blocks */
+  void GenerateInputRequestedRegion() override;
+
+  void AllocateOutputs() override;
+
+  void ThreadedGenerateData(const RegionType& outputRegionForThread,
+                            itk::ThreadIdType threadId) override;
+
+private:
+  PersistentConnectedComponentEquivalenceFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  std::string m_Expression;
+  bool        m_FullyConnected;
+
+  /** One functor per thread, since the functors are not thread safe */
+  std::vector<std::unique_ptr<FunctorType> > m_Functors;
+
+  /** Blocks processed by each thread */
+  std::vector<std::vector<BlockType> > m_ThreadBlocks;
+
+  std::vector<BlockType> m_Blocks;
+  ObjectLabelType        m_NumberOfObjects;
+};
+
+/** \class StreamingConnectedComponentImageFilter
+ * \brief Label the connected components of an arbitrarily large image
+ *
+ * Two neighbour pixels are connected if the functor returns true for their
+ * values. With the default ConnectedComponentMuParserFunctor, the
+ * connection is given by a muParser expression (see SetExpression()), as in
+ * itk::ConnectedComponentFunctorImageFilter. With a
+ * ConnectedComponentBinaryFunctor, the components are those of the mask
+ * image. Pixels outside the mask are labelled 0.
+ *
+ * The labelling is done in two passes:
+ * - the first one streams the whole input through a
+ *   PersistentConnectedComponentEquivalenceFilter, which labels each block
+ *   in parallel and resolves the equivalences between the components
+ *   touching the block borders. Its memory footprint is bounded by the size
+ *   of the border data;
+ * - the second one, run when this filter is updated on a requested region,
+ *   relabels the blocks overlapping this region in parallel.
+ *
+ * The output labels are consecutive and consistent over the whole image, so
+ * that the output can be streamed by a writer. The streaming of the first
+ * pass is set with GetEquivalenceFilter()->GetStreamer(). The blocks
+ * overlapping the output requested region are fully read, so aligning the
+ * streaming of both passes avoids reading the input several times.
+ *
+ * \code
+ * typedef otb::StreamingConnectedComponentImageFilter<VectorImageType, LabelImageType> CCFilterType;
+ * CCFilterType::Pointer ccFilter = CCFilterType::New();
+ * ccFilter->SetInput(image);
+ * ccFilter->SetMaskImage(mask);
+ * ccFilter->SetExpression("distance<10");
+ * writer->SetInput(ccFilter->GetOutput());
+ * writer->Update();
+ * \endcode
+ *
+ * Only 2D images are supported.
+ *
+ * \sa PersistentConnectedComponentEquivalenceFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBCCOBIA
+ */
+template <class TInputImage, class TLabelImage,
+          class TFunctor = Functor::ConnectedComponentMuParserFunctor<typename TInputImage::PixelType>,
+          class TMaskImage = TLabelImage>
+class ITK_EXPORT StreamingConnectedComponentImageFilter
+  : public itk::ImageToImageFilter<TInputImage, TLabelImage>
+{
+public:
+  /** Standard class typedefs */
+  typedef StreamingConnectedComponentImageFilter              Self;
+  typedef itk::ImageToImageFilter<TInputImage, TLabelImage>   Superclass;
+  typedef itk::SmartPointer<Self>                             Pointer;
+  typedef itk::SmartPointer<const Self>                       ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(StreamingConnectedComponentImageFilter, ImageToImageFilter);
+
+  typedef TInputImage                                    InputImageType;
+  typedef TLabelImage                                    LabelImageType;
+  typedef typename LabelImageType::PixelType             LabelType;
+  typedef typename LabelImageType::RegionType            RegionType;
+  typedef TMaskImage                                     MaskImageType;
+  typedef TFunctor                                       FunctorType;
+
+  typedef PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+                                                          PersistentFilterType;
+  typedef PersistentFilterStreamingDecorator<PersistentFilterType> EquivalenceFilterType;
+  typedef typename PersistentFilterType::BlockType        BlockType;
+  typedef typename PersistentFilterType::LocalLabelType   LocalLabelType;
+  typedef typename PersistentFilterType::ObjectLabelType  ObjectLabelType;
+
+  /** Set the mask image (optional) */
+  void SetMaskImage(const MaskImageType * mask);
+
+  /** Get the mask image */
+  const MaskImageType * GetMaskImage() const;
+
+  /** Set the expression of the functor */
+  void SetExpression(const std::string & expression);
+
+  /** Get the expression of the functor */
+  std::string GetExpression() const
+  {
+    return m_EquivalenceFilter->GetFilter()->GetExpression();
+  }
+
+  /** Set whether the diagonal neighbours are connected (false by default) */
+  void SetFullyConnected(bool fullyConnected);
+
+  /** Get whether the diagonal neighbours are connected */
+  bool GetFullyConnected() const
+  {
+    return m_EquivalenceFilter->GetFilter()->GetFullyConnected();
+  }
+
+  /** Get the filter running the first pass */
+  EquivalenceFilterType * GetEquivalenceFilter()
+  {
+    return m_EquivalenceFilter;
+  }
+
+  /** Number of connected components, available once the output information
+   * is generated */
+  ObjectLabelType GetObjectCount() const
+  {
+    return m_EquivalenceFilter->GetFilter()->GetNumberOfObjects();
+  }
+
+protected:
+  StreamingConnectedComponentImageFilter();
+  ~StreamingConnectedComponentImageFilter() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  /** Run the first pass */
+  void GenerateOutputInformation() override;
+
+  /** The whole blocks overlapping the output requested region are needed */
+  void GenerateInputRequestedRegion() override;
+
+  void GenerateData() override;
+
+private:
+  StreamingConnectedComponentImageFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+
+  typename EquivalenceFilterType::Pointer m_EquivalenceFilter;
+
+  /** Time of the last run of the first pass */
+  itk::TimeStamp m_EquivalenceTime;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingConnectedComponentImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,695 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingConnectedComponentImageFilter_hxx
+#define otbStreamingConnectedComponentImageFilter_hxx
+
+#include "otbStreamingConnectedComponentImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace otb
+{
+
+template <class TInputImage, class TMaskImage, class TFunctor>
+PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::PersistentConnectedComponentEquivalenceFilter()
+  : m_Expression(""), m_FullyConnected(false), m_NumberOfObjects(0)
+{
+  this->SetNumberOfRequiredInputs(1);
+}
+
+template <class TInputImage, class TMaskImage, class TFunctor>
+void
+PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::SetMaskImage(const MaskImageType * mask)
+{
+  // Process object is not const-correct so the const_cast is required here
+  this->itk::ProcessObject::SetNthInput(1, const_cast<MaskImageType *>(mask));
+}
+
+template <class TInputImage, class TMaskImage, class TFunctor>
+const typename PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::MaskImageType *
+PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::GetMaskImage() const
+{
+  if (this->GetNumberOfInputs() < 2)
+    {
+    return nullptr;
+    }
+  return static_cast<const MaskImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TInputImage, class TMaskImage, class TFunctor>
+std::unique_ptr<TFunctor>
+PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::CreateFunctor() const
+{
+  std::unique_ptr<FunctorType> functor(new FunctorType);
+  functor->SetExpression(m_Expression);
+  return functor;
+}
+
+template <class TInputImage, class TMaskImage, class TFunctor>
+void
+PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  if (this->GetInput())
+    {
+    this->GetOutput()->CopyInformation(this->GetInput());
+    this->GetOutput()->SetLargestPossibleRegion(this->GetInput()->GetLargestPossibleRegion());
+
+    if (this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() == 0)
+      {
+      this->GetOutput()->SetRequestedRegion(this->GetOutput()->GetLargestPossibleRegion());
+      }
+    }
+}
+
+template <class TInputImage, class TMaskImage, class TFunctor>
+void
+PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::GenerateInputRequestedRegion()
+{
+  auto input = const_cast<InputImageType *>(this->GetInput());
+  auto mask = const_cast<MaskImageType *>(this->GetMaskImage());
+
+  if (input)
+    {
+    RegionType region = this->GetOutput()->GetRequestedRegion();
+    region.PadByRadius(1);
+    region.Crop(input->GetLargestPossibleRegion());
+    input->SetRequestedRegion(region);
+    if (mask)
+      {
+      mask->SetRequestedRegion(region);
+      }
+    }
+}
+
+template <class TInputImage, class TMaskImage, class TFunctor>
+void
+PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::AllocateOutputs()
+{
+  // Nothing to allocate: the output image is not intended to be used
+}
+
+template <class TInputImage, class TMaskImage, class TFunctor>
+void
+PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::Reset()
+{
+  const itk::ThreadIdType nbThreads = this->GetNumberOfThreads();
+  m_Functors.clear();
+  for (itk::ThreadIdType threadId = 0; threadId < nbThreads; ++threadId)
+    {
+    m_Functors.push_back(this->CreateFunctor());
+    }
+  m_ThreadBlocks.clear();
+  m_ThreadBlocks.resize(nbThreads);
+  m_Blocks.clear();
+  m_NumberOfObjects = 0;
+}
+
+template <class TInputImage, class TMaskImage, class TFunctor>
+typename PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::LocalLabelType
+PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::LabelBlock(const RegionType & block,
+             FunctorType & functor,
+             std::vector<LocalLabelType> & labels) const
+{
+  const InputImageType * input = this->GetInput();
+  const MaskImageType * mask = this->GetMaskImage();
+
+  const std::size_t width = block.GetSize()[0];
+  const std::size_t height = block.GetSize()[1];
+  const std::size_t nbPixels = width * height;
+  if (nbPixels >= std::numeric_limits<LocalLabelType>::max())
+    {
+    itkExceptionMacro(<< "Block " << block << " is too large to be labelled");
+    }
+
+  // Union-find over the pixels of the block. Roots are always the smallest
+  // pixel of their component, so that labels follow the raster order.
+  const LocalLabelType background = std::numeric_limits<LocalLabelType>::max();
+  std::vector<LocalLabelType> parent(nbPixels, background);
+  auto find = [&parent](LocalLabelType i)
+    {
+    while (parent[i] != i)
+      {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+      }
+    return i;
+    };
+  auto unite = [&parent, &find](LocalLabelType a, LocalLabelType b)
+    {
+    a = find(a);
+    b = find(b);
+    if (a < b)
+      {
+      parent[b] = a;
+      }
+    else if (b < a)
+      {
+      parent[a] = b;
+      }
+    };
+
+  // Only the current and previous rows are kept
+  std::vector<PixelType> previousRow(width);
+  std::vector<PixelType> currentRow(width);
+  std::vector<bool> previousInside(width, false);
+  std::vector<bool> currentInside(width, false);
+
+  itk::ImageRegionConstIterator<InputImageType> inIt(input, block);
+  itk::ImageRegionConstIterator<MaskImageType> maskIt;
+  if (mask)
+    {
+    maskIt = itk::ImageRegionConstIterator<MaskImageType>(mask, block);
+    }
+
+  LocalLabelType pos = 0;
+  for (std::size_t y = 0; y < height; ++y)
+    {
+    for (std::size_t x = 0; x < width; ++x, ++pos, ++inIt)
+      {
+      currentRow[x] = inIt.Get();
+      currentInside[x] = true;
+      if (mask)
+        {
+        currentInside[x] = (maskIt.Get() != 0);
+        ++maskIt;
+        }
+      if (!currentInside[x])
+        {
+        continue;
+        }
+      parent[pos] = pos;
+
+      if (x > 0 && currentInside[x - 1] && functor(currentRow[x], currentRow[x - 1]))
+        {
+        unite(pos, pos - 1);
+        }
+      if (y > 0)
+        {
+        if (previousInside[x] && functor(currentRow[x], previousRow[x]))
+          {
+          unite(pos, pos - width);
+          }
+        if (m_FullyConnected)
+          {
+          if (x > 0 && previousInside[x - 1] && functor(currentRow[x], previousRow[x - 1]))
+            {
+            unite(pos, pos - width - 1);
+            }
+          if (x + 1 < width && previousInside[x + 1] && functor(currentRow[x], previousRow[x + 1]))
+            {
+            unite(pos, pos - width + 1);
+            }
+          }
+        }
+      }
+    std::swap(previousRow, currentRow);
+    std::swap(previousInside, currentInside);
+    }
+
+  labels.assign(nbPixels, 0);
+  LocalLabelType nbComponents = 0;
+  for (pos = 0; pos < nbPixels; ++pos)
+    {
+    if (parent[pos] == background)
+      {
+      continue;
+      }
+    const LocalLabelType root = find(pos);
+    labels[pos] = (root == pos) ? ++nbComponents : labels[root];
+    }
+  return nbComponents;
+}
+
+template <class TInputImage, class TMaskImage, class TFunctor>
+void
+PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  const InputImageType * input = this->GetInput();
+  const MaskImageType * mask = this->GetMaskImage();
+  FunctorType & functor = *m_Functors[threadId];
+
+  const RegionType & largestRegion = input->GetLargestPossibleRegion();
+  const IndexType & origin = largestRegion.GetIndex();
+  const std::uint64_t imageWidth = largestRegion.GetSize()[0];
+  auto linearIndex = [&origin, imageWidth](const IndexType & index)
+    {
+    return static_cast<std::uint64_t>(index[1] - origin[1]) * imageWidth
+      + static_cast<std::uint64_t>(index[0] - origin[0]);
+    };
+
+  itk::ProgressReporter progress(this, threadId, 1);
+
+  BlockType block;
+  block.Region = outputRegionForThread;
+  block.FirstNewLabel = 0;
+  std::vector<LocalLabelType> labels;
+  block.NumberOfComponents = this->LabelBlock(outputRegionForThread, functor, labels);
+
+  // Neighbours following a pixel in raster order: each pair of neighbour
+  // pixels lying in different blocks is found by exactly one of them.
+  std::vector<std::pair<int, int> > forward = {{1, 0}, {0, 1}};
+  if (m_FullyConnected)
+    {
+    forward.push_back({-1, 1});
+    forward.push_back({1, 1});
+    }
+
+  const IndexType & start = outputRegionForThread.GetIndex();
+  const std::size_t width = outputRegionForThread.GetSize()[0];
+  const std::size_t height = outputRegionForThread.GetSize()[1];
+  for (std::size_t y = 0; y < height; ++y)
+    {
+    const bool fullRow = (y == 0 || y + 1 == height);
+    for (std::size_t x = 0; x < width; x += (fullRow || x + 1 == width) ? 1 : width - 1)
+      {
+      const LocalLabelType label = labels[y * width + x];
+      if (label == 0)
+        {
+        continue;
+        }
+      IndexType index;
+      index[0] = start[0] + x;
+      index[1] = start[1] + y;
+      block.Perimeter.push_back(std::make_pair(linearIndex(index), label));
+
+      for (auto const & offset : forward)
+        {
+        IndexType neighbour;
+        neighbour[0] = index[0] + offset.first;
+        neighbour[1] = index[1] + offset.second;
+        if (outputRegionForThread.IsInside(neighbour) || !largestRegion.IsInside(neighbour)
+            || (mask && mask->GetPixel(neighbour) == 0))
+          {
+          continue;
+          }
+        // Same argument order as in LabelBlock(): the pixel coming later first
+        if (functor(input->GetPixel(neighbour), input->GetPixel(index)))
+          {
+          block.Links.push_back(std::make_pair(label, linearIndex(neighbour)));
+          }
+        }
+      }
+    }
+
+  m_ThreadBlocks[threadId].push_back(std::move(block));
+  progress.CompletedPixel();
+}
+
+template <class TInputImage, class TMaskImage, class TFunctor>
+void
+PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::Synthetize()
+{
+  m_Blocks.clear();
+  for (auto & threadBlocks : m_ThreadBlocks)
+    {
+    std::move(threadBlocks.begin(), threadBlocks.end(), std::back_inserter(m_Blocks));
+    }
+  m_ThreadBlocks.clear();
+
+  // Labels do not depend on the order of processing of the blocks
+  std::sort(m_Blocks.begin(), m_Blocks.end(), [](BlockType const & a, BlockType const & b)
+    {
+    const IndexType & ia = a.Region.GetIndex();
+    const IndexType & ib = b.Region.GetIndex();
+    return ia[1] < ib[1] || (ia[1] == ib[1] && ia[0] < ib[0]);
+    });
+
+  // Nodes of the union-find: components touching the border of a block
+  const std::size_t nbBlocks = m_Blocks.size();
+  std::vector<std::size_t> nodeOffsets(nbBlocks + 1, 0);
+  std::size_t nbPerimeterPixels = 0;
+  for (std::size_t b = 0; b < nbBlocks; ++b)
+    {
+    BlockType & block = m_Blocks[b];
+    std::vector<LocalLabelType> borderLabels;
+    borderLabels.reserve(block.Perimeter.size());
+    for (auto const & pixel : block.Perimeter)
+      {
+      borderLabels.push_back(pixel.second);
+      }
+    std::sort(borderLabels.begin(), borderLabels.end());
+    borderLabels.erase(std::unique(borderLabels.begin(), borderLabels.end()), borderLabels.end());
+
+    block.BorderLabels.clear();
+    block.BorderLabels.reserve(borderLabels.size());
+    for (auto label : borderLabels)
+      {
+      block.BorderLabels.push_back(std::make_pair(label, ObjectLabelType(0)));
+      }
+    nodeOffsets[b + 1] = nodeOffsets[b] + borderLabels.size();
+    nbPerimeterPixels += block.Perimeter.size();
+    }
+
+  auto nodeOf = [this, &nodeOffsets](std::size_t b, LocalLabelType label)
+    {
+    auto const & borderLabels = m_Blocks[b].BorderLabels;
+    auto it = std::lower_bound(borderLabels.begin(), borderLabels.end(),
+                               std::make_pair(label, ObjectLabelType(0)));
+    return nodeOffsets[b] + (it - borderLabels.begin());
+    };
+
+  std::unordered_map<std::uint64_t, std::size_t> perimeterNodes;
+  perimeterNodes.reserve(nbPerimeterPixels);
+  for (std::size_t b = 0; b < nbBlocks; ++b)
+    {
+    for (auto const & pixel : m_Blocks[b].Perimeter)
+      {
+      perimeterNodes.emplace(pixel.first, nodeOf(b, pixel.second));
+      }
+    }
+
+  std::vector<std::size_t> parent(nodeOffsets[nbBlocks]);
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&parent](std::size_t i)
+    {
+    while (parent[i] != i)
+      {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+      }
+    return i;
+    };
+
+  for (std::size_t b = 0; b < nbBlocks; ++b)
+    {
+    for (auto const & link : m_Blocks[b].Links)
+      {
+      auto it = perimeterNodes.find(link.second);
+      if (it == perimeterNodes.end())
+        {
+        continue;
+        }
+      std::size_t root1 = find(nodeOf(b, link.first));
+      std::size_t root2 = find(it->second);
+      if (root1 != root2)
+        {
+        parent[std::max(root1, root2)] = std::min(root1, root2);
+        }
+      }
+    }
+  perimeterNodes.clear();
+
+  // Global labels, in the order of the blocks then of the local labels. A
+  // component spanning several blocks gets its label in the first one.
+  std::vector<ObjectLabelType> rootLabels(parent.size(), 0);
+  ObjectLabelType next = 1;
+  for (std::size_t b = 0; b < nbBlocks; ++b)
+    {
+    BlockType & block = m_Blocks[b];
+    block.FirstNewLabel = next;
+    LocalLabelType previous = 0;
+    for (std::size_t k = 0; k < block.BorderLabels.size(); ++k)
+      {
+      // Interior components between two border components
+      next += block.BorderLabels[k].first - previous - 1;
+      previous = block.BorderLabels[k].first;
+
+      ObjectLabelType & rootLabel = rootLabels[find(nodeOffsets[b] + k)];
+      if (rootLabel == 0)
+        {
+        rootLabel = next++;
+        }
+      block.BorderLabels[k].second = rootLabel;
+      }
+    next += block.NumberOfComponents - previous;
+
+    std::vector<std::pair<std::uint64_t, LocalLabelType> >().swap(block.Perimeter);
+    std::vector<std::pair<LocalLabelType, std::uint64_t> >().swap(block.Links);
+    }
+  m_NumberOfObjects = next - 1;
+}
+
+template <class TInputImage, class TMaskImage, class TFunctor>
+void
+PersistentConnectedComponentEquivalenceFilter<TInputImage, TMaskImage, TFunctor>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Expression: " << m_Expression << std::endl;
+  os << indent << "FullyConnected: " << m_FullyConnected << std::endl;
+  os << indent << "Number of blocks: " << m_Blocks.size() << std::endl;
+  os << indent << "Number of objects: " << m_NumberOfObjects << std::endl;
+}
+
+template <class TInputImage, class TLabelImage, class TFunctor, class TMaskImage>
+StreamingConnectedComponentImageFilter<TInputImage, TLabelImage, TFunctor, TMaskImage>
+::StreamingConnectedComponentImageFilter()
+{
+  this->SetNumberOfRequiredInputs(1);
+  m_EquivalenceFilter = EquivalenceFilterType::New();
+}
+
+template <class TInputImage, class TLabelImage, class TFunctor, class TMaskImage>
+void
+StreamingConnectedComponentImageFilter<TInputImage, TLabelImage, TFunctor, TMaskImage>
+::SetMaskImage(const MaskImageType * mask)
+{
+  // Process object is not const-correct so the const_cast is required here
+  this->itk::ProcessObject::SetNthInput(1, const_cast<MaskImageType *>(mask));
+}
+
+template <class TInputImage, class TLabelImage, class TFunctor, class TMaskImage>
+const typename StreamingConnectedComponentImageFilter<TInputImage, TLabelImage, TFunctor, TMaskImage>
+::MaskImageType *
+StreamingConnectedComponentImageFilter<TInputImage, TLabelImage, TFunctor, TMaskImage>
+::GetMaskImage() const
+{
+  if (this->GetNumberOfInputs() < 2)
+    {
+    return nullptr;
+    }
+  return static_cast<const MaskImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TInputImage, class TLabelImage, class TFunctor, class TMaskImage>
+void
+StreamingConnectedComponentImageFilter<TInputImage, TLabelImage, TFunctor, TMaskImage>
+::SetExpression(const std::string & expression)
+{
+  if (expression != this->GetExpression())
+    {
+    m_EquivalenceFilter->GetFilter()->SetExpression(expression);
+    this->Modified();
+    }
+}
+
+template <class TInputImage, class TLabelImage, class TFunctor, class TMaskImage>
+void
+StreamingConnectedComponentImageFilter<TInputImage, TLabelImage, TFunctor, TMaskImage>
+::SetFullyConnected(bool fullyConnected)
+{
+  if (fullyConnected != this->GetFullyConnected())
+    {
+    m_EquivalenceFilter->GetFilter()->SetFullyConnected(fullyConnected);
+    this->Modified();
+    }
+}
+
+template <class TInputImage, class TLabelImage, class TFunctor, class TMaskImage>
+void
+StreamingConnectedComponentImageFilter<TInputImage, TLabelImage, TFunctor, TMaskImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  // Run the first pass only if the inputs or the parameters changed
+  const InputImageType * input = this->GetInput();
+  const MaskImageType * mask = this->GetMaskImage();
+  PersistentFilterType * equivalenceFilter = m_EquivalenceFilter->GetFilter();
+
+  itk::ModifiedTimeType mtime = std::max(this->GetMTime(), input->GetPipelineMTime());
+  if (mask)
+    {
+    mtime = std::max(mtime, mask->GetPipelineMTime());
+    }
+  if (equivalenceFilter->GetInput() != input || equivalenceFilter->GetMaskImage() != mask
+      || mtime > m_EquivalenceTime.GetMTime())
+    {
+    equivalenceFilter->SetInput(input);
+    equivalenceFilter->SetMaskImage(mask);
+    m_EquivalenceFilter->Update();
+    m_EquivalenceTime.Modified();
+    }
+}
+
+template <class TInputImage, class TLabelImage, class TFunctor, class TMaskImage>
+void
+StreamingConnectedComponentImageFilter<TInputImage, TLabelImage, TFunctor, TMaskImage>
+::GenerateInputRequestedRegion()
+{
+  auto input = const_cast<InputImageType *>(this->GetInput());
+  auto mask = const_cast<MaskImageType *>(this->GetMaskImage());
+  if (!input)
+    {
+    return;
+    }
+
+  // Bounding region of the blocks overlapping the output requested region
+  const RegionType & outputRegion = this->GetOutput()->GetRequestedRegion();
+  RegionType inputRegion;
+  bool first = true;
+  for (auto const & block : m_EquivalenceFilter->GetFilter()->GetBlocks())
+    {
+    RegionType overlap = block.Region;
+    if (!overlap.Crop(outputRegion))
+      {
+      continue;
+      }
+    if (first)
+      {
+      inputRegion = block.Region;
+      first = false;
+      continue;
+      }
+    typename RegionType::IndexType start;
+    typename RegionType::IndexType end;
+    for (unsigned int d = 0; d < RegionType::ImageDimension; ++d)
+      {
+      start[d] = std::min(inputRegion.GetIndex()[d], block.Region.GetIndex()[d]);
+      end[d] = std::max(inputRegion.GetUpperIndex()[d], block.Region.GetUpperIndex()[d]);
+      }
+    inputRegion.SetIndex(start);
+    inputRegion.SetUpperIndex(end);
+    }
+  if (first)
+    {
+    inputRegion = outputRegion;
+    }
+
+  input->SetRequestedRegion(inputRegion);
+  if (mask)
+    {
+    mask->SetRequestedRegion(inputRegion);
+    }
+}
+
+template <class TInputImage, class TLabelImage, class TFunctor, class TMaskImage>
+void
+StreamingConnectedComponentImageFilter<TInputImage, TLabelImage, TFunctor, TMaskImage>
+::GenerateData()
+{
+  this->AllocateOutputs();
+
+  LabelImageType * output = this->GetOutput();
+  const RegionType & outputRegion = output->GetRequestedRegion();
+  const PersistentFilterType * equivalenceFilter = m_EquivalenceFilter->GetFilter();
+  auto const & blocks = equivalenceFilter->GetBlocks();
+
+  std::vector<std::size_t> selected;
+  for (std::size_t b = 0; b < blocks.size(); ++b)
+    {
+    RegionType overlap = blocks[b].Region;
+    if (overlap.Crop(outputRegion))
+      {
+      selected.push_back(b);
+      }
+    }
+
+  const itk::ThreadIdType nbThreads = this->GetNumberOfThreads();
+  std::vector<std::unique_ptr<FunctorType> > functors;
+  for (itk::ThreadIdType threadId = 0; threadId < nbThreads; ++threadId)
+    {
+    functors.push_back(equivalenceFilter->CreateFunctor());
+    }
+
+  ParallelFor(selected.size(), this->GetNumberOfThreads(),
+    [&](std::size_t begin, std::size_t end, itk::ThreadIdType threadId)
+    {
+    std::vector<LocalLabelType> labels;
+    std::vector<LabelType> lut;
+    for (std::size_t i = begin; i < end; ++i)
+      {
+      BlockType const & block = blocks[selected[i]];
+      const LocalLabelType nbComponents = equivalenceFilter->LabelBlock(block.Region, *functors[threadId], labels);
+
+      // Same numbering as in PersistentConnectedComponentEquivalenceFilter::Synthetize()
+      lut.assign(nbComponents + 1, 0);
+      ObjectLabelType next = block.FirstNewLabel;
+      auto borderIt = block.BorderLabels.begin();
+      for (LocalLabelType label = 1; label <= nbComponents; ++label)
+        {
+        if (borderIt != block.BorderLabels.end() && borderIt->first == label)
+          {
+          lut[label] = static_cast<LabelType>(borderIt->second);
+          if (borderIt->second == next)
+            {
+            ++next;
+            }
+          ++borderIt;
+          }
+        else
+          {
+          lut[label] = static_cast<LabelType>(next++);
+          }
+        }
+
+      RegionType overlap = block.Region;
+      overlap.Crop(outputRegion);
+      const auto & start = block.Region.GetIndex();
+      const std::size_t width = block.Region.GetSize()[0];
+      itk::ImageRegionIteratorWithIndex<LabelImageType> outIt(output, overlap);
+      for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+        {
+        const auto & index = outIt.GetIndex();
+        const std::size_t pos = static_cast<std::size_t>(index[1] - start[1]) * width
+          + static_cast<std::size_t>(index[0] - start[0]);
+        outIt.Set(lut[labels[pos]]);
+        }
+      }
+    });
+}
+
+template <class TInputImage, class TLabelImage, class TFunctor, class TMaskImage>
+void
+StreamingConnectedComponentImageFilter<TInputImage, TLabelImage, TFunctor, TMaskImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Expression: " << this->GetExpression() << std::endl;
+  os << indent << "FullyConnected: " << this->GetFullyConnected() << std::endl;
+  os << indent << "Number of objects: " << this->GetObjectCount() << std::endl;
+}
+
+} // end namespace otb
+
+#endif
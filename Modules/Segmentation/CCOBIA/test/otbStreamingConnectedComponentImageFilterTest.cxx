@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbVectorImage.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbStreamingConnectedComponentImageFilter.h"
+#include "itkConnectedComponentFunctorImageFilter.h"
+#include "itkConnectedComponentImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <iostream>
+#include <map>
+
+typedef otb::VectorImage<float, 2>       ImageType;
+typedef otb::Image<unsigned int, 2>      LabelImageType;
+typedef otb::Image<unsigned int, 2>      MaskImageType;
+
+namespace
+{
+/** Check that two label images describe the same partition */
+bool SamePartition(const LabelImageType * ref, const LabelImageType * test)
+{
+  std::map<unsigned int, unsigned int> refToTest;
+  std::map<unsigned int, unsigned int> testToRef;
+  itk::ImageRegionConstIterator<LabelImageType> refIt(ref, ref->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<LabelImageType> testIt(test, ref->GetLargestPossibleRegion());
+  for (; !refIt.IsAtEnd(); ++refIt, ++testIt)
+    {
+    if ((refIt.Get() == 0) != (testIt.Get() == 0))
+      {
+      std::cerr << "Background mismatch at " << refIt.GetIndex() << std::endl;
+      return false;
+      }
+    auto it1 = refToTest.insert(std::make_pair(refIt.Get(), testIt.Get())).first;
+    auto it2 = testToRef.insert(std::make_pair(testIt.Get(), refIt.Get())).first;
+    if (it1->second != testIt.Get() || it2->second != refIt.Get())
+      {
+      std::cerr << "Components mismatch at " << refIt.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int otbStreamingConnectedComponentImageFilterTest(int itkNotUsed(argc), char * argv[])
+{
+  const char * inputFilename = argv[1];
+  const char * maskFilename = argv[2];
+  const std::string expression = argv[3];
+  const unsigned int nbDivisions = atoi(argv[4]);
+
+  typedef otb::ImageFileReader<ImageType>     ReaderType;
+  typedef otb::ImageFileReader<MaskImageType> MaskReaderType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputFilename);
+  MaskReaderType::Pointer maskReader = MaskReaderType::New();
+  maskReader->SetFileName(maskFilename);
+
+  // Labelling with an expression, compared with the whole image labelling
+  typedef otb::Functor::ConnectedComponentMuParserFunctor<ImageType::PixelType> FunctorType;
+  typedef itk::ConnectedComponentFunctorImageFilter<ImageType, LabelImageType, FunctorType, MaskImageType> RefFilterType;
+  typedef otb::StreamingConnectedComponentImageFilter<ImageType, LabelImageType> FilterType;
+
+  RefFilterType::Pointer refFilter = RefFilterType::New();
+  refFilter->SetInput(reader->GetOutput());
+  refFilter->SetMaskImage(maskReader->GetOutput());
+  refFilter->GetFunctor().SetExpression(expression);
+  refFilter->Update();
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(reader->GetOutput());
+  filter->SetMaskImage(maskReader->GetOutput());
+  filter->SetExpression(expression);
+  filter->GetEquivalenceFilter()->GetStreamer()->SetNumberOfDivisionsTiledStreaming(nbDivisions);
+  filter->Update();
+
+  std::cout << "Expression: " << filter->GetObjectCount() << " objects, reference: "
+            << refFilter->GetObjectCount() << std::endl;
+  if (filter->GetObjectCount() != refFilter->GetObjectCount()
+      || !SamePartition(refFilter->GetOutput(), filter->GetOutput()))
+    {
+    std::cerr << "Labelling with expression differs from the reference" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Labelling of the mask, fully connected
+  typedef itk::ConnectedComponentImageFilter<MaskImageType, LabelImageType> RefBinaryFilterType;
+  typedef otb::Functor::ConnectedComponentBinaryFunctor<MaskImageType::PixelType> BinaryFunctorType;
+  typedef otb::StreamingConnectedComponentImageFilter<MaskImageType, LabelImageType, BinaryFunctorType>
+      BinaryFilterType;
+
+  RefBinaryFilterType::Pointer refBinaryFilter = RefBinaryFilterType::New();
+  refBinaryFilter->SetInput(maskReader->GetOutput());
+  refBinaryFilter->FullyConnectedOn();
+  refBinaryFilter->Update();
+
+  BinaryFilterType::Pointer binaryFilter = BinaryFilterType::New();
+  binaryFilter->SetInput(maskReader->GetOutput());
+  binaryFilter->SetMaskImage(maskReader->GetOutput());
+  binaryFilter->SetFullyConnected(true);
+  binaryFilter->GetEquivalenceFilter()->GetStreamer()->SetNumberOfDivisionsTiledStreaming(nbDivisions);
+  binaryFilter->Update();
+
+  std::cout << "Mask: " << binaryFilter->GetObjectCount() << " objects, reference: "
+            << refBinaryFilter->GetObjectCount() << std::endl;
+  if (binaryFilter->GetObjectCount() != refBinaryFilter->GetObjectCount()
+      || !SamePartition(refBinaryFilter->GetOutput(), binaryFilter->GetOutput()))
+    {
+    std::cerr << "Labelling of the mask differs from the reference" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
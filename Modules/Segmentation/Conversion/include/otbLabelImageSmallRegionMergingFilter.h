@@ -24,7 +24,12 @@
 #include "otbPersistentImageFilter.h"
 #include "otbPersistentFilterStreamingDecorator.h"
 
+#include "otbParallelFor.h"
+
 #include <unordered_map>
+#include <set>
+#include <vector>
+#include <functional>
 
 namespace otb
 {
@@ -43,6 +48,14 @@ namespace otb
  * This filter can be updated several times for different values of size, 
  * the output equivalence table will be the results of all computations.
  *
+ * Each thread collects the edges of the region adjacency graph between the
+ * segments of size m_Size and their neighbours in a sorted list. In 
+ * Synthetize(), the closest neighbour of each segment is searched in
+ * parallel, and the merges are applied with a concurrent union-find which
+ * always links the largest root to the smallest one, so that the resulting
+ * labels do not depend on the number of threads and are the same as with a
+ * sequential merging.
+ *
  * \ingroup ImageSegmentation
  *
  * \ingroup OTBConversion
@@ -82,6 +95,11 @@ public:
   typedef std::unordered_map<InputLabelType , double>                           
                                                           LabelPopulationType;
   typedef std::unordered_map<InputLabelType , InputLabelType>   LUTType;
+
+  /** Edge of the region adjacency graph, from a segment to be merged to one 
+   * of its neighbours */
+  typedef std::pair<InputLabelType, InputLabelType>      EdgeType;
+  typedef std::vector<EdgeType>                           EdgeListType;
   
   /** Set/Get size of segments to be merged */
   itkGetMacro(Size , unsigned int);
@@ -120,6 +138,10 @@ protected:
    * label */
   InputLabelType FindCorrespondingLabel( InputLabelType label);
 
+  /** Get the current label of an input label, without modifying the LUT (thread
+   * safe) */
+  InputLabelType LookupLabel( InputLabelType label) const;
+
   /** Constructor */
   PersistentLabelImageSmallRegionMergingFilter();
 
@@ -142,9 +164,9 @@ private:
   /** Map containing at key i the mean of element of the segment labelled i */
   LabelStatisticType m_LabelStatistic;
   
-  /** Neigbours maps for each thread */
-  std::vector <NeigboursMapType > m_NeighboursMapsTmp;
-  
+  /** Sorted edges found by each thread */
+  std::vector <EdgeListType > m_EdgesTmp;
+
   /** LUT giving correspondance between labels in the original segmentation 
    * and the merged labels */
   LUTType m_LUT;
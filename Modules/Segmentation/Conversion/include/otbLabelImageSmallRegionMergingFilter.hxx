@@ -26,6 +26,9 @@
 #include "itkConstShapedNeighborhoodIterator.h"
 #include "itkProgressReporter.h"
 
+#include <algorithm>
+#include <atomic>
+
 namespace otb
 {
 template <class TInputLabelImage >
@@ -89,8 +92,8 @@ void
 PersistentLabelImageSmallRegionMergingFilter< TInputLabelImage >
 ::Reset()
 {
-  m_NeighboursMapsTmp.clear();
-  m_NeighboursMapsTmp.resize( this->GetNumberOfThreads() );
+  m_EdgesTmp.clear();
+  m_EdgesTmp.resize( this->GetNumberOfThreads() );
 }
 
 template <class TInputLabelImage >
@@ -98,68 +101,191 @@ void
 PersistentLabelImageSmallRegionMergingFilter< TInputLabelImage >
 ::Synthetize()
 {
-  NeigboursMapType neighboursMap;
-  
-  // Merge the neighbours maps from all threads
-  for( unsigned int threadId = 0; threadId < this->GetNumberOfThreads(); 
-        threadId++)
+  // Merge the sorted edge lists from all threads
+  EdgeListType edges;
+  std::size_t nbEdges = 0;
+  for (auto const & threadEdges : m_EdgesTmp)
+    {
+    nbEdges += threadEdges.size();
+    }
+  edges.reserve(nbEdges);
+  for (auto & threadEdges : m_EdgesTmp)
     {
-    for (auto const & neighbours : m_NeighboursMapsTmp[threadId])
+    auto middle = edges.size();
+    edges.insert(edges.end(), threadEdges.begin(), threadEdges.end());
+    std::inplace_merge(edges.begin(), edges.begin() + middle, edges.end());
+    EdgeListType().swap(threadEdges);
+    }
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  if (edges.empty())
+    {
+    return;
+    }
+
+  // Edges are sorted by source label, then by neighbour label : find the 
+  // range of edges of each source label.
+  std::vector<std::size_t> sourceBegin;
+  for (std::size_t i = 0; i < edges.size(); i++)
+    {
+    if (i == 0 || edges[i].first != edges[i-1].first)
       {
-      neighboursMap[ neighbours.first ].insert
-        ( neighbours.second.begin(), neighbours.second.end() );
+      sourceBegin.push_back(i);
       }
     }
-  
+  const std::size_t nbSources = sourceBegin.size();
+  sourceBegin.push_back(edges.size());
+
   // For each label of the label map, find the "closest" connected label, 
   // according to the euclidian distance between the corresponding 
-  // m_labelStatistic elements.
-  for (auto const & neighbours : neighboursMap)
+  // m_labelStatistic elements. Neighbours are visited in increasing order,
+  // so the smallest label is kept in case of equality.
+  std::vector<InputLabelType> closestNeighbours(nbSources);
+  auto const & labelStatistic = m_LabelStatistic;
+  ParallelFor(nbSources, this->GetNumberOfThreads(),
+    [&](std::size_t begin, std::size_t end, itk::ThreadIdType)
     {
-    double proximity = itk::NumericTraits<double>::max();
-    InputLabelType label = neighbours.first;
-    InputLabelType closestNeighbour = label;
-    auto const& statsLabel = m_LabelStatistic[ label ];
-    
-    for (auto const & neighbour : neighbours.second)
+    for (std::size_t source = begin; source < end; source++)
       {
-      auto const & statsNeighbour = m_LabelStatistic[ neighbour ];
-      assert( statsLabel.Size() == statsNeighbour.Size() );
-      
-      double distance = (statsLabel - statsNeighbour).GetSquaredNorm();
-      if (distance < proximity)
+      double proximity = itk::NumericTraits<double>::max();
+      InputLabelType label = edges[sourceBegin[source]].first;
+      InputLabelType closestNeighbour = label;
+      auto const & statsLabel = labelStatistic.at( label );
+
+      for (std::size_t i = sourceBegin[source]; i < sourceBegin[source+1]; i++)
         {
-        proximity = distance;
-        closestNeighbour = neighbour;
+        auto const & statsNeighbour = labelStatistic.at( edges[i].second );
+        assert( statsLabel.Size() == statsNeighbour.Size() );
+
+        double distance = (statsLabel - statsNeighbour).GetSquaredNorm();
+        if (distance < proximity)
+          {
+          proximity = distance;
+          closestNeighbour = edges[i].second;
+          }
         }
+      closestNeighbours[source] = closestNeighbour;
       }
+    });
+
+  // Dense indices of the labels involved in a merge, in increasing label 
+  // order. All these labels are roots of the LUT.
+  std::vector<InputLabelType> nodes;
+  nodes.reserve(2 * nbSources);
+  for (std::size_t source = 0; source < nbSources; source++)
+    {
+    nodes.push_back(edges[sourceBegin[source]].first);
+    }
+  nodes.insert(nodes.end(), closestNeighbours.begin(), closestNeighbours.end());
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+  auto nodeIndex = [&nodes](InputLabelType label)
+    {
+    return static_cast<std::size_t>
+      (std::lower_bound(nodes.begin(), nodes.end(), label) - nodes.begin());
+    };
 
-    auto curLabelLUT = FindCorrespondingLabel(label);
-    auto adjLabelLUT = FindCorrespondingLabel(closestNeighbour);
+  // Concurrent union-find. The largest root is always linked to the 
+  // smallest one (this prevents cycles like LUT[i]=j and LUT[j]=i), so each
+  // component ends up with its smallest label as root, whatever the order in
+  // which the merges are done.
+  std::vector<std::atomic<std::size_t> > parents(nodes.size());
+  for (std::size_t i = 0; i < nodes.size(); i++)
+    {
+    parents[i].store(i);
+    }
 
-    // Keep the smallest label (this prevents infinite loop in the LUT 
-    // (like LUT[i]=j and LUT[j]=i)
-    if(curLabelLUT < adjLabelLUT)
+  auto findRoot = [&parents](std::size_t node)
+    {
+    std::size_t parent = parents[node].load();
+    while (parent != node)
       {
-      m_LUT[adjLabelLUT] = curLabelLUT;
+      // Path halving
+      std::size_t grandParent = parents[parent].load();
+      if (grandParent != parent)
+        {
+        parents[node].compare_exchange_weak(parent, grandParent);
+        }
+      node = grandParent;
+      parent = parents[node].load();
       }
-    else
+    return node;
+    };
+
+  ParallelFor(nbSources, this->GetNumberOfThreads(),
+    [&](std::size_t begin, std::size_t end, itk::ThreadIdType)
+    {
+    for (std::size_t source = begin; source < end; source++)
       {
-      m_LUT[curLabelLUT] = adjLabelLUT;
+      std::size_t first = nodeIndex(edges[sourceBegin[source]].first);
+      std::size_t second = nodeIndex(closestNeighbours[source]);
+      while (true)
+        {
+        first = findRoot(first);
+        second = findRoot(second);
+        if (first == second)
+          {
+          break;
+          }
+        if (first < second)
+          {
+          std::swap(first, second);
+          }
+        std::size_t expected = first;
+        if (parents[first].compare_exchange_strong(expected, second))
+          {
+          break;
+          }
+        }
       }
-    }
-    
-  // Update the LUT
-  for (auto & label : m_LUT)
+    });
+
+  // Link the merged roots to their new root. Only the values of existing 
+  // keys are modified, so the LUT can be accessed concurrently.
+  ParallelFor(nodes.size(), this->GetNumberOfThreads(),
+    [&](std::size_t begin, std::size_t end, itk::ThreadIdType)
     {
-    label.second = FindCorrespondingLabel( label.first );
-    }
+    for (std::size_t i = begin; i < end; i++)
+      {
+      std::size_t root = findRoot(i);
+      if (root != i)
+        {
+        m_LUT.find(nodes[i])->second = nodes[root];
+        }
+      }
+    });
+
+  // Update the LUT : labels pointing to a merged root now point to its new 
+  // root (the LUT is always fully compressed, so one lookup is enough). The
+  // values read are the ones of the roots, which are not modified here.
+  ParallelFor(m_LUT.bucket_count(), this->GetNumberOfThreads(),
+    [this](std::size_t begin, std::size_t end, itk::ThreadIdType)
+    {
+    for (std::size_t bucket = begin; bucket < end; bucket++)
+      {
+      for (auto label = m_LUT.begin(bucket); label != m_LUT.end(bucket); ++label)
+        {
+        if (label->second != label->first)
+          {
+          auto root = m_LUT.find(label->second)->second;
+          if (root != label->second)
+            {
+            label->second = root;
+            }
+          }
+        }
+      }
+    });
   
   // Update statistics : for each newly merged segments, sum the population, and
-  // recompute the mean.
+  // recompute the mean. The LUT is iterated in its own order so that the
+  // statistics are accumulated in the same order as before.
   for (auto const & label : m_LUT)
     {
-    if ((label.second != label.first) && (m_LabelPopulation[label.first]!=0))
+    if ((label.second != label.first) 
+      && std::binary_search(nodes.begin(), nodes.end(), label.first)
+      && (m_LabelPopulation[label.first]!=0))
       {
       // Cache values to reduce number of lookups
       auto const & populationFirst = m_LabelPopulation[label.first];
@@ -196,6 +322,16 @@ PersistentLabelImageSmallRegionMergingFilter< TInputLabelImage >
   return correspondingLabel;
 }
 
+template <class TInputLabelImage >
+typename PersistentLabelImageSmallRegionMergingFilter< TInputLabelImage >
+::InputLabelType
+PersistentLabelImageSmallRegionMergingFilter< TInputLabelImage >
+::LookupLabel( InputLabelType label) const
+{
+  auto it = m_LUT.find(label);
+  return it != m_LUT.end() ? it->second : label;
+}
+
 template <class TInputLabelImage >
 void
 PersistentLabelImageSmallRegionMergingFilter< TInputLabelImage >
@@ -266,21 +402,43 @@ PersistentLabelImageSmallRegionMergingFilter< TInputLabelImage >
   typename IteratorType::OffsetType left = {{-1,0}};
   itN.ActivateOffset(left);
   
+  auto & edges = m_EdgesTmp[threadId];
+
+  // Consecutive pixels often have the same label, cache the last lookups
+  bool first = true;
+  InputLabelType previousLabel = 0;
+  InputLabelType currentLabel = 0;
+  bool isSmall = false;
+
   for (it.GoToBegin(); ! it.IsAtEnd(); ++it, ++itN)
     {
     assert( !itN.IsAtEnd() );
-    int currentLabel = m_LUT[ it.Get() ];
+    if (first || it.Get() != previousLabel)
+      {
+      first = false;
+      previousLabel = it.Get();
+      currentLabel = LookupLabel( previousLabel );
+      auto population = m_LabelPopulation.find(currentLabel);
+      isSmall = population != m_LabelPopulation.end() 
+                && population->second == m_Size;
+      }
     
-    if ( m_LabelPopulation[currentLabel] == m_Size )
+    if ( isSmall )
       {
       for (auto ci = itN.Begin() ; !ci.IsAtEnd(); ci++)
         {
-        int neighbourLabel = m_LUT[ ci.Get() ];
-        if (neighbourLabel != currentLabel)
-          m_NeighboursMapsTmp[threadId][ currentLabel ].insert(neighbourLabel);
+        InputLabelType neighbourLabel = LookupLabel( ci.Get() );
+        if (neighbourLabel != currentLabel 
+          && (edges.empty() || edges.back() != EdgeType(currentLabel, neighbourLabel)))
+          {
+          edges.push_back(EdgeType(currentLabel, neighbourLabel));
+          }
         }
       }
     }
+
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
 }
 
 template <class TInputLabelImage >
@@ -22,8 +22,13 @@
 #define otbLabelImageToOGRDataSourceFilter_h
 
 #include "itkProcessObject.h"
+#include "itkRegionOfInterestImageFilter.h"
 #include "otbOGRDataSourceWrapper.h"
+#include "otbParallelFor.h"
 #include <string>
+#include <vector>
+
+class GDALDataset;
 
 namespace otb
 {
@@ -37,7 +42,29 @@ namespace otb
  *  All pixels with a value of 0 in the input mask image will not be suitable for vectorization.
  * \note The Use8Connected parameter can be turn on and it will be used in \c GDALPolygonize(). But be carreful, it
  * can create cross polygons !
- * \note It is a non-streamed version.
+ *
+ * If a tile size is set with \c SetTileSize(), the image is streamed and
+ * polygonized by tiles: the tiles are requested from the upstream pipeline
+ * one at a time, and up to GetNumberOfThreads() tiles are polygonized in
+ * parallel. Each tile is extended by one pixel on its right and bottom
+ * sides so that neighbouring tiles overlap. Polygons which do not touch an
+ * inner tile border are written as soon as their tile is done, in the tile
+ * order. The others are grouped by label, and the pieces of a label are
+ * merged with a cascaded union as soon as no tile left to process can
+ * contain its pixels, that is when they all end above the next tiles. Only
+ * the pieces of the labels crossing the current row of tiles are held in
+ * memory. Pieces of the same label which are not connected stay separate
+ * features, so the output is the same as the non-tiled one up to the order
+ * of the features and collinear vertices along tile borders. With the
+ * 8-connected option, polygons which touch only by a corner on a tile
+ * border are not merged.
+ *
+ * By default, the polygons are written in a "memory" \c OGRDataSource,
+ * returned by GetOutput(). A layer set with \c SetOGRLayer() (for instance
+ * a layer of a file datasource) receives them instead, and GetOutput() is
+ * then empty.
+ *
+ * \note Without tile size, the whole input image is requested.
  * \ingroup OBIA
  *
  *
@@ -76,6 +103,8 @@ public:
   typedef typename OGRDataSourceType::Pointer        OGRDataSourcePointerType;
   typedef ogr::Layer                                 OGRLayerType;
 
+  typedef itk::RegionOfInterestImageFilter<InputImageType, InputImageType> ExtractFilterType;
+
   typedef itk::ProcessObject::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
 
   /** Set/Get the input image of this process object.  */
@@ -108,6 +137,23 @@ public:
    */
   itkGetMacro(Use8Connected, bool);
 
+  /**
+   * Set/Get the size of the tiles streamed and polygonized in parallel. If 0
+   * (default), the whole image is polygonized at once.
+   */
+  itkSetMacro(TileSize, unsigned int);
+  itkGetMacro(TileSize, unsigned int);
+
+  /**
+   * Set the layer in which the polygons are written instead of the output
+   * "memory" datasource. The field FieldName is created if it does not exist.
+   */
+  void SetOGRLayer(const OGRLayerType & layer);
+  /**
+   * Get the layer in which the polygons are written, if any.
+   */
+  const OGRLayerType & GetOGRLayer() const;
+
   /**
    * Get the output \c ogr::DataSource which is a "memory" datasource.
    */
@@ -128,13 +174,39 @@ protected:
   DataObjectPointer MakeOutput(DataObjectPointerArraySizeType idx) override;
   using Superclass::MakeOutput;
 
+  /** Compute the GDAL geo transform of a region of an image */
+  void ComputeGeoTransform(const InputImageType * image, const RegionType & region, double geoTransform[6]) const;
+
+  /** Wrap a region of the buffer of an image in a GDAL "MEM" dataset, with
+   * the corresponding projection and geo transform */
+  GDALDataset * CreateMemDataset(const InputImageType * image, const RegionType & region) const;
+
+  /** Polygonize the buffered region of an image (and of its mask) into a
+   * layer, writing the labels in the field fieldIndex */
+  void Polygonize(const InputImageType * image, const InputImageType * mask,
+                  OGRLayerType & layer, int fieldIndex) const;
+
+  /** True if the input is polygonized by tiles */
+  bool IsTiled();
+
+  /** Compute the tiles of the input, extended by one pixel on their right
+   * and bottom sides */
+  void ComputeTiles(std::vector<RegionType> & tiles);
+
+  /** Update the upstream pipeline on a tile, and return the tile image */
+  typename InputImageType::Pointer ExtractTile(const InputImageType * image, const RegionType & tile) const;
+
+  /** Polygonize the image by tiles and merge the polygons across tiles */
+  void GenerateTiledData(OGRLayerType & outputLayer, int fieldIndex);
+
 private:
   LabelImageToOGRDataSourceFilter(const Self &) = delete;
   void operator =(const Self&) = delete;
 
   std::string m_FieldName;
   bool m_Use8Connected;
-
+  unsigned int m_TileSize;
+  OGRLayerType m_OGRLayer;
 
 };
 
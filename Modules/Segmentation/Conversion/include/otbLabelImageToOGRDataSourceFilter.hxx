@@ -23,20 +23,30 @@
 
 #include "otbLabelImageToOGRDataSourceFilter.h"
 #include "otbGdalDataTypeBridge.h"
+#include "otbOGRFeatureWrapper.h"
+#include "otbOGRGeometryWrapper.h"
 
 //gdal libraries
 #include "gdal.h"
 #include "gdal_priv.h"
 #include "cpl_conv.h"
 #include "gdal_alg.h"
+#include "ogr_geometry.h"
 
 #include "stdint.h" //needed for uintptr_t
 
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
 namespace otb
 {
 template <class TInputImage>
 LabelImageToOGRDataSourceFilter<TInputImage>
-::LabelImageToOGRDataSourceFilter() : m_FieldName("DN"), m_Use8Connected(false)
+::LabelImageToOGRDataSourceFilter()
+  : m_FieldName("DN"), m_Use8Connected(false), m_TileSize(0), m_OGRLayer(nullptr, false)
 {
    this->SetNumberOfRequiredInputs(2);
    this->SetNumberOfRequiredInputs(1);
@@ -109,6 +119,56 @@ LabelImageToOGRDataSourceFilter<TInputImage>
   return static_cast<const InputImageType *>(this->Superclass::GetInput(1));
 }
 
+template <class TInputImage>
+void
+LabelImageToOGRDataSourceFilter<TInputImage>
+::SetOGRLayer(const OGRLayerType & layer)
+{
+  m_OGRLayer = layer;
+  this->Modified();
+}
+
+template <class TInputImage>
+const typename LabelImageToOGRDataSourceFilter<TInputImage>::OGRLayerType &
+LabelImageToOGRDataSourceFilter<TInputImage>
+::GetOGRLayer() const
+{
+  return m_OGRLayer;
+}
+
+template <class TInputImage>
+bool
+LabelImageToOGRDataSourceFilter<TInputImage>
+::IsTiled()
+{
+  const SizeType & size = this->GetInput()->GetLargestPossibleRegion().GetSize();
+  return m_TileSize != 0 && (size[0] > m_TileSize || size[1] > m_TileSize);
+}
+
+template <class TInputImage>
+void
+LabelImageToOGRDataSourceFilter<TInputImage>
+::ComputeTiles(std::vector<RegionType> & tiles)
+{
+  const RegionType & largestRegion = this->GetInput()->GetLargestPossibleRegion();
+  const IndexType & start = largestRegion.GetIndex();
+  const SizeType & size = largestRegion.GetSize();
+
+  tiles.clear();
+  for (unsigned long y = 0; y < size[1]; y += m_TileSize)
+    {
+    for (unsigned long x = 0; x < size[0]; x += m_TileSize)
+      {
+      RegionType tile;
+      tile.SetIndex(0, start[0] + x);
+      tile.SetIndex(1, start[1] + y);
+      tile.SetSize(0, std::min<unsigned long>(m_TileSize + 1, size[0] - x));
+      tile.SetSize(1, std::min<unsigned long>(m_TileSize + 1, size[1] - y));
+      tiles.push_back(tile);
+      }
+    }
+}
+
 template <class TInputImage>
 void
 LabelImageToOGRDataSourceFilter<TInputImage>
@@ -125,8 +185,18 @@ LabelImageToOGRDataSourceFilter<TInputImage>
     {
     return;
     }
-  // The input is necessarily the largest possible region.
-  input->SetRequestedRegionToLargestPossibleRegion();
+
+  // Without tiles, the input is necessarily the largest possible region.
+  // Otherwise, the tiles are requested one by one in GenerateData(), and
+  // the first one is requested here.
+  RegionType requestedRegion = input->GetLargestPossibleRegion();
+  if (this->IsTiled())
+    {
+    std::vector<RegionType> tiles;
+    this->ComputeTiles(tiles);
+    requestedRegion = tiles.front();
+    }
+  input->SetRequestedRegion(requestedRegion);
 
   typename InputImageType::Pointer mask  =
     const_cast<InputImageType *> (this->GetInputMask());
@@ -134,161 +204,375 @@ LabelImageToOGRDataSourceFilter<TInputImage>
   {
    return;
   }
-  // The input is necessarily the largest possible region.
-  mask->SetRequestedRegionToLargestPossibleRegion();
+  mask->SetRequestedRegion(requestedRegion);
+}
+
+template <class TInputImage>
+void
+LabelImageToOGRDataSourceFilter<TInputImage>
+::ComputeGeoTransform(const InputImageType * image, const RegionType & region, double geoTransform[6]) const
+{
+  unsigned int projSize = image->GetGeoTransform().size();
+
+  //Set the geo transform of the input image (if any)
+  // Reporting origin and spacing of the region
+  // the spacing is unchanged, the origin is relative to the region
+  IndexType  regionIndexOrigin = region.GetIndex();
+  OriginType  regionOrigin;
+  image->TransformIndexToPhysicalPoint(regionIndexOrigin, regionOrigin);
+  geoTransform[0] = regionOrigin[0] - 0.5 * image->GetSignedSpacing()[0];
+  geoTransform[3] = regionOrigin[1] - 0.5 * image->GetSignedSpacing()[1];
+  geoTransform[1] = image->GetSignedSpacing()[0];
+  geoTransform[5] = image->GetSignedSpacing()[1];
+  // FIXME: Here component 1 and 4 should be replaced by the orientation parameters
+  if (projSize == 0)
+  {
+    geoTransform[2] = 0.;
+    geoTransform[4] = 0.;
+  }
+  else
+  {
+    geoTransform[2] = image->GetGeoTransform()[2];
+    geoTransform[4] = image->GetGeoTransform()[4];
+  }
+}
+
+template <class TInputImage>
+GDALDataset *
+LabelImageToOGRDataSourceFilter<TInputImage>
+::CreateMemDataset(const InputImageType * image, const RegionType & region) const
+{
+  const RegionType & bufferedRegion = image->GetBufferedRegion();
+  const unsigned int nbBands = image->GetNumberOfComponentsPerPixel();
+  const unsigned int bytePerPixel = sizeof(InputPixelType);
+
+  // Address of the first pixel of the region in the buffer
+  const InputPixelType * buffer = image->GetBufferPointer()
+    + image->ComputeOffset(region.GetIndex()) * nbBands;
+
+  // buffer casted in unsigned long cause under Win32 the address
+  // don't begin with 0x, the address in not interpreted as
+  // hexadecimal but alpha numeric value, then the conversion to
+  // integer make us pointing to an non allowed memory block => Crash.
+  std::ostringstream stream;
+  stream << "MEM:::"
+         <<  "DATAPOINTER=" << (uintptr_t)(buffer) << ","
+         <<  "PIXELS=" << region.GetSize()[0] << ","
+         <<  "LINES=" << region.GetSize()[1] << ","
+         <<  "BANDS=" << nbBands << ","
+         <<  "DATATYPE=" << GDALGetDataTypeName(GdalDataTypeBridge::GetGDALDataType<InputPixelType>()) << ","
+         <<  "PIXELOFFSET=" << bytePerPixel * nbBands << ","
+         <<  "LINEOFFSET=" << bytePerPixel * nbBands * bufferedRegion.GetSize()[0] << ","
+         <<  "BANDOFFSET=" << bytePerPixel;
+
+  GDALDataset * dataset = static_cast<GDALDataset *> (GDALOpen(stream.str().c_str(), GA_ReadOnly));
+
+  //Set input Projection ref and Geo transform to the dataset.
+  dataset->SetProjection(image->GetProjectionRef().c_str());
+
+  double geoTransform[6];
+  this->ComputeGeoTransform(image, region, geoTransform);
+  dataset->SetGeoTransform(geoTransform);
+
+  return dataset;
+}
+
+template <class TInputImage>
+void
+LabelImageToOGRDataSourceFilter<TInputImage>
+::Polygonize(const InputImageType * image, const InputImageType * mask,
+             OGRLayerType & layer, int fieldIndex) const
+{
+  //Call GDALPolygonize()
+  char ** options;
+  options = nullptr;
+  char * option[2]= { nullptr , nullptr } ;
+  std::string opt("8CONNECTED:8");
+  if (m_Use8Connected == true)
+  {
+    option[0] = const_cast<char *>(opt.c_str());
+    options=option;
+  }
+
+  const RegionType & region = image->GetBufferedRegion();
+  GDALDataset * dataset = this->CreateMemDataset(image, region);
+
+  /* Convert the mask input into a GDAL raster needed by GDALPolygonize */
+  if (mask != nullptr)
+  {
+    GDALDataset * maskDataset = this->CreateMemDataset(mask, region);
+    GDALPolygonize(dataset->GetRasterBand(1), maskDataset->GetRasterBand(1), &layer.ogr(), fieldIndex, options, nullptr, nullptr);
+    GDALClose(maskDataset);
+  }
+  else
+  {
+    GDALPolygonize(dataset->GetRasterBand(1), nullptr, &layer.ogr(), fieldIndex, options, nullptr, nullptr);
+  }
+
+  //Clear memory
+  GDALClose(dataset);
 }
 
+template <class TInputImage>
+typename TInputImage::Pointer
+LabelImageToOGRDataSourceFilter<TInputImage>
+::ExtractTile(const InputImageType * image, const RegionType & tile) const
+{
+  typename ExtractFilterType::Pointer extract = ExtractFilterType::New();
+  extract->SetInput(image);
+  extract->SetRegionOfInterest(tile);
+  extract->Update();
+
+  typename InputImageType::Pointer tileImage = extract->GetOutput();
+  tileImage->DisconnectPipeline();
+  // Keep the geo transform and the projection of the input
+  tileImage->SetMetaDataDictionary(image->GetMetaDataDictionary());
+  return tileImage;
+}
 
 template <class TInputImage>
 void
 LabelImageToOGRDataSourceFilter<TInputImage>
 ::GenerateData(void)
 {
-   if (this->GetInput()->GetRequestedRegion() != this->GetInput()->GetLargestPossibleRegion())
+    if (!this->IsTiled()
+        && this->GetInput()->GetRequestedRegion() != this->GetInput()->GetLargestPossibleRegion())
     {
     itkExceptionMacro(<< "Not streamed filter. ERROR : requested region is not the largest possible region.");
     }
 
-    SizeType size;
-    unsigned int nbBands = 0;
-    unsigned int bytePerPixel = 0;
-
-    /* Convert the input image into a GDAL raster needed by GDALPolygonize */
-    size = this->GetInput()->GetLargestPossibleRegion().GetSize();
-    nbBands = this->GetInput()->GetNumberOfComponentsPerPixel();
-    bytePerPixel = sizeof(InputPixelType);
-
-    // buffer casted in unsigned long cause under Win32 the address
-    // don't begin with 0x, the address in not interpreted as
-    // hexadecimal but alpha numeric value, then the conversion to
-    // integer make us pointing to an non allowed memory block => Crash.
-    std::ostringstream stream;
-    stream << "MEM:::"
-           <<  "DATAPOINTER=" << (uintptr_t)(this->GetInput()->GetBufferPointer()) << ","
-           <<  "PIXELS=" << size[0] << ","
-           <<  "LINES=" << size[1] << ","
-           <<  "BANDS=" << nbBands << ","
-           <<  "DATATYPE=" << GDALGetDataTypeName(GdalDataTypeBridge::GetGDALDataType<InputPixelType>()) << ","
-           <<  "PIXELOFFSET=" << bytePerPixel * nbBands << ","
-           <<  "LINEOFFSET=" << bytePerPixel * nbBands * size[0] << ","
-           <<  "BANDOFFSET=" << bytePerPixel;
-
-    GDALDataset * dataset = static_cast<GDALDataset *> (GDALOpen(stream.str().c_str(), GA_ReadOnly));
-
-    //Set input Projection ref and Geo transform to the dataset.
-    dataset->SetProjection(this->GetInput()->GetProjectionRef().c_str());
-
-    unsigned int projSize = this->GetInput()->GetGeoTransform().size();
-    double geoTransform[6];
-
-    //Set the geo transform of the input image (if any)
-    // Reporting origin and spacing of the buffered region
-    // the spacing is unchanged, the origin is relative to the buffered region
-    IndexType  bufferIndexOrigin = this->GetInput()->GetBufferedRegion().GetIndex();
-    OriginType  bufferOrigin;
-    this->GetInput()->TransformIndexToPhysicalPoint(bufferIndexOrigin, bufferOrigin);
-    geoTransform[0] = bufferOrigin[0] - 0.5 * this->GetInput()->GetSignedSpacing()[0];
-    geoTransform[3] = bufferOrigin[1] - 0.5 * this->GetInput()->GetSignedSpacing()[1];
-    geoTransform[1] = this->GetInput()->GetSignedSpacing()[0];
-    geoTransform[5] = this->GetInput()->GetSignedSpacing()[1];
-    // FIXME: Here component 1 and 4 should be replaced by the orientation parameters
-    if (projSize == 0)
+    //Create the output layer for GDALPolygonize().
+    ogr::DataSource::Pointer ogrDS = ogr::DataSource::New();
+
+    OGRLayerType outputLayer = m_OGRLayer;
+    if (!outputLayer)
     {
-      geoTransform[2] = 0.;
-      geoTransform[4] = 0.;
+      outputLayer = ogrDS->CreateLayer("layer",nullptr,wkbPolygon);
+    }
+
+    int fieldIndex = outputLayer.GetLayerDefn().GetFieldIndex(m_FieldName.c_str());
+    if (fieldIndex < 0)
+    {
+      OGRFieldDefn field(m_FieldName.c_str(),OFTInteger);
+      outputLayer.CreateField(field, true);
+      fieldIndex = outputLayer.GetLayerDefn().GetFieldIndex(m_FieldName.c_str());
+    }
+
+    if (!this->IsTiled())
+    {
+      this->Polygonize(this->GetInput(), this->GetInputMask(), outputLayer, fieldIndex);
     }
     else
     {
-      geoTransform[2] = this->GetInput()->GetGeoTransform()[2];
-      geoTransform[4] = this->GetInput()->GetGeoTransform()[4];
+      this->GenerateTiledData(outputLayer, fieldIndex);
     }
-    dataset->SetGeoTransform(geoTransform);
 
-    //Create the output layer for GDALPolygonize().
-    ogr::DataSource::Pointer ogrDS = ogr::DataSource::New();
+    this->SetNthOutput(0,ogrDS);
+}
+
+template <class TInputImage>
+void
+LabelImageToOGRDataSourceFilter<TInputImage>
+::GenerateTiledData(OGRLayerType & outputLayer, int fieldIndex)
+{
+  typedef std::unique_ptr<OGRGeometry, ogr::internal::GeometryDeleter> GeometryPointerType;
+  typedef std::vector< std::pair<int, GeometryPointerType> >         PolygonListType;
 
-    OGRLayerType outputLayer = ogrDS->CreateLayer("layer",nullptr,wkbPolygon);
+  /** Pieces of the polygons of a label touching an inner tile border, with
+   * the last image row they cover */
+  struct BorderPiecesType
+  {
+    double LastRow = 0.;
+    std::vector<GeometryPointerType> Pieces;
+  };
 
-    OGRFieldDefn field(m_FieldName.c_str(),OFTInteger);
-    outputLayer.CreateField(field, true);
+  const InputImageType * input = this->GetInput();
+  const InputImageType * mask = this->GetInputMask();
+  const RegionType & largestRegion = input->GetLargestPossibleRegion();
 
-    //Call GDALPolygonize()
-    char ** options;
-    options = nullptr;
-    char * option[2]= { nullptr , nullptr } ;
-    if (m_Use8Connected == true)
-    {
-      std::string opt("8CONNECTED:8");
-      option[0] = const_cast<char *>(opt.c_str());
-      options=option;
-    }
+  // Tiles, extended by one pixel on their right and bottom sides
+  std::vector<RegionType> tiles;
+  this->ComputeTiles(tiles);
 
-    /* Convert the mask input into a GDAL raster needed by GDALPolygonize */
-    typename InputImageType::ConstPointer inputMask = this->GetInputMask();
-    if (!inputMask.IsNull())
-    {
-      size = this->GetInputMask()->GetLargestPossibleRegion().GetSize();
-      nbBands = this->GetInputMask()->GetNumberOfComponentsPerPixel();
-      bytePerPixel = sizeof(InputPixelType);
-      // buffer casted in unsigned long cause under Win32 the address
-      // don't begin with 0x, the address in not interpreted as
-      // hexadecimal but alpha numeric value, then the conversion to
-      // integer make us pointing to an non allowed memory block => Crash.
-      std::ostringstream maskstream;
-      maskstream << "MEM:::"
-            <<  "DATAPOINTER=" << (uintptr_t)(this->GetInputMask()->GetBufferPointer()) << ","
-            <<  "PIXELS=" << size[0] << ","
-            <<  "LINES=" << size[1] << ","
-            <<  "BANDS=" << nbBands << ","
-            <<  "DATATYPE=" << GDALGetDataTypeName(GdalDataTypeBridge::GetGDALDataType<InputPixelType>()) << ","
-            <<  "PIXELOFFSET=" << bytePerPixel * nbBands << ","
-            <<  "LINEOFFSET=" << bytePerPixel * nbBands * size[0] << ","
-            <<  "BANDOFFSET=" << bytePerPixel;
-
-      GDALDataset * maskDataset = static_cast<GDALDataset *> (GDALOpen(maskstream.str().c_str(), GA_ReadOnly));
-
-      //Set input Projection ref and Geo transform to the dataset.
-      maskDataset->SetProjection(this->GetInputMask()->GetProjectionRef().c_str());
-
-      projSize = this->GetInputMask()->GetGeoTransform().size();
-
-      //Set the geo transform of the input mask image (if any)
-      // Reporting origin and spacing of the buffered region
-      // the spacing is unchanged, the origin is relative to the buffered region
-      bufferIndexOrigin = this->GetInputMask()->GetBufferedRegion().GetIndex();
-      this->GetInputMask()->TransformIndexToPhysicalPoint(bufferIndexOrigin, bufferOrigin);
-      geoTransform[0] = bufferOrigin[0] - 0.5 * this->GetInputMask()->GetSignedSpacing()[0];
-      geoTransform[3] = bufferOrigin[1] - 0.5 * this->GetInputMask()->GetSignedSpacing()[1];
-      geoTransform[1] = this->GetInputMask()->GetSignedSpacing()[0];
-      geoTransform[5] = this->GetInputMask()->GetSignedSpacing()[1];
-      // FIXME: Here component 1 and 4 should be replaced by the orientation parameters
-      if (projSize == 0)
+  std::map<int, BorderPiecesType> borderPolygons;
+
+  auto writePolygons = [&outputLayer, fieldIndex](PolygonListType & polygons)
+  {
+    for (auto & polygon : polygons)
       {
-         geoTransform[2] = 0.;
-         geoTransform[4] = 0.;
+      ogr::Feature feature(outputLayer.GetLayerDefn());
+      feature.ogr().SetField(fieldIndex, polygon.first);
+      feature.SetGeometryDirectly(ogr::UniqueGeometryPtr(polygon.second.release()));
+      outputLayer.CreateFeature(feature);
       }
-      else
+    PolygonListType().swap(polygons);
+  };
+
+  const std::size_t batchSize = std::max<std::size_t>(this->GetNumberOfThreads(), 1);
+  for (std::size_t batchStart = 0; batchStart < tiles.size(); batchStart += batchSize)
+    {
+    const std::size_t batchEnd = std::min(batchStart + batchSize, tiles.size());
+    const std::size_t nbTiles = batchEnd - batchStart;
+
+    // The upstream pipeline is updated on one tile at a time
+    std::vector<typename InputImageType::Pointer> tileImages(nbTiles);
+    std::vector<typename InputImageType::Pointer> tileMasks(nbTiles);
+    for (std::size_t k = 0; k < nbTiles; ++k)
       {
-         geoTransform[2] = this->GetInputMask()->GetGeoTransform()[2];
-         geoTransform[4] = this->GetInputMask()->GetGeoTransform()[4];
+      tileImages[k] = this->ExtractTile(input, tiles[batchStart + k]);
+      if (mask != nullptr)
+        {
+        tileMasks[k] = this->ExtractTile(mask, tiles[batchStart + k]);
+        }
       }
-      maskDataset->SetGeoTransform(geoTransform);
 
-      GDALPolygonize(dataset->GetRasterBand(1), maskDataset->GetRasterBand(1), &outputLayer.ogr(), 0, options, nullptr, nullptr);
-      GDALClose(maskDataset);
-    }
-    else
-    {
-      GDALPolygonize(dataset->GetRasterBand(1), nullptr, &outputLayer.ogr(), 0, options, nullptr, nullptr);
-    }
+    std::vector<PolygonListType> innerPolygons(nbTiles);
+    std::vector< std::vector< std::pair<double, std::pair<int, GeometryPointerType> > > > tileBorderPolygons(nbTiles);
 
-    this->SetNthOutput(0,ogrDS);
+    ParallelFor(nbTiles, this->GetNumberOfThreads(),
+      [&](std::size_t begin, std::size_t end, itk::ThreadIdType)
+      {
+      for (std::size_t k = begin; k < end; ++k)
+        {
+        const RegionType & tile = tiles[batchStart + k];
+
+        ogr::DataSource::Pointer tileDS = ogr::DataSource::New();
+        OGRLayerType tileLayer = tileDS->CreateLayer("layer", nullptr, wkbPolygon);
+        OGRFieldDefn field(m_FieldName.c_str(), OFTInteger);
+        tileLayer.CreateField(field, true);
+
+        this->Polygonize(tileImages[k], tileMasks[k], tileLayer, 0);
+
+        // Tile sides which are inside the image
+        bool innerSide[4];
+        innerSide[0] = tile.GetIndex(0) > largestRegion.GetIndex(0);
+        innerSide[1] = tile.GetIndex(0) + tile.GetSize(0) < largestRegion.GetIndex(0) + largestRegion.GetSize(0);
+        innerSide[2] = tile.GetIndex(1) > largestRegion.GetIndex(1);
+        innerSide[3] = tile.GetIndex(1) + tile.GetSize(1) < largestRegion.GetIndex(1) + largestRegion.GetSize(1);
+
+        double geoTransform[6];
+        this->ComputeGeoTransform(tileImages[k], tileImages[k]->GetBufferedRegion(), geoTransform);
+
+        tileLayer.ogr().ResetReading();
+        for (OGRFeature * feature = tileLayer.ogr().GetNextFeature(); feature != nullptr;
+             feature = tileLayer.ogr().GetNextFeature())
+          {
+          const int label = feature->GetFieldAsInteger(0);
+          GeometryPointerType geometry(feature->StealGeometry());
+          OGRFeature::DestroyFeature(feature);
+          if (!geometry)
+            {
+            continue;
+            }
+
+          // Envelope in pixel coordinates relative to the tile
+          OGREnvelope envelope;
+          geometry->getEnvelope(&envelope);
+          const double col1 = (envelope.MinX - geoTransform[0]) / geoTransform[1];
+          const double col2 = (envelope.MaxX - geoTransform[0]) / geoTransform[1];
+          const double row1 = (envelope.MinY - geoTransform[3]) / geoTransform[5];
+          const double row2 = (envelope.MaxY - geoTransform[3]) / geoTransform[5];
+          const bool onBorder =
+            (innerSide[0] && std::min(col1, col2) < 0.5)
+            || (innerSide[1] && std::max(col1, col2) > tile.GetSize(0) - 0.5)
+            || (innerSide[2] && std::min(row1, row2) < 0.5)
+            || (innerSide[3] && std::max(row1, row2) > tile.GetSize(1) - 0.5);
+
+          if (onBorder)
+            {
+            const double lastRow = tile.GetIndex(1) + std::max(row1, row2);
+            tileBorderPolygons[k].emplace_back(lastRow, std::make_pair(label, std::move(geometry)));
+            }
+          else
+            {
+            innerPolygons[k].emplace_back(label, std::move(geometry));
+            }
+          }
+        }
+      });
+
+    tileImages.clear();
+    tileMasks.clear();
+
+    // Write the inner polygons in the tile order, and keep the border ones
+    for (std::size_t k = 0; k < nbTiles; ++k)
+      {
+      writePolygons(innerPolygons[k]);
+      for (auto & polygon : tileBorderPolygons[k])
+        {
+        auto & pieces = borderPolygons[polygon.second.first];
+        pieces.LastRow = std::max(pieces.LastRow, polygon.first);
+        pieces.Pieces.push_back(std::move(polygon.second.second));
+        }
+      }
 
-    //Clear memory
-    GDALClose(dataset);
+    // The remaining tiles start at the first row of the next tile, or
+    // after. A label whose pieces all end above it is complete.
+    std::vector<int> labels;
+    for (auto const & pieces : borderPolygons)
+      {
+      if (batchEnd == tiles.size() || pieces.second.LastRow < tiles[batchEnd].GetIndex(1) + 0.5)
+        {
+        labels.push_back(pieces.first);
+        }
+      }
 
-}
+    // Merge the pieces of each complete label
+    std::vector<PolygonListType> mergedPolygons(labels.size());
+    ParallelFor(labels.size(), this->GetNumberOfThreads(),
+      [&](std::size_t begin, std::size_t end, itk::ThreadIdType)
+      {
+      for (std::size_t id = begin; id < end; ++id)
+        {
+        const int label = labels[id];
+        // Each label is processed by a single thread, and the map is not
+        // modified meanwhile
+        auto & pieces = borderPolygons.find(label)->second.Pieces;
+        auto & merged = mergedPolygons[id];
+
+        if (pieces.size() == 1)
+          {
+          merged.emplace_back(label, std::move(pieces.front()));
+          continue;
+          }
+
+        OGRMultiPolygon multiPolygon;
+        for (auto & piece : pieces)
+          {
+          multiPolygon.addGeometryDirectly(piece.release());
+          }
+
+        ogr::UniqueGeometryPtr unionGeometry = ogr::UnionCascaded(multiPolygon);
+        if (!unionGeometry)
+          {
+          continue;
+          }
+
+        // Pieces which are not connected give separate polygons
+        if (wkbFlatten(unionGeometry->getGeometryType()) == wkbMultiPolygon)
+          {
+          auto polygons = static_cast<OGRMultiPolygon *>(unionGeometry.get());
+          for (int i = 0; i < polygons->getNumGeometries(); ++i)
+            {
+            merged.emplace_back(label, GeometryPointerType(polygons->getGeometryRef(i)->clone()));
+            }
+          }
+        else
+          {
+          merged.emplace_back(label, GeometryPointerType(unionGeometry.release()));
+          }
+        }
+      });
+
+    for (std::size_t id = 0; id < labels.size(); ++id)
+      {
+      writePolygons(mergedPolygons[id]);
+      borderPolygons.erase(labels[id]);
+      }
 
+    this->UpdateProgress(static_cast<float>(batchEnd) / tiles.size());
+    }
+}
 
 } // end namespace otb
 
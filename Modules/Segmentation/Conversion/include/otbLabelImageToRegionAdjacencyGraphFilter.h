@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbLabelImageToRegionAdjacencyGraphFilter_h
+#define otbLabelImageToRegionAdjacencyGraphFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "otbRegionAdjacencyGraph.h"
+#include "otbVectorImage.h"
+
+#include <vector>
+
+namespace otb
+{
+
+/** \class PersistentLabelImageToRegionAdjacencyGraphFilter
+ * \brief Build the region adjacency graph of a label image
+ *
+ * This filter computes the nodes and the edges of the region adjacency
+ * graph of the input label image, with the boundary length of each edge
+ * (4-connectivity) and the population of each node. If a support image is
+ * set with SetSupportImage(), the sum and sum of squares of its components
+ * are also computed for each node.
+ *
+ * This filter persists its temporary data: if it is updated on several
+ * requested regions, the graph is the one of the whole set of regions. Each
+ * pixel is compared to its next neighbour along each dimension, so that
+ * boundaries between tiles are counted exactly once. Each thread keeps
+ * compact sorted lists of nodes and edges, and the graph is built in CSR
+ * format by Synthetize().
+ *
+ * The support image is expected to be an otb::VectorImage.
+ *
+ * \sa RegionAdjacencyGraph
+ * \sa LabelImageToRegionAdjacencyGraphFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBConversion
+ */
+template <class TLabelImage, class TSupportImage = otb::VectorImage<float, TLabelImage::ImageDimension> >
+class ITK_EXPORT PersistentLabelImageToRegionAdjacencyGraphFilter
+  : public PersistentImageFilter<TLabelImage, TLabelImage>
+{
+public:
+  /** Standard class typedefs */
+  typedef PersistentLabelImageToRegionAdjacencyGraphFilter  Self;
+  typedef PersistentImageFilter<TLabelImage, TLabelImage>   Superclass;
+  typedef itk::SmartPointer<Self>                           Pointer;
+  typedef itk::SmartPointer<const Self>                     ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentLabelImageToRegionAdjacencyGraphFilter, PersistentImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TLabelImage::ImageDimension);
+
+  typedef TLabelImage                                   LabelImageType;
+  typedef typename LabelImageType::PixelType            LabelType;
+  typedef typename LabelImageType::RegionType           RegionType;
+  typedef typename LabelImageType::IndexType            IndexType;
+
+  typedef TSupportImage                                 SupportImageType;
+  typedef typename SupportImageType::InternalPixelType  SupportInternalPixelType;
+
+  typedef RegionAdjacencyGraph<LabelType>               RegionAdjacencyGraphType;
+  typedef typename RegionAdjacencyGraphType::Pointer    RegionAdjacencyGraphPointerType;
+  typedef typename RegionAdjacencyGraphType::CountType  CountType;
+  typedef typename RegionAdjacencyGraphType::EdgeType   EdgeType;
+  typedef typename RegionAdjacencyGraphType::EdgeListType EdgeListType;
+
+  /** Set the support image used to compute the node statistics (optional) */
+  void SetSupportImage(const SupportImageType * image);
+
+  /** Get the support image */
+  const SupportImageType * GetSupportImage() const;
+
+  /** Get the region adjacency graph, available after Synthetize() */
+  const RegionAdjacencyGraphType * GetRegionAdjacencyGraph() const;
+
+  void Reset(void) override;
+
+  void Synthetize(void) override;
+
+  /** Sort edges by (First, Second) and sum the boundary lengths of
+   * duplicated edges */
+  static void SortAndReduceEdges(EdgeListType & edges);
+
+protected:
+  PersistentLabelImageToRegionAdjacencyGraphFilter();
+  ~PersistentLabelImageToRegionAdjacencyGraphFilter() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  void GenerateOutputInformation() override;
+
+  /** The label image is padded by one pixel to access the next neighbours */
+  void GenerateInputRequestedRegion() override;
+
+  void AllocateOutputs() override;
+
+  void ThreadedGenerateData(const RegionType& outputRegionForThread,
+                            itk::ThreadIdType threadId) override;
+
+private:
+  PersistentLabelImageToRegionAdjacencyGraphFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Nodes and edges found by one thread, over all requested regions */
+  struct ThreadAccumulatorType
+  {
+    std::vector<LabelType> Labels;
+    std::vector<CountType> Populations;
+    std::vector<double>    Sums;
+    std::vector<double>    SquaredSums;
+    EdgeListType           Edges;
+    std::size_t            ReducedEdges;
+  };
+
+  std::vector<ThreadAccumulatorType> m_ThreadAccumulators;
+
+  unsigned int m_NumberOfComponents;
+
+  RegionAdjacencyGraphPointerType m_RegionAdjacencyGraph;
+};
+
+/** \class LabelImageToRegionAdjacencyGraphFilter
+ * \brief Build the region adjacency graph of a label image by streaming
+ *
+ * This class streams the label image (and the optional support image)
+ * through a PersistentLabelImageToRegionAdjacencyGraphFilter.
+ *
+ * \code
+ * typedef otb::LabelImageToRegionAdjacencyGraphFilter<LabelImageType, ImageType> RAGFilterType;
+ * RAGFilterType::Pointer ragFilter = RAGFilterType::New();
+ * ragFilter->SetInput(labelImage);
+ * ragFilter->SetSupportImage(image);
+ * ragFilter->Update();
+ * auto rag = ragFilter->GetRegionAdjacencyGraph();
+ * \endcode
+ *
+ * \sa RegionAdjacencyGraph
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBConversion
+ */
+template <class TLabelImage, class TSupportImage = otb::VectorImage<float, TLabelImage::ImageDimension> >
+class ITK_EXPORT LabelImageToRegionAdjacencyGraphFilter
+  : public PersistentFilterStreamingDecorator
+      <PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage> >
+{
+public:
+  /** Standard class typedefs */
+  typedef LabelImageToRegionAdjacencyGraphFilter Self;
+  typedef PersistentFilterStreamingDecorator
+    <PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage> > Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(LabelImageToRegionAdjacencyGraphFilter, PersistentFilterStreamingDecorator);
+
+  typedef TLabelImage                                                 LabelImageType;
+  typedef TSupportImage                                               SupportImageType;
+  typedef typename Superclass::FilterType::RegionAdjacencyGraphType   RegionAdjacencyGraphType;
+
+  /** Set the input label image */
+  using Superclass::SetInput;
+  void SetInput(const LabelImageType * input)
+  {
+    this->GetFilter()->SetInput(input);
+  }
+
+  /** Get the input label image */
+  const LabelImageType * GetInput()
+  {
+    return this->GetFilter()->GetInput();
+  }
+
+  /** Set the support image (optional) */
+  void SetSupportImage(const SupportImageType * image)
+  {
+    this->GetFilter()->SetSupportImage(image);
+  }
+
+  /** Get the support image */
+  const SupportImageType * GetSupportImage() const
+  {
+    return this->GetFilter()->GetSupportImage();
+  }
+
+  /** Get the region adjacency graph */
+  const RegionAdjacencyGraphType * GetRegionAdjacencyGraph() const
+  {
+    return this->GetFilter()->GetRegionAdjacencyGraph();
+  }
+
+protected:
+  /** Constructor */
+  LabelImageToRegionAdjacencyGraphFilter() {}
+  /** Destructor */
+  ~LabelImageToRegionAdjacencyGraphFilter() override {}
+
+private:
+  LabelImageToRegionAdjacencyGraphFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbLabelImageToRegionAdjacencyGraphFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,390 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbLabelImageToRegionAdjacencyGraphFilter_hxx
+#define otbLabelImageToRegionAdjacencyGraphFilter_hxx
+
+#include "otbLabelImageToRegionAdjacencyGraphFilter.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+namespace otb
+{
+
+template <class TLabelImage, class TSupportImage>
+PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::PersistentLabelImageToRegionAdjacencyGraphFilter() : m_NumberOfComponents(0)
+{
+  this->SetNumberOfRequiredInputs(1);
+  m_RegionAdjacencyGraph = RegionAdjacencyGraphType::New();
+}
+
+template <class TLabelImage, class TSupportImage>
+void
+PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::SetSupportImage(const SupportImageType * image)
+{
+  // Process object is not const-correct so the const_cast is required here
+  this->itk::ProcessObject::SetNthInput(1, const_cast<SupportImageType *>(image));
+}
+
+template <class TLabelImage, class TSupportImage>
+const typename PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::SupportImageType *
+PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::GetSupportImage() const
+{
+  if (this->GetNumberOfInputs() < 2)
+    {
+    return nullptr;
+    }
+  return static_cast<const SupportImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TLabelImage, class TSupportImage>
+const typename PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::RegionAdjacencyGraphType *
+PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::GetRegionAdjacencyGraph() const
+{
+  return m_RegionAdjacencyGraph;
+}
+
+template <class TLabelImage, class TSupportImage>
+void
+PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  if (this->GetInput())
+    {
+    this->GetOutput()->CopyInformation(this->GetInput());
+    this->GetOutput()->SetLargestPossibleRegion(this->GetInput()->GetLargestPossibleRegion());
+
+    if (this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() == 0)
+      {
+      this->GetOutput()->SetRequestedRegion(this->GetOutput()->GetLargestPossibleRegion());
+      }
+    }
+}
+
+template <class TLabelImage, class TSupportImage>
+void
+PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::GenerateInputRequestedRegion()
+{
+  auto labelImage = const_cast<LabelImageType *>(this->GetInput());
+  auto supportImage = const_cast<SupportImageType *>(this->GetSupportImage());
+  const RegionType & outputRegion = this->GetOutput()->GetRequestedRegion();
+
+  if (labelImage)
+    {
+    RegionType labelRegion = outputRegion;
+    labelRegion.PadByRadius(1);
+    labelRegion.Crop(labelImage->GetLargestPossibleRegion());
+    labelImage->SetRequestedRegion(labelRegion);
+    }
+  if (supportImage)
+    {
+    supportImage->SetRequestedRegion(outputRegion);
+    }
+}
+
+template <class TLabelImage, class TSupportImage>
+void
+PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::AllocateOutputs()
+{
+  // Nothing to allocate: the output image is not intended to be used
+}
+
+template <class TLabelImage, class TSupportImage>
+void
+PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::Reset()
+{
+  m_ThreadAccumulators.clear();
+  m_ThreadAccumulators.resize(this->GetNumberOfThreads());
+  for (auto & acc : m_ThreadAccumulators)
+    {
+    acc.ReducedEdges = 0;
+    }
+
+  auto supportImage = const_cast<SupportImageType *>(this->GetSupportImage());
+  m_NumberOfComponents = 0;
+  if (supportImage)
+    {
+    supportImage->UpdateOutputInformation();
+    m_NumberOfComponents = supportImage->GetNumberOfComponentsPerPixel();
+    }
+
+  m_RegionAdjacencyGraph->Clear();
+}
+
+template <class TLabelImage, class TSupportImage>
+void
+PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::SortAndReduceEdges(EdgeListType & edges)
+{
+  std::sort(edges.begin(), edges.end(), [](EdgeType const & a, EdgeType const & b)
+    {
+    return a.First < b.First || (a.First == b.First && a.Second < b.Second);
+    });
+
+  auto out = edges.begin();
+  for (auto it = edges.begin(); it != edges.end(); ++it)
+    {
+    if (out != edges.begin() && (out - 1)->First == it->First && (out - 1)->Second == it->Second)
+      {
+      (out - 1)->BoundaryLength += it->BoundaryLength;
+      }
+    else
+      {
+      *out = *it;
+      ++out;
+      }
+    }
+  edges.erase(out, edges.end());
+}
+
+template <class TLabelImage, class TSupportImage>
+void
+PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  const LabelImageType * labelImage = this->GetInput();
+  const SupportImageType * supportImage = this->GetSupportImage();
+  const unsigned int nbComp = m_NumberOfComponents;
+
+  const RegionType & largestRegion = labelImage->GetLargestPossibleRegion();
+  const auto & offsetTable = labelImage->GetOffsetTable();
+
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  // Nodes of this region : slot of each label in the local arrays
+  std::unordered_map<LabelType, std::size_t> slots;
+  std::vector<LabelType> labels;
+  std::vector<CountType> populations;
+  std::vector<double> sums;
+  std::vector<double> squaredSums;
+
+  // Edges of this region. Consecutive pixels often see the same pair of
+  // labels, so the boundary length of the last edge is incremented directly.
+  EdgeListType edges;
+  auto addBoundary = [&edges](LabelType label1, LabelType label2)
+    {
+    if (label2 < label1)
+      {
+      std::swap(label1, label2);
+      }
+    if (!edges.empty() && edges.back().First == label1 && edges.back().Second == label2)
+      {
+      ++edges.back().BoundaryLength;
+      }
+    else
+      {
+      edges.push_back(EdgeType{label1, label2, 1});
+      }
+    };
+
+  const long lineLength = outputRegionForThread.GetSize(0);
+
+  itk::ImageLinearConstIteratorWithIndex<LabelImageType> lineIt(labelImage, outputRegionForThread);
+  lineIt.SetDirection(0);
+  for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); lineIt.NextLine())
+    {
+    const IndexType index = lineIt.GetIndex();
+    const LabelType * line = &(labelImage->GetPixel(index));
+
+    // Next neighbours along each dimension which are inside the image
+    const bool hasNextInLine = index[0] + lineLength
+      < largestRegion.GetIndex(0) + static_cast<long>(largestRegion.GetSize(0));
+    bool hasNext[ImageDimension];
+    for (unsigned int dim = 1; dim < ImageDimension; ++dim)
+      {
+      hasNext[dim] = index[dim] + 1
+        < largestRegion.GetIndex(dim) + static_cast<long>(largestRegion.GetSize(dim));
+      }
+
+    const SupportInternalPixelType * values = nullptr;
+    if (supportImage)
+      {
+      values = supportImage->GetBufferPointer() + supportImage->ComputeOffset(index) * nbComp;
+      }
+
+    std::size_t slot = 0;
+    for (long x = 0; x < lineLength; ++x)
+      {
+      const LabelType label = line[x];
+
+      if (x == 0 || label != line[x - 1])
+        {
+        auto found = slots.find(label);
+        if (found == slots.end())
+          {
+          slot = labels.size();
+          slots.emplace(label, slot);
+          labels.push_back(label);
+          populations.push_back(0);
+          sums.resize(sums.size() + nbComp, 0.);
+          squaredSums.resize(squaredSums.size() + nbComp, 0.);
+          }
+        else
+          {
+          slot = found->second;
+          }
+        }
+
+      ++populations[slot];
+      if (values)
+        {
+        double * sum = &sums[slot * nbComp];
+        double * squaredSum = &squaredSums[slot * nbComp];
+        for (unsigned int comp = 0; comp < nbComp; ++comp)
+          {
+          const double value = static_cast<double>(values[x * nbComp + comp]);
+          sum[comp] += value;
+          squaredSum[comp] += value * value;
+          }
+        }
+
+      if (x + 1 < lineLength || hasNextInLine)
+        {
+        const LabelType next = line[x + 1];
+        if (next != label)
+          {
+          addBoundary(label, next);
+          }
+        }
+      for (unsigned int dim = 1; dim < ImageDimension; ++dim)
+        {
+        if (hasNext[dim])
+          {
+          const LabelType next = line[x + offsetTable[dim]];
+          if (next != label)
+            {
+            addBoundary(label, next);
+            }
+          }
+        }
+      progress.CompletedPixel();
+      }
+    }
+
+  // Append the results of this region to the thread accumulator, keeping
+  // the edge list compact when it has doubled since the last reduction.
+  auto & acc = m_ThreadAccumulators[threadId];
+  acc.Labels.insert(acc.Labels.end(), labels.begin(), labels.end());
+  acc.Populations.insert(acc.Populations.end(), populations.begin(), populations.end());
+  acc.Sums.insert(acc.Sums.end(), sums.begin(), sums.end());
+  acc.SquaredSums.insert(acc.SquaredSums.end(), squaredSums.begin(), squaredSums.end());
+
+  SortAndReduceEdges(edges);
+  acc.Edges.insert(acc.Edges.end(), edges.begin(), edges.end());
+  if (acc.Edges.size() > 2 * acc.ReducedEdges)
+    {
+    SortAndReduceEdges(acc.Edges);
+    acc.ReducedEdges = acc.Edges.size();
+    }
+}
+
+template <class TLabelImage, class TSupportImage>
+void
+PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::Synthetize()
+{
+  const unsigned int nbComp = m_NumberOfComponents;
+
+  // Sort the node entries of all threads by label. Entries of the same label
+  // are kept in the order of the threads, so that the sums do not depend on
+  // the sort.
+  struct NodeEntry
+  {
+    LabelType Label;
+    unsigned int Thread;
+    std::size_t Position;
+  };
+  std::vector<NodeEntry> entries;
+  EdgeListType edges;
+  for (unsigned int thread = 0; thread < m_ThreadAccumulators.size(); ++thread)
+    {
+    auto & acc = m_ThreadAccumulators[thread];
+    for (std::size_t pos = 0; pos < acc.Labels.size(); ++pos)
+      {
+      entries.push_back(NodeEntry{acc.Labels[pos], thread, pos});
+      }
+    edges.insert(edges.end(), acc.Edges.begin(), acc.Edges.end());
+    EdgeListType().swap(acc.Edges);
+    }
+  std::sort(entries.begin(), entries.end(), [](NodeEntry const & a, NodeEntry const & b)
+    {
+    return a.Label < b.Label
+      || (a.Label == b.Label && (a.Thread < b.Thread || (a.Thread == b.Thread && a.Position < b.Position)));
+    });
+
+  // Sum the entries of each label
+  std::vector<LabelType> labels;
+  std::vector<CountType> populations;
+  std::vector<double> sums;
+  std::vector<double> squaredSums;
+  for (auto const & entry : entries)
+    {
+    auto const & acc = m_ThreadAccumulators[entry.Thread];
+    if (labels.empty() || labels.back() != entry.Label)
+      {
+      labels.push_back(entry.Label);
+      populations.push_back(0);
+      sums.resize(sums.size() + nbComp, 0.);
+      squaredSums.resize(squaredSums.size() + nbComp, 0.);
+      }
+    populations.back() += acc.Populations[entry.Position];
+    const std::size_t out = sums.size() - nbComp;
+    for (unsigned int comp = 0; comp < nbComp; ++comp)
+      {
+      sums[out + comp] += acc.Sums[entry.Position * nbComp + comp];
+      squaredSums[out + comp] += acc.SquaredSums[entry.Position * nbComp + comp];
+      }
+    }
+  std::vector<NodeEntry>().swap(entries);
+  m_ThreadAccumulators.clear();
+
+  SortAndReduceEdges(edges);
+
+  m_RegionAdjacencyGraph->Build(std::move(labels), std::move(populations),
+                                std::move(sums), std::move(squaredSums), nbComp, edges);
+}
+
+template <class TLabelImage, class TSupportImage>
+void
+PersistentLabelImageToRegionAdjacencyGraphFilter<TLabelImage, TSupportImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of components: " << m_NumberOfComponents << std::endl;
+}
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbRegionAdjacencyGraph_h
+#define otbRegionAdjacencyGraph_h
+
+#include "itkDataObject.h"
+#include "itkObjectFactory.h"
+#include "itkVariableLengthVector.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace otb
+{
+
+/** \class RegionAdjacencyGraph
+ *  \brief Region adjacency graph of a segmentation, stored in compressed
+ *  sparse row (CSR) format.
+ *
+ * Nodes are the labels of the segmentation, sorted in increasing order and
+ * identified by their index in [0, GetNumberOfNodes()). The neighbours of
+ * node i are the edges in [GetFirstEdge(i), GetLastEdge(i)), sorted by
+ * increasing node index. Each edge holds the target node and the boundary
+ * length between both regions, i.e. the number of pairs of 4-connected
+ * pixels (2n-connected in dimension n) lying on each side of the boundary.
+ * Undirected edges are stored in both directions.
+ *
+ * Each node also holds its population and the sum and sum of squares of the
+ * pixel values of each component of a support image, from which the mean and
+ * variance of the region can be computed.
+ *
+ * The graph is usually built by a LabelImageToRegionAdjacencyGraphFilter.
+ *
+ * \sa LabelImageToRegionAdjacencyGraphFilter
+ *
+ * \ingroup OTBConversion
+ */
+template <class TLabel>
+class ITK_EXPORT RegionAdjacencyGraph : public itk::DataObject
+{
+public:
+  /** Standard class typedefs */
+  typedef RegionAdjacencyGraph          Self;
+  typedef itk::DataObject               Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(RegionAdjacencyGraph, itk::DataObject);
+
+  typedef TLabel                                   LabelType;
+  typedef std::uint32_t                            NodeIndexType;
+  typedef std::size_t                              EdgeIndexType;
+  typedef std::uint64_t                            CountType;
+  typedef itk::VariableLengthVector<double>        RealVectorType;
+
+  /** Undirected edge, with First < Second, used to build the graph */
+  struct EdgeType
+  {
+    LabelType First;
+    LabelType Second;
+    CountType BoundaryLength;
+  };
+  typedef std::vector<EdgeType>                    EdgeListType;
+
+  /** Build the graph.
+   * \param labels sorted labels of the nodes
+   * \param populations population of each node
+   * \param sums sum of the values of each node (nbComponents values per node)
+   * \param squaredSums sum of the squared values (nbComponents values per node)
+   * \param nbComponents number of components of the statistics
+   * \param edges undirected edges, sorted by (First, Second), whose labels
+   * are in labels
+   */
+  void Build(std::vector<LabelType> labels,
+             std::vector<CountType> populations,
+             std::vector<double> sums,
+             std::vector<double> squaredSums,
+             unsigned int nbComponents,
+             EdgeListType const & edges);
+
+  /** Remove all nodes and edges */
+  void Clear();
+
+  /** Number of nodes */
+  NodeIndexType GetNumberOfNodes() const
+  {
+    return static_cast<NodeIndexType>(m_Labels.size());
+  }
+
+  /** Number of undirected edges */
+  EdgeIndexType GetNumberOfEdges() const
+  {
+    return m_Targets.size() / 2;
+  }
+
+  /** Number of components of the node statistics */
+  unsigned int GetNumberOfComponents() const
+  {
+    return m_NumberOfComponents;
+  }
+
+  /** Find the node of a label. Returns false if the label is not in the
+   * graph. */
+  bool GetNodeIndex(LabelType label, NodeIndexType & node) const;
+
+  /** Label of a node */
+  LabelType GetLabel(NodeIndexType node) const
+  {
+    return m_Labels[node];
+  }
+
+  /** Number of pixels of a node */
+  CountType GetPopulation(NodeIndexType node) const
+  {
+    return m_Populations[node];
+  }
+
+  /** Mean value of a node */
+  RealVectorType GetMean(NodeIndexType node) const;
+
+  /** Variance of a node */
+  RealVectorType GetVariance(NodeIndexType node) const;
+
+  /** Sum of the values of a node (GetNumberOfComponents() values) */
+  const double * GetSum(NodeIndexType node) const
+  {
+    return m_Sums.data() + static_cast<std::size_t>(node) * m_NumberOfComponents;
+  }
+
+  /** Sum of the squared values of a node (GetNumberOfComponents() values) */
+  const double * GetSquaredSum(NodeIndexType node) const
+  {
+    return m_SquaredSums.data() + static_cast<std::size_t>(node) * m_NumberOfComponents;
+  }
+
+  /** Number of neighbours of a node */
+  NodeIndexType GetNumberOfNeighbours(NodeIndexType node) const
+  {
+    return static_cast<NodeIndexType>(m_Offsets[node + 1] - m_Offsets[node]);
+  }
+
+  /** First edge of a node */
+  EdgeIndexType GetFirstEdge(NodeIndexType node) const
+  {
+    return m_Offsets[node];
+  }
+
+  /** Edge after the last edge of a node */
+  EdgeIndexType GetLastEdge(NodeIndexType node) const
+  {
+    return m_Offsets[node + 1];
+  }
+
+  /** Target node of an edge */
+  NodeIndexType GetEdgeTarget(EdgeIndexType edge) const
+  {
+    return m_Targets[edge];
+  }
+
+  /** Boundary length of an edge */
+  CountType GetEdgeBoundaryLength(EdgeIndexType edge) const
+  {
+    return m_BoundaryLengths[edge];
+  }
+
+  /** Boundary length between two nodes (0 if they are not adjacent) */
+  CountType GetBoundaryLength(NodeIndexType node1, NodeIndexType node2) const;
+
+  /** Total length of the boundaries of a node with other nodes */
+  CountType GetTotalBoundaryLength(NodeIndexType node) const;
+
+protected:
+  RegionAdjacencyGraph();
+  ~RegionAdjacencyGraph() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+private:
+  RegionAdjacencyGraph(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Sorted labels of the nodes */
+  std::vector<LabelType> m_Labels;
+
+  /** Population of each node */
+  std::vector<CountType> m_Populations;
+
+  /** Sum and sum of squares of each node (m_NumberOfComponents per node) */
+  std::vector<double> m_Sums;
+  std::vector<double> m_SquaredSums;
+
+  unsigned int m_NumberOfComponents;
+
+  /** Edges of node i are in [m_Offsets[i], m_Offsets[i+1]) */
+  std::vector<EdgeIndexType> m_Offsets;
+
+  /** Target node of each edge */
+  std::vector<NodeIndexType> m_Targets;
+
+  /** Boundary length of each edge */
+  std::vector<CountType> m_BoundaryLengths;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbRegionAdjacencyGraph.hxx"
+#endif
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbRegionAdjacencyGraph_hxx
+#define otbRegionAdjacencyGraph_hxx
+
+#include "otbRegionAdjacencyGraph.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace otb
+{
+
+template <class TLabel>
+RegionAdjacencyGraph<TLabel>
+::RegionAdjacencyGraph() : m_NumberOfComponents(0)
+{
+  m_Offsets.assign(1, 0);
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::Clear()
+{
+  m_Labels.clear();
+  m_Populations.clear();
+  m_Sums.clear();
+  m_SquaredSums.clear();
+  m_NumberOfComponents = 0;
+  m_Offsets.assign(1, 0);
+  m_Targets.clear();
+  m_BoundaryLengths.clear();
+  this->Modified();
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::Build(std::vector<LabelType> labels,
+        std::vector<CountType> populations,
+        std::vector<double> sums,
+        std::vector<double> squaredSums,
+        unsigned int nbComponents,
+        EdgeListType const & edges)
+{
+  if (labels.size() >= std::numeric_limits<NodeIndexType>::max())
+    {
+    itkExceptionMacro(<< "Too many nodes in the region adjacency graph: " << labels.size());
+    }
+  if (populations.size() != labels.size()
+      || sums.size() != labels.size() * nbComponents
+      || squaredSums.size() != labels.size() * nbComponents)
+    {
+    itkExceptionMacro(<< "Inconsistent sizes of the node statistics");
+    }
+
+  m_Labels.swap(labels);
+  m_Populations.swap(populations);
+  m_Sums.swap(sums);
+  m_SquaredSums.swap(squaredSums);
+  m_NumberOfComponents = nbComponents;
+
+  // Node index of the ends of each edge
+  const std::size_t nbEdges = edges.size();
+  std::vector<NodeIndexType> firstNodes(nbEdges);
+  std::vector<NodeIndexType> secondNodes(nbEdges);
+  NodeIndexType node1 = 0;
+  for (std::size_t e = 0; e < nbEdges; ++e)
+    {
+    // Edges are sorted by first label : no need to search from the start
+    while (node1 < m_Labels.size() && m_Labels[node1] < edges[e].First)
+      {
+      ++node1;
+      }
+    auto it2 = std::lower_bound(m_Labels.begin(), m_Labels.end(), edges[e].Second);
+    if (node1 == m_Labels.size() || m_Labels[node1] != edges[e].First
+        || it2 == m_Labels.end() || *it2 != edges[e].Second)
+      {
+      itkExceptionMacro(<< "Edge (" << edges[e].First << ", " << edges[e].Second
+                        << ") refers to a label which is not a node");
+      }
+    firstNodes[e] = node1;
+    secondNodes[e] = static_cast<NodeIndexType>(it2 - m_Labels.begin());
+    }
+
+  // Degree of each node, then offsets
+  m_Offsets.assign(m_Labels.size() + 1, 0);
+  for (std::size_t e = 0; e < nbEdges; ++e)
+    {
+    ++m_Offsets[firstNodes[e] + 1];
+    ++m_Offsets[secondNodes[e] + 1];
+    }
+  for (std::size_t node = 0; node < m_Labels.size(); ++node)
+    {
+    m_Offsets[node + 1] += m_Offsets[node];
+    }
+
+  // Fill the edges in both directions. Since the edges are sorted by
+  // (First, Second), the neighbours of a node smaller than itself are
+  // written before the greater ones, and both are in increasing order.
+  m_Targets.resize(2 * nbEdges);
+  m_BoundaryLengths.resize(2 * nbEdges);
+  std::vector<EdgeIndexType> position(m_Offsets.begin(), m_Offsets.end() - 1);
+  for (std::size_t e = 0; e < nbEdges; ++e)
+    {
+    EdgeIndexType & pos1 = position[firstNodes[e]];
+    m_Targets[pos1] = secondNodes[e];
+    m_BoundaryLengths[pos1] = edges[e].BoundaryLength;
+    ++pos1;
+    EdgeIndexType & pos2 = position[secondNodes[e]];
+    m_Targets[pos2] = firstNodes[e];
+    m_BoundaryLengths[pos2] = edges[e].BoundaryLength;
+    ++pos2;
+    }
+
+  this->Modified();
+}
+
+template <class TLabel>
+bool
+RegionAdjacencyGraph<TLabel>
+::GetNodeIndex(LabelType label, NodeIndexType & node) const
+{
+  auto it = std::lower_bound(m_Labels.begin(), m_Labels.end(), label);
+  if (it == m_Labels.end() || *it != label)
+    {
+    return false;
+    }
+  node = static_cast<NodeIndexType>(it - m_Labels.begin());
+  return true;
+}
+
+template <class TLabel>
+typename RegionAdjacencyGraph<TLabel>::RealVectorType
+RegionAdjacencyGraph<TLabel>
+::GetMean(NodeIndexType node) const
+{
+  RealVectorType mean(m_NumberOfComponents);
+  const double * sum = this->GetSum(node);
+  const double population = static_cast<double>(m_Populations[node]);
+  for (unsigned int comp = 0; comp < m_NumberOfComponents; ++comp)
+    {
+    mean[comp] = sum[comp] / population;
+    }
+  return mean;
+}
+
+template <class TLabel>
+typename RegionAdjacencyGraph<TLabel>::RealVectorType
+RegionAdjacencyGraph<TLabel>
+::GetVariance(NodeIndexType node) const
+{
+  RealVectorType variance(m_NumberOfComponents);
+  const double * sum = this->GetSum(node);
+  const double * squaredSum = this->GetSquaredSum(node);
+  const double population = static_cast<double>(m_Populations[node]);
+  for (unsigned int comp = 0; comp < m_NumberOfComponents; ++comp)
+    {
+    const double mean = sum[comp] / population;
+    variance[comp] = std::max(0., squaredSum[comp] / population - mean * mean);
+    }
+  return variance;
+}
+
+template <class TLabel>
+typename RegionAdjacencyGraph<TLabel>::CountType
+RegionAdjacencyGraph<TLabel>
+::GetBoundaryLength(NodeIndexType node1, NodeIndexType node2) const
+{
+  auto first = m_Targets.begin() + m_Offsets[node1];
+  auto last = m_Targets.begin() + m_Offsets[node1 + 1];
+  auto it = std::lower_bound(first, last, node2);
+  if (it == last || *it != node2)
+    {
+    return 0;
+    }
+  return m_BoundaryLengths[it - m_Targets.begin()];
+}
+
+template <class TLabel>
+typename RegionAdjacencyGraph<TLabel>::CountType
+RegionAdjacencyGraph<TLabel>
+::GetTotalBoundaryLength(NodeIndexType node) const
+{
+  CountType length = 0;
+  for (EdgeIndexType edge = m_Offsets[node]; edge < m_Offsets[node + 1]; ++edge)
+    {
+    length += m_BoundaryLengths[edge];
+    }
+  return length;
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of nodes: " << this->GetNumberOfNodes() << std::endl;
+  os << indent << "Number of edges: " << this->GetNumberOfEdges() << std::endl;
+  os << indent << "Number of components: " << m_NumberOfComponents << std::endl;
+}
+
+} // end namespace otb
+
+#endif
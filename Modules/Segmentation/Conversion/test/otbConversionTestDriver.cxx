@@ -26,10 +26,13 @@ void RegisterTests()
   REGISTER_TEST(otbOGRDataSourceToLabelImageFilter);
   REGISTER_TEST(otbLabelImageToVectorDataFilter);
   REGISTER_TEST(otbLabelImageToOGRDataSourceFilter);
+  REGISTER_TEST(otbLabelImageToOGRDataSourceFilterTiled);
   REGISTER_TEST(otbVectorDataToLabelImageFilter);
   REGISTER_TEST(otbPolygonizationRasterizationTest);
   REGISTER_TEST(otbVectorDataRasterizeFilter);
   REGISTER_TEST(otbLabelImageRegionPruningFilter);
   REGISTER_TEST(otbLabelImageRegionMergingFilter);
   REGISTER_TEST(otbLabelMapToVectorDataFilter);
+  REGISTER_TEST(otbLabelImageSmallRegionMergingFilter);
+  REGISTER_TEST(otbLabelImageToRegionAdjacencyGraphFilter);
 }
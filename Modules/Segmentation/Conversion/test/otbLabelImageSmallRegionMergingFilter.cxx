@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "itkMacro.h"
+#include "itkImageRegionIterator.h"
+#include "itkMultiThreader.h"
+#include "otbImage.h"
+#include "otbLabelImageSmallRegionMergingFilter.h"
+
+typedef otb::Image<unsigned int, 2>                             LabelImageType;
+typedef otb::LabelImageSmallRegionMergingFilter<LabelImageType> SmallRegionMergingFilterType;
+
+namespace
+{
+// Run the merging on the label image with the given number of threads
+void RunSmallRegionMerging(LabelImageType * labelImage,
+                           SmallRegionMergingFilterType::LabelPopulationType const & population,
+                           SmallRegionMergingFilterType::LabelStatisticType const & statistic,
+                           unsigned int minSize,
+                           unsigned int nbThreads,
+                           SmallRegionMergingFilterType::LUTType & lut,
+                           SmallRegionMergingFilterType::LabelPopulationType & outPopulation)
+{
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads(nbThreads);
+  auto filter = SmallRegionMergingFilterType::New();
+  filter->SetInputLabelImage(labelImage);
+  filter->SetLabelPopulation(population);
+  filter->SetLabelStatistic(statistic);
+  filter->SetMinSize(minSize);
+  filter->Update();
+  lut = filter->GetLUT();
+  outPopulation = filter->GetLabelPopulation();
+}
+}
+
+int otbLabelImageSmallRegionMergingFilter(int argc, char * argv[])
+{
+  if (argc != 4)
+    {
+    std::cerr << "Usage: " << argv[0] << " size minsize nbthreads" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int size = atoi(argv[1]);
+  const unsigned int minSize = atoi(argv[2]);
+  const unsigned int nbThreads = atoi(argv[3]);
+
+  // Label image made of segments of various sizes : each pixel gets the
+  // label of the 3x3 cell it belongs to, and some cells are split in smaller
+  // segments.
+  LabelImageType::RegionType region;
+  region.SetSize(0, size);
+  region.SetSize(1, size);
+  auto labelImage = LabelImageType::New();
+  labelImage->SetRegions(region);
+  labelImage->Allocate();
+
+  SmallRegionMergingFilterType::LabelPopulationType population;
+  SmallRegionMergingFilterType::LabelStatisticType statistic;
+
+  itk::ImageRegionIterator<LabelImageType> it(labelImage, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const unsigned int cellX = it.GetIndex()[0] / 3;
+    const unsigned int cellY = it.GetIndex()[1] / 3;
+    unsigned int label = 1 + 4 * (cellY * (size / 3 + 1) + cellX);
+    if ((cellX * 7 + cellY * 13) % 5 == 0)
+      {
+      label += (it.GetIndex()[0] % 3) + (it.GetIndex()[1] % 3 == 0 ? 0 : 1);
+      }
+    it.Set(label);
+    population[label] += 1;
+    if (statistic.find(label) == statistic.end())
+      {
+      // Integer statistics, so that equal distances are frequent
+      itk::VariableLengthVector<double> mean(2);
+      mean[0] = (label * 37) % 11;
+      mean[1] = (label * 17) % 5;
+      statistic[label] = mean;
+      }
+    }
+
+  SmallRegionMergingFilterType::LUTType refLUT, lut;
+  SmallRegionMergingFilterType::LabelPopulationType refPopulation, outPopulation;
+  RunSmallRegionMerging(labelImage, population, statistic, minSize, 1, refLUT, refPopulation);
+  RunSmallRegionMerging(labelImage, population, statistic, minSize, nbThreads, lut, outPopulation);
+
+  if (lut != refLUT)
+    {
+    std::cerr << "The LUT depends on the number of threads" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  double totalPopulation = 0.;
+  for (auto const & label : lut)
+    {
+    // The LUT must be fully compressed, and roots must be the smallest label
+    // of their segment
+    if (lut[label.second] != label.second || label.second > label.first)
+      {
+      std::cerr << "Invalid LUT entry " << label.first << " -> " << label.second << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (outPopulation[label.first] != refPopulation[label.first])
+      {
+      std::cerr << "The population of " << label.first << " depends on the number of threads" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (label.second == label.first)
+      {
+      totalPopulation += outPopulation[label.first];
+      if (outPopulation[label.first] < minSize && lut.size() > 1)
+        {
+        std::cerr << "Segment " << label.first << " is smaller than " << minSize << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  if (totalPopulation != size * size)
+    {
+    std::cerr << "Total population is " << totalPopulation << " instead of " << size * size << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -25,6 +25,9 @@
 #include "otbImageFileReader.h"
 #include "otbVectorDataFileWriter.h"
 
+#include <cmath>
+#include <map>
+
 
 
 int otbLabelImageToOGRDataSourceFilter(int argc, char * argv[])
@@ -56,3 +59,84 @@ int otbLabelImageToOGRDataSourceFilter(int argc, char * argv[])
 
   return EXIT_SUCCESS;
 }
+
+int otbLabelImageToOGRDataSourceFilterTiled(int argc, char * argv[])
+{
+  if (argc != 3)
+    {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " inputLabelImageFile tileSize" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const char * infname = argv[1];
+  const unsigned int tileSize = atoi(argv[2]);
+
+  typedef otb::Image<unsigned short, 2>                             InputLabelImageType;
+  typedef otb::LabelImageToOGRDataSourceFilter<InputLabelImageType> FilterType;
+  typedef otb::ImageFileReader<InputLabelImageType>                 LabelImageReaderType;
+
+  LabelImageReaderType::Pointer reader = LabelImageReaderType::New();
+  reader->SetFileName(infname);
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(reader->GetOutput());
+  filter->Update();
+
+  // The tiled filter streams its input, and writes in a given layer
+  LabelImageReaderType::Pointer tiledReader = LabelImageReaderType::New();
+  tiledReader->SetFileName(infname);
+
+  otb::ogr::DataSource::Pointer tiledDS = otb::ogr::DataSource::New();
+  otb::ogr::Layer tiledLayer = tiledDS->CreateLayer("tiled", nullptr, wkbPolygon);
+
+  FilterType::Pointer tiledFilter = FilterType::New();
+  tiledFilter->SetInput(tiledReader->GetOutput());
+  tiledFilter->SetTileSize(tileSize);
+  tiledFilter->SetOGRLayer(tiledLayer);
+  tiledFilter->Update();
+
+  const InputLabelImageType::RegionType & largestRegion = tiledReader->GetOutput()->GetLargestPossibleRegion();
+  const InputLabelImageType::RegionType & bufferedRegion = tiledReader->GetOutput()->GetBufferedRegion();
+  if (bufferedRegion.GetSize(0) > tileSize + 1 || bufferedRegion.GetSize(1) > tileSize + 1)
+    {
+    std::cerr << "The input is not streamed: buffered region " << bufferedRegion
+              << " of " << largestRegion << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Number of polygons and total area of each label
+  typedef std::map<int, std::pair<unsigned int, double> > LabelSummaryType;
+  auto summarize = [](otb::ogr::Layer layer)
+    {
+    LabelSummaryType summary;
+    for (auto & feature : layer)
+      {
+      auto & entry = summary[feature.ogr().GetFieldAsInteger(0)];
+      entry.first += 1;
+      entry.second += static_cast<const OGRPolygon *>(feature.GetGeometry())->get_Area();
+      }
+    return summary;
+    };
+
+  const LabelSummaryType reference = summarize(filter->GetOutput()->GetLayerChecked(0));
+  const LabelSummaryType tiled = summarize(tiledLayer);
+
+  if (reference.size() != tiled.size())
+    {
+    std::cerr << "Number of labels differ: " << tiled.size() << " instead of " << reference.size() << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (auto const & entry : reference)
+    {
+    auto found = tiled.find(entry.first);
+    if (found == tiled.end()
+        || found->second.first != entry.second.first
+        || std::abs(found->second.second - entry.second.second) > 1e-6 * entry.second.second)
+      {
+      std::cerr << "Polygons of label " << entry.first << " differ" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
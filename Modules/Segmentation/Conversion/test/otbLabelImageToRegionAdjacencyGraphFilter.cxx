@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "itkMacro.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "otbImage.h"
+#include "otbVectorImage.h"
+#include "otbLabelImageToRegionAdjacencyGraphFilter.h"
+
+#include <map>
+
+int otbLabelImageToRegionAdjacencyGraphFilter(int argc, char * argv[])
+{
+  if (argc != 3)
+    {
+    std::cerr << "Usage: " << argv[0] << " size nbtiles" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int size = atoi(argv[1]);
+  const unsigned int nbTiles = atoi(argv[2]);
+
+  typedef otb::Image<unsigned int, 2>                                   LabelImageType;
+  typedef otb::VectorImage<float, 2>                                    ImageType;
+  typedef otb::LabelImageToRegionAdjacencyGraphFilter<LabelImageType, ImageType> RAGFilterType;
+  typedef RAGFilterType::RegionAdjacencyGraphType                       RAGType;
+
+  LabelImageType::RegionType region;
+  region.SetSize(0, size);
+  region.SetSize(1, size);
+
+  auto labelImage = LabelImageType::New();
+  labelImage->SetRegions(region);
+  labelImage->Allocate();
+
+  auto image = ImageType::New();
+  image->SetRegions(region);
+  image->SetNumberOfComponentsPerPixel(2);
+  image->Allocate();
+
+  // Irregular segments, and brute force computation of the expected graph
+  std::map<unsigned int, std::vector<double> > expectedStats;
+  std::map<std::pair<unsigned int, unsigned int>, unsigned long> expectedEdges;
+
+  itk::ImageRegionIteratorWithIndex<LabelImageType> it(labelImage, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const long x = it.GetIndex()[0];
+    const long y = it.GetIndex()[1];
+    const unsigned int label = 10 + ((x * x + 3 * y) / 17) % 7 + 7 * ((x + y * y) / 23 % 5);
+    it.Set(label);
+
+    ImageType::PixelType pixel(2);
+    pixel[0] = (x * 3 + y) % 10;
+    pixel[1] = label % 4;
+    image->SetPixel(it.GetIndex(), pixel);
+
+    auto & stats = expectedStats[label];
+    stats.resize(3, 0.);
+    stats[0] += 1;
+    stats[1] += pixel[0];
+    stats[2] += pixel[0] * pixel[0];
+    }
+
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+      LabelImageType::IndexType next = it.GetIndex();
+      next[dim] += 1;
+      if (region.IsInside(next) && labelImage->GetPixel(next) != it.Get())
+        {
+        const unsigned int label1 = std::min(it.Get(), labelImage->GetPixel(next));
+        const unsigned int label2 = std::max(it.Get(), labelImage->GetPixel(next));
+        expectedEdges[std::make_pair(label1, label2)] += 1;
+        }
+      }
+    }
+
+  auto ragFilter = RAGFilterType::New();
+  ragFilter->SetInput(labelImage);
+  ragFilter->SetSupportImage(image);
+  ragFilter->GetStreamer()->SetNumberOfDivisionsTiledStreaming(nbTiles);
+  ragFilter->Update();
+
+  const RAGType * rag = ragFilter->GetRegionAdjacencyGraph();
+
+  if (rag->GetNumberOfNodes() != expectedStats.size()
+      || rag->GetNumberOfEdges() != expectedEdges.size()
+      || rag->GetNumberOfComponents() != 2)
+    {
+    std::cerr << "Wrong graph size: " << rag->GetNumberOfNodes() << " nodes and "
+              << rag->GetNumberOfEdges() << " edges instead of " << expectedStats.size()
+              << " and " << expectedEdges.size() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for (auto const & stats : expectedStats)
+    {
+    RAGType::NodeIndexType node;
+    if (!rag->GetNodeIndex(stats.first, node))
+      {
+      std::cerr << "Label " << stats.first << " not found" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (rag->GetPopulation(node) != stats.second[0]
+        || rag->GetSum(node)[0] != stats.second[1]
+        || rag->GetSquaredSum(node)[0] != stats.second[2])
+      {
+      std::cerr << "Wrong statistics for label " << stats.first << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // Neighbours are sorted and symmetric
+    for (auto edge = rag->GetFirstEdge(node); edge < rag->GetLastEdge(node); ++edge)
+      {
+      const auto target = rag->GetEdgeTarget(edge);
+      if ((edge > rag->GetFirstEdge(node) && rag->GetEdgeTarget(edge - 1) >= target)
+          || rag->GetBoundaryLength(target, node) != rag->GetEdgeBoundaryLength(edge))
+        {
+        std::cerr << "Invalid neighbours for label " << stats.first << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  for (auto const & edge : expectedEdges)
+    {
+    RAGType::NodeIndexType node1, node2;
+    rag->GetNodeIndex(edge.first.first, node1);
+    rag->GetNodeIndex(edge.first.second, node2);
+    if (rag->GetBoundaryLength(node1, node2) != edge.second)
+      {
+      std::cerr << "Wrong boundary length between " << edge.first.first << " and "
+                << edge.first.second << ": " << rag->GetBoundaryLength(node1, node2)
+                << " instead of " << edge.second << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
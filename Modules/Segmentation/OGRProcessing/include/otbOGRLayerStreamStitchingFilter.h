@@ -29,8 +29,11 @@
 //#endif
 
 #include "itkProgressReporter.h"
+#include "otbParallelFor.h"
 
 #include <algorithm>
+#include <functional>
+#include <vector>
 
 namespace otb
 {
@@ -47,6 +50,14 @@ namespace otb
  *  The input image is used to transform pixel coordinates of the streaming lines into
  *  coordinate system of the image, which must be the same as the one in the OGR input file.
  *  This filter is intended to be used after \c StreamingVectorizedSegmentationOGR.
+ *
+ *  The layer is read only once: the features lying within a few pixels of a
+ *  streaming line are kept in an in-memory index, bucketed by stream tile, which
+ *  replaces the spatial filter scans of the layer for each side of each streaming
+ *  line. Labels are not shared between tiles, hence the matching stays geometric.
+ *  The intersections between the candidate polygons of a streaming line and the
+ *  unions of the selected pairs are computed in parallel; the layer is then
+ *  updated sequentially, in the same order as a sequential processing.
  *  @see Example/StreamingMeanShiftSegmentation.cxx
  *
  *  \ingroup OBIA
@@ -131,6 +142,33 @@ protected:
      bool operator() (FusionStruct f1, FusionStruct f2) { return (f1.overlap > f2.overlap); }
   } SortFeature;
 
+  /** Feature close to a streaming line, stored in the in-memory index */
+  struct IndexedFeatureStruct
+  {
+     IndexedFeatureStruct(OGRFeatureType const& f) : feat(f), deleted(false)
+     {
+     }
+     OGRFeatureType feat;
+     OGREnvelope envelope;
+     bool deleted;
+  };
+
+  /** Read the layer once and index the features close to a streaming line */
+  void BuildStreamLineIndex();
+  /** Add a feature to the index. Returns false if it is not close to any
+   * streaming line */
+  bool AddToStreamLineIndex(OGRFeatureType const& feat, bool force);
+  /** Get the indexed features intersecting the rectangle of pixels
+   * [ulIndex, lrIndex], in increasing order of insertion */
+  void QueryStreamLineIndex(IndexType const& ulIndex, IndexType const& lrIndex,
+                            std::vector<std::size_t> & result);
+
+  /** Overlap of two polygons along a streaming line. Returns false if they
+   * are not to be fused. */
+  bool ComputeOverlap(OGRGeometry const& upper, OGRGeometry const& lower,
+                      OGRLineString const& streamLine, double & overlap);
+
+
   /**
    Main computation method. if line is true process row part, else process column part.
    */
@@ -150,6 +188,13 @@ private:
   unsigned int m_Radius;
   OGRLayerType m_OGRLayer;
 
+  /** Indexed features, in increasing order of insertion */
+  std::vector<IndexedFeatureStruct> m_IndexedFeatures;
+  /** Indexed features intersecting each stream tile (row major) */
+  std::vector<std::vector<std::size_t> > m_IndexCells;
+  unsigned int m_NbColStream;
+  unsigned int m_NbRowStream;
+
 
 };
 
@@ -26,14 +26,16 @@
 
 #include <iomanip>
 #include "ogrsf_frmts.h"
-#include <set>
+#include <cmath>
+#include <iterator>
 
 namespace otb
 {
 
 template<class TImage>
 OGRLayerStreamStitchingFilter<TImage>
-::OGRLayerStreamStitchingFilter() : m_Radius(2), m_OGRLayer(nullptr, false)
+::OGRLayerStreamStitchingFilter() : m_Radius(2), m_OGRLayer(nullptr, false),
+  m_NbColStream(0), m_NbRowStream(0)
 {
    m_StreamSize.Fill(0);
 }
@@ -101,33 +103,231 @@ OGRLayerStreamStitchingFilter<TInputImage>
     }
   return dfLength;
 }
+template<class TInputImage>
+bool
+OGRLayerStreamStitchingFilter<TInputImage>
+::ComputeOverlap(OGRGeometry const& upper, OGRGeometry const& lower,
+                 OGRLineString const& streamLine, double & overlap)
+{
+  overlap = 0.;
+  if (!ogr::Intersects(upper, lower))
+    {
+    return false;
+    }
+  ogr::UniqueGeometryPtr intersection2 = ogr::Intersection(upper, lower);
+  if (!intersection2)
+    {
+    return false;
+    }
+  ogr::UniqueGeometryPtr intersection = ogr::Intersection(*intersection2, streamLine);
+  if (!intersection)
+    {
+    return false;
+    }
+
+  if(intersection->getGeometryType() == wkbPolygon)
+    {
+    overlap = dynamic_cast<OGRPolygon *>(intersection.get())->get_Area();
+    }
+  else if(intersection->getGeometryType() == wkbMultiPolygon)
+    {
+    overlap = dynamic_cast<OGRMultiPolygon *>(intersection.get())->get_Area();
+    }
+  else if(intersection->getGeometryType() == wkbGeometryCollection)
+    {
+    overlap = dynamic_cast<OGRGeometryCollection *>(intersection.get())->get_Area();
+    }
+  else if(intersection->getGeometryType() == wkbLineString)
+    {
+    overlap = dynamic_cast<OGRLineString *>(intersection.get())->get_Length();
+    }
+  else if (intersection->getGeometryType() == wkbMultiLineString)
+    {
+    #if(GDAL_VERSION_NUM < 1800)
+    overlap = GetLengthOGRGeometryCollection(dynamic_cast<OGRGeometryCollection *> (intersection.get()));
+    #else
+    overlap = dynamic_cast<OGRMultiLineString *>(intersection.get())->get_Length();
+    #endif
+    }
+  return true;
+}
+
+template<class TInputImage>
+bool
+OGRLayerStreamStitchingFilter<TInputImage>
+::AddToStreamLineIndex(OGRFeatureType const& feat, bool force)
+{
+  OGRGeometry const* geom = feat.GetGeometry();
+  if (!geom)
+    {
+    return false;
+    }
+
+  IndexedFeatureStruct s(feat);
+  geom->getEnvelope(&s.envelope);
+
+  // Bounds of the envelope in continuous index
+  typename InputImageType::ConstPointer inputImage = this->GetInput();
+  OriginType minPoint;
+  minPoint[0] = s.envelope.MinX;
+  minPoint[1] = s.envelope.MinY;
+  OriginType maxPoint;
+  maxPoint[0] = s.envelope.MaxX;
+  maxPoint[1] = s.envelope.MaxY;
+  itk::ContinuousIndex<double,2> minIndex;
+  itk::ContinuousIndex<double,2> maxIndex;
+  inputImage->TransformPhysicalPointToContinuousIndex(minPoint, minIndex);
+  inputImage->TransformPhysicalPointToContinuousIndex(maxPoint, maxIndex);
+
+  double lower[2];
+  double upper[2];
+  const unsigned int nbStreams[2] = {m_NbColStream, m_NbRowStream};
+  bool nearStreamLine = force;
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    lower[dim] = std::min(minIndex[dim], maxIndex[dim]);
+    upper[dim] = std::max(minIndex[dim], maxIndex[dim]);
+
+    // First streaming line whose band [k*size - 1 - radius, k*size + radius]
+    // is not before the envelope
+    const double size = static_cast<double>(m_StreamSize[dim]);
+    const double k = std::max(1., std::ceil((lower[dim] - m_Radius) / size));
+    if (k <= nbStreams[dim] && k * size - 1 - m_Radius <= upper[dim])
+      {
+      nearStreamLine = true;
+      }
+    }
+  if (!nearStreamLine)
+    {
+    return false;
+    }
+
+  // Register the feature in the stream tiles intersecting its envelope
+  unsigned int firstCell[2];
+  unsigned int lastCell[2];
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    const double size = static_cast<double>(m_StreamSize[dim]);
+    const double maxCell = static_cast<double>(nbStreams[dim] - 1);
+    firstCell[dim] = static_cast<unsigned int>(std::min(maxCell, std::max(0., std::floor(lower[dim] / size))));
+    lastCell[dim] = static_cast<unsigned int>(std::min(maxCell, std::max(0., std::floor(upper[dim] / size))));
+    }
+
+  const std::size_t id = m_IndexedFeatures.size();
+  m_IndexedFeatures.push_back(s);
+  for (unsigned int cy = firstCell[1]; cy <= lastCell[1]; ++cy)
+    {
+    for (unsigned int cx = firstCell[0]; cx <= lastCell[0]; ++cx)
+      {
+      m_IndexCells[cy * m_NbColStream + cx].push_back(id);
+      }
+    }
+  return true;
+}
+
 template<class TInputImage>
 void
 OGRLayerStreamStitchingFilter<TInputImage>
-::ProcessStreamingLine( bool line, itk::ProgressReporter & progress)
+::BuildStreamLineIndex()
 {
-   typename InputImageType::ConstPointer inputImage = this->GetInput();
+  m_IndexedFeatures.clear();
+  m_IndexCells.assign(static_cast<std::size_t>(m_NbColStream) * m_NbRowStream,
+                      std::vector<std::size_t>());
 
-   //compute the number of stream division in row and column
-   SizeType imageSize = this->GetInput()->GetLargestPossibleRegion().GetSize();
-   unsigned int nbRowStream = static_cast<unsigned int>(imageSize[1] / m_StreamSize[1] + 1);
-   unsigned int nbColStream = static_cast<unsigned int>(imageSize[0] / m_StreamSize[0] + 1);
+  m_OGRLayer.SetSpatialFilter(nullptr);
+  for (OGRLayerType::const_iterator featIt = m_OGRLayer.begin(); featIt != m_OGRLayer.end(); ++featIt)
+    {
+    this->AddToStreamLineIndex(*featIt, false);
+    }
+}
 
-   /*unsigned long startReporter;
-   unsigned long stopReporter;
-   if (!line)
-   {
-     startReporter = 0;
-     stopReporter = 50;
-   }
-   else
-   {
-     startReporter = 50;
-     stopReporter = 100;
-   }
-   itk::ProgressReporter progress(this,0,2*nbRowStream*nbColStream,100,startReporter); */
+template<class TInputImage>
+void
+OGRLayerStreamStitchingFilter<TInputImage>
+::QueryStreamLineIndex(IndexType const& ulIndex, IndexType const& lrIndex,
+                       std::vector<std::size_t> & result)
+{
+  result.clear();
 
-   for(unsigned int x=1; x<=nbColStream; x++)
+  // Candidates from the stream tiles intersecting the rectangle
+  const unsigned int nbStreams[2] = {m_NbColStream, m_NbRowStream};
+  unsigned int firstCell[2];
+  unsigned int lastCell[2];
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    const double size = static_cast<double>(m_StreamSize[dim]);
+    const double maxCell = static_cast<double>(nbStreams[dim] - 1);
+    firstCell[dim] = static_cast<unsigned int>(std::min(maxCell, std::max(0., std::floor(ulIndex[dim] / size))));
+    lastCell[dim] = static_cast<unsigned int>(std::min(maxCell, std::max(0., std::floor(lrIndex[dim] / size))));
+    }
+  for (unsigned int cy = firstCell[1]; cy <= lastCell[1]; ++cy)
+    {
+    for (unsigned int cx = firstCell[0]; cx <= lastCell[0]; ++cx)
+      {
+      std::vector<std::size_t> const& cell = m_IndexCells[cy * m_NbColStream + cx];
+      result.insert(result.end(), cell.begin(), cell.end());
+      }
+    }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+
+  // Same test as the spatial filter of the layer: envelope first, then
+  // geometry if the envelope is not inside the rectangle
+  typename InputImageType::ConstPointer inputImage = this->GetInput();
+  OriginType  ulCorner;
+  inputImage->TransformIndexToPhysicalPoint(ulIndex, ulCorner);
+  OriginType  lrCorner;
+  inputImage->TransformIndexToPhysicalPoint(lrIndex, lrCorner);
+  OGREnvelope rect;
+  rect.MinX = std::min(ulCorner[0], lrCorner[0]);
+  rect.MaxX = std::max(ulCorner[0], lrCorner[0]);
+  rect.MinY = std::min(ulCorner[1], lrCorner[1]);
+  rect.MaxY = std::max(ulCorner[1], lrCorner[1]);
+
+  OGRLinearRing ring;
+  ring.addPoint(rect.MinX, rect.MinY);
+  ring.addPoint(rect.MinX, rect.MaxY);
+  ring.addPoint(rect.MaxX, rect.MaxY);
+  ring.addPoint(rect.MaxX, rect.MinY);
+  ring.addPoint(rect.MinX, rect.MinY);
+  OGRPolygon rectPolygon;
+  rectPolygon.addRing(&ring);
+
+  std::vector<char> keep(result.size(), 0);
+  ParallelFor(result.size(), this->GetNumberOfThreads(),
+    [&](std::size_t begin, std::size_t end, itk::ThreadIdType)
+    {
+    for (std::size_t i = begin; i < end; ++i)
+      {
+      IndexedFeatureStruct const& s = m_IndexedFeatures[result[i]];
+      if (s.deleted || !s.envelope.Intersects(rect))
+        {
+        continue;
+        }
+      keep[i] = rect.Contains(s.envelope)
+        || ogr::Intersects(*s.feat.GetGeometry(), rectPolygon);
+      }
+    });
+
+  std::size_t nbKept = 0;
+  for (std::size_t i = 0; i < result.size(); ++i)
+    {
+    if (keep[i])
+      {
+      result[nbKept++] = result[i];
+      }
+    }
+  result.resize(nbKept);
+}
+
+template<class TInputImage>
+void
+OGRLayerStreamStitchingFilter<TInputImage>
+::ProcessStreamingLine( bool line, itk::ProgressReporter & progress)
+{
+   typename InputImageType::ConstPointer inputImage = this->GetInput();
+
+   for(unsigned int x=1; x<=m_NbColStream; x++)
    {
    OGRErr errStart = m_OGRLayer.ogr().StartTransaction();
 
@@ -136,7 +336,7 @@ OGRLayerStreamStitchingFilter<TInputImage>
      itkExceptionMacro(<< "Unable to start transaction for OGR layer " << m_OGRLayer.ogr().GetName() << ".");
      }
 
-      for(unsigned int y=1; y<=nbRowStream; y++)
+      for(unsigned int y=1; y<=m_NbRowStream; y++)
       {
 
         //Compute Stream line
@@ -167,8 +367,6 @@ OGRLayerStreamStitchingFilter<TInputImage>
 
 
         //First we get all the feature that intersect the streaming line of the Upper/left stream
-         std::vector<FeatureStruct> upperStreamFeatureList;
-         upperStreamFeatureList.clear();
          IndexType  UpperLeftCorner;
          IndexType  LowerRightCorner;
 
@@ -192,28 +390,10 @@ OGRLayerStreamStitchingFilter<TInputImage>
             LowerRightCorner[1] = m_StreamSize[1]*y - 1; //-1 to stop just before stream line
          }
 
-         OriginType  ulCorner;
-         inputImage->TransformIndexToPhysicalPoint(UpperLeftCorner, ulCorner);
-         OriginType  lrCorner;
-         inputImage->TransformIndexToPhysicalPoint(LowerRightCorner, lrCorner);
-
-         m_OGRLayer.SetSpatialFilterRect(ulCorner[0],lrCorner[1],lrCorner[0],ulCorner[1]);
-
-        std::set<unsigned int> upperFIDs;
-         OGRLayerType::const_iterator featIt = m_OGRLayer.begin();
-         for(; featIt!=m_OGRLayer.end(); ++featIt)
-         {
-            FeatureStruct s(m_OGRLayer.GetLayerDefn());
-            s.feat = *featIt;
-            s.fusioned = false;
-            upperStreamFeatureList.push_back(s);
-           upperFIDs.insert((*featIt).GetFID());
-         }
+         std::vector<std::size_t> upperStreamFeatureList;
+         this->QueryStreamLineIndex(UpperLeftCorner, LowerRightCorner, upperStreamFeatureList);
 
          //Do the same thing for the lower/right stream
-         std::vector<FeatureStruct> lowerStreamFeatureList;
-         lowerStreamFeatureList.clear();
-
          if(!line)
          {
             //Compute the spatial filter of the lower stream
@@ -233,127 +413,134 @@ OGRLayerStreamStitchingFilter<TInputImage>
             LowerRightCorner[1] = m_StreamSize[1]*y + m_Radius;
          }
 
-         inputImage->TransformIndexToPhysicalPoint(UpperLeftCorner, ulCorner);
-         inputImage->TransformIndexToPhysicalPoint(LowerRightCorner, lrCorner);
+         std::vector<std::size_t> lowerCandidates;
+         this->QueryStreamLineIndex(UpperLeftCorner, LowerRightCorner, lowerCandidates);
 
-         m_OGRLayer.SetSpatialFilterRect(ulCorner[0],lrCorner[1],lrCorner[0],ulCorner[1]);
-
-         for(featIt = m_OGRLayer.begin(); featIt!=m_OGRLayer.end(); ++featIt)
-         {
-            if(upperFIDs.find((*featIt).GetFID()) == upperFIDs.end())
-           {
-             FeatureStruct s(m_OGRLayer.GetLayerDefn());
-             s.feat = *featIt;
-             s.fusioned = false;
-             lowerStreamFeatureList.push_back(s);
-           }
-         }
+         // Features of the upper stream are not in the lower stream
+         std::vector<std::size_t> lowerStreamFeatureList;
+         std::set_difference(lowerCandidates.begin(), lowerCandidates.end(),
+                             upperStreamFeatureList.begin(), upperStreamFeatureList.end(),
+                             std::back_inserter(lowerStreamFeatureList));
 
          unsigned int nbUpperPolygons = upperStreamFeatureList.size();
          unsigned int nbLowerPolygons = lowerStreamFeatureList.size();
-         std::vector<FusionStruct> fusionList;
-         fusionList.clear();
+
+         // Polygons may intersect only if their envelopes intersect
+         std::vector<FusionStruct> candidateList;
          for(unsigned int u=0; u<nbUpperPolygons; u++)
          {
+            OGREnvelope const& upperEnvelope = m_IndexedFeatures[upperStreamFeatureList[u]].envelope;
             for(unsigned int l=0; l<nbLowerPolygons; l++)
             {
-               FeatureStruct upper = upperStreamFeatureList[u];
-               FeatureStruct lower = lowerStreamFeatureList[l];
-              if (!(upper.feat == lower.feat))
-              {
-                if (ogr::Intersects(*upper.feat.GetGeometry(), *lower.feat.GetGeometry()))
-                {
-                    ogr::UniqueGeometryPtr intersection2 = ogr::Intersection(*upper.feat.GetGeometry(),*lower.feat.GetGeometry());
-                    ogr::UniqueGeometryPtr intersection = ogr::Intersection(*intersection2, streamLine);
-                    //ogr::UniqueGeometryPtr intersection = ogr::Intersection(*upper.feat.GetGeometry(),*lower.feat.GetGeometry());
-                    if (intersection)
-                    {
-                     FusionStruct fusion;
-                     fusion.indStream1 = u;
-                     fusion.indStream2 = l;
-                     fusion.overlap = 0.;
-
-                     if(intersection->getGeometryType() == wkbPolygon)
-                     {
-                         fusion.overlap = dynamic_cast<OGRPolygon *>(intersection.get())->get_Area();
-                     }
-                     else if(intersection->getGeometryType() == wkbMultiPolygon)
-                     {
-                         fusion.overlap = dynamic_cast<OGRMultiPolygon *>(intersection.get())->get_Area();
-                     }
-                     else if(intersection->getGeometryType() == wkbGeometryCollection)
-                     {
-                         fusion.overlap = dynamic_cast<OGRGeometryCollection *>(intersection.get())->get_Area();
-                     }
-                     else if(intersection->getGeometryType() == wkbLineString)
-                     {
-                         fusion.overlap = dynamic_cast<OGRLineString *>(intersection.get())->get_Length();
-                     }
-                     else if (intersection->getGeometryType() == wkbMultiLineString)
-                     {
-                         #if(GDAL_VERSION_NUM < 1800)
-                     fusion.overlap = GetLengthOGRGeometryCollection(dynamic_cast<OGRGeometryCollection *> (intersection.get()));
-                         #else
-                     fusion.overlap = dynamic_cast<OGRMultiLineString *>(intersection.get())->get_Length();
-                         #endif
-                    }
-
-                     /** -Wunused-variable
-                     long upperFID = upper.feat.GetFID();
-                     long lowerFID = lower.feat.GetFID();
-                     **/
-                     fusionList.push_back(fusion);
-                    }
-                }
-              }
+               if (upperEnvelope.Intersects(m_IndexedFeatures[lowerStreamFeatureList[l]].envelope))
+               {
+                 FusionStruct fusion;
+                 fusion.indStream1 = u;
+                 fusion.indStream2 = l;
+                 fusion.overlap = 0.;
+                 candidateList.push_back(fusion);
+               }
             }
          }
-         unsigned int fusionListSize = fusionList.size();
-         std::sort(fusionList.begin(),fusionList.end(),SortFeature);
-         for(unsigned int i=0; i<fusionListSize; i++)
+
+         // Compute the overlaps of the candidate pairs in parallel
+         std::vector<char> validFusion(candidateList.size(), 0);
+         ParallelFor(candidateList.size(), this->GetNumberOfThreads(),
+           [&](std::size_t begin, std::size_t end, itk::ThreadIdType)
+           {
+           for (std::size_t i = begin; i < end; ++i)
+             {
+             FusionStruct & fusion = candidateList[i];
+             validFusion[i] = this->ComputeOverlap(
+               *m_IndexedFeatures[upperStreamFeatureList[fusion.indStream1]].feat.GetGeometry(),
+               *m_IndexedFeatures[lowerStreamFeatureList[fusion.indStream2]].feat.GetGeometry(),
+               streamLine, fusion.overlap);
+             }
+           });
+
+         std::vector<FusionStruct> fusionList;
+         for(unsigned int i=0; i<candidateList.size(); i++)
          {
-            FeatureStruct upper = upperStreamFeatureList.at(fusionList.at(i).indStream1);
-            FeatureStruct lower = lowerStreamFeatureList.at(fusionList.at(i).indStream2);
-            if( !upper.fusioned && !lower.fusioned)
+            if (validFusion[i])
             {
-              upperStreamFeatureList[fusionList[i].indStream1].fusioned = true;
-               lowerStreamFeatureList[fusionList[i].indStream2].fusioned = true;
-               ogr::UniqueGeometryPtr fusionPolygon = ogr::Union(*upper.feat.GetGeometry(),*lower.feat.GetGeometry());
-               OGRFeatureType fusionFeature(m_OGRLayer.GetLayerDefn());
-               fusionFeature.SetGeometry( fusionPolygon.get() );
-
-               ogr::Field field = upper.feat[0];
-               try
-                 {
-                 #ifdef OTB_USE_GDAL_20
-                 // In this case, the feature id can be either
-                 // OFTInteger64 or OFTInteger
-                 switch(field.GetType())
-                   {
-                   case OFTInteger64:
-                   {
-                   fusionFeature[0].SetValue(field.GetValue<GIntBig>());
-                   break;
-                   }
-                   default:
-                   {
-                   fusionFeature[0].SetValue(field.GetValue<int>());
-                   }
-                   }
-                 #else
-                 // Only OFTInteger supported in this case
-                 fusionFeature[0].SetValue(field.GetValue<int>());
-                 #endif
-                 m_OGRLayer.CreateFeature(fusionFeature);
-                 m_OGRLayer.DeleteFeature(lower.feat.GetFID());
-                 m_OGRLayer.DeleteFeature(upper.feat.GetFID());
-                 }
-               catch(itk::ExceptionObject& err)
-                 {
-                   otbWarningMacro(<<"An exception was caught during fusion: "<<err);
-                 }
+              fusionList.push_back(candidateList[i]);
             }
          }
+         std::stable_sort(fusionList.begin(),fusionList.end(),SortFeature);
+
+         // Each polygon is fused at most once per streaming line
+         std::vector<bool> upperFusioned(nbUpperPolygons, false);
+         std::vector<bool> lowerFusioned(nbLowerPolygons, false);
+         std::vector<FusionStruct> selectedList;
+         for(unsigned int i=0; i<fusionList.size(); i++)
+         {
+            if( !upperFusioned[fusionList[i].indStream1] && !lowerFusioned[fusionList[i].indStream2])
+            {
+              upperFusioned[fusionList[i].indStream1] = true;
+              lowerFusioned[fusionList[i].indStream2] = true;
+              selectedList.push_back(fusionList[i]);
+            }
+         }
+
+         // Compute the unions in parallel
+         std::vector<OGRGeometry *> fusionPolygons(selectedList.size(), nullptr);
+         ParallelFor(selectedList.size(), this->GetNumberOfThreads(),
+           [&](std::size_t begin, std::size_t end, itk::ThreadIdType)
+           {
+           for (std::size_t i = begin; i < end; ++i)
+             {
+             fusionPolygons[i] = ogr::Union(
+               *m_IndexedFeatures[upperStreamFeatureList[selectedList[i].indStream1]].feat.GetGeometry(),
+               *m_IndexedFeatures[lowerStreamFeatureList[selectedList[i].indStream2]].feat.GetGeometry()).release();
+             }
+           });
+
+         // Update the layer and the index
+         for(unsigned int i=0; i<selectedList.size(); i++)
+         {
+            ogr::UniqueGeometryPtr fusionPolygon(fusionPolygons[i]);
+            const std::size_t upperId = upperStreamFeatureList[selectedList[i].indStream1];
+            const std::size_t lowerId = lowerStreamFeatureList[selectedList[i].indStream2];
+            OGRFeatureType upperFeat = m_IndexedFeatures[upperId].feat;
+            OGRFeatureType lowerFeat = m_IndexedFeatures[lowerId].feat;
+
+            OGRFeatureType fusionFeature(m_OGRLayer.GetLayerDefn());
+            fusionFeature.SetGeometry( fusionPolygon.get() );
+
+            ogr::Field field = upperFeat[0];
+            try
+              {
+              #ifdef OTB_USE_GDAL_20
+              // In this case, the feature id can be either
+              // OFTInteger64 or OFTInteger
+              switch(field.GetType())
+                {
+                case OFTInteger64:
+                {
+                fusionFeature[0].SetValue(field.GetValue<GIntBig>());
+                break;
+                }
+                default:
+                {
+                fusionFeature[0].SetValue(field.GetValue<int>());
+                }
+                }
+              #else
+              // Only OFTInteger supported in this case
+              fusionFeature[0].SetValue(field.GetValue<int>());
+              #endif
+              m_OGRLayer.CreateFeature(fusionFeature);
+              this->AddToStreamLineIndex(fusionFeature, true);
+              m_OGRLayer.DeleteFeature(lowerFeat.GetFID());
+              m_IndexedFeatures[lowerId].deleted = true;
+              m_OGRLayer.DeleteFeature(upperFeat.GetFID());
+              m_IndexedFeatures[upperId].deleted = true;
+              }
+            catch(itk::ExceptionObject& err)
+              {
+                otbWarningMacro(<<"An exception was caught during fusion: "<<err);
+              }
+         }
 
          // Update progress
          progress.CompletedPixel();
@@ -397,15 +584,20 @@ OGRLayerStreamStitchingFilter<TImage>
 
   //compute the number of stream division in row and column
    SizeType imageSize = this->GetInput()->GetLargestPossibleRegion().GetSize();
-   unsigned int nbRowStream = static_cast<unsigned int>(imageSize[1] / m_StreamSize[1] + 1);
-   unsigned int nbColStream = static_cast<unsigned int>(imageSize[0] / m_StreamSize[0] + 1);
+   m_NbRowStream = static_cast<unsigned int>(imageSize[1] / m_StreamSize[1] + 1);
+   m_NbColStream = static_cast<unsigned int>(imageSize[0] / m_StreamSize[0] + 1);
 
-   itk::ProgressReporter progress(this,0,2*nbRowStream*nbColStream,100,0);
+   itk::ProgressReporter progress(this,0,2*m_NbRowStream*m_NbColStream,100,0);
+   //Index the features close to the streaming lines
+   this->BuildStreamLineIndex();
    //Process column
    this->ProcessStreamingLine(false, progress);
    //Process row
    this->ProcessStreamingLine(true, progress);
 
+   m_IndexedFeatures.clear();
+   m_IndexCells.clear();
+
    this->InvokeEvent(itk::EndEvent());
 }
 
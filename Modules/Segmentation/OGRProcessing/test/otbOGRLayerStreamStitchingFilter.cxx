@@ -23,6 +23,9 @@
 #include "otbImage.h"
 #include "otbImageFileReader.h"
 #include "itksys/SystemTools.hxx"
+#include "otbStopwatch.h"
+
+#include <map>
 
 int otbOGRLayerStreamStitchingFilter(int argc, char * argv[])
 {
@@ -92,3 +95,122 @@ int otbOGRLayerStreamStitchingFilter(int argc, char * argv[])
 
   return EXIT_SUCCESS;
 }
+
+/** Stitch a synthetic layer made of square segments of segmentSize pixels,
+ * cut along the streaming lines. Each segment must be a single feature with
+ * its full area after the fusion. The borders of the segments must not lie
+ * on a streaming line (the least common multiple of the streaming size and
+ * the segment size must be greater than the image size). The image is not
+ * allocated, so that large sizes (e.g. 100000 1000 101) can be used to
+ * benchmark the filter. */
+int otbOGRLayerStreamStitchingFilterSynthetic(int argc, char * argv[])
+{
+  if (argc != 4)
+    {
+      std::cerr << "Usage: " << argv[0];
+      std::cerr << " imageSize streamingSize segmentSize" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+  const long imageSize   = atol(argv[1]);
+  const long streamSize  = atol(argv[2]);
+  const long segmentSize = atol(argv[3]);
+
+  const unsigned int Dimension = 2;
+  typedef unsigned int PixelType;
+  typedef otb::Image<PixelType, Dimension> ImageType;
+  typedef otb::OGRLayerStreamStitchingFilter<ImageType> FilterType;
+
+  ImageType::Pointer image = ImageType::New();
+  ImageType::RegionType region;
+  region.SetSize(0, imageSize);
+  region.SetSize(1, imageSize);
+  image->SetLargestPossibleRegion(region);
+
+  otb::ogr::DataSource::Pointer ogrDS = otb::ogr::DataSource::New();
+  otb::ogr::Layer layer = ogrDS->CreateLayer("layer", nullptr, wkbPolygon);
+  OGRFieldDefn field("DN", OFTInteger);
+  layer.CreateField(field, true);
+
+  // Cut each segment by the stream tiles
+  const long nbSegments = (imageSize + segmentSize - 1) / segmentSize;
+  for (long sy = 0; sy < nbSegments; ++sy)
+    {
+    for (long sx = 0; sx < nbSegments; ++sx)
+      {
+      const long segmentEnd[2] = {std::min(imageSize, (sx + 1) * segmentSize),
+                                  std::min(imageSize, (sy + 1) * segmentSize)};
+      for (long y0 = sy * segmentSize; y0 < segmentEnd[1]; y0 = (y0 / streamSize + 1) * streamSize)
+        {
+        const long y1 = std::min(segmentEnd[1], (y0 / streamSize + 1) * streamSize);
+        for (long x0 = sx * segmentSize; x0 < segmentEnd[0]; x0 = (x0 / streamSize + 1) * streamSize)
+          {
+          const long x1 = std::min(segmentEnd[0], (x0 / streamSize + 1) * streamSize);
+          OGRLinearRing ring;
+          ring.addPoint(x0 - 0.5, y0 - 0.5);
+          ring.addPoint(x1 - 0.5, y0 - 0.5);
+          ring.addPoint(x1 - 0.5, y1 - 0.5);
+          ring.addPoint(x0 - 0.5, y1 - 0.5);
+          ring.addPoint(x0 - 0.5, y0 - 0.5);
+          OGRPolygon polygon;
+          polygon.addRing(&ring);
+
+          otb::ogr::Feature feature(layer.GetLayerDefn());
+          feature.SetGeometry(&polygon);
+          feature[0].SetValue(static_cast<int>(sy * nbSegments + sx));
+          layer.CreateFeature(feature);
+          }
+        }
+      }
+    }
+  std::cout << "Number of features before fusion: " << layer.GetFeatureCount(true) << std::endl;
+
+  ImageType::SizeType streamSizeType;
+  streamSizeType.Fill(streamSize);
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetOGRLayer(layer);
+  filter->SetStreamSize(streamSizeType);
+
+  otb::Stopwatch chrono = otb::Stopwatch::StartNew();
+  filter->GenerateData();
+  chrono.Stop();
+  std::cout << "Stitching took " << chrono.GetElapsedMilliseconds() << " ms" << std::endl;
+
+  // Check that each segment is a single feature with the right area
+  layer.SetSpatialFilter(nullptr);
+  std::map<int, double> areas;
+  int nbFeatures = 0;
+  for (otb::ogr::Layer::const_iterator featIt = layer.begin(); featIt != layer.end(); ++featIt, ++nbFeatures)
+    {
+    const int label = (*featIt)[0].GetValue<int>();
+    if (areas.count(label))
+      {
+      std::cerr << "Segment " << label << " is split in several features" << std::endl;
+      return EXIT_FAILURE;
+      }
+    areas[label] = dynamic_cast<OGRSurface const&>(*(*featIt).GetGeometry()).get_Area();
+    }
+  if (nbFeatures != nbSegments * nbSegments)
+    {
+    std::cerr << "Expected " << nbSegments * nbSegments << " features, got " << nbFeatures << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (auto const& labelArea : areas)
+    {
+    const long sx = labelArea.first % nbSegments;
+    const long sy = labelArea.first / nbSegments;
+    const double expectedArea =
+      static_cast<double>(std::min(imageSize, (sx + 1) * segmentSize) - sx * segmentSize)
+      * static_cast<double>(std::min(imageSize, (sy + 1) * segmentSize) - sy * segmentSize);
+    if (std::abs(labelArea.second - expectedArea) > 1e-6 * expectedArea)
+      {
+      std::cerr << "Segment " << labelArea.first << " has an area of " << labelArea.second
+                << " instead of " << expectedArea << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbTiledWatershedSegmentationFilter_h
+#define otbTiledWatershedSegmentationFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "otbParallelFor.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace otb {
+
+/** \class TiledWatershedSegmentationFilter
+*   \brief Watershed segmentation flooding the image by tiles in parallel
+*
+*   The input image (usually a gradient magnitude) is split into tiles of
+*   TileSize pixels, which are flooded in parallel. Each tile is flooded with
+*   a halo of HaloRadius pixels around it, and only the basins of its core
+*   pixels are kept. Basins are identified by their lowest pixel (the seed),
+*   so that the parts of a basin lying in different tiles are merged when
+*   they were flooded from the same seed. With a halo large enough to contain
+*   the minima of the basins crossing the tile borders, the result does not
+*   depend on the tiling.
+*
+*   Tiles are the unit of parallel work, not of streaming: the whole input
+*   is requested and the whole output is produced at once, since basins and
+*   their merging are global. To segment large images, use this filter
+*   through StreamingImageToOGRLayerSegmentationFilter, which streams it on
+*   large tiles.
+*
+*   This is not the algorithm of WatershedSegmentationFilter (which builds
+*   the merge tree of itk::WatershedImageFilter), so the segments differ.
+*
+*   Parameters have the same meaning as for WatershedSegmentationFilter:
+*   - Threshold: input values lower than Threshold (in proportion of the
+*     input range) above the minimum are flattened before flooding;
+*   - Level: adjacent basins are merged when the depth of the shallowest one
+*     below their saddle is lower than Level (in proportion of the input
+*     range). Basins are merged by increasing saddle height.
+*
+*   The output labels are consecutive, starting at 1. Only 2D images are
+*   supported, with 4-connectivity.
+*
+*   \sa WatershedSegmentationFilter
+*
+*   \ingroup Multithreaded
+*
+*   \ingroup OTBWatersheds
+*/
+template <class TInputImage, class TOutputLabelImage>
+class ITK_EXPORT TiledWatershedSegmentationFilter
+  : public itk::ImageToImageFilter<TInputImage, TOutputLabelImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef TiledWatershedSegmentationFilter                         Self;
+  typedef itk::ImageToImageFilter<TInputImage, TOutputLabelImage>  Superclass;
+  typedef itk::SmartPointer<Self>                                  Pointer;
+  typedef itk::SmartPointer<const Self>                            ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TInputImage                                  InputImageType;
+  typedef typename InputImageType::PixelType           InputPixelType;
+  typedef TOutputLabelImage                            OutputLabelImageType;
+  typedef typename OutputLabelImageType::PixelType     LabelType;
+  typedef typename OutputLabelImageType::RegionType    RegionType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(TiledWatershedSegmentationFilter, ImageToImageFilter);
+
+  /** ImageDimension constants */
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+  static_assert(TInputImage::ImageDimension == 2, "Only 2D images are supported");
+
+  itkSetMacro(Level, float);
+  itkGetConstMacro(Level, float);
+
+  itkSetMacro(Threshold, float);
+  itkGetConstMacro(Threshold, float);
+
+  /** Size of the flooded tiles (512 by default) */
+  itkSetMacro(TileSize, unsigned int);
+  itkGetConstMacro(TileSize, unsigned int);
+
+  /** Radius of the halo flooded around each tile (64 by default) */
+  itkSetMacro(HaloRadius, unsigned int);
+  itkGetConstMacro(HaloRadius, unsigned int);
+
+  /** Number of segments of the last output */
+  itkGetConstMacro(NumberOfSegments, std::size_t);
+
+protected:
+  TiledWatershedSegmentationFilter();
+  ~TiledWatershedSegmentationFilter() override {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const override;
+
+  /** The whole image is processed: the filter is not streamed */
+  void EnlargeOutputRequestedRegion(itk::DataObject * output) override;
+
+  void GenerateInputRequestedRegion() override;
+
+  void GenerateData() override;
+
+private:
+  TiledWatershedSegmentationFilter(const Self &) = delete;
+  void operator =(const Self&) = delete;
+
+  /** Core region of a tile and seeds of its basins */
+  struct TileType
+  {
+    std::size_t X;
+    std::size_t Y;
+    std::size_t Width;
+    std::size_t Height;
+    /** Linear index of the seed of each basin of the tile */
+    std::vector<std::uint64_t> Seeds;
+    /** Global node of each basin of the tile */
+    std::vector<std::uint32_t> Nodes;
+  };
+
+  /** Undirected edge between two basins, with the height of their saddle */
+  struct EdgeType
+  {
+    std::uint32_t First;
+    std::uint32_t Second;
+    double        Saddle;
+  };
+
+  /** Flood a tile with its halo. Basins of the core pixels are written in
+   * localLabels, as indices in tile.Seeds. */
+  void FloodTile(TileType & tile, std::vector<std::uint32_t> & localLabels) const;
+
+  float        m_Level;
+  float        m_Threshold;
+  unsigned int m_TileSize;
+  unsigned int m_HaloRadius;
+
+  /** Flooded values: input values above the threshold */
+  double       m_ThresholdValue;
+  std::size_t  m_NumberOfSegments;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbTiledWatershedSegmentationFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,420 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbTiledWatershedSegmentationFilter_hxx
+#define otbTiledWatershedSegmentationFilter_hxx
+
+#include "otbTiledWatershedSegmentationFilter.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace otb {
+
+template <class TInputImage, class TOutputLabelImage>
+TiledWatershedSegmentationFilter<TInputImage, TOutputLabelImage>
+::TiledWatershedSegmentationFilter()
+  : m_Level(0.1), m_Threshold(0.01), m_TileSize(512), m_HaloRadius(64),
+    m_ThresholdValue(0.), m_NumberOfSegments(0)
+{
+  this->SetNumberOfRequiredInputs(1);
+}
+
+template <class TInputImage, class TOutputLabelImage>
+void
+TiledWatershedSegmentationFilter<TInputImage, TOutputLabelImage>
+::EnlargeOutputRequestedRegion(itk::DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template <class TInputImage, class TOutputLabelImage>
+void
+TiledWatershedSegmentationFilter<TInputImage, TOutputLabelImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+  auto input = const_cast<InputImageType *>(this->GetInput());
+  if (input)
+    {
+    input->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template <class TInputImage, class TOutputLabelImage>
+void
+TiledWatershedSegmentationFilter<TInputImage, TOutputLabelImage>
+::FloodTile(TileType & tile, std::vector<std::uint32_t> & localLabels) const
+{
+  const InputImageType * input = this->GetInput();
+  const InputPixelType * data = input->GetBufferPointer();
+  const std::size_t width = input->GetBufferedRegion().GetSize()[0];
+  const std::size_t height = input->GetBufferedRegion().GetSize()[1];
+
+  // Tile with its halo
+  const std::size_t halo = m_HaloRadius;
+  const std::size_t x0 = tile.X > halo ? tile.X - halo : 0;
+  const std::size_t y0 = tile.Y > halo ? tile.Y - halo : 0;
+  const std::size_t x1 = std::min(width, tile.X + tile.Width + halo);
+  const std::size_t y1 = std::min(height, tile.Y + tile.Height + halo);
+  const std::size_t w = x1 - x0;
+  const std::size_t h = y1 - y0;
+  const std::uint32_t nbPixels = static_cast<std::uint32_t>(w * h);
+
+  std::vector<double> values(nbPixels);
+  for (std::size_t y = 0; y < h; ++y)
+    {
+    const InputPixelType * row = data + (y0 + y) * width + x0;
+    for (std::size_t x = 0; x < w; ++x)
+      {
+      values[y * w + x] = std::max(static_cast<double>(row[x]), m_ThresholdValue);
+      }
+    }
+
+  // Pixels are flooded by increasing value. Ties are broken by position,
+  // which follows the order of the linear indices in the image.
+  std::vector<std::uint32_t> order(nbPixels);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&values](std::uint32_t a, std::uint32_t b)
+    {
+    return values[a] < values[b] || (values[a] == values[b] && a < b);
+    });
+
+  // Basins, merged with a union-find. The root of a basin is the one with
+  // the lowest seed, so that its seed and minimum never change.
+  const std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+  std::vector<std::uint32_t> basins(nbPixels, none);
+  std::vector<std::uint32_t> parent;
+  std::vector<std::uint32_t> seeds;
+  auto find = [&parent](std::uint32_t b)
+    {
+    while (parent[b] != b)
+      {
+      parent[b] = parent[parent[b]];
+      b = parent[b];
+      }
+    return b;
+    };
+  auto unite = [&](std::uint32_t a, std::uint32_t b)
+    {
+    a = find(a);
+    b = find(b);
+    if (a == b)
+      {
+      return;
+      }
+    // Seeds are pixels, flooded in order
+    if (values[seeds[b]] < values[seeds[a]] || (values[seeds[b]] == values[seeds[a]] && seeds[b] < seeds[a]))
+      {
+      std::swap(a, b);
+      }
+    parent[b] = a;
+    };
+
+  std::uint32_t neighbours[4];
+  for (auto pos : order)
+    {
+    const double value = values[pos];
+    const std::size_t x = pos % w;
+    unsigned int nbNeighbours = 0;
+    if (x > 0)
+      neighbours[nbNeighbours++] = pos - 1;
+    if (x + 1 < w)
+      neighbours[nbNeighbours++] = pos + 1;
+    if (pos >= w)
+      neighbours[nbNeighbours++] = pos - w;
+    if (pos + w < nbPixels)
+      neighbours[nbNeighbours++] = pos + w;
+
+    // Join the basin of the lowest flooded neighbour
+    std::uint32_t best = none;
+    for (unsigned int n = 0; n < nbNeighbours; ++n)
+      {
+      const std::uint32_t q = neighbours[n];
+      if (basins[q] != none && (best == none || values[q] < values[best] || (values[q] == values[best] && q < best)))
+        {
+        best = q;
+        }
+      }
+
+    if (best == none)
+      {
+      // Local minimum: new basin
+      basins[pos] = static_cast<std::uint32_t>(parent.size());
+      parent.push_back(basins[pos]);
+      seeds.push_back(pos);
+      continue;
+      }
+    basins[pos] = find(basins[best]);
+
+    // Basins whose minimum is at this level are flat: they belong to the
+    // same plateau as this pixel, and drain with it
+    for (unsigned int n = 0; n < nbNeighbours; ++n)
+      {
+      const std::uint32_t q = neighbours[n];
+      if (basins[q] != none && values[q] == value && values[seeds[find(basins[q])]] == value)
+        {
+        unite(basins[pos], basins[q]);
+        }
+      }
+    }
+
+  // Compact the basins of the core pixels
+  std::vector<std::uint32_t> compact(parent.size(), none);
+  tile.Seeds.clear();
+  const std::size_t cx = tile.X - x0;
+  const std::size_t cy = tile.Y - y0;
+  for (std::size_t y = 0; y < tile.Height; ++y)
+    {
+    std::uint32_t * out = localLabels.data() + (tile.Y + y) * width + tile.X;
+    for (std::size_t x = 0; x < tile.Width; ++x)
+      {
+      const std::uint32_t root = find(basins[(cy + y) * w + cx + x]);
+      if (compact[root] == none)
+        {
+        compact[root] = static_cast<std::uint32_t>(tile.Seeds.size());
+        const std::uint32_t seed = seeds[root];
+        tile.Seeds.push_back(static_cast<std::uint64_t>(y0 + seed / w) * width + x0 + seed % w);
+        }
+      out[x] = compact[root];
+      }
+    }
+}
+
+template <class TInputImage, class TOutputLabelImage>
+void
+TiledWatershedSegmentationFilter<TInputImage, TOutputLabelImage>
+::GenerateData()
+{
+  this->AllocateOutputs();
+
+  const InputImageType * input = this->GetInput();
+  OutputLabelImageType * output = this->GetOutput();
+  const InputPixelType * data = input->GetBufferPointer();
+  LabelType * outData = output->GetBufferPointer();
+  const std::size_t width = input->GetBufferedRegion().GetSize()[0];
+  const std::size_t height = input->GetBufferedRegion().GetSize()[1];
+  const std::size_t nbPixels = width * height;
+  const itk::ThreadIdType nbThreads = this->GetNumberOfThreads();
+
+  if (m_TileSize == 0)
+    {
+    itkExceptionMacro(<< "Tile size must be positive");
+    }
+  const std::size_t tileSize = m_TileSize;
+  const std::size_t paddedSize = tileSize + 2 * static_cast<std::size_t>(m_HaloRadius);
+  if (paddedSize * paddedSize >= std::numeric_limits<std::uint32_t>::max())
+    {
+    itkExceptionMacro(<< "Tiles with their halo are too large");
+    }
+
+  // Input range
+  std::vector<double> threadMin(nbThreads, std::numeric_limits<double>::max());
+  std::vector<double> threadMax(nbThreads, std::numeric_limits<double>::lowest());
+  ParallelFor(nbPixels, nbThreads, [&](std::size_t begin, std::size_t end, itk::ThreadIdType threadId)
+    {
+    for (std::size_t i = begin; i < end; ++i)
+      {
+      threadMin[threadId] = std::min(threadMin[threadId], static_cast<double>(data[i]));
+      threadMax[threadId] = std::max(threadMax[threadId], static_cast<double>(data[i]));
+      }
+    });
+  const double minimum = *std::min_element(threadMin.begin(), threadMin.end());
+  const double maximum = *std::max_element(threadMax.begin(), threadMax.end());
+  m_ThresholdValue = minimum + m_Threshold * (maximum - minimum);
+  const double levelValue = m_Level * (maximum - minimum);
+  auto floodedValue = [this, data](std::uint64_t pos)
+    {
+    return std::max(static_cast<double>(data[pos]), m_ThresholdValue);
+    };
+
+  // Flood the tiles
+  const std::size_t nbTilesX = (width + tileSize - 1) / tileSize;
+  const std::size_t nbTilesY = (height + tileSize - 1) / tileSize;
+  std::vector<TileType> tiles(nbTilesX * nbTilesY);
+  for (std::size_t ty = 0; ty < nbTilesY; ++ty)
+    {
+    for (std::size_t tx = 0; tx < nbTilesX; ++tx)
+      {
+      TileType & tile = tiles[ty * nbTilesX + tx];
+      tile.X = tx * tileSize;
+      tile.Y = ty * tileSize;
+      tile.Width = std::min(tileSize, width - tile.X);
+      tile.Height = std::min(tileSize, height - tile.Y);
+      }
+    }
+
+  std::vector<std::uint32_t> localLabels(nbPixels);
+  ParallelFor(tiles.size(), nbThreads, [&](std::size_t begin, std::size_t end, itk::ThreadIdType)
+    {
+    for (std::size_t t = begin; t < end; ++t)
+      {
+      this->FloodTile(tiles[t], localLabels);
+      }
+    });
+
+  // Basins flooded from the same seed in different tiles are the same node
+  std::vector<std::uint64_t> seeds;
+  for (auto const & tile : tiles)
+    {
+    seeds.insert(seeds.end(), tile.Seeds.begin(), tile.Seeds.end());
+    }
+  std::sort(seeds.begin(), seeds.end());
+  seeds.erase(std::unique(seeds.begin(), seeds.end()), seeds.end());
+  if (seeds.size() >= std::numeric_limits<std::uint32_t>::max())
+    {
+    itkExceptionMacro(<< "Too many basins: " << seeds.size());
+    }
+  for (auto & tile : tiles)
+    {
+    tile.Nodes.resize(tile.Seeds.size());
+    for (std::size_t b = 0; b < tile.Seeds.size(); ++b)
+      {
+      tile.Nodes[b] = static_cast<std::uint32_t>(
+        std::lower_bound(seeds.begin(), seeds.end(), tile.Seeds[b]) - seeds.begin());
+      }
+    }
+  auto nodeOf = [&](std::size_t x, std::size_t y)
+    {
+    TileType const & tile = tiles[(y / tileSize) * nbTilesX + x / tileSize];
+    return tile.Nodes[localLabels[y * width + x]];
+    };
+
+  // Merge the basins by increasing saddle while the shallowest one is
+  // lower than the flood level
+  const std::size_t nbNodes = seeds.size();
+  std::vector<std::uint32_t> parent(nbNodes);
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&parent](std::uint32_t n)
+    {
+    while (parent[n] != n)
+      {
+      parent[n] = parent[parent[n]];
+      n = parent[n];
+      }
+    return n;
+    };
+
+  if (levelValue > 0)
+    {
+    // Lowest saddle between each pair of adjacent basins
+    std::vector<std::vector<EdgeType> > threadEdges(nbThreads);
+    ParallelFor(height, nbThreads, [&](std::size_t begin, std::size_t end, itk::ThreadIdType threadId)
+      {
+      std::vector<EdgeType> & edges = threadEdges[threadId];
+      for (std::size_t y = begin; y < end; ++y)
+        {
+        for (std::size_t x = 0; x < width; ++x)
+          {
+          const std::uint32_t node = nodeOf(x, y);
+          const std::uint64_t pos = y * width + x;
+          if (x + 1 < width && nodeOf(x + 1, y) != node)
+            {
+            edges.push_back({std::min(node, nodeOf(x + 1, y)), std::max(node, nodeOf(x + 1, y)),
+                             std::max(floodedValue(pos), floodedValue(pos + 1))});
+            }
+          if (y + 1 < height && nodeOf(x, y + 1) != node)
+            {
+            edges.push_back({std::min(node, nodeOf(x, y + 1)), std::max(node, nodeOf(x, y + 1)),
+                             std::max(floodedValue(pos), floodedValue(pos + width))});
+            }
+          }
+        }
+      });
+
+    std::vector<EdgeType> edges;
+    for (auto & threadEdge : threadEdges)
+      {
+      edges.insert(edges.end(), threadEdge.begin(), threadEdge.end());
+      std::vector<EdgeType>().swap(threadEdge);
+      }
+    std::sort(edges.begin(), edges.end(), [](EdgeType const & a, EdgeType const & b)
+      {
+      return a.Saddle < b.Saddle
+        || (a.Saddle == b.Saddle && (a.First < b.First || (a.First == b.First && a.Second < b.Second)));
+      });
+
+    std::vector<double> minima(nbNodes);
+    for (std::size_t n = 0; n < nbNodes; ++n)
+      {
+      minima[n] = floodedValue(seeds[n]);
+      }
+    for (auto const & edge : edges)
+      {
+      std::uint32_t root1 = find(edge.First);
+      std::uint32_t root2 = find(edge.Second);
+      if (root1 == root2 || edge.Saddle - std::max(minima[root1], minima[root2]) >= levelValue)
+        {
+        continue;
+        }
+      // The deepest basin absorbs the other one
+      if (minima[root2] < minima[root1] || (minima[root2] == minima[root1] && root2 < root1))
+        {
+        std::swap(root1, root2);
+        }
+      parent[root2] = root1;
+      }
+    }
+
+  // Consecutive labels, in the order of the first seed of each segment.
+  // The root of a segment is not necessarily its smallest node, so the
+  // label is stored on the root when the segment is first met.
+  std::vector<LabelType> labels(nbNodes, 0);
+  LabelType nbSegments = 0;
+  for (std::size_t n = 0; n < nbNodes; ++n)
+    {
+    const std::uint32_t root = find(static_cast<std::uint32_t>(n));
+    if (labels[root] == 0)
+      {
+      labels[root] = ++nbSegments;
+      }
+    labels[n] = labels[root];
+    }
+  m_NumberOfSegments = nbSegments;
+
+  ParallelFor(height, nbThreads, [&](std::size_t begin, std::size_t end, itk::ThreadIdType)
+    {
+    for (std::size_t y = begin; y < end; ++y)
+      {
+      for (std::size_t x = 0; x < width; ++x)
+        {
+        outData[y * width + x] = labels[nodeOf(x, y)];
+        }
+      }
+    });
+}
+
+template <class TInputImage, class TOutputLabelImage>
+void
+TiledWatershedSegmentationFilter<TInputImage, TOutputLabelImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Level: " << m_Level << std::endl;
+  os << indent << "Threshold: " << m_Threshold << std::endl;
+  os << indent << "TileSize: " << m_TileSize << std::endl;
+  os << indent << "HaloRadius: " << m_HaloRadius << std::endl;
+  os << indent << "NumberOfSegments: " << m_NumberOfSegments << std::endl;
+}
+
+} // end namespace otb
+#endif
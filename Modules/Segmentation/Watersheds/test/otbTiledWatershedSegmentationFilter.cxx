@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbTiledWatershedSegmentationFilter.h"
+#include "itkMacro.h"
+#include "otbImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include <vector>
+
+int otbTiledWatershedSegmentationFilter(int argc, char * argv[])
+{
+  if (argc != 4)
+    {
+    std::cerr << "Usage: " << argv[0] << " tileSize haloRadius level" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int tileSize   = atoi(argv[1]);
+  const unsigned int haloRadius = atoi(argv[2]);
+  const float        level      = atof(argv[3]);
+
+  const unsigned int Dimension = 2;
+  typedef float                                                                 PixelType;
+  typedef otb::Image<PixelType,Dimension>                                       InputImageType;
+  typedef otb::Image<unsigned int, Dimension>                                   LabelImageType;
+  typedef otb::TiledWatershedSegmentationFilter<InputImageType, LabelImageType> FilterType;
+
+  // Egg-crate height: one basin per cell of cellSize x cellSize pixels, with
+  // its minimum at the center of the cell. Every pixel has a lower
+  // neighbour in its own cell, so the basins are exactly the cells.
+  // Cells on the even squares of a checkerboard are shallow: inside their
+  // inscribed circle, heights are raised to [40, 49], so their minimum is 40
+  // while their lowest saddle is 49, as for the deep ones (whose minimum is 0
+  // and maximum 98).
+  const unsigned int cellSize = 15;
+  const unsigned int nbCellsX = 10;
+  const unsigned int nbCellsY = 9;
+
+  InputImageType::RegionType region;
+  region.SetSize(0, nbCellsX * cellSize);
+  region.SetSize(1, nbCellsY * cellSize);
+  InputImageType::Pointer image = InputImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<InputImageType> inIt(image, region);
+  for (inIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt)
+    {
+    const int dx = static_cast<int>(inIt.GetIndex()[0] % cellSize) - static_cast<int>(cellSize / 2);
+    const int dy = static_cast<int>(inIt.GetIndex()[1] % cellSize) - static_cast<int>(cellSize / 2);
+    const unsigned int cx = inIt.GetIndex()[0] / cellSize;
+    const unsigned int cy = inIt.GetIndex()[1] / cellSize;
+    const float d2 = dx * dx + dy * dy;
+    inIt.Set(((cx + cy) % 2 == 0 && d2 < 49) ? 40.f + d2 * 9.f / 49.f : d2);
+    }
+
+  // With a level between 9 / 98 and 49 / 98, each shallow cell is absorbed
+  // by the deep neighbour of its first lowest saddle: the one above it, else
+  // the one on its left, else the one on its right. Segments are labelled
+  // in the order of their first cell.
+  std::vector<unsigned int> cellLabels(nbCellsX * nbCellsY, 0);
+  unsigned int nbSegments = 0;
+  for (unsigned int cy = 0; cy < nbCellsY; ++cy)
+    {
+    for (unsigned int cx = 0; cx < nbCellsX; ++cx)
+      {
+      unsigned int owner = cy * nbCellsX + cx;
+      if (level > 0 && (cx + cy) % 2 == 0)
+        {
+        owner = (cy > 0) ? owner - nbCellsX : (cx > 0) ? owner - 1 : owner + 1;
+        }
+      if (cellLabels[owner] == 0)
+        {
+        cellLabels[owner] = ++nbSegments;
+        }
+      cellLabels[cy * nbCellsX + cx] = cellLabels[owner];
+      }
+    }
+
+  // The seeds of the basins touching a tile are within cellSize / 2 pixels of
+  // it: with a halo at least that large, the cells must be found exactly
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetThreshold(0.);
+  filter->SetLevel(level);
+  filter->SetTileSize(tileSize);
+  filter->SetHaloRadius(haloRadius);
+  filter->SetInput(image);
+  filter->Update();
+
+  if (filter->GetNumberOfSegments() != nbSegments)
+    {
+    std::cerr << filter->GetNumberOfSegments() << " segments instead of " << nbSegments << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIteratorWithIndex<LabelImageType> it(filter->GetOutput(), region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const unsigned int expected = cellLabels[(it.GetIndex()[1] / cellSize) * nbCellsX + it.GetIndex()[0] / cellSize];
+    if (it.Get() != expected)
+      {
+      std::cerr << "Label mismatch at " << it.GetIndex() << ": " << it.Get()
+                << " instead of " << expected << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}